@@ -0,0 +1,433 @@
+#include "humanizer.h"
+#include "layout.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Microbenchmarks for the typing core: text loading and scanning, layout
+// lookup, the humanize model's random draws, planning and sink emission. Each
+// benchmark is repeated until it has run for the time budget and reported per
+// unit of work (byte, lookup, draw or keystroke), so numbers from different
+// releases and inputs compare directly. Where the linker supports it
+// (BENCH_COUNT_ALLOCATIONS) the heap allocations the core makes are counted too.
+
+#define BENCH_TEXT_LENGTH (MAX_TEXT_LENGTH - 1)
+#define BENCH_BUDGET_NS 500000000ULL        // Time each benchmark runs for
+#define BENCH_QUICK_BUDGET_NS 50000000ULL
+#define BENCH_DRAWS 1000000                 // Random draws or lookups per run
+#define BENCH_UINPUT_KEYSTROKES 4096        // Keystrokes per uinput run (a system call each)
+
+#ifdef BENCH_COUNT_ALLOCATIONS
+// The build links with --wrap, so every malloc, calloc and realloc in the core
+// comes through here first
+static size_t allocations;
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* pointer, size_t size);
+void __real_free(void* pointer);
+void* __wrap_malloc(size_t size);
+void* __wrap_calloc(size_t count, size_t size);
+void* __wrap_realloc(void* pointer, size_t size);
+void __wrap_free(void* pointer);
+
+void* __wrap_malloc(size_t size) {
+    allocations++;
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    allocations++;
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* pointer, size_t size) {
+    allocations++;
+    return __real_realloc(pointer, size);
+}
+
+void __wrap_free(void* pointer) {
+    __real_free(pointer);
+}
+#endif
+
+// Inputs shared by all benchmarks, prepared once
+typedef struct {
+    char* text;                   // Text every benchmark works on
+    size_t length;
+    const char* path;             // The same text on disk
+    KeySink* null_sink;
+    KeySink* uinput_sink;         // NULL when /dev/uinput is unavailable
+    KeyLayout keyed_layout;       // Printable ASCII on keycodes, the way the platform sinks map it
+    HumanizeModel model;
+    KeyPlan plan;                 // Humanized plan of the text for the null sink
+    KeyPlan scratch;              // Reused by the planning benchmarks
+    KeyPlan releases;             // Key releases for the uinput sink
+    uint64_t result;              // Folded benchmark results, so no loop is optimized away
+} BenchContext;
+
+// One benchmark: does a run of work and returns how many units it covered
+typedef struct {
+    const char* name;
+    const char* unit;
+    size_t (*run)(BenchContext* context);
+} Benchmark;
+
+static size_t BenchLoadText(BenchContext* context) {
+    TypingSimulator simulator;
+    memset(&simulator, 0, sizeof(simulator));
+    if (!LoadFileContent(context->path, &simulator)) {
+        return 0;
+    }
+    context->result += (unsigned char)simulator.text[simulator.length / 2];
+    free(simulator.text);
+    return simulator.length;
+}
+
+static size_t BenchStreamText(BenchContext* context) {
+    TextSource* source = OpenFileTextSource(context->path);
+    if (!source) {
+        return 0;
+    }
+    size_t total = 0;
+    const char* chunk;
+    size_t length;
+    while (source->Next(source, &chunk, &length)) {
+        context->result += (unsigned char)chunk[0];
+        total += length;
+    }
+    CloseTextSource(source);
+    return total;
+}
+
+static size_t BenchScanText(BenchContext* context) {
+    TextScan scan;
+    ScanBuffer(context->text, context->length, &context->keyed_layout, &scan);
+    context->result += scan.words;
+    return context->length;
+}
+
+static size_t BenchLayoutLookup(BenchContext* context) {
+    KeyEvent key;
+    uint64_t sum = 0;
+    for (size_t i = 0, at = 0; i < BENCH_DRAWS; i++, at = at + 1 < context->length ? at + 1 : 0) {
+        uint32_t codepoint = (unsigned char)context->text[at];
+        if (LookupLayout(&context->keyed_layout, codepoint, &key)) {
+            sum += key.code;
+        }
+    }
+    context->result += sum;
+    return BENCH_DRAWS;
+}
+
+static size_t BenchRandom(BenchContext* context) {
+    RandomState rng;
+    SeedRandom(&rng, context->result);
+    uint64_t sum = 0;
+    for (size_t i = 0; i < BENCH_DRAWS; i++) {
+        sum += NextRandom(&rng);
+    }
+    context->result += sum;
+    return BENCH_DRAWS;
+}
+
+static size_t BenchSampleInterval(BenchContext* context) {
+    RandomState rng;
+    SeedRandom(&rng, context->result);
+    uint64_t sum = 0;
+    for (size_t i = 0; i < BENCH_DRAWS; i++) {
+        sum += SampleKeystrokeInterval(&context->model, &rng, 120000000ULL);
+    }
+    context->result += sum;
+    return BENCH_DRAWS;
+}
+
+static size_t BenchSamplePause(BenchContext* context) {
+    RandomState rng;
+    SeedRandom(&rng, context->result);
+    uint64_t sum = 0;
+    for (size_t i = 0; i < BENCH_DRAWS; i++) {
+        sum += SampleThinkingPause(&context->model, &rng) + SampleCorrectionDelay(&context->model, &rng);
+    }
+    context->result += sum;
+    return BENCH_DRAWS;
+}
+
+// Plan the whole text into the scratch plan; returns the keystrokes planned
+static size_t PlanScratch(BenchContext* context, const HumanizeModel* model) {
+    KeyPlanner planner;
+    InitializePlanner(&planner, context->null_sink, 100.0, model, context->result);
+    ClearPlan(&context->scratch);
+    if (!PlanText(&planner, &context->scratch, context->text, context->length) ||
+        !FinishPlan(&planner, &context->scratch)) {
+        return 0;
+    }
+    context->result += context->scratch.events[context->scratch.count - 1].time_ns;
+    return context->scratch.count / 2;
+}
+
+static size_t BenchPlanSteady(BenchContext* context) {
+    return PlanScratch(context, NULL);
+}
+
+static size_t BenchPlanHumanized(BenchContext* context) {
+    return PlanScratch(context, &context->model);
+}
+
+// Hand every keystroke of a plan to a sink, one sink call each
+static size_t EmitKeystrokes(KeySink* sink, const KeyPlan* plan) {
+    size_t keystrokes = 0;
+    for (size_t i = 0; i < plan->count; keystrokes++) {
+        size_t count = PlanGroupLength(plan, i);
+        if (!sink->Emit(sink, &plan->events[i], count)) {
+            return 0;
+        }
+        i += count;
+    }
+    return keystrokes;
+}
+
+static size_t BenchEmitNull(BenchContext* context) {
+    return EmitKeystrokes(context->null_sink, &context->plan);
+}
+
+static size_t BenchEmitUinput(BenchContext* context) {
+    return context->uinput_sink ? EmitKeystrokes(context->uinput_sink, &context->releases) : 0;
+}
+
+static const Benchmark benchmarks[] = {
+    { "load_txt",         "byte",      BenchLoadText },
+    { "stream_txt",       "byte",      BenchStreamText },
+    { "scan",             "byte",      BenchScanText },
+    { "layout_lookup",    "lookup",    BenchLayoutLookup },
+    { "rng_next",         "draw",      BenchRandom },
+    { "sample_interval",  "draw",      BenchSampleInterval },
+    { "sample_pause",     "draw",      BenchSamplePause },
+    { "plan_steady",      "keystroke", BenchPlanSteady },
+    { "plan_humanized",   "keystroke", BenchPlanHumanized },
+    { "emit_null",        "keystroke", BenchEmitNull },
+    { "emit_uinput",      "keystroke", BenchEmitUinput },
+};
+
+// Pseudo-English prose with punctuation and paragraph breaks, the same every run
+static char* GenerateText(size_t length) {
+    static const char* const words[] = {
+        "the", "of", "and", "to", "in", "is", "that", "for", "it", "as", "was", "with", "typing", "keyboard",
+        "humanizer", "quickly", "measure", "between", "latency", "character", "sentence", "paragraph",
+        "simulator", "distribution", "deadline", "Monday", "Z\xC3\xBCrich", "na\xC3\xAFve", "d\xC3\xA9j\xC3\xA0",
+        "\xE2\x80\x94",
+    };
+    char* text = (char*)malloc(length + 1);
+    if (!text) {
+        return NULL;
+    }
+    RandomState rng;
+    SeedRandom(&rng, 1);
+    size_t used = 0;
+    while (used < length) {
+        const char* word = words[NextRandom(&rng) % (sizeof(words) / sizeof(words[0]))];
+        uint64_t roll = NextRandom(&rng) % 100;
+        const char* gap = roll < 2 ? ".\n\n" : roll < 10 ? ". " : roll < 16 ? ", " : " ";
+        size_t word_length = strlen(word);
+        size_t gap_length = strlen(gap);
+        if (used + word_length + gap_length > length) {
+            memset(text + used, ' ', length - used);
+            used = length;
+            break;
+        }
+        memcpy(text + used, word, word_length);
+        memcpy(text + used + word_length, gap, gap_length);
+        used += word_length + gap_length;
+    }
+    text[length] = '\0';
+    return text;
+}
+
+// Load the benchmark text from path, or generate it and write it to a temporary file
+static bool PrepareText(BenchContext* context, const char* path) {
+    static char generated_path[512];
+    if (path) {
+        TypingSimulator simulator;
+        memset(&simulator, 0, sizeof(simulator));
+        if (!LoadFileContent(path, &simulator)) {
+            return false;
+        }
+        context->text = simulator.text;
+        context->length = simulator.length;
+        context->path = path;
+        return true;
+    }
+
+    context->length = BENCH_TEXT_LENGTH;
+    context->text = GenerateText(context->length);
+    if (!context->text) {
+        printf(ANSI_COLOR_RED "Error: Memory allocation failed\n" ANSI_COLOR_RESET);
+        return false;
+    }
+    const char* dir = getenv("TMPDIR");
+    snprintf(generated_path, sizeof(generated_path), "%s/humanizer-bench.txt", dir ? dir : "/tmp");
+    FILE* file = fopen(generated_path, "wb");
+    bool ok = file && fwrite(context->text, 1, context->length, file) == context->length;
+    ok = file && fclose(file) == 0 && ok;
+    if (!ok) {
+        printf(ANSI_COLOR_RED "Error: Could not write %s\n" ANSI_COLOR_RESET, generated_path);
+        return false;
+    }
+    context->path = generated_path;
+    return true;
+}
+
+// Build everything the benchmarks share; false if something is missing
+static bool PrepareBench(BenchContext* context, const char* path, bool uinput) {
+    memset(context, 0, sizeof(*context));
+    InitializePlan(&context->plan);
+    InitializePlan(&context->scratch);
+    InitializePlan(&context->releases);
+    if (!PrepareText(context, path)) {
+        return false;
+    }
+
+    InitializeLayout(&context->keyed_layout, true);
+    for (uint32_t ch = ' '; ch < 0x7F; ch++) {
+        SetLayoutKey(&context->keyed_layout, ch, (uint16_t)ch, (ch >= 'A' && ch <= 'Z') ? KEY_MOD_SHIFT : 0);
+    }
+    SetLayoutKey(&context->keyed_layout, '\t', '\t', 0);
+    SetLayoutKey(&context->keyed_layout, '\n', '\n', 0);
+    SetLayoutKey(&context->keyed_layout, '\b', '\b', 0);
+    FinishLayout(&context->keyed_layout);
+
+    HumanizeProfile profile;
+    DefaultHumanizeProfile(&profile);
+    BuildHumanizeModel(&context->model, &profile);
+
+    context->null_sink = OpenNullSink();
+    if (!context->null_sink) {
+        return false;
+    }
+    KeyPlanner planner;
+    InitializePlanner(&planner, context->null_sink, 100.0, &context->model, 1);
+    if (!PlanText(&planner, &context->plan, context->text, context->length) ||
+        !FinishPlan(&planner, &context->plan)) {
+        return false;
+    }
+
+#ifdef __linux__
+    // Only key releases go to the device: the kernel drops releases of keys
+    // that are not down, so the benchmark pays for the whole write path
+    // without typing anything into the focused window
+    if (uinput) {
+        context->uinput_sink = OpenUinputSink("humanizer-bench", false);
+    }
+    if (context->uinput_sink) {
+        InitializePlanner(&planner, context->uinput_sink, 100.0, NULL, 1);
+        size_t prefix = context->length < BENCH_UINPUT_KEYSTROKES ? context->length : BENCH_UINPUT_KEYSTROKES;
+        if (!PlanText(&planner, &context->releases, context->text, prefix)) {
+            return false;
+        }
+        size_t kept = 0;
+        for (size_t i = 0; i < context->releases.count; i++) {
+            KeyEvent event = context->releases.events[i];
+            if ((event.flags & KEY_EVENT_UP) && !(event.flags & KEY_EVENT_UNICODE)) {
+                event.mods = 0;
+                context->releases.events[kept++] = event;
+            }
+        }
+        context->releases.count = kept;
+    }
+#else
+    (void)uinput;
+#endif
+    return true;
+}
+
+static void CleanupBench(BenchContext* context) {
+    CleanupPlan(&context->plan);
+    CleanupPlan(&context->scratch);
+    CleanupPlan(&context->releases);
+    CloseSink(context->null_sink);
+    CloseSink(context->uinput_sink);
+    free(context->text);
+}
+
+// Run one benchmark until the budget is spent and print its line
+static void RunBenchmark(BenchContext* context, const Benchmark* benchmark, uint64_t budget_ns) {
+    // One untimed run warms the caches and grows the reused plans
+    if (benchmark->run(context) == 0) {
+        printf("%-16s skipped\n", benchmark->name);
+        return;
+    }
+
+#ifdef BENCH_COUNT_ALLOCATIONS
+    size_t allocations_before = allocations;
+#endif
+    uint64_t units = 0;
+    uint64_t start_ns = MonotonicNowNs();
+    uint64_t elapsed_ns = 0;
+    do {
+        units += benchmark->run(context);
+        elapsed_ns = MonotonicNowNs() - start_ns;
+    } while (elapsed_ns < budget_ns);
+
+    double ns_per_unit = (double)elapsed_ns / (double)units;
+    printf("%-16s %-10s %12.3f %14.0f", benchmark->name, benchmark->unit, ns_per_unit, 1e9 / ns_per_unit);
+#ifdef BENCH_COUNT_ALLOCATIONS
+    printf(" %14.6f", (double)(allocations - allocations_before) / (double)units);
+#endif
+    printf("\n");
+    fflush(stdout);
+}
+
+static void PrintBenchUsage(const char* program) {
+    printf("Usage: %s [--quick] [--uinput] [--text PATH] [NAME...]\n", program);
+    printf("  --quick       Run each benchmark for %llu ms instead of %llu ms\n",
+           BENCH_QUICK_BUDGET_NS / 1000000ULL, BENCH_BUDGET_NS / 1000000ULL);
+    printf("  --uinput      Also time key releases written to a uinput device (needs /dev/uinput)\n");
+    printf("  --text PATH   Benchmark on a .txt or .docx file instead of generated prose\n");
+    printf("  NAME          Run only benchmarks whose name contains NAME\n");
+}
+
+int main(int argc, char** argv) {
+    uint64_t budget_ns = BENCH_BUDGET_NS;
+    bool uinput = false;
+    const char* text_path = NULL;
+    const char* names[sizeof(benchmarks) / sizeof(benchmarks[0])];
+    size_t name_count = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            budget_ns = BENCH_QUICK_BUDGET_NS;
+        } else if (strcmp(argv[i], "--uinput") == 0) {
+            uinput = true;
+        } else if (strcmp(argv[i], "--text") == 0 && i + 1 < argc) {
+            text_path = argv[++i];
+        } else if (argv[i][0] == '-' || name_count == sizeof(names) / sizeof(names[0])) {
+            PrintBenchUsage(argv[0]);
+            return 1;
+        } else {
+            names[name_count++] = argv[i];
+        }
+    }
+
+    BenchContext context;
+    bool ok = PrepareBench(&context, text_path, uinput);
+    if (ok) {
+        printf("%zu bytes of text, %zu keystrokes planned, scan kernel %s\n\n", context.length,
+               context.plan.count / 2, ScanKernelName());
+        printf("%-16s %-10s %12s %14s", "benchmark", "unit", "ns/unit", "units/s");
+#ifdef BENCH_COUNT_ALLOCATIONS
+        printf(" %14s", "allocs/unit");
+#endif
+        printf("\n");
+
+        for (size_t b = 0; b < sizeof(benchmarks) / sizeof(benchmarks[0]); b++) {
+            bool selected = name_count == 0;
+            for (size_t i = 0; i < name_count && !selected; i++) {
+                selected = strstr(benchmarks[b].name, names[i]) != NULL;
+            }
+            if (selected) {
+                RunBenchmark(&context, &benchmarks[b], budget_ns);
+            }
+        }
+    }
+    CleanupBench(&context);
+    return ok ? 0 : 1;
+}
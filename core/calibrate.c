@@ -0,0 +1,483 @@
+#include "humanizer.h"
+#include "calibrate.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Longest profile file line
+#define PROFILE_LINE_SIZE 256
+
+// Read a profile file over the defaults
+bool LoadTypingProfile(const char* path, TypingProfile* profile) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        printf(ANSI_COLOR_RED "Error: Could not open profile %s\n" ANSI_COLOR_RESET, path);
+        return false;
+    }
+
+    char line[PROFILE_LINE_SIZE];
+    size_t number = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file)) {
+        number++;
+        char* hash = strchr(line, '#');
+        if (hash) {
+            *hash = '\0';
+        }
+        char* key = line + strspn(line, " \t");
+        size_t length = strlen(key);
+        while (length > 0 && strchr(" \t\r\n", key[length - 1])) {
+            key[--length] = '\0';
+        }
+        if (length == 0) {
+            continue;
+        }
+
+        char* equals = strchr(key, '=');
+        char* end = NULL;
+        double value = 0.0;
+        if (equals) {
+            *equals = '\0';
+            value = strtod(equals + 1, &end);
+        }
+        if (equals && strcmp(key, "keyboard") == 0) {
+            ok = (profile->humanize.keyboard = FindKeyboardLayout(equals + 1)) >= 0;
+        } else if (!equals || end == equals + 1 || *end != '\0') {
+            ok = false;
+        } else if (strcmp(key, "wpm") == 0) {
+            ok = value > 0;
+            profile->wpm = value;
+        } else {
+            ok = SetHumanizeOption(&profile->humanize, key, value);
+        }
+        if (!ok) {
+            printf(ANSI_COLOR_RED "Error: Invalid setting on line %zu of %s\n" ANSI_COLOR_RESET, number, path);
+        }
+    }
+    fclose(file);
+    if (ok && !IsValidHumanizeProfile(&profile->humanize)) {
+        printf(ANSI_COLOR_RED "Error: correction_min is above correction_max in %s\n" ANSI_COLOR_RESET, path);
+        ok = false;
+    }
+    return ok;
+}
+
+// Write a profile file
+bool SaveTypingProfile(const char* path, const TypingProfile* profile, const char* comment) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        printf(ANSI_COLOR_RED "Error: Could not write profile %s\n" ANSI_COLOR_RESET, path);
+        return false;
+    }
+
+    for (const char* line = comment; line && *line;) {
+        size_t length = strcspn(line, "\n");
+        fprintf(file, "# %.*s\n", (int)length, line);
+        line += length + (line[length] == '\n');
+    }
+    const HumanizeProfile* humanize = &profile->humanize;
+    fprintf(file, "wpm=%.2f\n", profile->wpm);
+    fprintf(file, "variation=%.4f\n", humanize->speed_variation);
+    fprintf(file, "typo=%.6f\n", humanize->typo_probability);
+    fprintf(file, "correction_min=%.3f\n", humanize->correction_min);
+    fprintf(file, "correction_max=%.3f\n", humanize->correction_max);
+    fprintf(file, "word_pause=%.4f\n", humanize->word_pause_probability);
+    fprintf(file, "sentence_pause=%.4f\n", humanize->sentence_pause_probability);
+    fprintf(file, "pause_median=%.4f\n", humanize->pause_median);
+    fprintf(file, "distance=%.4f\n", humanize->distance_weight);
+    fprintf(file, "keyboard=%s\n", kKeyboardLayouts[humanize->keyboard].name);
+
+    bool ok = fclose(file) == 0;
+    if (!ok) {
+        printf(ANSI_COLOR_RED "Error: Could not write profile %s\n" ANSI_COLOR_RESET, path);
+    }
+    return ok;
+}
+
+// One measurement, shared by its worker threads
+typedef struct {
+    const char* text;
+    size_t length;
+    KeySink* sink;         // Null sink; only its layout is used
+    const HumanizeModel* model;
+    double wpm;
+    size_t sessions;
+    size_t session_chars;
+    uint64_t seed;
+    atomic_size_t next;    // Next session to plan
+    atomic_bool failed;    // A worker ran out of memory
+    double* session_wpm;   // Per session results, indexed by session
+    size_t* session_chars_typed;
+    size_t* session_typos;
+} CalibrationRun;
+
+// Plan one session over a slice of the corpus and record its speed and typos
+static bool MeasureSession(CalibrationRun* run, KeyPlan* plan, size_t index) {
+    RandomState rng;
+    SeedRandom(&rng, run->seed + index);
+
+    // Slices start and end on character boundaries
+    size_t span = run->session_chars < run->length ? run->session_chars : run->length;
+    size_t start = run->length > span ? (size_t)(NextRandom(&rng) % (run->length - span + 1)) : 0;
+    while (start < run->length && ((uint8_t)run->text[start] & 0xC0) == 0x80) {
+        start++;
+    }
+    size_t end = start + span < run->length ? start + span : run->length;
+    while (end < run->length && ((uint8_t)run->text[end] & 0xC0) == 0x80) {
+        end++;
+    }
+
+    KeyPlanner planner;
+    InitializePlanner(&planner, run->sink, run->wpm, run->model, NextRandom(&rng));
+    ClearPlan(plan);
+    if (!PlanText(&planner, plan, run->text + start, end - start) || !FinishPlan(&planner, plan)) {
+        return false;
+    }
+
+    size_t chars = 0;
+    bool any = false;
+    uint64_t first_ns = 0;
+    uint64_t last_ns = 0;
+    for (size_t i = 0; i < plan->count; i++) {
+        const KeyEvent* event = &plan->events[i];
+        if (event->flags & (KEY_EVENT_UP | KEY_EVENT_HOLD)) {
+            continue;
+        }
+        if (!(event->flags & KEY_EVENT_CORRECTION)) {
+            chars++;
+        }
+        if (!any) {
+            first_ns = event->time_ns;
+            any = true;
+        }
+        last_ns = event->time_ns;
+    }
+
+    // chars - 1 intervals separate the first character from the last
+    double minutes = (double)(last_ns - first_ns) / 60e9;
+    run->session_wpm[index] = chars > 1 && minutes > 0.0 ? (double)(chars - 1) / CHARS_PER_WORD / minutes : 0.0;
+    run->session_chars_typed[index] = chars;
+    run->session_typos[index] = planner.typos;
+    return true;
+}
+
+// Worker: plan sessions until none are left
+static void CalibrationWorker(void* arg) {
+    CalibrationRun* run = (CalibrationRun*)arg;
+    KeyPlan plan;
+    InitializePlan(&plan);
+    while (!atomic_load_explicit(&run->failed, memory_order_relaxed)) {
+        size_t index = atomic_fetch_add_explicit(&run->next, 1, memory_order_relaxed);
+        if (index >= run->sessions) {
+            break;
+        }
+        if (!MeasureSession(run, &plan, index)) {
+            atomic_store_explicit(&run->failed, true, memory_order_relaxed);
+        }
+    }
+    CleanupPlan(&plan);
+}
+
+// Plan the sessions on worker threads and sum them up
+bool MeasureTypingProfile(const char* text, size_t length, const TypingProfile* profile, size_t sessions,
+                          size_t session_chars, unsigned threads, uint64_t seed, CalibrationResult* result) {
+    memset(result, 0, sizeof(*result));
+    if (threads == 0) {
+        threads = CountProcessors();
+    }
+    if (threads > sessions) {
+        threads = sessions > 0 ? (unsigned)sessions : 1;
+    }
+
+    HumanizeModel model;
+    BuildHumanizeModel(&model, &profile->humanize);
+    CalibrationRun run;
+    memset(&run, 0, sizeof(run));
+    run.text = text;
+    run.length = length;
+    run.sink = OpenNullSink();
+    run.model = &model;
+    run.wpm = profile->wpm;
+    run.sessions = sessions;
+    run.session_chars = session_chars;
+    run.seed = seed;
+    atomic_init(&run.next, 0);
+    atomic_init(&run.failed, false);
+    run.session_wpm = (double*)calloc(sessions ? sessions : 1, sizeof(double));
+    run.session_chars_typed = (size_t*)calloc(sessions ? sessions : 1, sizeof(size_t));
+    run.session_typos = (size_t*)calloc(sessions ? sessions : 1, sizeof(size_t));
+    HumanizerThread* workers = (HumanizerThread*)calloc(threads, sizeof(HumanizerThread));
+    bool ok = run.sink && run.session_wpm && run.session_chars_typed && run.session_typos && workers;
+
+    // The calling thread plans too; any worker that does not start leaves its share to the others
+    unsigned started = 0;
+    while (ok && started + 1 < threads && StartThread(&workers[started], CalibrationWorker, &run)) {
+        started++;
+    }
+    if (ok) {
+        CalibrationWorker(&run);
+    }
+    for (unsigned i = 0; i < started; i++) {
+        JoinThread(&workers[i]);
+    }
+    ok = ok && !atomic_load(&run.failed);
+
+    if (ok) {
+        // Welford's running mean and variance
+        double mean = 0.0;
+        double squares = 0.0;
+        size_t typos = 0;
+        for (size_t i = 0; i < sessions; i++) {
+            double delta = run.session_wpm[i] - mean;
+            mean += delta / (double)(i + 1);
+            squares += delta * (run.session_wpm[i] - mean);
+            result->chars += run.session_chars_typed[i];
+            typos += run.session_typos[i];
+        }
+        result->mean_wpm = mean;
+        result->sd_wpm = sessions > 1 ? sqrt(squares / (double)(sessions - 1)) : 0.0;
+        result->typo_rate = result->chars ? (double)typos / (double)result->chars : 0.0;
+    }
+
+    free(workers);
+    free(run.session_wpm);
+    free(run.session_chars_typed);
+    free(run.session_typos);
+    if (run.sink) {
+        CloseSink(run.sink);
+    }
+    return ok;
+}
+
+// Search state shared by the steps of one calibration
+typedef struct {
+    const CalibrationOptions* options;
+    const char* text;
+    size_t length;
+    size_t measurements;   // Profiles measured so far
+} CalibrationSearch;
+
+static bool Measure(CalibrationSearch* search, const TypingProfile* profile, CalibrationResult* result) {
+    const CalibrationOptions* options = search->options;
+    search->measurements++;
+    // Every measurement replays the same sessions, so differences come from the profile alone
+    return MeasureTypingProfile(search->text, search->length, profile, options->sessions, options->session_chars,
+                                options->threads, options->seed, result);
+}
+
+// Adjust the paced speed and typo probability until the sessions' mean WPM
+// and typo rate hit their targets at the profile's pause length. Both respond
+// close to proportionally, so each round scales them by target / measured.
+// Returns whether the mean WPM was reached.
+static bool FitSpeedAndTypos(CalibrationSearch* search, TypingProfile* profile, CalibrationResult* result,
+                             bool* failed) {
+    const CalibrationOptions* options = search->options;
+    double max_wpm = options->target_wpm * CALIBRATE_MAX_SPEEDUP;
+    for (int round = 0; round < CALIBRATE_FIT_ROUNDS; round++) {
+        if (!Measure(search, profile, result)) {
+            *failed = true;
+            return false;
+        }
+        double speed_error = fabs(result->mean_wpm - options->target_wpm) / options->target_wpm;
+        double typo_error = options->target_typo_rate > 0.0
+                          ? fabs(result->typo_rate - options->target_typo_rate) / options->target_typo_rate
+                          : result->typo_rate;
+        if (speed_error < CALIBRATE_TOLERANCE && typo_error < CALIBRATE_TOLERANCE) {
+            return true;
+        }
+        if (result->mean_wpm <= 0.0 || (profile->wpm >= max_wpm && result->mean_wpm < options->target_wpm)) {
+            return false;
+        }
+
+        profile->wpm *= options->target_wpm / result->mean_wpm;
+        if (profile->wpm > max_wpm) {
+            profile->wpm = max_wpm;
+        }
+        double typo = profile->humanize.typo_probability;
+        if (options->target_typo_rate <= 0.0) {
+            typo = 0.0;
+        } else if (result->typo_rate > 0.0) {
+            typo *= options->target_typo_rate / result->typo_rate;
+        } else {
+            typo = options->target_typo_rate;
+        }
+        profile->humanize.typo_probability = typo < 1.0 ? typo : 1.0;
+    }
+    return fabs(result->mean_wpm - options->target_wpm) / options->target_wpm < CALIBRATE_TOLERANCE * 2;
+}
+
+static void PrintCalibrationStep(const TypingProfile* profile, const CalibrationResult* result, bool fitted) {
+    printf("  pause median %6.3f s, paced %7.1f WPM, typo %.4f -> %7.1f WPM, sd %6.2f, %5.2f%% typos%s\n",
+           profile->humanize.pause_median, profile->wpm, profile->humanize.typo_probability, result->mean_wpm,
+           result->sd_wpm, result->typo_rate * 100.0, fitted ? "" : " (mean not reached)");
+}
+
+// Calibration corpus held whole: the file mapped in place, or a copy
+// gathered chunk by chunk from sources that stream (.docx)
+typedef struct {
+    TextSource* source;
+    TextBuffer copy;
+    const char* text;
+    size_t length;
+} Corpus;
+
+static void CloseCorpus(Corpus* corpus) {
+    CloseTextSource(corpus->source);
+    FreeTextBuffer(&corpus->copy);
+}
+
+// Open the corpus without the size limit of typed documents
+static bool OpenCorpus(const char* path, Corpus* corpus) {
+    memset(corpus, 0, sizeof(*corpus));
+    InitializeTextBuffer(&corpus->copy);
+    corpus->source = OpenFileTextSource(path);
+    if (!corpus->source) {
+        return false;
+    }
+
+    if (corpus->source->text) {
+        corpus->text = corpus->source->text;
+        corpus->length = corpus->source->length;
+    } else {
+        const char* chunk;
+        size_t chunk_length;
+        while (corpus->source->Next(corpus->source, &chunk, &chunk_length)) {
+            if (!ReserveTextBuffer(&corpus->copy, chunk_length)) {
+                printf(ANSI_COLOR_RED "Error: Memory allocation failed\n" ANSI_COLOR_RESET);
+                CloseCorpus(corpus);
+                return false;
+            }
+            memcpy(corpus->copy.data + corpus->copy.length, chunk, chunk_length);
+            corpus->copy.length += chunk_length;
+        }
+        if (corpus->source->failed) {
+            printf(ANSI_COLOR_RED "Error: Could not read %s\n" ANSI_COLOR_RESET, path);
+            CloseCorpus(corpus);
+            return false;
+        }
+        corpus->text = corpus->copy.data;
+        corpus->length = corpus->copy.length;
+    }
+
+    if (corpus->length == 0) {
+        printf(ANSI_COLOR_RED "Error: File is empty\n" ANSI_COLOR_RESET);
+        CloseCorpus(corpus);
+        return false;
+    }
+    return true;
+}
+
+// Search for a profile that hits the targets and write it
+int RunCalibration(const CalibrationOptions* options) {
+    if (options->target_wpm <= 0.0 || options->target_wpm_sd < 0.0 || options->target_typo_rate < 0.0 ||
+        options->sessions < 2 || options->session_chars == 0) {
+        printf(ANSI_COLOR_RED "Error: Invalid calibration targets\n" ANSI_COLOR_RESET);
+        return 1;
+    }
+
+    Corpus corpus;
+    if (!OpenCorpus(options->corpus_path, &corpus)) {
+        return 1;
+    }
+    CalibrationSearch search = { options, corpus.text, corpus.length, 0 };
+    unsigned threads = options->threads ? options->threads : CountProcessors();
+    printf("Calibrating on %s: %zu sessions of %zu bytes per profile on %u threads\n", options->corpus_path,
+           options->sessions, options->session_chars, threads);
+    printf("Targets: %.1f WPM mean, %.2f WPM standard deviation, %.2f%% typos\n", options->target_wpm,
+           options->target_wpm_sd, options->target_typo_rate * 100.0);
+    uint64_t start_ns = MonotonicNowNs();
+
+    // Longer thinking pauses spread session speeds further apart once the
+    // paced speed makes up for them, so the standard deviation is searched by
+    // bisection on the pause median with speed and typos refitted at each step
+    TypingProfile best;
+    best.wpm = options->target_wpm;
+    DefaultHumanizeProfile(&best.humanize);
+    best.humanize.typo_probability = options->target_typo_rate;
+    CalibrationResult best_result;
+    memset(&best_result, 0, sizeof(best_result));
+    bool have_best = false;
+    bool failed = false;
+    TypingProfile start = best;    // Each step starts from the last fitted speed and typos
+
+    double lo = 0.0;
+    double hi = CALIBRATE_MAX_PAUSE_MEDIAN;
+    for (int step = -2; step < CALIBRATE_SEARCH_STEPS && !failed; step++) {
+        // The first two steps try both ends of the range
+        double pause_median = step == -2 ? lo : step == -1 ? hi : (lo + hi) / 2.0;
+        TypingProfile candidate = start;
+        candidate.humanize.pause_median = pause_median;
+        CalibrationResult result;
+        bool fitted = FitSpeedAndTypos(&search, &candidate, &result, &failed);
+        if (failed) {
+            break;
+        }
+        PrintCalibrationStep(&candidate, &result, fitted);
+        if (fitted) {
+            start = candidate;
+        }
+
+        if (fitted && (!have_best || fabs(result.sd_wpm - options->target_wpm_sd) <
+                                         fabs(best_result.sd_wpm - options->target_wpm_sd))) {
+            best = candidate;
+            best_result = result;
+            have_best = true;
+        }
+        if (fitted && fabs(result.sd_wpm - options->target_wpm_sd) <= CALIBRATE_TOLERANCE * options->target_wpm_sd) {
+            break;
+        }
+        if (step == -2 && fitted && result.sd_wpm >= options->target_wpm_sd) {
+            printf("Warning: Sessions vary by %.2f WPM even without thinking pauses; "
+                   "longer sessions vary less\n", result.sd_wpm);
+            break;
+        }
+        if (step == -1 && fitted && result.sd_wpm <= options->target_wpm_sd) {
+            printf("Warning: Pauses up to %.1f s spread sessions by only %.2f WPM\n", hi, result.sd_wpm);
+            break;
+        }
+        if (step >= 0) {
+            if (fitted && result.sd_wpm < options->target_wpm_sd) {
+                lo = pause_median;
+            } else {
+                hi = pause_median;
+            }
+        }
+    }
+
+    if (failed) {
+        printf(ANSI_COLOR_RED "Error: Memory allocation failed\n" ANSI_COLOR_RESET);
+        CloseCorpus(&corpus);
+        return 1;
+    }
+    if (!have_best) {
+        printf(ANSI_COLOR_RED "Error: No profile reaches %.1f WPM on this corpus\n" ANSI_COLOR_RESET,
+               options->target_wpm);
+        CloseCorpus(&corpus);
+        return 1;
+    }
+    if (options->target_typo_rate > 0.0 &&
+        fabs(best_result.typo_rate - options->target_typo_rate) / options->target_typo_rate > CALIBRATE_TOLERANCE * 2) {
+        printf("Warning: Reached %.2f%% typos; the corpus has too few letters for more\n",
+               best_result.typo_rate * 100.0);
+    }
+
+    double seconds = (double)(MonotonicNowNs() - start_ns) / 1e9;
+    printf("%zu profiles measured (%zu sessions) in %.1f s\n", search.measurements,
+           search.measurements * options->sessions, seconds);
+    printf("Result: %.1f WPM mean, %.2f WPM standard deviation, %.2f%% typos\n", best_result.mean_wpm,
+           best_result.sd_wpm, best_result.typo_rate * 100.0);
+
+    char comment[512];
+    snprintf(comment, sizeof(comment),
+             "Typing profile calibrated on %s (%zu sessions of %zu bytes, seed %llu)\n"
+             "Sessions average %.1f WPM with a standard deviation of %.2f WPM and %.2f%% typos",
+             options->corpus_path, options->sessions, options->session_chars, (unsigned long long)options->seed,
+             best_result.mean_wpm, best_result.sd_wpm, best_result.typo_rate * 100.0);
+    bool saved = SaveTypingProfile(options->output_path, &best, comment);
+    if (saved) {
+        printf("Profile written to %s\n", options->output_path);
+    }
+    CloseCorpus(&corpus);
+    return saved ? 0 : 1;
+}
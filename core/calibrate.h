@@ -0,0 +1,73 @@
+#ifndef HUMANIZER_CORE_CALIBRATE_H
+#define HUMANIZER_CORE_CALIBRATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "humanize.h"
+
+// Profile calibration (calibrate.c). The humanize parameters say how a typist
+// behaves keystroke by keystroke, not what a session of them adds up to: typos
+// and thinking pauses slow the planned speed down, and pauses make it vary
+// from session to session. Calibration plans many seeded sessions over slices
+// of a sample corpus on the virtual clock, spread over every processor, and
+// searches for the paced speed, typo probability and pause length whose
+// sessions hit a target mean WPM, WPM standard deviation and typo rate.
+
+#define CALIBRATE_DEFAULT_SESSIONS 1000
+#define CALIBRATE_DEFAULT_SESSION_CHARS 1000 // Bytes of corpus per session
+#define CALIBRATE_DEFAULT_TYPO_RATE 0.01     // Typos per character typed
+#define CALIBRATE_DEFAULT_SD_SHARE 0.1       // Default WPM standard deviation as a share of the mean
+#define CALIBRATE_MAX_PAUSE_MEDIAN 30.0      // Longest median thinking pause searched, in seconds
+#define CALIBRATE_MAX_SPEEDUP 20.0           // Paced speed may reach this multiple of the target
+#define CALIBRATE_SEARCH_STEPS 14            // Bisection steps on the pause median
+#define CALIBRATE_FIT_ROUNDS 8               // Speed and typo refinements per pause median
+#define CALIBRATE_TOLERANCE 0.01             // Relative error accepted for mean WPM and typo rate
+
+// Everything a typing profile file holds: the humanize parameters and the
+// speed the planner paces for. Files are key=value lines with the option
+// names of SetHumanizeOption plus wpm and keyboard (a layout name); # starts
+// a comment.
+typedef struct {
+    double wpm;            // 0 when the file does not set it
+    HumanizeProfile humanize;
+} TypingProfile;
+
+// Read a profile file over the defaults; false (with a message) on errors
+bool LoadTypingProfile(const char* path, TypingProfile* profile);
+
+// Write a profile file, led by comment (may be NULL, may span lines)
+bool SaveTypingProfile(const char* path, const TypingProfile* profile, const char* comment);
+
+// What the sessions planned with one profile add up to
+typedef struct {
+    double mean_wpm;       // Mean session WPM, first keystroke to last (pauses and typos included)
+    double sd_wpm;         // Standard deviation of session WPM
+    double typo_rate;      // Typos per character typed, over all sessions
+    size_t chars;          // Characters typed over all sessions
+} CalibrationResult;
+
+// Plan the given number of sessions, each over a slice of session_chars bytes
+// of text, on threads worker threads (0: one per processor). Session n is
+// fully determined by seed + n. False if memory ran out.
+bool MeasureTypingProfile(const char* text, size_t length, const TypingProfile* profile, size_t sessions,
+                          size_t session_chars, unsigned threads, uint64_t seed, CalibrationResult* result);
+
+typedef struct {
+    const char* corpus_path; // Sample text (.txt or .docx)
+    const char* output_path; // Profile file written
+    double target_wpm;
+    double target_wpm_sd;
+    double target_typo_rate; // Typos per character typed
+    size_t sessions;
+    size_t session_chars;
+    unsigned threads;        // 0: one per processor
+    uint64_t seed;
+} CalibrationOptions;
+
+// Search for a profile that hits the targets and write it; returns the
+// process exit code
+int RunCalibration(const CalibrationOptions* options);
+
+#endif // HUMANIZER_CORE_CALIBRATE_H
@@ -0,0 +1,131 @@
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "humanizer.h"
+#include "clock.h"
+#include "thread.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <mach/mach_time.h>
+#else
+#include <errno.h>
+#endif
+
+#if defined(_WIN32)
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+// Nanoseconds on a monotonic clock with an arbitrary epoch
+uint64_t MonotonicNowNs(void) {
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    QueryPerformanceCounter(&counter);
+
+    // Split the conversion so the multiplication cannot overflow
+    uint64_t seconds = (uint64_t)(counter.QuadPart / frequency.QuadPart);
+    uint64_t remainder = (uint64_t)(counter.QuadPart % frequency.QuadPart);
+    return seconds * 1000000000ULL + remainder * 1000000000ULL / (uint64_t)frequency.QuadPart;
+}
+
+// This thread's waitable timer (high resolution when available), set to fire
+// in ns nanoseconds; NULL if no timer could be created or set
+void* ArmSleepTimer(uint64_t ns) {
+    // One timer per thread, since the renderer and typing threads both sleep here
+    static HUMANIZER_THREAD_LOCAL HANDLE timer;
+    if (!timer) {
+        timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        if (!timer) {
+            timer = CreateWaitableTimerW(NULL, TRUE, NULL);
+        }
+    }
+
+    LARGE_INTEGER due;
+    due.QuadPart = -(LONGLONG)(ns / 100); // Negative means relative, in 100 ns units
+    return timer && SetWaitableTimer(timer, &due, 0, NULL, NULL, FALSE) ? timer : NULL;
+}
+
+// Coarse wait for a relative number of nanoseconds
+static void CoarseSleepNs(uint64_t ns) {
+    HANDLE timer = ArmSleepTimer(ns);
+    if (timer) {
+        WaitForSingleObject(timer, INFINITE);
+    } else {
+        Sleep((DWORD)(ns / 1000000));
+    }
+}
+
+#elif defined(__APPLE__)
+
+// Nanoseconds on a monotonic clock with an arbitrary epoch
+uint64_t MonotonicNowNs(void) {
+    static mach_timebase_info_data_t timebase;
+    if (timebase.denom == 0) {
+        mach_timebase_info(&timebase);
+    }
+    return mach_absolute_time() * timebase.numer / timebase.denom;
+}
+
+// Coarse wait for a relative number of nanoseconds
+static void CoarseSleepNs(uint64_t ns) {
+    static mach_timebase_info_data_t timebase;
+    if (timebase.denom == 0) {
+        mach_timebase_info(&timebase);
+    }
+    mach_wait_until(mach_absolute_time() + ns * timebase.denom / timebase.numer);
+}
+
+#else
+
+// Nanoseconds on a monotonic clock with an arbitrary epoch
+uint64_t MonotonicNowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+#endif
+
+// Sleep on the OS timer until roughly deadline_ns, without spinning
+void CoarseSleepUntilNs(uint64_t deadline_ns) {
+    uint64_t now = MonotonicNowNs();
+    if (now >= deadline_ns) {
+        return;
+    }
+#if defined(_WIN32) || defined(__APPLE__)
+    CoarseSleepNs(deadline_ns - now);
+#else
+    // Absolute deadlines keep wake-up latency from accumulating across keystrokes
+    struct timespec ts;
+    ts.tv_sec = (time_t)(deadline_ns / 1000000000ULL);
+    ts.tv_nsec = (long)(deadline_ns % 1000000000ULL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+#endif
+}
+
+// Block until MonotonicNowNs() >= deadline_ns: sleep on the OS timer, then spin the last stretch
+void SleepUntilNs(uint64_t deadline_ns) {
+    if (deadline_ns > SCHEDULER_SPIN_NS) {
+        CoarseSleepUntilNs(deadline_ns - SCHEDULER_SPIN_NS);
+    }
+
+    while (MonotonicNowNs() < deadline_ns) {
+    }
+}
+
+// Sleep for a (possibly fractional) number of seconds
+void SleepSeconds(double seconds) {
+    if (seconds <= 0.0) {
+        return;
+    }
+    SleepUntilNs(MonotonicNowNs() + (uint64_t)(seconds * 1e9));
+}
@@ -0,0 +1,34 @@
+#ifndef HUMANIZER_CORE_CLOCK_H
+#define HUMANIZER_CORE_CLOCK_H
+
+#include <stdint.h>
+
+// Final stretch before a deadline that is busy-waited instead of slept,
+// sized to cover the wake-up latency of each platform's timer
+#if defined(_WIN32)
+#define SCHEDULER_SPIN_NS 1000000ULL
+#elif defined(__APPLE__)
+#define SCHEDULER_SPIN_NS 100000ULL
+#else
+#define SCHEDULER_SPIN_NS 200000ULL
+#endif
+
+// Nanoseconds on a monotonic clock with an arbitrary epoch
+uint64_t MonotonicNowNs(void);
+
+// Block until MonotonicNowNs() >= deadline_ns
+void SleepUntilNs(uint64_t deadline_ns);
+
+// Sleep until about deadline_ns on the OS timer alone (for threads that don't need precision)
+void CoarseSleepUntilNs(uint64_t deadline_ns);
+
+// Sleep for a (possibly fractional) number of seconds
+void SleepSeconds(double seconds);
+
+#if defined(_WIN32)
+// The calling thread's waitable timer HANDLE, set to fire in ns nanoseconds
+// (NULL if unavailable); lets other waits combine the timer with their own events
+void* ArmSleepTimer(uint64_t ns);
+#endif
+
+#endif // HUMANIZER_CORE_CLOCK_H
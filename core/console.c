@@ -0,0 +1,186 @@
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "humanizer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// Keys that end manual input at the console
+#if defined(_WIN32)
+#define END_OF_INPUT_KEYS "Ctrl+Z, Enter"
+#else
+#define END_OF_INPUT_KEYS "Ctrl+D"
+#endif
+
+// Clear the console screen and scrollback with ANSI escapes (Windows front end
+// enables virtual terminal processing) instead of spawning cls/clear
+void ClearScreen(void) {
+    fputs("\x1b[H\x1b[2J\x1b[3J", stdout);
+    fflush(stdout);
+}
+
+// Clear input buffer safely
+void ClearInputBuffer(void) {
+    int c;
+    while ((c = getchar()) != '\n' && c != EOF);
+}
+
+// Handle the manual input mode where the user types/pastes text
+void HandleManualInput(TypingSimulator* simulator) {
+    ClearScreen();
+    printf("\nEnter your text (type 'END' on a new line or press " END_OF_INPUT_KEYS " to finish):\n");
+
+    // Lines are read straight into the free space of one growing buffer, so
+    // nothing is copied and long lines simply continue where they left off
+    TextBuffer text;
+    InitializeTextBuffer(&text);
+
+    while (true) {
+        if (!ReserveTextBuffer(&text, TEXT_CHUNK_SIZE / 4)) {
+            printf(ANSI_COLOR_RED "Error: Memory allocation failed\n" ANSI_COLOR_RESET);
+            FreeTextBuffer(&text);
+            return;
+        }
+
+        char* line = text.data + text.length;
+        bool line_start = text.length == 0 || line[-1] == '\n';
+        if (!fgets(line, (int)(text.capacity - text.length), stdin)) {
+            // End of input only ends this text; the menu reads stdin next
+            *line = '\0';
+            clearerr(stdin);
+            break;
+        }
+
+        size_t line_length = strlen(line);
+        if (line_start && (strcmp(line, "END\n") == 0 || strcmp(line, "END\r\n") == 0 || strcmp(line, "END") == 0)) {
+            *line = '\0';
+            break;
+        }
+        text.length += line_length;
+    }
+
+    if (text.length == 0) {
+        printf(ANSI_COLOR_RED "Error: No text entered\n" ANSI_COLOR_RESET);
+        FreeTextBuffer(&text);
+        return;
+    }
+
+    simulator->text = text.data;
+    simulator->length = text.length;
+
+    SimulateTyping(simulator);
+}
+
+// Handle the file drop or file path input from the user
+void HandleFileDrop(TypingSimulator* simulator) {
+    ClearScreen();
+    char filepath[MAX_PATH_LENGTH];
+    printf("Enter file path or drag file here: ");
+
+    if (!fgets(filepath, MAX_PATH_LENGTH, stdin)) {
+        printf(ANSI_COLOR_RED "Error: Failed to read input\n" ANSI_COLOR_RESET);
+        return;
+    }
+
+    filepath[strcspn(filepath, "\r\n")] = 0;
+
+    if (strcmp(filepath, "exit") == 0) {
+        exit(0);
+    }
+
+    // Remove quotes if present (Windows adds double quotes, macOS Terminal single quotes)
+    size_t len = strlen(filepath);
+    if (len > 2 && (filepath[0] == '"' || filepath[0] == '\'') && filepath[len - 1] == filepath[0]) {
+        memmove(filepath, filepath + 1, len - 2);
+        filepath[len - 2] = '\0';
+    }
+
+    // Files are streamed rather than loaded, so there is no size limit
+    TextSource* source = OpenFileTextSource(filepath);
+    if (source) {
+        SimulateTypingFromSource(simulator, source);
+        CloseTextSource(source);
+    }
+}
+
+// Handle user choice for input method (manual text or file)
+void HandleInputChoice(TypingSimulator* simulator) {
+    printf("\nSelect input method:\n");
+    printf("1. Type/Paste text\n");
+    printf("2. Drag and drop file\n");
+    printf("3. Exit\n");
+    printf("\nEnter your choice (1-3): ");
+
+    char choice;
+    if (scanf(" %c", &choice) != 1) {
+        printf(ANSI_COLOR_RED "Error: Invalid input\n" ANSI_COLOR_RESET);
+        ClearInputBuffer();
+        return;
+    }
+
+    ClearInputBuffer();
+
+    switch (choice) {
+        case '1':
+            HandleManualInput(simulator);
+            break;
+        case '2':
+            HandleFileDrop(simulator);
+            break;
+        case '3':
+            exit(0);
+        default:
+            printf(ANSI_COLOR_RED "Invalid choice. Please try again.\n" ANSI_COLOR_RESET);
+    }
+}
+
+// Whether standard input is a terminal (rather than a pipe or redirected file)
+bool StandardInputIsInteractive(void) {
+#if defined(_WIN32)
+    return _isatty(_fileno(stdin)) != 0;
+#else
+    return isatty(STDIN_FILENO) != 0;
+#endif
+}
+
+// Type path ("-" for standard input, streamed as it arrives) after
+// delay_seconds, without menu, countdown or screen clears. Prints one result
+// line and returns the process exit code.
+int TypeNonInteractive(TypingSimulator* simulator, const char* path, double delay_seconds) {
+    TextSource* source = strcmp(path, "-") == 0 ? OpenStdinTextSource() : OpenFileTextSource(path);
+    if (!source) {
+        return 1;
+    }
+
+    if (delay_seconds > 0) {
+        uint64_t deadline_ns = MonotonicNowNs() + (uint64_t)(delay_seconds * 1e9);
+        if (simulator->control) {
+            WaitForDeadline(simulator->control, deadline_ns);
+        } else {
+            SleepUntilNs(deadline_ns);
+        }
+    }
+
+    TypingReport report;
+    bool ok = TypeHeadless(simulator, source, &report);
+    CloseTextSource(source);
+
+    if (simulator->latency) {
+        ReportLatencyTrace(simulator->latency);
+    }
+    if (!ok) {
+        printf(ANSI_COLOR_RED "Error: %s\n" ANSI_COLOR_RESET, report.error);
+        return 1;
+    }
+    printf("Typed %zu characters (%zu words, %zu typos corrected) in %.1fs\n",
+           report.chars_typed, report.words_typed, report.typos, (double)report.wall_ns / 1e9);
+    return 0;
+}
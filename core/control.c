@@ -0,0 +1,192 @@
+#if defined(__linux__)
+#define _GNU_SOURCE
+#endif
+
+#include "humanizer.h"
+#include "control.h"
+
+#if defined(__linux__)
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
+#if defined(_WIN32)
+
+bool InitializeRunControl(RunControl* control) {
+    atomic_init(&control->state, RUN_STATE_RUNNING);
+    control->changed = CreateEventW(NULL, FALSE, FALSE, NULL);
+    return control->changed != NULL;
+}
+
+void DestroyRunControl(RunControl* control) {
+    CloseHandle(control->changed);
+}
+
+static void WakeRunControl(RunControl* control) {
+    SetEvent(control->changed);
+}
+
+// Sleep until deadline_ns or a state change, whichever comes first
+static void WaitForChangeUntil(RunControl* control, uint64_t deadline_ns) {
+    uint64_t now = MonotonicNowNs();
+    if (now >= deadline_ns) {
+        return;
+    }
+    HANDLE timer = ArmSleepTimer(deadline_ns - now);
+    if (timer) {
+        HANDLE handles[2] = { control->changed, timer };
+        WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+    } else {
+        WaitForSingleObject(control->changed, (DWORD)((deadline_ns - now) / 1000000));
+    }
+}
+
+// Sleep until the state is no longer expected
+static void WaitForChange(RunControl* control, RunState expected) {
+    if (GetRunState(control) == expected) {
+        WaitForSingleObject(control->changed, INFINITE);
+    }
+}
+
+#elif defined(__linux__)
+
+bool InitializeRunControl(RunControl* control) {
+    atomic_init(&control->state, RUN_STATE_RUNNING);
+    return true;
+}
+
+void DestroyRunControl(RunControl* control) {
+    (void)control;
+}
+
+static void WakeRunControl(RunControl* control) {
+    syscall(SYS_futex, (uint32_t*)&control->state, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+
+// Sleep until deadline_ns or a state change, whichever comes first. FUTEX_WAIT_BITSET
+// takes an absolute CLOCK_MONOTONIC deadline, the same clock as MonotonicNowNs.
+static void WaitForChangeUntil(RunControl* control, uint64_t deadline_ns) {
+    struct timespec ts;
+    ts.tv_sec = (time_t)(deadline_ns / 1000000000ULL);
+    ts.tv_nsec = (long)(deadline_ns % 1000000000ULL);
+    syscall(SYS_futex, (uint32_t*)&control->state, FUTEX_WAIT_BITSET | FUTEX_PRIVATE_FLAG,
+            RUN_STATE_RUNNING, &ts, NULL, FUTEX_BITSET_MATCH_ANY);
+}
+
+// Sleep until the state is no longer expected (the kernel rechecks it atomically)
+static void WaitForChange(RunControl* control, RunState expected) {
+    syscall(SYS_futex, (uint32_t*)&control->state, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+#else
+
+bool InitializeRunControl(RunControl* control) {
+    atomic_init(&control->state, RUN_STATE_RUNNING);
+    if (pthread_mutex_init(&control->lock, NULL) != 0) {
+        return false;
+    }
+    if (pthread_cond_init(&control->changed, NULL) != 0) {
+        pthread_mutex_destroy(&control->lock);
+        return false;
+    }
+    return true;
+}
+
+void DestroyRunControl(RunControl* control) {
+    pthread_cond_destroy(&control->changed);
+    pthread_mutex_destroy(&control->lock);
+}
+
+static void WakeRunControl(RunControl* control) {
+    pthread_mutex_lock(&control->lock);
+    pthread_cond_broadcast(&control->changed);
+    pthread_mutex_unlock(&control->lock);
+}
+
+// Sleep until deadline_ns or a state change, whichever comes first
+static void WaitForChangeUntil(RunControl* control, uint64_t deadline_ns) {
+    pthread_mutex_lock(&control->lock);
+    uint64_t now = MonotonicNowNs();
+    if (GetRunState(control) == RUN_STATE_RUNNING && now < deadline_ns) {
+        // Relative, so wall clock adjustments cannot stretch the wait
+        struct timespec ts;
+        ts.tv_sec = (time_t)((deadline_ns - now) / 1000000000ULL);
+        ts.tv_nsec = (long)((deadline_ns - now) % 1000000000ULL);
+        pthread_cond_timedwait_relative_np(&control->changed, &control->lock, &ts);
+    }
+    pthread_mutex_unlock(&control->lock);
+}
+
+// Sleep until the state is no longer expected
+static void WaitForChange(RunControl* control, RunState expected) {
+    pthread_mutex_lock(&control->lock);
+    while (GetRunState(control) == expected) {
+        pthread_cond_wait(&control->changed, &control->lock);
+    }
+    pthread_mutex_unlock(&control->lock);
+}
+
+#endif
+
+// Change the state and wake the waiting thread
+void SetRunState(RunControl* control, RunState state) {
+    atomic_store_explicit(&control->state, state, memory_order_release);
+    WakeRunControl(control);
+}
+
+// Pause a running control or resume a paused one
+void TogglePause(RunControl* control) {
+    unsigned state = atomic_load_explicit(&control->state, memory_order_relaxed);
+    while (state != RUN_STATE_STOPPED) {
+        unsigned next = state == RUN_STATE_PAUSED ? RUN_STATE_RUNNING : RUN_STATE_PAUSED;
+        if (atomic_compare_exchange_weak_explicit(&control->state, &state, next,
+                                                  memory_order_acq_rel, memory_order_relaxed)) {
+            WakeRunControl(control);
+            return;
+        }
+    }
+}
+
+// Pause a running control; a paused or stopped one is left alone
+void RequestPause(RunControl* control) {
+    unsigned running = RUN_STATE_RUNNING;
+    if (atomic_compare_exchange_strong_explicit(&control->state, &running, RUN_STATE_PAUSED,
+                                                memory_order_acq_rel, memory_order_relaxed)) {
+        WakeRunControl(control);
+    }
+}
+
+// Stop for good; the typing thread gives up at its next wait
+void RequestStop(RunControl* control) {
+    SetRunState(control, RUN_STATE_STOPPED);
+}
+
+// Sleep on the OS until the spin window before deadline_ns, waking early on
+// any state change, then spin the last stretch while watching the state
+RunState WaitForDeadline(RunControl* control, uint64_t deadline_ns) {
+    RunState state = GetRunState(control);
+    if (deadline_ns > SCHEDULER_SPIN_NS) {
+        uint64_t sleep_until = deadline_ns - SCHEDULER_SPIN_NS;
+        while (state == RUN_STATE_RUNNING && MonotonicNowNs() < sleep_until) {
+            WaitForChangeUntil(control, sleep_until);
+            state = GetRunState(control);
+        }
+    }
+
+    while (state == RUN_STATE_RUNNING && MonotonicNowNs() < deadline_ns) {
+        state = GetRunState(control);
+    }
+    return state;
+}
+
+// Block until the state is no longer PAUSED
+RunState WaitWhilePaused(RunControl* control) {
+    RunState state;
+    while ((state = GetRunState(control)) == RUN_STATE_PAUSED) {
+        WaitForChange(control, RUN_STATE_PAUSED);
+    }
+    return state;
+}
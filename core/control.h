@@ -0,0 +1,69 @@
+#ifndef HUMANIZER_CORE_CONTROL_H
+#define HUMANIZER_CORE_CONTROL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif !defined(__linux__)
+#include <pthread.h>
+#endif
+
+// Hotkeys handled by the listener
+#define HOTKEY_PAUSE_NAME "F6"
+#define HOTKEY_STOP_NAME "F8"
+
+// What the typing thread should be doing
+typedef enum {
+    RUN_STATE_RUNNING = 0,
+    RUN_STATE_PAUSED = 1,
+    RUN_STATE_STOPPED = 2
+} RunState;
+
+// Run state shared between the typing thread and whoever pauses or stops it.
+// Waits end as soon as the state changes: Linux waits on a futex on the state
+// word, Windows on an auto-reset event, macOS on a condition variable. Only
+// one thread may wait on a control at a time.
+typedef struct {
+    atomic_uint state;         // RunState
+#if defined(_WIN32)
+    HANDLE changed;            // Signalled on every state change
+#elif !defined(__linux__)
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+#endif
+} RunControl;
+
+// Lifecycle (starts RUNNING)
+bool InitializeRunControl(RunControl* control);
+void DestroyRunControl(RunControl* control);
+
+static inline RunState GetRunState(RunControl* control) {
+    return (RunState)atomic_load_explicit(&control->state, memory_order_acquire);
+}
+
+// State changes, safe from any thread
+void SetRunState(RunControl* control, RunState state);
+void TogglePause(RunControl* control);  // RUNNING <-> PAUSED; a stopped control stays stopped
+void RequestStop(RunControl* control);
+void RequestPause(RunControl* control); // RUNNING -> PAUSED only
+
+// Block until MonotonicNowNs() >= deadline_ns like SleepUntilNs, but return
+// early if the state leaves RUNNING. Returns the state at return.
+RunState WaitForDeadline(RunControl* control, uint64_t deadline_ns);
+
+// Block without using CPU until the state is no longer PAUSED; returns it
+RunState WaitWhilePaused(RunControl* control);
+
+// Global hotkeys (hotkeys_evdev.c, hotkeys_win32.c, hotkeys_quartz.c):
+// HOTKEY_PAUSE_NAME toggles pause, HOTKEY_STOP_NAME stops typing
+typedef struct HotkeyListener HotkeyListener;
+
+// Start listening on a background thread; NULL (after a warning) if hotkeys
+// are unavailable on this system
+HotkeyListener* StartHotkeyListener(RunControl* control);
+void StopHotkeyListener(HotkeyListener* listener);
+
+#endif // HUMANIZER_CORE_CONTROL_H
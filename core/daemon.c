@@ -0,0 +1,751 @@
+#define _GNU_SOURCE
+
+#include "humanizer.h"
+#include "daemon.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#define DAEMON_LINE_LENGTH 512
+#define DAEMON_BACKLOG 16
+#define DAEMON_MAX_PENDING 64
+#define DAEMON_REQUEST_TIMEOUT_S 10
+
+// One queued typing request
+typedef struct DaemonJob {
+    struct DaemonJob* next;
+    uint64_t id;
+    int client;                // Connection that submitted the job and receives its replies
+    char* payload;             // Text for TEXT jobs, NUL-terminated path for FILE jobs
+    size_t length;             // Payload length
+    bool is_file;              // payload is a path
+    double wpm;                // Target speed
+    bool has_seed;             // seed was given explicitly
+    uint64_t seed;
+    bool steady;               // Evenly spaced keystrokes, no humanization
+    bool directives;           // Obey {PAUSE:N}, {WPM:N} and {TYPOS:N} and tidy lists ({PAUSE} is ignored)
+    bool null_sink;            // Discard keystrokes instead of using the worker's device
+    double delay;              // Seconds to wait before typing
+    HumanizeProfile profile;   // Humanization settings
+} DaemonJob;
+
+// Queue shared by the acceptor and the workers
+typedef struct {
+    const DaemonOptions* options;
+    pthread_mutex_t lock;
+    pthread_cond_t ready;      // Signalled when a job is queued or the daemon stops
+    DaemonJob* head;
+    DaemonJob* tail;
+    size_t queued;             // Jobs waiting
+    size_t running;            // Jobs being typed
+    uint64_t next_id;
+    bool stopping;
+} JobQueue;
+
+// Worker thread with its own virtual keyboard
+typedef struct {
+    JobQueue* queue;
+    size_t index;
+    KeySink* device;           // uinput keyboard, opened on first use
+    TypingSimulator* active;   // Simulator of the running job (guarded by queue->lock)
+    HumanizerThread thread;
+    bool started;
+} DaemonWorker;
+
+// Progress receiver state for one job
+typedef struct {
+    int client;
+    uint64_t id;
+    TypingSimulator* simulator;
+} JobProgress;
+
+// Connection whose request is still arriving, read without blocking
+typedef struct {
+    int fd;
+    uint64_t deadline_ns;      // The whole request must have arrived by then
+    char line[DAEMON_LINE_LENGTH]; // Header line so far
+    size_t used;
+    DaemonJob* job;            // Parsed header waiting for its payload
+    size_t received;           // Payload bytes so far
+} PendingRequest;
+
+static volatile sig_atomic_t g_stop_signal = 0;
+
+static void HandleStopSignal(int signal_number) {
+    (void)signal_number;
+    g_stop_signal = 1;
+}
+
+// Send one formatted line; false if the peer is gone. With MSG_DONTWAIT in
+// flags a line that does not fit in the socket buffer is dropped instead.
+static bool SendLineWith(int fd, int flags, const char* format, va_list args) {
+    char line[DAEMON_LINE_LENGTH];
+    int length = vsnprintf(line, sizeof(line), format, args);
+    if (length < 0) {
+        return false;
+    }
+    if ((size_t)length >= sizeof(line)) {
+        length = (int)sizeof(line) - 1;
+        line[length - 1] = '\n';
+    }
+
+    const char* data = line;
+    size_t remaining = (size_t)length;
+    while (remaining > 0) {
+        // Only the first write may be skipped, so a line is never cut short
+        int mode = data == line ? flags : 0;
+        ssize_t sent = send(fd, data, remaining, MSG_NOSIGNAL | mode);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return (mode & MSG_DONTWAIT) && (errno == EAGAIN || errno == EWOULDBLOCK);
+        }
+        data += sent;
+        remaining -= (size_t)sent;
+    }
+    return true;
+}
+
+static bool SendLine(int fd, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    bool ok = SendLineWith(fd, 0, format, args);
+    va_end(args);
+    return ok;
+}
+
+// Like SendLine, but drop the line rather than wait for a slow reader
+static bool TrySendLine(int fd, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    bool ok = SendLineWith(fd, MSG_DONTWAIT, format, args);
+    va_end(args);
+    return ok;
+}
+
+// Apply one key=value option to a job; false if it is not recognised
+static bool ApplyJobOption(DaemonJob* job, const char* key, const char* value) {
+    char* end = NULL;
+    double number = strtod(value, &end);
+    bool numeric = end != value && *end == '\0';
+
+    if (strcmp(key, "sink") == 0) {
+        if (strcmp(value, "null") == 0 || strcmp(value, "uinput") == 0) {
+            job->null_sink = strcmp(value, "null") == 0;
+            return true;
+        }
+        return false;
+    }
+    if (strcmp(key, "keyboard") == 0) {
+        return (job->profile.keyboard = FindKeyboardLayout(value)) >= 0;
+    }
+    if (strcmp(key, "seed") == 0) {
+        job->seed = strtoull(value, &end, 0);
+        job->has_seed = end != value && *end == '\0';
+        return job->has_seed;
+    }
+    if (!numeric || number < 0) {
+        return false;
+    }
+
+    if (strcmp(key, "wpm") == 0 && IsValidWpm(number)) {
+        job->wpm = number;
+    } else if (strcmp(key, "steady") == 0) {
+        job->steady = number != 0;
+    } else if (strcmp(key, "directives") == 0) {
+        job->directives = number != 0;
+    } else if (strcmp(key, "delay") == 0 && number <= MAX_DELAY_S) {
+        job->delay = number;
+    } else if (!SetHumanizeOption(&job->profile, key, number)) {
+        return false;
+    }
+    return true;
+}
+
+static void FreeJob(DaemonJob* job) {
+    if (job->client >= 0) {
+        close(job->client);
+    }
+    free(job->payload);
+    free(job);
+}
+
+// Parse a TEXT/FILE header into a job whose payload is still to be read.
+// Returns the job, or NULL with error set to a message for the client.
+static DaemonJob* ParseJobHeader(char* line, double default_wpm, const char** error) {
+    char* save = NULL;
+    char* kind = strtok_r(line, " ", &save);
+    char* size = strtok_r(NULL, " ", &save);
+
+    if (!kind || !size || (strcmp(kind, "TEXT") != 0 && strcmp(kind, "FILE") != 0)) {
+        *error = "Unknown request (expected TEXT, FILE or STATUS)";
+        return NULL;
+    }
+
+    char* end = NULL;
+    unsigned long long length = strtoull(size, &end, 10);
+    bool is_file = strcmp(kind, "FILE") == 0;
+    if (end == size || *end != '\0' || length == 0 ||
+        length > (is_file ? MAX_PATH_LENGTH * 16ULL : (unsigned long long)MAX_TEXT_LENGTH)) {
+        *error = "Invalid payload length";
+        return NULL;
+    }
+
+    DaemonJob* job = (DaemonJob*)calloc(1, sizeof(DaemonJob));
+    char* payload = (char*)malloc((size_t)length + 1);
+    if (!job || !payload) {
+        free(job);
+        free(payload);
+        *error = "Out of memory";
+        return NULL;
+    }
+    job->client = -1;
+    job->payload = payload;
+    job->length = (size_t)length;
+    job->is_file = is_file;
+    job->wpm = default_wpm;
+    DefaultHumanizeProfile(&job->profile);
+
+    for (char* option = strtok_r(NULL, " ", &save); option; option = strtok_r(NULL, " ", &save)) {
+        char* equals = strchr(option, '=');
+        if (!equals) {
+            *error = "Options must be key=value";
+            FreeJob(job);
+            return NULL;
+        }
+        *equals = '\0';
+        if (!ApplyJobOption(job, option, equals + 1)) {
+            *error = "Unknown option or value out of range";
+            FreeJob(job);
+            return NULL;
+        }
+    }
+    if (!IsValidHumanizeProfile(&job->profile)) {
+        *error = "correction_min is above correction_max";
+        FreeJob(job);
+        return NULL;
+    }
+
+    return job;
+}
+
+// Read whatever the client has sent so far. Returns 0 while more is
+// expected, 1 once the request is complete (request->job is NULL for
+// STATUS) and -1 with error set if it is not a valid request.
+static int ReadRequest(PendingRequest* request, double default_wpm, const char** error) {
+    // The header one byte at a time so no payload bytes are consumed
+    while (!request->job) {
+        char ch;
+        ssize_t got = recv(request->fd, &ch, 1, 0);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return 0;
+        }
+        if (got <= 0 || (ch != '\n' && request->used + 1 >= sizeof(request->line))) {
+            *error = "Request line missing or too long";
+            return -1;
+        }
+        if (ch != '\n') {
+            request->line[request->used++] = ch;
+            continue;
+        }
+        request->line[request->used] = '\0';
+        if (strcmp(request->line, "STATUS") == 0) {
+            return 1;
+        }
+        request->job = ParseJobHeader(request->line, default_wpm, error);
+        if (!request->job) {
+            return -1;
+        }
+    }
+
+    DaemonJob* job = request->job;
+    while (request->received < job->length) {
+        ssize_t got = recv(request->fd, job->payload + request->received, job->length - request->received, 0);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return 0;
+        }
+        if (got <= 0) {
+            *error = "Payload shorter than announced";
+            return -1;
+        }
+        request->received += (size_t)got;
+    }
+    job->payload[job->length] = '\0';
+    if (job->is_file && strlen(job->payload) != job->length) {
+        *error = "Invalid file path";
+        return -1;
+    }
+    return 1;
+}
+
+// Forward renderer snapshots to the client, skipping them while it is not
+// reading so the renderer never waits; a vanished client cancels the job
+static void SendJobProgress(const TypingStats* stats, void* context) {
+    JobProgress* progress = (JobProgress*)context;
+    if (!TrySendLine(progress->client, "PROGRESS %llu chars=%zu words=%zu wpm=%.1f elapsed=%.1f\n",
+                  (unsigned long long)progress->id, stats->chars_typed, stats->words_typed,
+                  stats->current_wpm, stats->elapsed_time)) {
+        RequestStop(progress->simulator->control);
+    }
+}
+
+// Type one job on the worker's device (or a null sink) and report the outcome
+static void RunJob(DaemonWorker* worker, DaemonJob* job) {
+    const DaemonOptions* options = worker->queue->options;
+    KeySink* sink;
+
+    if (job->null_sink) {
+        sink = OpenNullSink();
+    } else {
+        if (!worker->device) {
+            char name[80]; // UINPUT_MAX_NAME_SIZE
+            snprintf(name, sizeof(name), "%s-%zu", options->device_prefix, worker->index);
+            worker->device = OpenUinputSink(name, options->unicode_input);
+        }
+        sink = worker->device;
+    }
+    if (!sink) {
+        SendLine(job->client, "ERROR %llu Could not open the keyboard device\n", (unsigned long long)job->id);
+        return;
+    }
+
+    TextSource* source = job->is_file ? OpenFileTextSource(job->payload)
+                                      : OpenMemoryTextSource(job->payload, job->length);
+    if (!source) {
+        SendLine(job->client, "ERROR %llu Could not open the input\n", (unsigned long long)job->id);
+        if (job->null_sink) {
+            CloseSink(sink);
+        }
+        return;
+    }
+
+    // Shutdown and vanished clients stop the job through its control, which
+    // also cuts short the start delay and the wait for the next keystroke
+    RunControl control;
+    InitializeRunControl(&control);
+
+    TypingSimulator simulator;
+    InitializeSimulator(&simulator, sink, job->wpm);
+    simulator.control = &control;
+    BuildHumanizeModel(&simulator.humanize, &job->profile);
+    simulator.humanized = !job->steady;
+    simulator.directives = job->directives;
+    if (job->has_seed) {
+        simulator.seed = job->seed;
+    }
+
+    JobProgress progress = { job->client, job->id, &simulator };
+    simulator.progress = SendJobProgress;
+    simulator.progress_context = &progress;
+
+    pthread_mutex_lock(&worker->queue->lock);
+    worker->active = &simulator;
+    bool stopping = worker->queue->stopping;
+    pthread_mutex_unlock(&worker->queue->lock);
+    if (stopping) {
+        RequestStop(&control);
+    }
+
+    SendLine(job->client, "STARTED %llu worker=%zu seed=%llu\n",
+             (unsigned long long)job->id, worker->index, (unsigned long long)simulator.seed);
+    if (job->delay > 0) {
+        WaitForDeadline(&control, MonotonicNowNs() + (uint64_t)(job->delay * 1e9));
+    }
+
+    TypingReport report;
+    if (TypeHeadless(&simulator, source, &report)) {
+        SendLine(job->client, "DONE %llu chars=%zu words=%zu typos=%zu skipped=%zu elapsed=%.1f\n",
+                 (unsigned long long)job->id, report.chars_typed, report.words_typed,
+                 report.typos, report.unmapped_chars, (double)report.wall_ns / 1e9);
+    } else {
+        SendLine(job->client, "ERROR %llu %s\n", (unsigned long long)job->id, report.error);
+    }
+    printf("Job %llu on worker %zu: %s (%zu chars)\n", (unsigned long long)job->id, worker->index,
+           report.error ? report.error : "done", report.chars_typed);
+    fflush(stdout);
+
+    pthread_mutex_lock(&worker->queue->lock);
+    worker->active = NULL;
+    pthread_mutex_unlock(&worker->queue->lock);
+
+    CloseTextSource(source);
+    CleanupSimulator(&simulator);
+    DestroyRunControl(&control);
+    if (job->null_sink) {
+        CloseSink(sink);
+    }
+}
+
+// Worker thread body: take jobs until the daemon stops
+static void WorkerMain(void* arg) {
+    DaemonWorker* worker = (DaemonWorker*)arg;
+    JobQueue* queue = worker->queue;
+
+    for (;;) {
+        pthread_mutex_lock(&queue->lock);
+        while (!queue->head && !queue->stopping) {
+            pthread_cond_wait(&queue->ready, &queue->lock);
+        }
+        if (queue->stopping) {
+            pthread_mutex_unlock(&queue->lock);
+            break;
+        }
+        DaemonJob* job = queue->head;
+        queue->head = job->next;
+        if (!queue->head) {
+            queue->tail = NULL;
+        }
+        queue->queued--;
+        queue->running++;
+        pthread_mutex_unlock(&queue->lock);
+
+        RunJob(worker, job);
+
+        pthread_mutex_lock(&queue->lock);
+        queue->running--;
+        pthread_mutex_unlock(&queue->lock);
+        FreeJob(job);
+    }
+}
+
+// Answer a complete request: reply to STATUS or queue the job
+static void AnswerRequest(JobQueue* queue, PendingRequest* request) {
+    int client = request->fd;
+    if (!request->job) {
+        pthread_mutex_lock(&queue->lock);
+        size_t queued = queue->queued;
+        size_t running = queue->running;
+        pthread_mutex_unlock(&queue->lock);
+        SendLine(client, "STATUS queued=%zu running=%zu workers=%zu\n", queued, running, queue->options->workers);
+        close(client);
+        return;
+    }
+
+    // Workers send the remaining replies; a client that stops reading holds
+    // up only its own job, and only for the timeout
+    DaemonJob* job = request->job;
+    job->client = client;
+    fcntl(client, F_SETFL, fcntl(client, F_GETFL) & ~O_NONBLOCK);
+    struct timeval timeout = { DAEMON_REQUEST_TIMEOUT_S, 0 };
+    setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    // Reply before queueing so QUEUED always precedes the worker's STARTED
+    pthread_mutex_lock(&queue->lock);
+    job->id = ++queue->next_id;
+    size_t position = queue->queued + 1;
+    pthread_mutex_unlock(&queue->lock);
+    SendLine(client, "QUEUED %llu %zu\n", (unsigned long long)job->id, position);
+
+    pthread_mutex_lock(&queue->lock);
+    if (queue->tail) {
+        queue->tail->next = job;
+    } else {
+        queue->head = job;
+    }
+    queue->tail = job;
+    queue->queued++;
+    pthread_cond_signal(&queue->ready);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+// Advance one pending connection on the acceptor thread; true once it has
+// been answered, queued or dropped
+static bool ServeRequest(JobQueue* queue, PendingRequest* request, bool readable, uint64_t now_ns) {
+    const char* error = NULL;
+    int state = readable ? ReadRequest(request, queue->options->default_wpm, &error) : 0;
+    if (state == 0 && now_ns >= request->deadline_ns) {
+        state = -1;
+        error = "Request timed out";
+    }
+    if (state < 0) {
+        SendLine(request->fd, "ERROR %s\n", error);
+        close(request->fd);
+        if (request->job) {
+            FreeJob(request->job);
+        }
+        return true;
+    }
+    if (state > 0) {
+        AnswerRequest(queue, request);
+    }
+    return state > 0;
+}
+
+// Fill in a sockaddr_un; false if the path does not fit
+static bool SocketAddress(const char* path, struct sockaddr_un* address) {
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address->sun_path)) {
+        printf(ANSI_COLOR_RED "Error: Socket path too long: %s\n" ANSI_COLOR_RESET, path);
+        return false;
+    }
+    strcpy(address->sun_path, path);
+    return true;
+}
+
+// Bind the listening socket, refusing to steal the path from a live daemon
+static int OpenListeningSocket(const char* path) {
+    struct sockaddr_un address;
+    if (!SocketAddress(path, &address)) {
+        return -1;
+    }
+
+    int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe >= 0) {
+        bool live = connect(probe, (struct sockaddr*)&address, sizeof(address)) == 0;
+        close(probe);
+        if (live) {
+            printf(ANSI_COLOR_RED "Error: A daemon is already listening on %s\n" ANSI_COLOR_RESET, path);
+            return -1;
+        }
+    }
+    unlink(path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        printf(ANSI_COLOR_RED "Error: Could not create socket (%s)\n" ANSI_COLOR_RESET, strerror(errno));
+        return -1;
+    }
+
+    // Only the owner may submit keystrokes
+    mode_t old_mask = umask(0077);
+    bool ok = bind(fd, (struct sockaddr*)&address, sizeof(address)) == 0 && listen(fd, DAEMON_BACKLOG) == 0;
+    umask(old_mask);
+    if (!ok) {
+        printf(ANSI_COLOR_RED "Error: Could not listen on %s (%s)\n" ANSI_COLOR_RESET, path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Socket path used when none is given
+void DefaultDaemonSocketPath(char* buffer, size_t size) {
+    const char* runtime = getenv("XDG_RUNTIME_DIR");
+    if (runtime && runtime[0]) {
+        snprintf(buffer, size, "%s/" DAEMON_SOCKET_NAME, runtime);
+    } else {
+        snprintf(buffer, size, "/tmp/humanizer-%u.sock", (unsigned)getuid());
+    }
+}
+
+// Serve jobs until SIGINT or SIGTERM
+int RunDaemon(const DaemonOptions* options) {
+    if (options->workers == 0 || options->workers > DAEMON_MAX_WORKERS) {
+        printf(ANSI_COLOR_RED "Error: Worker count must be between 1 and %d\n" ANSI_COLOR_RESET, DAEMON_MAX_WORKERS);
+        return 1;
+    }
+
+    int listener = OpenListeningSocket(options->socket_path);
+    if (listener < 0) {
+        return 1;
+    }
+
+    // Stop signals stay blocked except while waiting in ppoll, so none is missed
+    sigset_t stop_signals;
+    sigset_t wait_mask;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, &wait_mask);
+    sigdelset(&wait_mask, SIGINT);
+    sigdelset(&wait_mask, SIGTERM);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = HandleStopSignal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    JobQueue queue;
+    memset(&queue, 0, sizeof(queue));
+    queue.options = options;
+    pthread_mutex_init(&queue.lock, NULL);
+    pthread_cond_init(&queue.ready, NULL);
+
+    // Workers inherit the blocked mask, so signals are always handled here
+    DaemonWorker workers[DAEMON_MAX_WORKERS];
+    memset(workers, 0, sizeof(workers));
+    for (size_t i = 0; i < options->workers; i++) {
+        workers[i].queue = &queue;
+        workers[i].index = i;
+        workers[i].started = StartThread(&workers[i].thread, WorkerMain, &workers[i]);
+        if (!workers[i].started) {
+            printf("Warning: Could not start worker %zu\n", i);
+        }
+    }
+
+    printf("Listening on %s with %zu workers\n", options->socket_path, options->workers);
+    fflush(stdout);
+
+    // Requests are read as they arrive, so a slow client delays no one else
+    PendingRequest pending[DAEMON_MAX_PENDING];
+    size_t pending_count = 0;
+
+    while (!g_stop_signal) {
+        // With every slot taken, new connections wait in the listen backlog
+        struct pollfd poll_fds[DAEMON_MAX_PENDING + 1];
+        poll_fds[0] = (struct pollfd){ pending_count < DAEMON_MAX_PENDING ? listener : -1, POLLIN, 0 };
+        uint64_t wake_ns = UINT64_MAX;
+        for (size_t i = 0; i < pending_count; i++) {
+            poll_fds[i + 1] = (struct pollfd){ pending[i].fd, POLLIN, 0 };
+            wake_ns = pending[i].deadline_ns < wake_ns ? pending[i].deadline_ns : wake_ns;
+        }
+
+        uint64_t now_ns = MonotonicNowNs();
+        uint64_t wait_ns = wake_ns > now_ns ? wake_ns - now_ns : 0;
+        struct timespec timeout = { (time_t)(wait_ns / 1000000000ULL), (long)(wait_ns % 1000000000ULL) };
+        int ready = ppoll(poll_fds, pending_count + 1, wake_ns == UINT64_MAX ? NULL : &timeout, &wait_mask);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            printf(ANSI_COLOR_RED "Error: poll failed (%s)\n" ANSI_COLOR_RESET, strerror(errno));
+            break;
+        }
+
+        // Backwards, so a finished slot can take the last one's place
+        now_ns = MonotonicNowNs();
+        for (size_t i = pending_count; i-- > 0;) {
+            if (ServeRequest(&queue, &pending[i], poll_fds[i + 1].revents != 0, now_ns)) {
+                pending[i] = pending[--pending_count];
+            }
+        }
+
+        if (poll_fds[0].revents & POLLIN) {
+            int client = accept4(listener, NULL, NULL, SOCK_CLOEXEC | SOCK_NONBLOCK);
+            if (client >= 0) {
+                PendingRequest* request = &pending[pending_count++];
+                memset(request, 0, sizeof(*request));
+                request->fd = client;
+                request->deadline_ns = now_ns + DAEMON_REQUEST_TIMEOUT_S * 1000000000ULL;
+            }
+        }
+    }
+
+    printf("Shutting down\n");
+    close(listener);
+    for (size_t i = 0; i < pending_count; i++) {
+        SendLine(pending[i].fd, "ERROR Daemon shutting down\n");
+        close(pending[i].fd);
+        if (pending[i].job) {
+            FreeJob(pending[i].job);
+        }
+    }
+    unlink(options->socket_path);
+
+    // Stop the workers, cancelling whatever they are typing
+    pthread_mutex_lock(&queue.lock);
+    queue.stopping = true;
+    for (size_t i = 0; i < options->workers; i++) {
+        if (workers[i].active) {
+            RequestStop(workers[i].active->control);
+        }
+    }
+    pthread_cond_broadcast(&queue.ready);
+    pthread_mutex_unlock(&queue.lock);
+
+    for (size_t i = 0; i < options->workers; i++) {
+        if (workers[i].started) {
+            JoinThread(&workers[i].thread);
+        }
+        CloseSink(workers[i].device);
+    }
+
+    while (queue.head) {
+        DaemonJob* job = queue.head;
+        queue.head = job->next;
+        SendLine(job->client, "ERROR %llu Daemon shutting down\n", (unsigned long long)job->id);
+        FreeJob(job);
+    }
+
+    pthread_cond_destroy(&queue.ready);
+    pthread_mutex_destroy(&queue.lock);
+    return 0;
+}
+
+// Submit a file or standard input to a running daemon and relay its replies
+int SubmitDaemonJob(const char* socket_path, const char* path, const char* options) {
+    struct sockaddr_un address;
+    if (!SocketAddress(socket_path, &address)) {
+        return 1;
+    }
+
+    bool from_stdin = strcmp(path, "-") == 0;
+    char* payload = NULL;
+    size_t length = 0;
+    if (from_stdin) {
+        TextBuffer text;
+        InitializeTextBuffer(&text);
+        ReadTextBuffer(&text, stdin, MAX_TEXT_LENGTH);
+        payload = text.data;
+        length = text.length;
+    } else {
+        // The daemon has its own working directory
+        payload = realpath(path, NULL);
+        length = payload ? strlen(payload) : 0;
+    }
+    if (!payload || length == 0) {
+        printf(ANSI_COLOR_RED "Error: %s\n" ANSI_COLOR_RESET, from_stdin ? "No text on standard input" : "Could not find file");
+        free(payload);
+        return 1;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0) {
+        printf(ANSI_COLOR_RED "Error: No daemon listening on %s\n" ANSI_COLOR_RESET, socket_path);
+        if (fd >= 0) {
+            close(fd);
+        }
+        free(payload);
+        return 1;
+    }
+
+    bool ok = SendLine(fd, "%s %zu %s\n", from_stdin ? "TEXT" : "FILE", length, options ? options : "");
+    for (size_t sent = 0; ok && sent < length;) {
+        ssize_t n = send(fd, payload + sent, length - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        ok = n > 0;
+        sent += ok ? (size_t)n : 0;
+    }
+    free(payload);
+
+    // Relay replies until the daemon closes the connection
+    FILE* replies = ok ? fdopen(fd, "r") : NULL;
+    if (!replies) {
+        printf(ANSI_COLOR_RED "Error: Could not send the job\n" ANSI_COLOR_RESET);
+        close(fd);
+        return 1;
+    }
+
+    char line[DAEMON_LINE_LENGTH];
+    bool done = false;
+    while (fgets(line, sizeof(line), replies)) {
+        fputs(line, stdout);
+        fflush(stdout);
+        done = strncmp(line, "DONE ", 5) == 0;
+    }
+    fclose(replies);
+    return done ? 0 : 1;
+}
@@ -0,0 +1,52 @@
+#ifndef HUMANIZER_CORE_DAEMON_H
+#define HUMANIZER_CORE_DAEMON_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+// Long-running job server on a Unix domain socket (daemon.c, Linux only).
+//
+// One request per connection, a header line optionally followed by a payload:
+//   TEXT <bytes> [key=value ...]\n<bytes of UTF-8 text>   type the text
+//   FILE <bytes> [key=value ...]\n<bytes of file path>    type a .txt/.docx file
+//   STATUS\n                                               queue summary
+// Options: wpm=N (at most MAX_WPM) seed=N steady=1 directives=1 sink=uinput|null
+//          delay=SECONDS (at most MAX_DELAY_S) typo=P variation=P correction_min=SECONDS
+//          correction_max=SECONDS word_pause=P sentence_pause=P pause_median=SECONDS distance=W
+//          keyboard=qwerty|azerty|qwertz|dvorak|colemak
+//
+// The daemon answers with lines until the job finishes and then closes:
+//   QUEUED <id> <position>
+//   STARTED <id> worker=<n> seed=<seed>
+//   PROGRESS <id> chars=<n> words=<n> wpm=<x> elapsed=<seconds>   (10 per second, skipped
+//                                                                while the client is not reading)
+//   DONE <id> chars=<n> words=<n> typos=<n> skipped=<n> elapsed=<seconds>
+//   ERROR [<id>] <message>
+// Closing the connection cancels the job. A request that has not fully
+// arrived within 10 seconds is answered with ERROR and dropped.
+
+#define DAEMON_SOCKET_NAME "humanizer.sock"
+#define DAEMON_DEFAULT_WORKERS 4
+#define DAEMON_MAX_WORKERS 64
+
+// Daemon configuration
+typedef struct {
+    const char* socket_path;   // Where to listen
+    size_t workers;            // Jobs typed concurrently, each on its own uinput device
+    const char* device_prefix; // Worker n types on the device "<prefix>-<n>"
+    bool unicode_input;        // Passed to OpenUinputSink
+    double default_wpm;        // Speed for jobs that do not set wpm
+} DaemonOptions;
+
+// Socket path used when none is given: $XDG_RUNTIME_DIR/humanizer.sock, else /tmp/humanizer-<uid>.sock
+void DefaultDaemonSocketPath(char* buffer, size_t size);
+
+// Serve jobs until SIGINT or SIGTERM; returns the process exit code
+int RunDaemon(const DaemonOptions* options);
+
+// Submit a file ("-" reads standard input) to a running daemon and copy its
+// replies to stdout; options is a space-separated key=value list (may be empty).
+// Returns the process exit code.
+int SubmitDaemonJob(const char* socket_path, const char* path, const char* options);
+
+#endif // HUMANIZER_CORE_DAEMON_H
@@ -0,0 +1,109 @@
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+#endif
+
+#include "humanizer.h"
+#include "digraph.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// Whether size bytes at data hold a profile this build can use
+static bool ValidDigraphProfile(const void* data, size_t size) {
+    const DigraphFileHeader* header = (const DigraphFileHeader*)data;
+    if (size != sizeof(DigraphFileHeader) + (size_t)DIGRAPH_SLOTS * DIGRAPH_SLOTS * sizeof(DigraphEntry) ||
+        memcmp(header->magic, DIGRAPH_MAGIC, 4) != 0 || header->byte_order != DIGRAPH_BYTE_ORDER ||
+        header->version != DIGRAPH_VERSION || header->slots != DIGRAPH_SLOTS ||
+        header->quantiles != DIGRAPH_QUANTILES || header->tick_us != DIGRAPH_TICK_US || header->mean_ticks == 0) {
+        return false;
+    }
+
+    // Quantiles must rise, or sampling could run backwards
+    const DigraphEntry* entries = (const DigraphEntry*)(header + 1);
+    for (size_t i = 0; i < (size_t)DIGRAPH_SLOTS * DIGRAPH_SLOTS; i++) {
+        for (size_t q = 0; q < DIGRAPH_QUANTILES; q++) {
+            if (entries[i].quantiles[q] > entries[i].quantiles[q + 1]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Map a profile file and check it
+DigraphProfile* LoadDigraphProfile(const char* path) {
+    void* data = NULL;
+    size_t size = 0;
+#if !defined(_WIN32)
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd >= 0 && fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        size = (size_t)st.st_size;
+        data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            data = NULL;
+        }
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+#else
+    FILE* file = fopen(path, "rb");
+    if (file && fseek(file, 0, SEEK_END) == 0) {
+        long length = ftell(file);
+        rewind(file);
+        data = length > 0 ? malloc((size_t)length) : NULL;
+        size = data ? fread(data, 1, (size_t)length, file) : 0;
+    }
+    if (file) {
+        fclose(file);
+    }
+#endif
+    if (!data) {
+        printf(ANSI_COLOR_RED "Error: Could not open digraph profile %s\n" ANSI_COLOR_RESET, path);
+        return NULL;
+    }
+
+    DigraphProfile* profile = (DigraphProfile*)calloc(1, sizeof(DigraphProfile));
+    if (!profile || !ValidDigraphProfile(data, size)) {
+        if (profile) {
+            printf(ANSI_COLOR_RED "Error: %s is not a digraph profile\n" ANSI_COLOR_RESET, path);
+        } else {
+            printf(ANSI_COLOR_RED "Error: Memory allocation failed\n" ANSI_COLOR_RESET);
+        }
+        free(profile);
+#if !defined(_WIN32)
+        munmap(data, size);
+#else
+        free(data);
+#endif
+        return NULL;
+    }
+
+    profile->header = (const DigraphFileHeader*)data;
+    profile->entries = (const DigraphEntry*)(profile->header + 1);
+    profile->per_mean_tick = 1.0 / (double)profile->header->mean_ticks;
+    profile->mapping = data;
+    profile->size = size;
+    return profile;
+}
+
+void UnloadDigraphProfile(DigraphProfile* profile) {
+    if (!profile) {
+        return;
+    }
+#if !defined(_WIN32)
+    munmap(profile->mapping, profile->size);
+#else
+    free(profile->mapping);
+#endif
+    free(profile);
+}
@@ -0,0 +1,106 @@
+#ifndef HUMANIZER_CORE_DIGRAPH_H
+#define HUMANIZER_CORE_DIGRAPH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "random.h"
+#include "keyboard.h"
+
+// Digraph profile: how long a typist takes from one key to the next, per key
+// pair, learned from recorded keyboard input (digraph_train.c). Slots are the
+// physical keys of keyboard.h (slot = key + 1) followed by Enter, Tab and
+// Backspace, so 'a' and 'A' share one, a layout only changes which slot a
+// character lands on, and every other character shares DIGRAPH_OTHER.
+//
+// The file is the in-memory layout, so a profile is used straight from its
+// mapping (integers little endian, the byte order of every supported host):
+//   DigraphFileHeader, then DIGRAPH_SLOTS * DIGRAPH_SLOTS DigraphEntry cells,
+//   cell (from, to) at index from * DIGRAPH_SLOTS + to
+// Each cell holds quantiles of the latency distribution. Sampling draws a
+// quantile bin and a point inside it, so a delay costs one random number and
+// one table read.
+#define DIGRAPH_MAGIC "HZDG"
+#define DIGRAPH_VERSION 1
+#define DIGRAPH_BYTE_ORDER 0x01020304u
+#define DIGRAPH_SLOTS 64
+#define DIGRAPH_QUANTILE_BITS 4
+#define DIGRAPH_QUANTILES (1 << DIGRAPH_QUANTILE_BITS)
+#define DIGRAPH_TICK_US 20         // Unit of the stored latencies
+#define DIGRAPH_OTHER 0            // Slot of characters off the keyboard's keys
+#define DIGRAPH_ENTER (KEYBOARD_KEYS + 1)
+#define DIGRAPH_TAB (KEYBOARD_KEYS + 2)
+#define DIGRAPH_BACKSPACE (KEYBOARD_KEYS + 3)
+
+// Where a cell's distribution came from
+#define DIGRAPH_SOURCE_PAIR   0    // Samples of this key pair
+#define DIGRAPH_SOURCE_CLASS  1    // Key pairs typed alike (hand, finger and row distance)
+#define DIGRAPH_SOURCE_GLOBAL 2    // Every sample
+
+typedef struct {
+    char magic[4];         // DIGRAPH_MAGIC
+    uint32_t byte_order;   // DIGRAPH_BYTE_ORDER as written
+    uint16_t version;      // DIGRAPH_VERSION
+    uint16_t slots;        // DIGRAPH_SLOTS
+    uint16_t quantiles;    // DIGRAPH_QUANTILES
+    uint16_t tick_us;      // DIGRAPH_TICK_US
+    uint32_t mean_ticks;   // Mean latency over all samples
+    uint32_t reserved;
+    uint64_t samples;      // Key pairs the profile was trained on
+} DigraphFileHeader;
+
+typedef struct {
+    uint16_t samples;      // Samples of this exact key pair (saturates)
+    uint8_t source;        // DIGRAPH_SOURCE_*
+    uint8_t reserved;
+    uint16_t quantiles[DIGRAPH_QUANTILES + 1]; // Latency at each 1/DIGRAPH_QUANTILES step, in ticks
+} DigraphEntry;
+
+// A loaded profile; the cells stay in the file mapping
+typedef struct DigraphProfile {
+    const DigraphFileHeader* header;
+    const DigraphEntry* entries;
+    double per_mean_tick;  // 1 / header->mean_ticks, scales draws to the planner's pace
+    void* mapping;         // Memory to release on unload
+    size_t size;
+} DigraphProfile;
+
+// Slot of the key that types a character on a layout (DIGRAPH_OTHER if none)
+static inline uint32_t DigraphSlot(const KeyboardLayout* layout, uint32_t codepoint) {
+    switch (codepoint) {
+    case '\n':
+    case '\r':
+        return DIGRAPH_ENTER;
+    case '\t':
+        return DIGRAPH_TAB;
+    case '\b':
+        return DIGRAPH_BACKSPACE;
+    }
+    uint8_t key = KeyboardKey(layout, codepoint);
+    return key == KEYBOARD_NONE ? DIGRAPH_OTHER : (uint32_t)(key & KEYBOARD_KEY_MASK) + 1;
+}
+
+// Map a profile file and check it; NULL (with a message) if it is not a valid profile
+DigraphProfile* LoadDigraphProfile(const char* path);
+void UnloadDigraphProfile(DigraphProfile* profile);
+
+// Delay from the key in slot from to the one in slot to, at a pace that
+// averages mean_ns over text like the recordings
+static inline uint64_t SampleDigraphDelay(const DigraphProfile* profile, RandomState* rng, uint32_t from,
+                                          uint32_t to, uint64_t mean_ns) {
+    const uint16_t* q = profile->entries[from * DIGRAPH_SLOTS + to].quantiles;
+
+    uint64_t r = NextRandom(rng);
+    uint32_t bin = (uint32_t)(r >> (64 - DIGRAPH_QUANTILE_BITS));
+    double within = (double)((r >> 32) & 0xFFFFFF) * (1.0 / 16777216.0);
+    double ticks = (double)q[bin] + (double)(q[bin + 1] - q[bin]) * within;
+    return (uint64_t)(ticks * profile->per_mean_tick * (double)mean_ns);
+}
+
+// Offline trainer (digraph_train.c, Linux): read raw evdev logs (the bytes of
+// struct input_event read from /dev/input/eventN) and write a profile to
+// output_path; returns the process exit code
+int TrainDigraphProfile(const char* const* log_paths, size_t log_count, const char* output_path);
+
+#endif // HUMANIZER_CORE_DIGRAPH_H
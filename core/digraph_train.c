@@ -0,0 +1,352 @@
+#define _GNU_SOURCE
+
+#include "humanizer.h"
+#include "digraph.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <linux/input.h>
+
+// A pause longer than this is thinking, not moving between keys
+#define DIGRAPH_MAX_GAP_US 1200000ULL
+// Fewer samples than this and a cell borrows its class's (or every) distribution
+#define DIGRAPH_MIN_SAMPLES 16
+// Key pair classes: same key, same finger, same hand, other hand, via the
+// thumb (space) or an unknown key, each at row distance 0, 1 or 2+
+#define DIGRAPH_CLASSES (6 * 3)
+
+// Evdev keys the trainer learns from and the character of each
+static const struct {
+    uint16_t code;
+    char character;
+} kTrainedKeys[] = {
+    { KEY_GRAVE, '`' }, { KEY_1, '1' }, { KEY_2, '2' }, { KEY_3, '3' }, { KEY_4, '4' }, { KEY_5, '5' },
+    { KEY_6, '6' }, { KEY_7, '7' }, { KEY_8, '8' }, { KEY_9, '9' }, { KEY_0, '0' }, { KEY_MINUS, '-' },
+    { KEY_EQUAL, '=' }, { KEY_Q, 'q' }, { KEY_W, 'w' }, { KEY_E, 'e' }, { KEY_R, 'r' }, { KEY_T, 't' },
+    { KEY_Y, 'y' }, { KEY_U, 'u' }, { KEY_I, 'i' }, { KEY_O, 'o' }, { KEY_P, 'p' }, { KEY_LEFTBRACE, '[' },
+    { KEY_RIGHTBRACE, ']' }, { KEY_BACKSLASH, '\\' }, { KEY_A, 'a' }, { KEY_S, 's' }, { KEY_D, 'd' },
+    { KEY_F, 'f' }, { KEY_G, 'g' }, { KEY_H, 'h' }, { KEY_J, 'j' }, { KEY_K, 'k' }, { KEY_L, 'l' },
+    { KEY_SEMICOLON, ';' }, { KEY_APOSTROPHE, '\'' }, { KEY_Z, 'z' }, { KEY_X, 'x' }, { KEY_C, 'c' },
+    { KEY_V, 'v' }, { KEY_B, 'b' }, { KEY_N, 'n' }, { KEY_M, 'm' }, { KEY_COMMA, ',' }, { KEY_DOT, '.' },
+    { KEY_SLASH, '/' }, { KEY_SPACE, ' ' }, { KEY_ENTER, '\n' }, { KEY_TAB, '\t' }, { KEY_BACKSPACE, '\b' },
+};
+
+// Hand (0 left, 1 right, 2 thumb, 3 unknown), finger and row of a slot's key
+typedef struct {
+    uint8_t hand;
+    uint8_t finger;
+    uint8_t row;
+} KeyPosition;
+
+// One measured key-to-key latency
+typedef struct {
+    uint16_t cell;         // from * DIGRAPH_SLOTS + to
+    uint32_t ticks;
+} DigraphSample;
+
+typedef struct {
+    DigraphSample* samples;
+    size_t count;
+    size_t capacity;
+    uint64_t dropped_reports; // SYN_DROPPED seen in the logs
+} DigraphSamples;
+
+// Touch-typing position of a slot's key: the keyboard tables for the main
+// block and space, the right little finger for Enter and Backspace and the
+// left one for Tab
+static KeyPosition PositionOfSlot(uint32_t slot) {
+    KeyPosition position = { 3, 0, 0 };
+    if (slot >= 1 && slot <= KEYBOARD_KEYS) {
+        position.hand = kKeyboardHand[slot - 1];
+        position.finger = kKeyboardFinger[slot - 1];
+        position.row = kKeyboardRow[slot - 1];
+    } else if (slot == DIGRAPH_ENTER || slot == DIGRAPH_BACKSPACE) {
+        position.hand = KEYBOARD_HAND_RIGHT;
+        position.finger = 4;
+        position.row = slot == DIGRAPH_ENTER ? 2 : 0;
+    } else if (slot == DIGRAPH_TAB) {
+        position.hand = KEYBOARD_HAND_LEFT;
+        position.finger = 4;
+        position.row = 1;
+    }
+    return position;
+}
+
+// Class of a key pair for cells without samples of their own
+static size_t DigraphClass(const KeyPosition* positions, size_t from, size_t to) {
+    const KeyPosition* a = &positions[from];
+    const KeyPosition* b = &positions[to];
+    size_t kind;
+    if (a->hand == 3 || b->hand == 3) {
+        kind = 5;
+    } else if (a->hand == 2 || b->hand == 2) {
+        kind = 4;
+    } else if (from == to) {
+        kind = 0;
+    } else if (a->hand != b->hand) {
+        kind = 3;
+    } else if (a->finger == b->finger) {
+        kind = 1;
+    } else {
+        kind = 2;
+    }
+    int distance = a->row > b->row ? a->row - b->row : b->row - a->row;
+    return kind * 3 + (size_t)(distance < 2 ? distance : 2);
+}
+
+static bool AddSample(DigraphSamples* samples, size_t cell, uint64_t gap_us) {
+    if (samples->count == samples->capacity) {
+        size_t capacity = samples->capacity ? samples->capacity * 2 : 4096;
+        DigraphSample* grown = (DigraphSample*)realloc(samples->samples, capacity * sizeof(DigraphSample));
+        if (!grown) {
+            return false;
+        }
+        samples->samples = grown;
+        samples->capacity = capacity;
+    }
+    samples->samples[samples->count].cell = (uint16_t)cell;
+    samples->samples[samples->count].ticks = (uint32_t)((gap_us + DIGRAPH_TICK_US / 2) / DIGRAPH_TICK_US);
+    samples->count++;
+    return true;
+}
+
+// Collect the press-to-press latencies of one log. Modifiers are skipped (a
+// capital is the latency to its letter), shortcuts and long pauses break the
+// chain, and so does a gap in the log.
+static bool ReadEvdevLog(const char* path, const uint8_t* key_slots, DigraphSamples* samples) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        printf(ANSI_COLOR_RED "Error: Could not open %s\n" ANSI_COLOR_RESET, path);
+        return false;
+    }
+
+    struct input_event events[256];
+    size_t got;
+    int previous = -1;
+    uint64_t previous_us = 0;
+    int held_shortcut_modifiers = 0;
+    bool ok = true;
+    while (ok && (got = fread(events, sizeof(struct input_event), sizeof(events) / sizeof(events[0]), file)) > 0) {
+        for (size_t i = 0; i < got && ok; i++) {
+            const struct input_event* ev = &events[i];
+            if (ev->type == EV_SYN && ev->code == SYN_DROPPED) {
+                samples->dropped_reports++;
+                previous = -1;
+                continue;
+            }
+            if (ev->type != EV_KEY || ev->value == 2) {
+                continue;
+            }
+            switch (ev->code) {
+                case KEY_LEFTCTRL: case KEY_RIGHTCTRL: case KEY_LEFTALT: case KEY_RIGHTALT:
+                case KEY_LEFTMETA: case KEY_RIGHTMETA:
+                    held_shortcut_modifiers += ev->value ? 1 : -1;
+                    if (held_shortcut_modifiers < 0) {
+                        held_shortcut_modifiers = 0;
+                    }
+                    previous = -1;
+                    continue;
+                case KEY_LEFTSHIFT: case KEY_RIGHTSHIFT: case KEY_CAPSLOCK:
+                    continue;
+                default:
+                    break;
+            }
+            if (ev->value != 1) {
+                continue;
+            }
+            // Mouse and joystick buttons are not typing
+            if (held_shortcut_modifiers > 0 || (ev->code >= BTN_MISC && ev->code < KEY_OK)) {
+                previous = -1;
+                continue;
+            }
+
+#if defined(input_event_sec)
+            uint64_t now_us = (uint64_t)ev->input_event_sec * 1000000ULL + (uint64_t)ev->input_event_usec;
+#else
+            uint64_t now_us = (uint64_t)ev->time.tv_sec * 1000000ULL + (uint64_t)ev->time.tv_usec;
+#endif
+            int slot = ev->code < KEY_CNT ? key_slots[ev->code] : DIGRAPH_OTHER;
+            if (previous >= 0 && now_us >= previous_us && now_us - previous_us <= DIGRAPH_MAX_GAP_US) {
+                ok = AddSample(samples, (size_t)previous * DIGRAPH_SLOTS + (size_t)slot, now_us - previous_us);
+            }
+            previous = slot;
+            previous_us = now_us;
+        }
+    }
+    if (!ok) {
+        printf(ANSI_COLOR_RED "Error: Memory allocation failed\n" ANSI_COLOR_RESET);
+    } else if (ferror(file)) {
+        printf(ANSI_COLOR_RED "Error: Could not read %s\n" ANSI_COLOR_RESET, path);
+        ok = false;
+    }
+    fclose(file);
+    return ok;
+}
+
+static int CompareTicks(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Quantiles of count sorted latencies, interpolated between neighbours
+static void FillQuantiles(DigraphEntry* entry, const uint32_t* sorted, size_t count) {
+    for (size_t q = 0; q <= DIGRAPH_QUANTILES; q++) {
+        double position = (double)q * (double)(count - 1) / DIGRAPH_QUANTILES;
+        size_t below = (size_t)position;
+        size_t above = below + 1 < count ? below + 1 : below;
+        double value = (double)sorted[below] + (double)(sorted[above] - sorted[below]) * (position - (double)below);
+        entry->quantiles[q] = value < 65535.0 ? (uint16_t)(value + 0.5) : 65535;
+    }
+}
+
+// Read raw evdev logs and write a profile
+int TrainDigraphProfile(const char* const* log_paths, size_t log_count, const char* output_path) {
+    uint8_t key_slots[KEY_CNT] = { 0 };
+    KeyPosition positions[DIGRAPH_SLOTS];
+    memset(positions, 0, sizeof(positions));
+    for (size_t slot = 0; slot < DIGRAPH_SLOTS; slot++) {
+        positions[slot].hand = 3;
+    }
+    for (size_t i = 0; i < sizeof(kTrainedKeys) / sizeof(kTrainedKeys[0]); i++) {
+        uint32_t slot = DigraphSlot(&kKeyboardLayouts[KEYBOARD_QWERTY], (unsigned char)kTrainedKeys[i].character);
+        key_slots[kTrainedKeys[i].code] = (uint8_t)slot;
+        positions[slot] = PositionOfSlot(slot);
+    }
+
+    DigraphSamples samples;
+    memset(&samples, 0, sizeof(samples));
+    for (size_t i = 0; i < log_count; i++) {
+        if (!ReadEvdevLog(log_paths[i], key_slots, &samples)) {
+            free(samples.samples);
+            return 1;
+        }
+    }
+    if (samples.count < DIGRAPH_MIN_SAMPLES) {
+        printf(ANSI_COLOR_RED "Error: The logs hold %zu key pairs; at least %d are needed\n" ANSI_COLOR_RESET,
+               samples.count, DIGRAPH_MIN_SAMPLES);
+        free(samples.samples);
+        return 1;
+    }
+    if (samples.dropped_reports > 0) {
+        printf("Warning: The logs lost events %llu times; key pairs across the gaps were left out\n",
+               (unsigned long long)samples.dropped_reports);
+    }
+
+    // Bucket the latencies by cell, by class and all together
+    size_t cells = (size_t)DIGRAPH_SLOTS * DIGRAPH_SLOTS;
+    size_t* cell_start = (size_t*)calloc(cells + 1, sizeof(size_t));
+    size_t* class_start = (size_t*)calloc(DIGRAPH_CLASSES + 1, sizeof(size_t));
+    uint32_t* by_cell = (uint32_t*)malloc(samples.count * sizeof(uint32_t));
+    uint32_t* by_class = (uint32_t*)malloc(samples.count * sizeof(uint32_t));
+    uint32_t* all = (uint32_t*)malloc(samples.count * sizeof(uint32_t));
+    size_t entries_size = cells * sizeof(DigraphEntry);
+    DigraphEntry* entries = (DigraphEntry*)calloc(cells, sizeof(DigraphEntry));
+    size_t* cell_fill = (size_t*)malloc(cells * sizeof(size_t));
+    if (!cell_start || !class_start || !by_cell || !by_class || !all || !entries || !cell_fill) {
+        printf(ANSI_COLOR_RED "Error: Memory allocation failed\n" ANSI_COLOR_RESET);
+        free(cell_fill);
+        free(cell_start);
+        free(class_start);
+        free(by_cell);
+        free(by_class);
+        free(all);
+        free(entries);
+        free(samples.samples);
+        return 1;
+    }
+
+    // Counting sort into cells and classes
+    uint64_t total_ticks = 0;
+    for (size_t i = 0; i < samples.count; i++) {
+        size_t cell = samples.samples[i].cell;
+        cell_start[cell + 1]++;
+        class_start[DigraphClass(positions, cell / DIGRAPH_SLOTS, cell % DIGRAPH_SLOTS) + 1]++;
+        all[i] = samples.samples[i].ticks;
+        total_ticks += samples.samples[i].ticks;
+    }
+    for (size_t i = 0; i < cells; i++) {
+        cell_start[i + 1] += cell_start[i];
+    }
+    for (size_t i = 0; i < DIGRAPH_CLASSES; i++) {
+        class_start[i + 1] += class_start[i];
+    }
+    size_t class_fill[DIGRAPH_CLASSES];
+    memcpy(cell_fill, cell_start, cells * sizeof(size_t));
+    memcpy(class_fill, class_start, sizeof(class_fill));
+    for (size_t i = 0; i < samples.count; i++) {
+        size_t cell = samples.samples[i].cell;
+        by_cell[cell_fill[cell]++] = samples.samples[i].ticks;
+        by_class[class_fill[DigraphClass(positions, cell / DIGRAPH_SLOTS, cell % DIGRAPH_SLOTS)]++] =
+            samples.samples[i].ticks;
+    }
+    qsort(all, samples.count, sizeof(uint32_t), CompareTicks);
+
+    size_t sources[3] = { 0, 0, 0 };
+    bool class_sorted[DIGRAPH_CLASSES] = { false };
+    for (size_t cell = 0; cell < cells; cell++) {
+        DigraphEntry* entry = &entries[cell];
+        size_t count = cell_start[cell + 1] - cell_start[cell];
+        size_t class_index = DigraphClass(positions, cell / DIGRAPH_SLOTS, cell % DIGRAPH_SLOTS);
+        size_t class_count = class_start[class_index + 1] - class_start[class_index];
+        entry->samples = (uint16_t)(count < 65535 ? count : 65535);
+        if (count >= DIGRAPH_MIN_SAMPLES) {
+            uint32_t* values = by_cell + cell_start[cell];
+            qsort(values, count, sizeof(uint32_t), CompareTicks);
+            FillQuantiles(entry, values, count);
+            entry->source = DIGRAPH_SOURCE_PAIR;
+        } else if (class_count >= DIGRAPH_MIN_SAMPLES) {
+            uint32_t* values = by_class + class_start[class_index];
+            if (!class_sorted[class_index]) {
+                qsort(values, class_count, sizeof(uint32_t), CompareTicks);
+                class_sorted[class_index] = true;
+            }
+            FillQuantiles(entry, values, class_count);
+            entry->source = DIGRAPH_SOURCE_CLASS;
+        } else {
+            FillQuantiles(entry, all, samples.count);
+            entry->source = DIGRAPH_SOURCE_GLOBAL;
+        }
+        sources[entry->source]++;
+    }
+
+    DigraphFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DIGRAPH_MAGIC, 4);
+    header.byte_order = DIGRAPH_BYTE_ORDER;
+    header.version = DIGRAPH_VERSION;
+    header.slots = DIGRAPH_SLOTS;
+    header.quantiles = DIGRAPH_QUANTILES;
+    header.tick_us = DIGRAPH_TICK_US;
+    header.mean_ticks = (uint32_t)((total_ticks + samples.count / 2) / samples.count);
+    if (header.mean_ticks == 0) {
+        header.mean_ticks = 1;
+    }
+    header.samples = samples.count;
+
+    FILE* file = fopen(output_path, "wb");
+    bool ok = file && fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(entries, entries_size, 1, file) == 1;
+    if (file && fclose(file) != 0) {
+        ok = false;
+    }
+    if (ok) {
+        printf("Trained on %zu key pairs from %zu logs: mean %.1f ms, median %.1f ms between keys\n",
+               samples.count, log_count, (double)header.mean_ticks * DIGRAPH_TICK_US / 1000.0,
+               (double)all[samples.count / 2] * DIGRAPH_TICK_US / 1000.0);
+        printf("Cells: %zu from their own key pair, %zu from a key pair class, %zu from every sample\n",
+               sources[DIGRAPH_SOURCE_PAIR], sources[DIGRAPH_SOURCE_CLASS], sources[DIGRAPH_SOURCE_GLOBAL]);
+        printf("Profile written to %s\n", output_path);
+    } else {
+        printf(ANSI_COLOR_RED "Error: Could not write %s\n" ANSI_COLOR_RESET, output_path);
+    }
+
+    free(cell_fill);
+    free(cell_start);
+    free(class_start);
+    free(by_cell);
+    free(by_class);
+    free(all);
+    free(entries);
+    free(samples.samples);
+    return ok ? 0 : 1;
+}
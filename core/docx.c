@@ -0,0 +1,398 @@
+#include "humanizer.h"
+#include "source.h"
+#include "inflate.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// ZIP record signatures and sizes
+#define ZIP_END_OF_CENTRAL_DIR 0x06054b50
+#define ZIP_CENTRAL_FILE_HEADER 0x02014b50
+#define ZIP_LOCAL_FILE_HEADER 0x04034b50
+#define ZIP_END_RECORD_SIZE 22
+#define ZIP_CENTRAL_HEADER_SIZE 46
+#define ZIP_LOCAL_HEADER_SIZE 30
+#define ZIP_MAX_COMMENT 65535
+
+#define ZIP_METHOD_STORED 0
+#define ZIP_METHOD_DEFLATE 8
+
+#define DOCX_BODY_PART "word/document.xml"
+#define XML_NAME_LENGTH 32
+#define XML_ENTITY_LENGTH 12
+
+// Position of the SAX scanner inside the markup
+enum {
+    XML_TEXT,      // Character data
+    XML_TAG_NAME,  // Reading the name right after '<'
+    XML_TAG_REST,  // Attributes, waiting for '>'
+    XML_ENTITY     // Between '&' and ';' in character data
+};
+
+// Streams the text of a .docx: the body part is inflated chunk by chunk out of
+// the archive and fed through a small SAX-style scanner, so neither the archive
+// nor the XML is ever held in memory
+typedef struct {
+    TextSource base;
+    FILE* file;
+    uint32_t method;               // ZIP compression method of the body part
+    uint32_t compressed_remaining; // Compressed bytes of the body part not yet read
+    Inflater inflater;
+
+    // Scanner state
+    int state;
+    bool in_text_run;              // Inside <w:t>, whose character data is document text
+    bool in_tab_stops;             // Inside <w:tabs>, where <w:tab> defines a tab stop
+    char name[XML_NAME_LENGTH];    // Current tag name (truncated)
+    size_t name_length;
+    char last_tag_char;            // Last non-space character seen inside the tag
+    char quote;                    // Open attribute quote, 0 when outside a value
+    char entity[XML_ENTITY_LENGTH];
+    size_t entity_length;
+
+    uint8_t raw[TEXT_CHUNK_SIZE];  // Decompressed XML
+    // Extracted text handed to the caller; an entity split across two raw blocks
+    // can emit up to its own length more than the second block holds
+    char text[TEXT_CHUNK_SIZE + XML_ENTITY_LENGTH + 2];
+} DocxTextSource;
+
+static uint16_t ReadLE16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t ReadLE32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Locate the body part through the central directory and seek to its data
+static bool FindBodyPart(DocxTextSource* docx) {
+    FILE* file = docx->file;
+    uint8_t tail[ZIP_END_RECORD_SIZE + ZIP_MAX_COMMENT];
+
+    if (fseek(file, 0, SEEK_END) != 0) {
+        return false;
+    }
+    long file_size = ftell(file);
+    if (file_size < ZIP_END_RECORD_SIZE) {
+        return false;
+    }
+
+    // The end record sits in the last 22 bytes plus an optional comment
+    size_t tail_size = (size_t)file_size < sizeof(tail) ? (size_t)file_size : sizeof(tail);
+    if (fseek(file, file_size - (long)tail_size, SEEK_SET) != 0 || fread(tail, 1, tail_size, file) != tail_size) {
+        return false;
+    }
+
+    const uint8_t* end_record = NULL;
+    for (size_t i = tail_size - ZIP_END_RECORD_SIZE + 1; i-- > 0;) {
+        if (ReadLE32(tail + i) == ZIP_END_OF_CENTRAL_DIR) {
+            end_record = tail + i;
+            break;
+        }
+    }
+    if (!end_record) {
+        return false;
+    }
+
+    uint16_t entries = ReadLE16(end_record + 10);
+    uint32_t directory_offset = ReadLE32(end_record + 16);
+    if (directory_offset == 0xFFFFFFFF || fseek(file, (long)directory_offset, SEEK_SET) != 0) {
+        return false;
+    }
+
+    // Walk the central directory one header at a time
+    for (uint16_t e = 0; e < entries; e++) {
+        uint8_t header[ZIP_CENTRAL_HEADER_SIZE];
+        char name[sizeof(DOCX_BODY_PART)];
+
+        if (fread(header, 1, sizeof(header), file) != sizeof(header) ||
+            ReadLE32(header) != ZIP_CENTRAL_FILE_HEADER) {
+            return false;
+        }
+
+        uint16_t name_length = ReadLE16(header + 28);
+        long skip = (long)ReadLE16(header + 30) + ReadLE16(header + 32);
+
+        if (name_length != sizeof(DOCX_BODY_PART) - 1) {
+            if (fseek(file, (long)name_length + skip, SEEK_CUR) != 0) {
+                return false;
+            }
+            continue;
+        }
+        if (fread(name, 1, name_length, file) != name_length) {
+            return false;
+        }
+        if (memcmp(name, DOCX_BODY_PART, name_length) != 0) {
+            if (fseek(file, skip, SEEK_CUR) != 0) {
+                return false;
+            }
+            continue;
+        }
+
+        docx->method = ReadLE16(header + 10);
+        docx->compressed_remaining = ReadLE32(header + 20);
+        uint32_t local_offset = ReadLE32(header + 42);
+
+        // Sizes come from the central directory; the local header only tells us where the data starts
+        uint8_t local[ZIP_LOCAL_HEADER_SIZE];
+        if (fseek(file, (long)local_offset, SEEK_SET) != 0 ||
+            fread(local, 1, sizeof(local), file) != sizeof(local) ||
+            ReadLE32(local) != ZIP_LOCAL_FILE_HEADER) {
+            return false;
+        }
+        long data_skip = (long)ReadLE16(local + 26) + ReadLE16(local + 28);
+        return fseek(file, data_skip, SEEK_CUR) == 0;
+    }
+    return false;
+}
+
+// Compressed bytes of the body part, bounded by its recorded size
+static size_t ReadCompressed(void* context, uint8_t* buffer, size_t capacity) {
+    DocxTextSource* docx = (DocxTextSource*)context;
+    size_t want = capacity < docx->compressed_remaining ? capacity : docx->compressed_remaining;
+    size_t got = want ? fread(buffer, 1, want, docx->file) : 0;
+    docx->compressed_remaining -= (uint32_t)got;
+    return got;
+}
+
+// Append a codepoint as UTF-8
+static size_t AppendUtf8(char* out, uint32_t cp) {
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = (char)(0xC0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = (char)(0xE0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (cp >> 18));
+    out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+// Decode the entity collected in docx->entity (without '&' and ';'); never longer than its source
+static size_t DecodeEntity(const DocxTextSource* docx, char* out) {
+    const char* e = docx->entity;
+    size_t n = docx->entity_length;
+
+    if (n == 3 && memcmp(e, "amp", 3) == 0) { out[0] = '&'; return 1; }
+    if (n == 2 && memcmp(e, "lt", 2) == 0) { out[0] = '<'; return 1; }
+    if (n == 2 && memcmp(e, "gt", 2) == 0) { out[0] = '>'; return 1; }
+    if (n == 4 && memcmp(e, "quot", 4) == 0) { out[0] = '"'; return 1; }
+    if (n == 4 && memcmp(e, "apos", 4) == 0) { out[0] = '\''; return 1; }
+
+    if (n >= 2 && e[0] == '#') {
+        bool hex = e[1] == 'x' || e[1] == 'X';
+        uint32_t cp = 0;
+        size_t digits = 0;
+        for (size_t i = hex ? 2 : 1; i < n; i++, digits++) {
+            char c = e[i];
+            uint32_t d;
+            if (c >= '0' && c <= '9') d = (uint32_t)(c - '0');
+            else if (hex && c >= 'a' && c <= 'f') d = (uint32_t)(c - 'a' + 10);
+            else if (hex && c >= 'A' && c <= 'F') d = (uint32_t)(c - 'A' + 10);
+            else return 0;
+            cp = cp * (hex ? 16 : 10) + d;
+            if (cp > 0x10FFFF) return 0;
+        }
+        if (digits > 0 && (cp < 0xD800 || cp > 0xDFFF)) {
+            return AppendUtf8(out, cp);
+        }
+    }
+    return 0;
+}
+
+// React to a complete tag: track <w:t> runs and turn layout elements into whitespace
+static size_t HandleTag(DocxTextSource* docx, char* out) {
+    const char* name = docx->name;
+    size_t n = docx->name_length;
+    bool closing = n > 0 && name[0] == '/';
+    bool self_closing = docx->last_tag_char == '/';
+
+    if (closing) {
+        name++;
+        n--;
+    }
+
+    if (n == 3 && memcmp(name, "w:t", 3) == 0) {
+        docx->in_text_run = !closing && !self_closing;
+        return 0;
+    }
+    if (n == 6 && memcmp(name, "w:tabs", 6) == 0) {
+        docx->in_tab_stops = !closing && !self_closing;
+        return 0;
+    }
+    // A paragraph ends with </w:p>, or at once if it is empty (<w:p/>)
+    if ((closing || self_closing) && n == 3 && memcmp(name, "w:p", 3) == 0) {
+        out[0] = '\n';
+        return 1;
+    }
+    if (!closing && !docx->in_tab_stops && n == 5 && memcmp(name, "w:tab", 5) == 0) {
+        out[0] = '\t';
+        return 1;
+    }
+    if (!closing && ((n == 4 && memcmp(name, "w:br", 4) == 0) || (n == 4 && memcmp(name, "w:cr", 4) == 0))) {
+        out[0] = '\n';
+        return 1;
+    }
+    return 0;
+}
+
+// Scan a block of XML, writing document text to out. Every construct emits no
+// more bytes than it consumed, so out needs no more room than length bytes
+// (plus one pending entity carried over from the previous block).
+static size_t ScanXml(DocxTextSource* docx, const uint8_t* xml, size_t length, char* out) {
+    size_t written = 0;
+
+    for (size_t i = 0; i < length; i++) {
+        char c = (char)xml[i];
+
+        switch (docx->state) {
+            case XML_TEXT:
+                if (c == '<') {
+                    docx->state = XML_TAG_NAME;
+                    docx->name_length = 0;
+                    docx->last_tag_char = 0;
+                    docx->quote = 0;
+                } else if (docx->in_text_run) {
+                    if (c == '&') {
+                        docx->state = XML_ENTITY;
+                        docx->entity_length = 0;
+                    } else {
+                        out[written++] = c;
+                    }
+                }
+                break;
+
+            case XML_ENTITY:
+                if (c == ';') {
+                    size_t decoded = DecodeEntity(docx, out + written);
+                    if (decoded == 0) {
+                        // Unknown entity: keep it verbatim rather than losing text
+                        out[written++] = '&';
+                        memcpy(out + written, docx->entity, docx->entity_length);
+                        written += docx->entity_length;
+                        out[written++] = ';';
+                    } else {
+                        written += decoded;
+                    }
+                    docx->state = XML_TEXT;
+                } else if (docx->entity_length < XML_ENTITY_LENGTH) {
+                    docx->entity[docx->entity_length++] = c;
+                } else {
+                    out[written++] = '&';
+                    memcpy(out + written, docx->entity, docx->entity_length);
+                    written += docx->entity_length;
+                    out[written++] = c;
+                    docx->state = XML_TEXT;
+                }
+                break;
+
+            case XML_TAG_NAME:
+                if (c == '>' || c == ' ' || c == '\t' || c == '\r' || c == '\n' || (c == '/' && docx->name_length > 0)) {
+                    docx->state = XML_TAG_REST;
+                    i--; // Let XML_TAG_REST see the delimiter
+                } else if (docx->name_length < XML_NAME_LENGTH) {
+                    docx->name[docx->name_length++] = c;
+                }
+                break;
+
+            case XML_TAG_REST:
+                if (docx->quote) {
+                    if (c == docx->quote) {
+                        docx->quote = 0;
+                    }
+                } else if (c == '"' || c == '\'') {
+                    docx->quote = c;
+                    docx->last_tag_char = c;
+                } else if (c == '>') {
+                    written += HandleTag(docx, out + written);
+                    docx->state = XML_TEXT;
+                } else if (c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+                    docx->last_tag_char = c;
+                }
+                break;
+        }
+    }
+    return written;
+}
+
+static bool DocxNext(TextSource* source, const char** data, size_t* length) {
+    DocxTextSource* docx = (DocxTextSource*)source;
+
+    for (;;) {
+        size_t raw_length;
+        if (docx->method == ZIP_METHOD_STORED) {
+            raw_length = ReadCompressed(docx, docx->raw, sizeof(docx->raw));
+        } else {
+            raw_length = InflateRead(&docx->inflater, docx->raw, sizeof(docx->raw));
+            if (docx->inflater.failed) {
+                source->failed = true;
+            }
+        }
+
+        if (raw_length == 0) {
+            if (docx->method == ZIP_METHOD_STORED && ferror(docx->file)) {
+                source->failed = true;
+            }
+            return false;
+        }
+
+        size_t text_length = ScanXml(docx, docx->raw, raw_length, docx->text);
+        if (text_length > 0) {
+            *data = docx->text;
+            *length = text_length;
+            return true;
+        }
+    }
+}
+
+static void DocxClose(TextSource* source) {
+    DocxTextSource* docx = (DocxTextSource*)source;
+    fclose(docx->file);
+    free(docx);
+}
+
+// Stream the body text of a Word .docx document
+TextSource* OpenDocxTextSource(const char* filepath) {
+    FILE* file = fopen(filepath, "rb");
+    if (file == NULL) {
+        printf(ANSI_COLOR_RED "Error: Could not open file\n" ANSI_COLOR_RESET);
+        return NULL;
+    }
+
+    DocxTextSource* docx = (DocxTextSource*)calloc(1, sizeof(DocxTextSource));
+    if (!docx) {
+        printf(ANSI_COLOR_RED "Error: Memory allocation failed\n" ANSI_COLOR_RESET);
+        fclose(file);
+        return NULL;
+    }
+    docx->base.name = "docx";
+    docx->base.Next = DocxNext;
+    docx->base.Close = DocxClose;
+    docx->file = file;
+    docx->state = XML_TEXT;
+
+    if (!FindBodyPart(docx)) {
+        printf(ANSI_COLOR_RED "Error: Not a valid .docx document (no " DOCX_BODY_PART ")\n" ANSI_COLOR_RESET);
+        DocxClose(&docx->base);
+        return NULL;
+    }
+    if (docx->method != ZIP_METHOD_STORED && docx->method != ZIP_METHOD_DEFLATE) {
+        printf(ANSI_COLOR_RED "Error: Unsupported .docx compression method %u\n" ANSI_COLOR_RESET, docx->method);
+        DocxClose(&docx->base);
+        return NULL;
+    }
+
+    InitializeInflater(&docx->inflater, ReadCompressed, docx);
+    return &docx->base;
+}
@@ -0,0 +1,685 @@
+#define _GNU_SOURCE
+
+#include "humanizer.h"
+#include "layout.h"
+#include "e2e.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <dirent.h>
+#include <signal.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+#include <linux/input.h>
+#include <linux/uinput.h>
+
+// Codepoint a receiver records for a backspace
+#define E2E_BACKSPACE 0x08
+
+// Text typed when no path is given: prose, punctuation, digits, a tab, line
+// breaks and a few characters outside US QWERTY
+static const char kSampleText[] =
+    "The quick brown fox jumps over the lazy dog. Pack my box with five dozen liquor jugs!\n"
+    "Sphinx of black quartz, judge my vow: 1234567890 (#@$%^&*) [braces] {curly} <angle> ~`|\\/?\n"
+    "\tIndented line with \"quotes\" and 'apostrophes'; semicolons, commas + equals = done.\r\n"
+    "Caf\xC3\xA9 na\xC3\xAFve \xE2\x80\x94 r\xC3\xA9sum\xC3\xA9 \xF0\x9F\x98\x80 end of the sample.\n";
+
+// Sink between the simulator and the sink under test: stamps every key press
+// it forwards, so each can be matched with its receipt
+typedef struct {
+    KeySink base;
+    KeySink* inner;
+    uint64_t* sent_ns;     // Time each press was handed to the inner sink
+    size_t sent;
+    size_t capacity;
+} TimingSink;
+
+static bool TimingEmit(KeySink* sink, const KeyEvent* events, size_t count) {
+    TimingSink* timing = (TimingSink*)sink;
+    uint64_t now_ns = MonotonicNowNs();
+    for (size_t i = 0; i < count && timing->sent < timing->capacity; i++) {
+        if (!(events[i].flags & KEY_EVENT_UP)) {
+            timing->sent_ns[timing->sent++] = now_ns;
+        }
+    }
+    return timing->inner->Emit(timing->inner, events, count);
+}
+
+static void TimingClose(KeySink* sink) {
+    (void)sink;
+}
+
+// Stand-in for a keyboard: writes each keystroke's character to a pseudo-terminal
+typedef struct {
+    KeySink base;
+    int fd;                // pty master
+    KeyLayout layout;      // Every character as Unicode, backspace included
+} PtySink;
+
+// Append a codepoint as UTF-8
+static size_t EncodeUtf8(uint32_t cp, char* out) {
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = (char)(0xC0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = (char)(0xE0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (cp >> 18));
+    out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+// Write the characters of every press in one write, like the uinput sink's batches
+static bool PtyEmit(KeySink* sink, const KeyEvent* events, size_t count) {
+    PtySink* pty = (PtySink*)sink;
+    char bytes[EMIT_BURST_EVENTS * 4];
+    size_t used = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (!(events[i].flags & KEY_EVENT_UP)) {
+            if (used + 4 > sizeof(bytes)) {
+                if (write(pty->fd, bytes, used) != (ssize_t)used) {
+                    return false;
+                }
+                used = 0;
+            }
+            used += EncodeUtf8(events[i].code, bytes + used);
+        }
+    }
+    return used == 0 || write(pty->fd, bytes, used) == (ssize_t)used;
+}
+
+static void PtyClose(KeySink* sink) {
+    PtySink* pty = (PtySink*)sink;
+    close(pty->fd);
+    free(pty);
+}
+
+// Where a receiver reads keystrokes from
+#define E2E_RECEIVER_PTY   0
+#define E2E_RECEIVER_EVDEV 1
+
+typedef struct {
+    int kind;              // E2E_RECEIVER_*
+    int fd;                // Raw pty slave, or the grabbed event device
+    uint32_t keymap[2][KEY_CNT]; // Evdev: character of each key, without and with Shift
+} E2EReceiver;
+
+// One character (or backspace) as the receiver saw it
+typedef struct {
+    uint64_t received_ns;
+    uint32_t codepoint;
+} E2EReceipt;
+
+// Receiver-side decoding state and what it collected
+typedef struct {
+    E2EReceipt* receipts;
+    size_t count;
+    size_t capacity;
+    bool dropped;          // The kernel reported lost events (SYN_DROPPED)
+    Utf8Decoder decoder;   // Pty: UTF-8 split across reads
+    bool shift;            // Evdev: modifier state
+    bool ctrl;
+    bool hex_entry;        // Evdev: inside a Ctrl+Shift+U sequence
+    uint32_t hex_value;
+} E2ECollector;
+
+static void AddReceipt(E2ECollector* collector, uint32_t codepoint, uint64_t now_ns) {
+    if (collector->count == collector->capacity) {
+        size_t capacity = collector->capacity ? collector->capacity * 2 : 4096;
+        E2EReceipt* receipts = (E2EReceipt*)realloc(collector->receipts, capacity * sizeof(E2EReceipt));
+        if (!receipts) {
+            collector->dropped = true;
+            return;
+        }
+        collector->receipts = receipts;
+        collector->capacity = capacity;
+    }
+    collector->receipts[collector->count].received_ns = now_ns;
+    collector->receipts[collector->count].codepoint = codepoint;
+    collector->count++;
+}
+
+// Decode terminal input: UTF-8 characters, with BS or DEL as a backspace
+static void CollectPtyBytes(E2ECollector* collector, const uint8_t* bytes, size_t length, uint64_t now_ns) {
+    for (size_t i = 0; i < length; i++) {
+        uint32_t cp;
+        int step = Utf8Step(&collector->decoder, bytes[i], &cp);
+        if (step == UTF8_REJECT || step == UTF8_INVALID) {
+            AddReceipt(collector, 0xFFFD, now_ns);
+            i -= step == UTF8_REJECT;
+        } else if (step == UTF8_ACCEPT) {
+            AddReceipt(collector, cp == 0x7F ? E2E_BACKSPACE : cp, now_ns);
+        }
+    }
+}
+
+// Decode key presses the way a US QWERTY desktop would, including the
+// Ctrl+Shift+U <hex> Space entry of IBus and GTK
+static void CollectInputEvents(E2ECollector* collector, const E2EReceiver* receiver,
+                               const struct input_event* events, size_t count, uint64_t now_ns) {
+    for (size_t i = 0; i < count; i++) {
+        const struct input_event* ev = &events[i];
+        if (ev->type == EV_SYN && ev->code == SYN_DROPPED) {
+            collector->dropped = true;
+        }
+        if (ev->type != EV_KEY || ev->code >= KEY_CNT || ev->value == 2) {
+            continue;
+        }
+        bool press = ev->value == 1;
+        if (ev->code == KEY_LEFTSHIFT || ev->code == KEY_RIGHTSHIFT) {
+            collector->shift = press;
+            continue;
+        }
+        if (ev->code == KEY_LEFTCTRL || ev->code == KEY_RIGHTCTRL) {
+            collector->ctrl = press;
+            continue;
+        }
+        if (!press) {
+            continue;
+        }
+
+        if (collector->ctrl && collector->shift && ev->code == KEY_U) {
+            collector->hex_entry = true;
+            collector->hex_value = 0;
+        } else if (collector->hex_entry) {
+            uint32_t c = receiver->keymap[0][ev->code];
+            if (ev->code == KEY_SPACE) {
+                AddReceipt(collector, collector->hex_value, now_ns);
+                collector->hex_entry = false;
+            } else if (c >= '0' && c <= '9') {
+                collector->hex_value = collector->hex_value * 16 + (c - '0');
+            } else if (c >= 'a' && c <= 'f') {
+                collector->hex_value = collector->hex_value * 16 + (c - 'a' + 10);
+            }
+        } else {
+            uint32_t c = receiver->keymap[collector->shift ? 1 : 0][ev->code];
+            if (c) {
+                AddReceipt(collector, c, now_ns);
+            }
+        }
+    }
+}
+
+// Write all of data to fd
+static bool WriteAll(int fd, const void* data, size_t length) {
+    const char* bytes = (const char*)data;
+    while (length > 0) {
+        ssize_t written = write(fd, bytes, length);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        bytes += written;
+        length -= (size_t)written;
+    }
+    return true;
+}
+
+// Read exactly length bytes from fd
+static bool ReadAll(int fd, void* data, size_t length) {
+    char* bytes = (char*)data;
+    while (length > 0) {
+        ssize_t got = read(fd, bytes, length);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            return false;
+        }
+        bytes += got;
+        length -= (size_t)got;
+    }
+    return true;
+}
+
+// Body of the receiver process: collect keystrokes until stop_fd closes and
+// input has been quiet for E2E_DRAIN_MS, then send everything to result_fd
+static void RunReceiver(const E2EReceiver* receiver, int stop_fd, int result_fd) {
+    E2ECollector collector;
+    memset(&collector, 0, sizeof(collector));
+    InitializeUtf8Decoder(&collector.decoder);
+
+    struct pollfd fds[2] = { { receiver->fd, POLLIN, 0 }, { stop_fd, POLLIN, 0 } };
+    bool stopping = false;
+    while (true) {
+        int ready = poll(fds, stopping ? 1 : 2, stopping ? E2E_DRAIN_MS : -1);
+        if (ready < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ready <= 0) {
+            break;
+        }
+        if (!stopping && fds[1].revents) {
+            stopping = true;
+        }
+        if (!(fds[0].revents & POLLIN)) {
+            continue;
+        }
+
+        if (receiver->kind == E2E_RECEIVER_PTY) {
+            uint8_t bytes[4096];
+            ssize_t got = read(receiver->fd, bytes, sizeof(bytes));
+            if (got > 0) {
+                CollectPtyBytes(&collector, bytes, (size_t)got, MonotonicNowNs());
+            }
+        } else {
+            struct input_event events[256];
+            ssize_t got = read(receiver->fd, events, sizeof(events));
+            if (got > 0) {
+                CollectInputEvents(&collector, receiver, events, (size_t)got / sizeof(struct input_event),
+                                   MonotonicNowNs());
+            }
+        }
+    }
+
+    uint64_t header[2] = { collector.count, collector.dropped };
+    bool ok = WriteAll(result_fd, header, sizeof(header)) &&
+              WriteAll(result_fd, collector.receipts, collector.count * sizeof(E2EReceipt));
+    _exit(ok ? 0 : 1);
+}
+
+// The text the receiver should end up with: the source as the planner reads
+// it (CR and CRLF as one newline, malformed UTF-8 as nothing) without the
+// characters the sink cannot type
+static bool ExpectedText(const char* text, size_t length, const KeyLayout* layout, TextBuffer* out) {
+    if (!ReserveTextBuffer(out, length)) {
+        return false;
+    }
+    Utf8Decoder decoder;
+    InitializeUtf8Decoder(&decoder);
+    bool after_cr = false;
+    for (size_t i = 0; i < length; i++) {
+        uint32_t cp;
+        int step = Utf8Step(&decoder, (uint8_t)text[i], &cp);
+        if (step == UTF8_REJECT) {
+            i--;
+            continue;
+        }
+        if (step != UTF8_ACCEPT) {
+            continue;
+        }
+        if (cp == '\n' && after_cr) {
+            after_cr = false;
+            continue;
+        }
+        after_cr = cp == '\r';
+        if (cp == '\r') {
+            cp = '\n';
+        }
+        KeyEvent key;
+        if (LookupLayout(layout, cp, &key)) {
+            out->length += EncodeUtf8(cp, out->data + out->length);
+        }
+    }
+    out->data[out->length] = '\0';
+    return true;
+}
+
+// Replay the receipts as an editor would: characters append, backspace
+// deletes the last character. Returns the backspaces seen.
+static size_t ReplayReceipts(const E2EReceipt* receipts, size_t count, TextBuffer* out) {
+    size_t backspaces = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (receipts[i].codepoint == E2E_BACKSPACE) {
+            backspaces++;
+            while (out->length > 0 && ((uint8_t)out->data[out->length - 1] & 0xC0) == 0x80) {
+                out->length--;
+            }
+            if (out->length > 0) {
+                out->length--;
+            }
+        } else if (ReserveTextBuffer(out, 4)) {
+            out->length += EncodeUtf8(receipts[i].codepoint, out->data + out->length);
+        }
+    }
+    if (out->data) {
+        out->data[out->length] = '\0';
+    }
+    return backspaces;
+}
+
+// Print where two texts first differ, with a little of each around it
+static void PrintMismatch(const TextBuffer* expected, const TextBuffer* received) {
+    size_t at = 0;
+    while (at < expected->length && at < received->length && expected->data[at] == received->data[at]) {
+        at++;
+    }
+    size_t from = at > 16 ? at - 16 : 0;
+    printf("  Texts differ at byte %zu (expected %zu bytes, received %zu)\n", at, expected->length, received->length);
+    printf("  expected: \"%.*s\"\n", (int)((expected->length - from) < 40 ? expected->length - from : 40),
+           expected->data + from);
+    printf("  received: \"%.*s\"\n", (int)((received->length - from) < 40 ? received->length - from : 40),
+           received->length > from ? received->data + from : "");
+}
+
+// Type the text once with one batching mode and check what the receiver got
+static bool RunE2EPass(const EndToEndOptions* options, const char* text, size_t length, KeySink* sink,
+                       const E2EReceiver* receiver, const char* sink_name, const char* mode_name,
+                       uint64_t coalesce_ns) {
+    int stop_pipe[2];
+    int result_pipe[2];
+    if (pipe2(stop_pipe, O_CLOEXEC) != 0) {
+        return false;
+    }
+    if (pipe2(result_pipe, O_CLOEXEC) != 0) {
+        close(stop_pipe[0]);
+        close(stop_pipe[1]);
+        return false;
+    }
+
+    fflush(stdout);
+    pid_t child = fork();
+    if (child == 0) {
+        close(stop_pipe[1]);
+        close(result_pipe[0]);
+        RunReceiver(receiver, stop_pipe[0], result_pipe[1]);
+    }
+    close(stop_pipe[0]);
+    close(result_pipe[1]);
+    if (child < 0) {
+        printf(ANSI_COLOR_RED "Error: Could not start the receiver process (%s)\n" ANSI_COLOR_RESET, strerror(errno));
+        close(stop_pipe[1]);
+        close(result_pipe[0]);
+        return false;
+    }
+
+    // Every character may come with a typo and its backspace
+    TimingSink timing;
+    memset(&timing, 0, sizeof(timing));
+    timing.base.name = sink->name;
+    timing.base.layout = sink->layout;
+    timing.base.Emit = TimingEmit;
+    timing.base.Close = TimingClose;
+    timing.inner = sink;
+    timing.capacity = 3 * length + 16;
+    timing.sent_ns = (uint64_t*)malloc(timing.capacity * sizeof(uint64_t));
+
+    TypingReport report;
+    memset(&report, 0, sizeof(report));
+    bool typed = false;
+    if (timing.sent_ns) {
+        TypingSimulator simulator;
+        InitializeSimulator(&simulator, &timing.base, options->wpm);
+        HumanizeProfile profile;
+        DefaultHumanizeProfile(&profile);
+        profile.typo_probability = E2E_TYPO_PROBABILITY;
+        profile.correction_min = 0.01;
+        profile.correction_max = 0.03;
+        profile.word_pause_probability = 0.0;
+        profile.sentence_pause_probability = 0.0;
+        BuildHumanizeModel(&simulator.humanize, &profile);
+        simulator.humanized = !options->steady;
+        simulator.seed = options->seed;
+        simulator.coalesce_ns = coalesce_ns;
+
+        TextSource* source = OpenMemoryTextSource(text, length);
+        typed = source && TypeHeadless(&simulator, source, &report);
+        CloseTextSource(source);
+        CleanupSimulator(&simulator);
+    }
+
+    // Closing the stop pipe lets the receiver drain and report
+    close(stop_pipe[1]);
+    uint64_t header[2] = { 0, 0 };
+    E2EReceipt* receipts = NULL;
+    bool received = ReadAll(result_pipe[0], header, sizeof(header));
+    if (received && header[0] > 0) {
+        receipts = (E2EReceipt*)malloc(header[0] * sizeof(E2EReceipt));
+        received = receipts && ReadAll(result_pipe[0], receipts, header[0] * sizeof(E2EReceipt));
+    }
+    close(result_pipe[0]);
+    int status = 0;
+    while (waitpid(child, &status, 0) < 0 && errno == EINTR) {
+    }
+
+    TextBuffer expected;
+    TextBuffer got;
+    InitializeTextBuffer(&expected);
+    InitializeTextBuffer(&got);
+    bool ok = typed && received && !header[1] && ExpectedText(text, length, sink->layout, &expected);
+    size_t count = received ? (size_t)header[0] : 0;
+    size_t backspaces = ReplayReceipts(receipts, count, &got);
+    bool matched = ok && got.length == expected.length && memcmp(got.data, expected.data, got.length) == 0;
+    bool complete = count == timing.sent && backspaces == report.typos;
+
+    printf("%-15s %-7s %s  %zu keystrokes sent, %zu received, %zu of %zu typos corrected",
+           sink_name, mode_name, matched && complete ? ANSI_COLOR_GREEN "ok      " ANSI_COLOR_RESET
+                                                     : ANSI_COLOR_RED "MISMATCH" ANSI_COLOR_RESET,
+           timing.sent, count, backspaces, report.typos);
+    if (count > 0 && timing.sent > 0) {
+        uint64_t span_ns = receipts[count - 1].received_ns - timing.sent_ns[0];
+        printf(", %.0f keys/s", span_ns ? (double)count * 1e9 / (double)span_ns : 0.0);
+    }
+    printf("\n");
+    if (!typed) {
+        printf("  Typing failed: %s\n", report.error ? report.error : "out of memory");
+    }
+    if (header[1]) {
+        printf("  The receiver lost events (its buffer overflowed)\n");
+    }
+    if (ok && !matched) {
+        PrintMismatch(&expected, &got);
+    }
+
+    // Keystrokes pair up in order; a lost or extra one would shift the rest
+    if (matched && complete) {
+        LatencyHistogram delivery;
+        memset(&delivery, 0, sizeof(delivery));
+        for (size_t i = 0; i < count; i++) {
+            uint64_t sent_ns = timing.sent_ns[i];
+            RecordLatency(&delivery, receipts[i].received_ns > sent_ns ? receipts[i].received_ns - sent_ns : 0);
+        }
+        PrintLatencyLine(stdout, "delivery", &delivery);
+    }
+
+    FreeTextBuffer(&expected);
+    FreeTextBuffer(&got);
+    free(receipts);
+    free(timing.sent_ns);
+    return matched && complete;
+}
+
+// Open a pseudo-terminal pair: a sink writing to the master and a raw-mode
+// receiver reading the slave
+static KeySink* OpenPtyPair(E2EReceiver* receiver) {
+    int master = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        printf(ANSI_COLOR_RED "Error: Could not open a pseudo-terminal (%s)\n" ANSI_COLOR_RESET, strerror(errno));
+        if (master >= 0) {
+            close(master);
+        }
+        return NULL;
+    }
+    int slave = open(ptsname(master), O_RDWR | O_NOCTTY | O_CLOEXEC);
+    struct termios raw;
+    if (slave < 0 || tcgetattr(slave, &raw) != 0) {
+        printf(ANSI_COLOR_RED "Error: Could not open the pseudo-terminal's slave (%s)\n" ANSI_COLOR_RESET, strerror(errno));
+        if (slave >= 0) {
+            close(slave);
+        }
+        close(master);
+        return NULL;
+    }
+    // No echo, no line editing, no CR/NL translation: every byte arrives as written
+    cfmakeraw(&raw);
+    tcsetattr(slave, TCSANOW, &raw);
+
+    PtySink* pty = (PtySink*)calloc(1, sizeof(PtySink));
+    if (!pty) {
+        printf(ANSI_COLOR_RED "Error: Memory allocation failed\n" ANSI_COLOR_RESET);
+        close(slave);
+        close(master);
+        return NULL;
+    }
+    InitializeLayout(&pty->layout, true);
+    FinishLayout(&pty->layout);
+    pty->base.name = "pty";
+    pty->base.layout = &pty->layout;
+    pty->base.Emit = PtyEmit;
+    pty->base.Close = PtyClose;
+    pty->fd = master;
+
+    receiver->kind = E2E_RECEIVER_PTY;
+    receiver->fd = slave;
+    return &pty->base;
+}
+
+// Find the event node of the input device called name, waiting for it to appear
+static int OpenEventDevice(const char* name) {
+    for (int waited = 0; waited <= E2E_DEVICE_WAIT_MS; waited += 10) {
+        DIR* dir = opendir("/dev/input");
+        struct dirent* entry;
+        while (dir && (entry = readdir(dir))) {
+            if (strncmp(entry->d_name, "event", 5) != 0) {
+                continue;
+            }
+            int fd = openat(dirfd(dir), entry->d_name, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+            char device_name[UINPUT_MAX_NAME_SIZE] = "";
+            if (fd >= 0 && ioctl(fd, EVIOCGNAME(sizeof(device_name) - 1), device_name) >= 0 &&
+                strcmp(device_name, name) == 0) {
+                closedir(dir);
+                return fd;
+            }
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+        if (dir) {
+            closedir(dir);
+        }
+        CoarseSleepUntilNs(MonotonicNowNs() + 10000000ULL);
+    }
+    return -1;
+}
+
+// Create a uinput keyboard and grab its evdev node for the receiver, so the
+// keystrokes go nowhere else
+static KeySink* OpenUinputPair(E2EReceiver* receiver, bool unicode_input) {
+    char name[UINPUT_MAX_NAME_SIZE];
+    snprintf(name, sizeof(name), "humanizer-e2e-%ld%s", (long)getpid(), unicode_input ? "-u" : "");
+    KeySink* sink = OpenUinputSink(name, unicode_input);
+    if (!sink) {
+        return NULL;
+    }
+
+    int fd = OpenEventDevice(name);
+    if (fd < 0 || ioctl(fd, EVIOCGRAB, 1) != 0) {
+        printf(ANSI_COLOR_RED "Error: Could not read back %s through evdev (%s)\n" ANSI_COLOR_RESET, name,
+               fd < 0 ? "no readable event node" : strerror(errno));
+        if (fd >= 0) {
+            close(fd);
+        }
+        CloseSink(sink);
+        return NULL;
+    }
+
+    // The receiver reads keys back through the same table the sink types with
+    memset(receiver->keymap, 0, sizeof(receiver->keymap));
+    for (uint32_t cp = 0; cp < 128; cp++) {
+        const LayoutEntry* entry = &sink->layout->entries[cp];
+        if (entry->kind == LAYOUT_KEY && entry->code < KEY_CNT) {
+            uint32_t* slot = &receiver->keymap[(entry->mods & KEY_MOD_SHIFT) ? 1 : 0][entry->code];
+            if (!*slot) {
+                *slot = cp;
+            }
+        }
+    }
+    receiver->kind = E2E_RECEIVER_EVDEV;
+    receiver->fd = fd;
+    return sink;
+}
+
+// Type the text through every sink and batching mode and report fidelity and latency
+int RunEndToEndTest(const EndToEndOptions* options) {
+    TypingSimulator file;
+    memset(&file, 0, sizeof(file));
+    const char* text = kSampleText;
+    size_t length = sizeof(kSampleText) - 1;
+    if (options->path) {
+        if (!LoadFileContent(options->path, &file)) {
+            return 1;
+        }
+        text = file.text;
+        length = file.length;
+    }
+
+    static const struct {
+        const char* name;
+        uint64_t coalesce_ns;
+    } kBatchingModes[] = {
+        { "single", 0 },
+        { "spin", SCHEDULER_SPIN_NS },
+        { "wide", E2E_WIDE_COALESCE_NS },
+    };
+    static const struct {
+        const char* name;
+        bool uinput;
+        bool unicode_input;
+    } kSinks[] = {
+        { "pty", false, false },
+        { "uinput", true, false },
+        { "uinput-unicode", true, true },
+    };
+
+    printf("Typing %zu bytes at %.0f WPM (%s, seed %llu) through each sink and batching mode\n", length, options->wpm,
+           options->steady ? "steady" : "typos on, thinking pauses off", (unsigned long long)options->seed);
+    printf("Batching: single = one write per keystroke, spin = also what is due within %llu us of waking, wide = within %llu us\n\n",
+           (unsigned long long)(SCHEDULER_SPIN_NS / 1000), (unsigned long long)(E2E_WIDE_COALESCE_NS / 1000));
+
+    // A receiver that dies early must not kill the harness with SIGPIPE
+    signal(SIGPIPE, SIG_IGN);
+
+    size_t passes = 0;
+    size_t failures = 0;
+    for (size_t s = 0; s < sizeof(kSinks) / sizeof(kSinks[0]); s++) {
+        if (kSinks[s].uinput && (options->pty_only || access("/dev/uinput", W_OK) != 0)) {
+            printf("%-15s skipped (%s)\n", kSinks[s].name, options->pty_only ? "--e2e-pty" : "/dev/uinput is not writable");
+            continue;
+        }
+
+        E2EReceiver* receiver = (E2EReceiver*)calloc(1, sizeof(E2EReceiver));
+        KeySink* sink = NULL;
+        if (receiver) {
+            sink = kSinks[s].uinput ? OpenUinputPair(receiver, kSinks[s].unicode_input) : OpenPtyPair(receiver);
+        }
+        if (!sink) {
+            free(receiver);
+            failures++;
+            continue;
+        }
+
+        for (size_t m = 0; m < sizeof(kBatchingModes) / sizeof(kBatchingModes[0]); m++) {
+            if (RunE2EPass(options, text, length, sink, receiver, kSinks[s].name, kBatchingModes[m].name,
+                           kBatchingModes[m].coalesce_ns)) {
+                passes++;
+            } else {
+                failures++;
+            }
+        }
+        close(receiver->fd);
+        free(receiver);
+        CloseSink(sink);
+    }
+
+    printf("\n%zu passes matched, %zu failed\n", passes, failures);
+    free(file.text);
+    return failures == 0 && passes > 0 ? 0 : 1;
+}
@@ -0,0 +1,35 @@
+#ifndef HUMANIZER_CORE_E2E_H
+#define HUMANIZER_CORE_E2E_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// End-to-end check (e2e.c, Linux only). Types a text through the real
+// pipeline (planner, ring, emitter thread, coalescing) into a sink while a
+// forked receiver process reads what arrives: a uinput keyboard read back
+// through its evdev node (grabbed, so nothing reaches the desktop), or a
+// pseudo-terminal in raw mode as a stand-in that works without /dev/uinput.
+// The receiver replays the keys as an editor would, backspaces included, and
+// the result must equal the source byte for byte, less what the sink cannot
+// type. Every keystroke is also timed from the sink call to its receipt.
+
+#define E2E_DEFAULT_WPM 1200
+#define E2E_TYPO_PROBABILITY 0.05       // Raised so every run corrects a few typos
+#define E2E_WIDE_COALESCE_NS 5000000ULL // Coalescing window of the "wide" batching mode
+#define E2E_DRAIN_MS 200                // Receiver stops after this long without input once typing ends
+#define E2E_DEVICE_WAIT_MS 2000         // How long the evdev node of a new uinput device may take to appear
+
+typedef struct {
+    const char* path;      // Text to type, NULL for the built-in sample
+    double wpm;
+    bool steady;           // Evenly spaced keystrokes, no typos
+    uint64_t seed;
+    bool pty_only;         // Leave out the uinput sinks even if /dev/uinput is writable
+} EndToEndOptions;
+
+// Run every sink and batching mode; returns the process exit code (0 if all
+// received text matched)
+int RunEndToEndTest(const EndToEndOptions* options);
+
+#endif // HUMANIZER_CORE_E2E_H
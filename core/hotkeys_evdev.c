@@ -0,0 +1,166 @@
+#define _GNU_SOURCE
+
+#include "humanizer.h"
+#include "control.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/eventfd.h>
+#include <linux/input.h>
+
+#define HOTKEY_MAX_DEVICES 32
+#define HOTKEY_INPUT_DIR "/dev/input"
+
+// Reads F6/F8 presses straight from every keyboard under /dev/input, so the
+// hotkeys work whichever window has focus (X11, Wayland or the console)
+struct HotkeyListener {
+    RunControl* control;
+    int wake_fd;                      // eventfd written to stop the thread
+    int devices[HOTKEY_MAX_DEVICES];  // Open keyboards (-1 once one goes away)
+    size_t device_count;
+    HumanizerThread thread;
+};
+
+// Whether the device reports both hotkeys
+static bool HasHotkeys(int fd) {
+    unsigned long keys[KEY_MAX / (8 * sizeof(unsigned long)) + 1];
+    memset(keys, 0, sizeof(keys));
+    if (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keys)), keys) < 0) {
+        return false;
+    }
+    const size_t bits = 8 * sizeof(unsigned long);
+    return (keys[KEY_F6 / bits] >> (KEY_F6 % bits) & 1) && (keys[KEY_F8 / bits] >> (KEY_F8 % bits) & 1);
+}
+
+// Open every readable event device with the hotkeys
+static void OpenKeyboards(HotkeyListener* listener) {
+    DIR* dir = opendir(HOTKEY_INPUT_DIR);
+    if (!dir) {
+        return;
+    }
+
+    struct dirent* entry;
+    while ((entry = readdir(dir)) && listener->device_count < HOTKEY_MAX_DEVICES) {
+        if (strncmp(entry->d_name, "event", 5) != 0) {
+            continue;
+        }
+        int fd = openat(dirfd(dir), entry->d_name, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+        if (HasHotkeys(fd)) {
+            listener->devices[listener->device_count++] = fd;
+        } else {
+            close(fd);
+        }
+    }
+    closedir(dir);
+}
+
+// Apply the hotkey presses in a batch of input events (auto-repeat is ignored)
+static void HandleInputEvents(HotkeyListener* listener, const struct input_event* events, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (events[i].type != EV_KEY || events[i].value != 1) {
+            continue;
+        }
+        if (events[i].code == KEY_F6) {
+            TogglePause(listener->control);
+        } else if (events[i].code == KEY_F8) {
+            RequestStop(listener->control);
+        }
+    }
+}
+
+static void HotkeyThread(void* arg) {
+    HotkeyListener* listener = (HotkeyListener*)arg;
+    struct pollfd fds[HOTKEY_MAX_DEVICES + 1];
+
+    fds[0].fd = listener->wake_fd;
+    fds[0].events = POLLIN;
+    for (size_t i = 0; i < listener->device_count; i++) {
+        fds[i + 1].fd = listener->devices[i];
+        fds[i + 1].events = POLLIN;
+    }
+
+    while (true) {
+        if (poll(fds, listener->device_count + 1, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        if (fds[0].revents) {
+            return;
+        }
+
+        for (size_t i = 1; i <= listener->device_count; i++) {
+            if (!fds[i].revents) {
+                continue;
+            }
+            struct input_event events[64];
+            ssize_t got = read(fds[i].fd, events, sizeof(events));
+            if (got > 0) {
+                HandleInputEvents(listener, events, (size_t)got / sizeof(struct input_event));
+            } else if (got == 0 || (errno != EAGAIN && errno != EINTR)) {
+                // Unplugged: poll skips negative descriptors
+                close(fds[i].fd);
+                fds[i].fd = -1;
+                listener->devices[i - 1] = -1;
+            }
+        }
+    }
+}
+
+// Listen for the hotkeys on every keyboard the process can read
+HotkeyListener* StartHotkeyListener(RunControl* control) {
+    HotkeyListener* listener = (HotkeyListener*)calloc(1, sizeof(HotkeyListener));
+    if (!listener) {
+        return NULL;
+    }
+    listener->control = control;
+
+    OpenKeyboards(listener);
+    if (listener->device_count == 0) {
+        printf("Warning: Hotkeys unavailable (no readable keyboard under " HOTKEY_INPUT_DIR
+               "; join the input group to use " HOTKEY_PAUSE_NAME "/" HOTKEY_STOP_NAME ")\n");
+        free(listener);
+        return NULL;
+    }
+
+    listener->wake_fd = eventfd(0, EFD_CLOEXEC);
+    if (listener->wake_fd < 0 || !StartThread(&listener->thread, HotkeyThread, listener)) {
+        printf("Warning: Hotkeys unavailable (could not start the listener)\n");
+        if (listener->wake_fd >= 0) {
+            close(listener->wake_fd);
+        }
+        for (size_t i = 0; i < listener->device_count; i++) {
+            close(listener->devices[i]);
+        }
+        free(listener);
+        return NULL;
+    }
+    return listener;
+}
+
+void StopHotkeyListener(HotkeyListener* listener) {
+    if (!listener) {
+        return;
+    }
+    uint64_t one = 1;
+    if (write(listener->wake_fd, &one, sizeof(one)) == sizeof(one)) {
+        JoinThread(&listener->thread);
+    }
+    close(listener->wake_fd);
+    for (size_t i = 0; i < listener->device_count; i++) {
+        if (listener->devices[i] >= 0) {
+            close(listener->devices[i]);
+        }
+    }
+    free(listener);
+}
@@ -0,0 +1,92 @@
+#include "humanizer.h"
+#include "control.h"
+
+#include <stdlib.h>
+#include <dispatch/dispatch.h>
+#include <Carbon/Carbon.h>
+
+// Listen-only Quartz event tap on a thread running its own run loop (needs the
+// same Accessibility permission as the CGEvent sink)
+struct HotkeyListener {
+    RunControl* control;
+    CFMachPortRef tap;
+    CFRunLoopSourceRef source;
+    CFRunLoopRef run_loop;     // Listener thread's run loop, stopped on shutdown
+    dispatch_semaphore_t ready; // Signalled once run_loop is set
+    HumanizerThread thread;
+};
+
+static CGEventRef HotkeyTapCallback(CGEventTapProxy proxy, CGEventType type, CGEventRef event, void* context) {
+    (void)proxy;
+    HotkeyListener* listener = (HotkeyListener*)context;
+
+    // The system disables taps that are slow or during secure input; turn it back on
+    if (type == kCGEventTapDisabledByTimeout || type == kCGEventTapDisabledByUserInput) {
+        CGEventTapEnable(listener->tap, true);
+        return event;
+    }
+    if (type != kCGEventKeyDown || CGEventGetIntegerValueField(event, kCGKeyboardEventAutorepeat)) {
+        return event;
+    }
+
+    int64_t key = CGEventGetIntegerValueField(event, kCGKeyboardEventKeycode);
+    if (key == kVK_F6) {
+        TogglePause(listener->control);
+    } else if (key == kVK_F8) {
+        RequestStop(listener->control);
+    }
+    return event;
+}
+
+static void HotkeyThread(void* arg) {
+    HotkeyListener* listener = (HotkeyListener*)arg;
+    listener->run_loop = CFRunLoopGetCurrent();
+    CFRunLoopAddSource(listener->run_loop, listener->source, kCFRunLoopCommonModes);
+    dispatch_semaphore_signal(listener->ready);
+    CFRunLoopRun();
+}
+
+// Install the event tap and run it on a listener thread
+HotkeyListener* StartHotkeyListener(RunControl* control) {
+    HotkeyListener* listener = (HotkeyListener*)calloc(1, sizeof(HotkeyListener));
+    if (!listener) {
+        return NULL;
+    }
+    listener->control = control;
+
+    listener->tap = CGEventTapCreate(kCGSessionEventTap, kCGHeadInsertEventTap, kCGEventTapOptionListenOnly,
+                                     CGEventMaskBit(kCGEventKeyDown), HotkeyTapCallback, listener);
+    if (!listener->tap) {
+        printf("Warning: Hotkeys unavailable (allow this terminal under Privacy & Security > Accessibility)\n");
+        free(listener);
+        return NULL;
+    }
+    listener->source = CFMachPortCreateRunLoopSource(kCFAllocatorDefault, listener->tap, 0);
+    listener->ready = dispatch_semaphore_create(0);
+
+    if (!listener->source || !StartThread(&listener->thread, HotkeyThread, listener)) {
+        printf("Warning: Hotkeys unavailable (could not start the listener)\n");
+        if (listener->source) {
+            CFRelease(listener->source);
+        }
+        CFRelease(listener->tap);
+        dispatch_release(listener->ready);
+        free(listener);
+        return NULL;
+    }
+    dispatch_semaphore_wait(listener->ready, DISPATCH_TIME_FOREVER);
+    return listener;
+}
+
+void StopHotkeyListener(HotkeyListener* listener) {
+    if (!listener) {
+        return;
+    }
+    CGEventTapEnable(listener->tap, false);
+    CFRunLoopStop(listener->run_loop);
+    JoinThread(&listener->thread);
+    CFRelease(listener->source);
+    CFRelease(listener->tap);
+    dispatch_release(listener->ready);
+    free(listener);
+}
@@ -0,0 +1,88 @@
+#include "humanizer.h"
+#include "control.h"
+
+#include <stdlib.h>
+#include <windows.h>
+
+#pragma comment(lib, "user32.lib")
+
+#define HOTKEY_ID_PAUSE 1
+#define HOTKEY_ID_STOP  2
+
+// System-wide hotkeys registered on a thread with its own message queue
+struct HotkeyListener {
+    RunControl* control;
+    HumanizerThread thread;
+    DWORD thread_id;           // Receives WM_QUIT on stop
+    HANDLE ready;              // Set once registration finished
+    bool registered;           // At least one hotkey was registered
+};
+
+static void HotkeyThread(void* arg) {
+    HotkeyListener* listener = (HotkeyListener*)arg;
+    MSG message;
+
+    // Create the message queue before anyone can post WM_QUIT to it
+    PeekMessageW(&message, NULL, WM_USER, WM_USER, PM_NOREMOVE);
+    listener->thread_id = GetCurrentThreadId();
+    bool pause = RegisterHotKey(NULL, HOTKEY_ID_PAUSE, MOD_NOREPEAT, VK_F6) != 0;
+    bool stop = RegisterHotKey(NULL, HOTKEY_ID_STOP, MOD_NOREPEAT, VK_F8) != 0;
+    listener->registered = pause || stop;
+    SetEvent(listener->ready);
+    if (!listener->registered) {
+        return;
+    }
+
+    while (GetMessageW(&message, NULL, 0, 0) > 0) {
+        if (message.message != WM_HOTKEY) {
+            continue;
+        }
+        if (message.wParam == HOTKEY_ID_PAUSE) {
+            TogglePause(listener->control);
+        } else if (message.wParam == HOTKEY_ID_STOP) {
+            RequestStop(listener->control);
+        }
+    }
+
+    UnregisterHotKey(NULL, HOTKEY_ID_PAUSE);
+    UnregisterHotKey(NULL, HOTKEY_ID_STOP);
+}
+
+// Register the hotkeys on a listener thread
+HotkeyListener* StartHotkeyListener(RunControl* control) {
+    HotkeyListener* listener = (HotkeyListener*)calloc(1, sizeof(HotkeyListener));
+    if (!listener) {
+        return NULL;
+    }
+    listener->control = control;
+    listener->ready = CreateEventW(NULL, TRUE, FALSE, NULL);
+
+    if (!listener->ready || !StartThread(&listener->thread, HotkeyThread, listener)) {
+        printf("Warning: Hotkeys unavailable (could not start the listener)\n");
+        if (listener->ready) {
+            CloseHandle(listener->ready);
+        }
+        free(listener);
+        return NULL;
+    }
+
+    WaitForSingleObject(listener->ready, INFINITE);
+    CloseHandle(listener->ready);
+    if (!listener->registered) {
+        printf("Warning: Hotkeys unavailable (" HOTKEY_PAUSE_NAME " and " HOTKEY_STOP_NAME
+               " are taken by another program)\n");
+        JoinThread(&listener->thread);
+        free(listener);
+        return NULL;
+    }
+    return listener;
+}
+
+void StopHotkeyListener(HotkeyListener* listener) {
+    if (!listener) {
+        return;
+    }
+    PostThreadMessageW(listener->thread_id, WM_QUIT, 0, 0);
+    JoinThread(&listener->thread);
+    free(listener);
+}
@@ -0,0 +1,205 @@
+#include "humanize.h"
+
+#include <math.h>
+#include <string.h>
+
+// Lognormal spread of thinking pauses around the median
+#define PAUSE_SIGMA 0.6
+
+// Width of the tabulated range on each side of the lognormal's log-mean, in sigmas
+#define DISTRIBUTION_SIGMAS 4.0
+
+// Default humanization profile
+void DefaultHumanizeProfile(HumanizeProfile* profile) {
+    profile->speed_variation = 0.25;
+    profile->typo_probability = 0.02;
+    profile->correction_min = 0.1;
+    profile->correction_max = 0.3;
+    profile->word_pause_probability = 0.03;
+    profile->sentence_pause_probability = 0.25;
+    profile->pause_median = 0.6;
+    profile->distance_weight = 0.0;
+    profile->keyboard = KEYBOARD_QWERTY;
+}
+
+// Set one profile field by its option name
+bool SetHumanizeOption(HumanizeProfile* profile, const char* name, double value) {
+    if (!isfinite(value) || value < 0.0) {
+        return false;
+    }
+    if (strcmp(name, "typo") == 0 && value <= 1) {
+        profile->typo_probability = value;
+    } else if (strcmp(name, "variation") == 0 && value <= HUMANIZE_MAX_VARIATION) {
+        profile->speed_variation = value;
+    } else if (strcmp(name, "correction_min") == 0 && value <= HUMANIZE_MAX_SECONDS) {
+        profile->correction_min = value;
+    } else if (strcmp(name, "correction_max") == 0 && value <= HUMANIZE_MAX_SECONDS) {
+        profile->correction_max = value;
+    } else if (strcmp(name, "word_pause") == 0 && value <= 1) {
+        profile->word_pause_probability = value;
+    } else if (strcmp(name, "sentence_pause") == 0 && value <= 1) {
+        profile->sentence_pause_probability = value;
+    } else if (strcmp(name, "pause_median") == 0 && value <= HUMANIZE_MAX_SECONDS) {
+        profile->pause_median = value;
+    } else if (strcmp(name, "distance") == 0 && value <= HUMANIZE_MAX_DISTANCE) {
+        profile->distance_weight = value;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Cross-field checks SetHumanizeOption cannot make one field at a time
+bool IsValidHumanizeProfile(const HumanizeProfile* profile) {
+    return profile->correction_min <= profile->correction_max;
+}
+
+// Fill the alias table from unnormalized bin weights (Vose's method)
+static void BuildAliasTable(AliasDistribution* dist, const double* weights) {
+    double scaled[HUMANIZE_DISTRIBUTION_BINS];
+    uint16_t small[HUMANIZE_DISTRIBUTION_BINS];
+    uint16_t large[HUMANIZE_DISTRIBUTION_BINS];
+    size_t small_count = 0;
+    size_t large_count = 0;
+    double total = 0.0;
+
+    for (size_t i = 0; i < HUMANIZE_DISTRIBUTION_BINS; i++) {
+        total += weights[i];
+    }
+    for (size_t i = 0; i < HUMANIZE_DISTRIBUTION_BINS; i++) {
+        scaled[i] = total > 0.0 ? weights[i] * HUMANIZE_DISTRIBUTION_BINS / total : 1.0;
+        if (scaled[i] < 1.0) {
+            small[small_count++] = (uint16_t)i;
+        } else {
+            large[large_count++] = (uint16_t)i;
+        }
+    }
+
+    while (small_count > 0 && large_count > 0) {
+        uint16_t s = small[--small_count];
+        uint16_t l = large[--large_count];
+        dist->threshold[s] = (uint32_t)(scaled[s] * 4294967295.0);
+        dist->alias[s] = l;
+        scaled[l] -= 1.0 - scaled[s];
+        if (scaled[l] < 1.0) {
+            small[small_count++] = l;
+        } else {
+            large[large_count++] = l;
+        }
+    }
+
+    // Whatever is left is a full bin (up to rounding error) and never redirects
+    while (large_count > 0) {
+        uint16_t l = large[--large_count];
+        dist->threshold[l] = UINT32_MAX;
+        dist->alias[l] = l;
+    }
+    while (small_count > 0) {
+        uint16_t s = small[--small_count];
+        dist->threshold[s] = UINT32_MAX;
+        dist->alias[s] = s;
+    }
+}
+
+// Tabulate a lognormal distribution over equal-width bins
+static void BuildLognormal(AliasDistribution* dist, double mu, double sigma) {
+    double weights[HUMANIZE_DISTRIBUTION_BINS];
+
+    if (sigma <= 0.0) {
+        // Degenerate: every sample is exactly exp(mu)
+        dist->lo = exp(mu);
+        dist->width = 0.0;
+        for (size_t i = 0; i < HUMANIZE_DISTRIBUTION_BINS; i++) {
+            weights[i] = 1.0;
+        }
+        BuildAliasTable(dist, weights);
+        return;
+    }
+
+    double lo = exp(mu - DISTRIBUTION_SIGMAS * sigma);
+    double hi = exp(mu + DISTRIBUTION_SIGMAS * sigma);
+    dist->lo = lo;
+    dist->width = (hi - lo) / HUMANIZE_DISTRIBUTION_BINS;
+
+    for (size_t i = 0; i < HUMANIZE_DISTRIBUTION_BINS; i++) {
+        double x = lo + ((double)i + 0.5) * dist->width;
+        double z = (log(x) - mu) / sigma;
+        weights[i] = exp(-0.5 * z * z) / x;
+    }
+    BuildAliasTable(dist, weights);
+
+    // Rescale so the tabulated (truncated) distribution keeps the intended mean
+    double mean = 0.0;
+    double total = 0.0;
+    for (size_t i = 0; i < HUMANIZE_DISTRIBUTION_BINS; i++) {
+        mean += weights[i] * (lo + ((double)i + 0.5) * dist->width);
+        total += weights[i];
+    }
+    double target = exp(mu + 0.5 * sigma * sigma);
+    double scale = target / (mean / total);
+    dist->lo *= scale;
+    dist->width *= scale;
+}
+
+// Precompute the sampling tables for a profile
+void BuildHumanizeModel(HumanizeModel* model, const HumanizeProfile* profile) {
+    // Intervals: lognormal with mean 1 and the requested relative spread
+    double cv = profile->speed_variation > 0.0 ? profile->speed_variation : 0.0;
+    double sigma = sqrt(log(1.0 + cv * cv));
+    BuildLognormal(&model->interval, -0.5 * sigma * sigma, sigma);
+
+    double median_ns = (profile->pause_median > 0.0 ? profile->pause_median : 0.0) * 1e9;
+    if (median_ns > 0.0) {
+        BuildLognormal(&model->pause, log(median_ns), PAUSE_SIGMA);
+    } else {
+        BuildLognormal(&model->pause, 0.0, 0.0);
+        model->pause.lo = 0.0;
+    }
+
+    model->typo_chance = ChanceThreshold(profile->typo_probability);
+    model->word_pause_chance = ChanceThreshold(profile->word_pause_probability);
+    model->sentence_pause_chance = ChanceThreshold(profile->sentence_pause_probability);
+
+    double correction_min = profile->correction_min > 0.0 ? profile->correction_min : 0.0;
+    double correction_max = profile->correction_max > correction_min ? profile->correction_max : correction_min;
+    model->correction_min_ns = (uint64_t)(correction_min * 1e9);
+    model->correction_span_ns = (uint64_t)((correction_max - correction_min) * 1e9);
+    int keyboard = profile->keyboard >= 0 && profile->keyboard < KEYBOARD_LAYOUT_COUNT ? profile->keyboard
+                                                                                      : KEYBOARD_QWERTY;
+    model->keyboard = &kKeyboardLayouts[keyboard];
+    model->distance_weight = profile->distance_weight;
+    model->per_mean_travel = 1.0 / model->keyboard->mean_travel;
+    model->digraphs = NULL;
+}
+
+// Expected value of a draw: bin i is kept with probability threshold/2^32 and
+// receives the redirected share of every bin aliased to it
+double AliasDistributionMean(const AliasDistribution* dist) {
+    double mass[HUMANIZE_DISTRIBUTION_BINS] = { 0 };
+    for (size_t i = 0; i < HUMANIZE_DISTRIBUTION_BINS; i++) {
+        double keep = (double)dist->threshold[i] / 4294967296.0;
+        mass[i] += keep;
+        mass[dist->alias[i]] += 1.0 - keep;
+    }
+
+    double mean = 0.0;
+    for (size_t i = 0; i < HUMANIZE_DISTRIBUTION_BINS; i++) {
+        mean += mass[i] * (dist->lo + ((double)i + 0.5) * dist->width);
+    }
+    return mean / HUMANIZE_DISTRIBUTION_BINS;
+}
+
+// Pick the character of a key next to the given letter on the model's keyboard
+uint32_t PickTypo(const HumanizeModel* model, RandomState* rng, uint32_t codepoint) {
+    const KeyboardLayout* layout = model->keyboard;
+    uint8_t key = KeyboardKey(layout, codepoint);
+    if (key == KEYBOARD_NONE || !(layout->letters >> (key & KEYBOARD_KEY_MASK) & 1)) {
+        return 0;
+    }
+
+    bool shifted = (key & KEYBOARD_SHIFT) != 0;
+    key &= KEYBOARD_KEY_MASK;
+    uint64_t count = kKeyboardNeighborCount[key];
+    uint8_t neighbor = kKeyboardNeighbors[key][(NextRandom(rng) >> 32) * count >> 32];
+    return layout->characters[neighbor][shifted && (layout->letters >> neighbor & 1)];
+}
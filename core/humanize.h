@@ -0,0 +1,128 @@
+#ifndef HUMANIZER_CORE_HUMANIZE_H
+#define HUMANIZER_CORE_HUMANIZE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "random.h"
+#include "keyboard.h"
+
+struct DigraphProfile;
+
+// Resolution of the precomputed delay distributions (power of two, indexed by the top random bits)
+#define HUMANIZE_DISTRIBUTION_BITS 8
+#define HUMANIZE_DISTRIBUTION_BINS (1 << HUMANIZE_DISTRIBUTION_BITS)
+
+// Shortest share of an interval that travel timing leaves a key pair
+#define HUMANIZE_MIN_TRAVEL_SCALE 0.25
+
+// Largest values SetHumanizeOption accepts
+#define HUMANIZE_MAX_VARIATION 4.0      // Relative standard deviation of intervals
+#define HUMANIZE_MAX_SECONDS 60.0       // Typo-noticing delays and the median thinking pause
+#define HUMANIZE_MAX_DISTANCE 4.0       // Travel weight
+
+// Tunable description of how a person types
+typedef struct {
+    double speed_variation;            // Relative standard deviation of keystroke intervals
+    double typo_probability;           // Chance a letter hits a neighbouring key first
+    double correction_min;             // Seconds before a typo is noticed and backspaced
+    double correction_max;
+    double word_pause_probability;     // Chance of a thinking pause between words
+    double sentence_pause_probability; // Chance of a thinking pause after . ! or ?
+    double pause_median;               // Median thinking pause in seconds
+    double distance_weight;            // How much hand travel between keys stretches an interval (0: none)
+    int keyboard;                      // KEYBOARD_* layout the typist's fingers know
+} HumanizeProfile;
+
+// Discrete distribution sampled in O(1) with Walker's alias method. Each bin
+// covers an equal slice [lo + i * width, lo + (i + 1) * width) of the value range.
+typedef struct {
+    uint32_t threshold[HUMANIZE_DISTRIBUTION_BINS]; // Keep bin i if 32 random bits fall below this
+    uint16_t alias[HUMANIZE_DISTRIBUTION_BINS];     // Bin used otherwise
+    double lo;                                      // Start of the value range
+    double width;                                   // Width of one bin
+} AliasDistribution;
+
+// Profile compiled into tables and integer thresholds so planning needs no libm calls
+typedef struct {
+    AliasDistribution interval;        // Keystroke interval as a multiple of the mean (mean 1.0)
+    AliasDistribution pause;           // Thinking pause in nanoseconds
+    uint64_t typo_chance;              // ChanceThreshold() values
+    uint64_t word_pause_chance;
+    uint64_t sentence_pause_chance;
+    uint64_t correction_min_ns;        // Typo-noticing delay range
+    uint64_t correction_span_ns;
+    const KeyboardLayout* keyboard;    // Where typos land, and what travel and digraphs are measured on
+    double distance_weight;            // Relative interval change per mean travel of extra distance
+    double per_mean_travel;            // 1 / keyboard->mean_travel
+    const struct DigraphProfile* digraphs; // Per key pair delays replacing interval (NULL: none)
+} HumanizeModel;
+
+// Defaults modelled on the original Python typist, toned down to read as natural
+void DefaultHumanizeProfile(HumanizeProfile* profile);
+
+// Set one profile field by its option name (typo, variation, correction_min,
+// correction_max, word_pause, sentence_pause, pause_median, distance); false
+// if the name is unknown or the value out of range. The keyboard is named,
+// so it is set with FindKeyboardLayout instead.
+bool SetHumanizeOption(HumanizeProfile* profile, const char* name, double value);
+
+// Whether the fields that depend on each other agree (correction_min is not
+// above correction_max); checked once every option has been set
+bool IsValidHumanizeProfile(const HumanizeProfile* profile);
+
+// Precompute the sampling tables for a profile
+void BuildHumanizeModel(HumanizeModel* model, const HumanizeProfile* profile);
+
+// Expected value of a draw from the distribution
+double AliasDistributionMean(const AliasDistribution* dist);
+
+// Pick the character of a key next to the given letter on the model's keyboard
+// (same case where the neighbour is a letter too); 0 if the character is not
+// a letter of that keyboard
+uint32_t PickTypo(const HumanizeModel* model, RandomState* rng, uint32_t codepoint);
+
+// Draw a value from the distribution
+static inline double SampleAliasDistribution(const AliasDistribution* dist, RandomState* rng) {
+    uint64_t r = NextRandom(rng);
+    uint32_t bin = (uint32_t)(r >> (64 - HUMANIZE_DISTRIBUTION_BITS));
+    if ((uint32_t)r >= dist->threshold[bin]) {
+        bin = dist->alias[bin];
+    }
+    // The bits between the bin index and the threshold bits place the value inside the bin
+    double within = (double)((r >> 32) & 0xFFFFFF) * (1.0 / 16777216.0);
+    return dist->lo + ((double)bin + within) * dist->width;
+}
+
+// Interval until the next keystroke for a mean spacing of mean_ns
+static inline uint64_t SampleKeystrokeInterval(const HumanizeModel* model, RandomState* rng, uint64_t mean_ns) {
+    return (uint64_t)(SampleAliasDistribution(&model->interval, rng) * (double)mean_ns);
+}
+
+// Interval from the key typing from to the key typing to, stretched or
+// shortened by how far the hand travels compared with the keyboard's mean
+static inline uint64_t SampleTravelInterval(const HumanizeModel* model, RandomState* rng, uint32_t from,
+                                            uint32_t to, uint64_t mean_ns) {
+    double interval = SampleAliasDistribution(&model->interval, rng) * (double)mean_ns;
+    uint8_t a = KeyboardKey(model->keyboard, from);
+    uint8_t b = KeyboardKey(model->keyboard, to);
+    if (a == KEYBOARD_NONE || b == KEYBOARD_NONE) {
+        return (uint64_t)interval;
+    }
+    double travel = (double)KeyboardTravel(a & KEYBOARD_KEY_MASK, b & KEYBOARD_KEY_MASK) * model->per_mean_travel;
+    double scale = 1.0 + model->distance_weight * (travel - 1.0);
+    return (uint64_t)(interval * (scale > HUMANIZE_MIN_TRAVEL_SCALE ? scale : HUMANIZE_MIN_TRAVEL_SCALE));
+}
+
+// Length of a thinking pause
+static inline uint64_t SampleThinkingPause(const HumanizeModel* model, RandomState* rng) {
+    return (uint64_t)SampleAliasDistribution(&model->pause, rng);
+}
+
+// Time between a typo and the backspace that corrects it
+static inline uint64_t SampleCorrectionDelay(const HumanizeModel* model, RandomState* rng) {
+    return model->correction_min_ns + (uint64_t)(RandomUnit(rng) * (double)model->correction_span_ns);
+}
+
+#endif // HUMANIZER_CORE_HUMANIZE_H
@@ -0,0 +1,197 @@
+#ifndef HUMANIZER_CORE_HUMANIZER_H
+#define HUMANIZER_CORE_HUMANIZER_H
+
+// Stop the compiler from complaining about unsafe string functions
+#ifndef _CRT_SECURE_NO_WARNINGS
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#include "sink.h"
+#include "plan.h"
+#include "source.h"
+#include "trace.h"
+#include "latency.h"
+#include "ring.h"
+#include "control.h"
+#include "clock.h"
+#include "thread.h"
+
+// ANSI color codes for output formatting
+#define ANSI_COLOR_RED     "\x1b[31m"
+#define ANSI_COLOR_GREEN   "\x1b[32m"
+#define ANSI_COLOR_BLUE    "\x1b[34m"
+#define ANSI_COLOR_RESET   "\x1b[0m"
+
+// Constants defining limits for text and file handling
+#define MAX_TEXT_LENGTH 1000000
+#define PROGRESS_BAR_WIDTH 50
+#define STATS_REFRESH_HZ 10
+#define DELAY_HISTOGRAM_BUCKETS 4096 // 1 ms buckets; the last one collects everything longer
+#define RATE_WINDOW_NS 10000000000ULL // Span of the sliding-window typing speed
+#define RATE_WINDOW_CAPACITY 2048   // Characters the window remembers (power of two; faster typing shortens the window)
+#define RATE_INSTANT_CHARS 8        // Characters behind the instantaneous typing speed
+#define CHARS_PER_WORD 5            // Standard word length for WPM
+#define MAX_WPM 10000               // Fastest target speed accepted from users (--wpm, {WPM:N}, daemon jobs)
+#define MAX_PAUSE_S 3600            // Longest {PAUSE:N}, in seconds
+#define MAX_DELAY_S 60.0            // Longest wait before typing starts, in seconds (--delay, daemon jobs)
+#define EMIT_BURST_EVENTS 64        // Most events one coalesced sink call carries
+
+#define MAX_PATH_LENGTH 260
+#define SUPPORTED_EXTENSIONS ".txt\0.docx\0"
+
+// Structure to store typing statistics. Speeds count CHARS_PER_WORD characters
+// as a word and are measured on active time, which excludes pauses.
+typedef struct {
+    double current_wpm;    // Words per minute over the last RATE_WINDOW_NS
+    double instant_wpm;    // Words per minute over the last RATE_INSTANT_CHARS characters
+    double average_wpm;    // Words per minute over the whole session
+    double current_cpm;    // Characters per minute over the last RATE_WINDOW_NS
+    size_t chars_typed;    // Number of characters typed
+    size_t words_typed;    // Number of words typed
+    size_t typos;          // Wrong keys pressed
+    size_t corrections;    // Backspaces that erased a typo
+    double accuracy;       // Share of keystrokes for the text that were right first time (0-1)
+    time_t start_time;     // Start time for typing simulation
+    double elapsed_time;   // Active seconds since typing started
+} TypingStats;
+
+// Counters published by the typing thread for the stats renderer. The typing
+// thread is the only writer; sequence is odd while it updates the fields, so
+// readers can take a consistent snapshot without a lock (a seqlock).
+typedef struct {
+    atomic_uint sequence;
+    atomic_size_t chars_typed;    // Number of characters typed
+    atomic_size_t words_typed;    // Number of words typed
+    atomic_size_t typos;
+    atomic_size_t corrections;
+    atomic_size_t window_chars;   // Characters in the sliding window
+    _Atomic uint64_t window_start_ns; // Active time of the oldest of them
+    atomic_size_t instant_chars;  // Characters behind the instantaneous speed
+    _Atomic uint64_t instant_start_ns;
+    _Atomic uint64_t start_ns;    // Monotonic time of the active timeline's origin (moves forward after each pause)
+    _Atomic uint64_t paused_ns;   // Monotonic time the current pause began, 0 while typing
+} LiveTypingStats;
+
+// Typing-thread side of the statistics: a ring of recent character times on
+// the active timeline. Every update is O(1) amortized and allocation-free.
+typedef struct {
+    uint64_t times[RATE_WINDOW_CAPACITY]; // Active time of each recent character
+    uint64_t head;                // Characters recorded
+    uint64_t tail;                // Oldest character still inside the window
+    size_t chars_typed;
+    size_t words_typed;
+    size_t typos;
+    size_t corrections;
+} TypingMeter;
+
+// Receives each statistics snapshot taken by a StatsRenderer
+typedef void (*StatsDrawFn)(const TypingStats* stats, void* context);
+
+// Background thread that redraws the statistics line at a fixed rate
+typedef struct {
+    const LiveTypingStats* live;  // Counters to render
+    StatsDrawFn draw;             // Where snapshots go (the console line by default)
+    void* context;                // Passed to draw
+    HumanizerThread thread;       // Renderer thread
+    atomic_bool stop;             // Set to ask the renderer to draw once more and exit
+    uint64_t interval_ns;         // Time between redraws
+    bool running;                 // Whether the thread was started
+} StatsRenderer;
+
+// Distribution of the delays between consecutive keystrokes
+typedef struct {
+    uint64_t buckets[DELAY_HISTOGRAM_BUCKETS]; // Count per whole millisecond
+    uint64_t count;               // Delays recorded
+    uint64_t total_ns;            // Sum of all delays
+    uint64_t max_ns;              // Longest delay
+} DelayHistogram;
+
+// Outcome of a headless run (dry run or daemon job)
+typedef struct {
+    size_t keystrokes;            // Keystrokes emitted, typos and backspaces included
+    size_t chars_typed;           // Characters of the text typed
+    size_t words_typed;           // Words completed
+    size_t typos;                 // Typos made and corrected
+    size_t unmapped_chars;        // Characters the sink could not produce
+    uint64_t planned_ns;          // Planned time from the first to the last keystroke
+    uint64_t wall_ns;             // Real time the run took
+    double target_wpm;            // Speed the plan was paced for
+    const char* error;            // Why the run failed, NULL on success
+    DelayHistogram delays;        // Planned spacing between keystrokes
+} TypingReport;
+
+// Structure for the typing simulator, including text and stats
+typedef struct {
+    char* text;            // Pointer to the text being typed
+    size_t length;         // Length of the text
+    TypingStats stats;     // Typing statistics for the simulation
+    LiveTypingStats live;  // Counters updated while typing
+    KeySink* sink;         // Destination for generated keystrokes
+    double target_wpm;     // Words per minute the typing loop paces itself to
+    KeyPlan plan;          // Keystrokes compiled from text before typing starts
+    FILE* plan_listing;    // Optional destination for a listing of each compiled plan
+    const char* record_path; // Optional keystroke trace written for each session (overwritten)
+    LatencyTracer* latency; // Optional per-keystroke timing of real-time sessions
+    HumanizeModel humanize; // Typos, speed variation and thinking pauses
+    bool humanized;        // Apply the humanize model (false: evenly spaced keystrokes)
+    uint64_t seed;         // Seed for the humanize model; the same seed and text replay identically
+    StatsDrawFn progress;  // Progress receiver for headless runs (NULL: none)
+    void* progress_context;
+    RunControl* control;   // Pause/stop requests from other threads (NULL: typing always runs to the end)
+    bool resumable;        // Someone can resume the control (a hotkey), so {PAUSE} directives wait for it
+    bool directives;       // Compile {PAUSE}, {WPM:N}, {TYPOS:N} and list formatting found in the text
+    bool realtime;         // Run the emitter thread at real-time priority
+    uint64_t coalesce_ns;  // Keystrokes due by this long after the emitter wakes go out together (0: never)
+    int emitter_cpu;       // CPU the emitter thread is pinned to (-1: any)
+} TypingSimulator;
+
+// Simulator lifecycle and the typing loop (simulator.c)
+void InitializeSimulator(TypingSimulator* simulator, KeySink* sink, double target_wpm);
+void CleanupSimulator(TypingSimulator* simulator);
+void SimulateTyping(TypingSimulator* simulator);
+void SimulateTypingFromSource(TypingSimulator* simulator, TextSource* source);
+void DescribeText(const TypingSimulator* simulator, const char* text, size_t length);
+void InitializeSimulatorPlanner(TypingSimulator* simulator, KeyPlanner* planner);
+bool DryRunTyping(TypingSimulator* simulator, TextSource* source, TypingReport* report);
+bool TypeHeadless(TypingSimulator* simulator, TextSource* source, TypingReport* report);
+void ReplayTrace(TypingSimulator* simulator, const char* path);
+
+// File loading (input.c)
+bool IsSupportedFileType(const char* filepath);
+bool IsDocxFile(const char* filepath);
+bool LoadFileContent(const char* filepath, TypingSimulator* simulator);
+
+// Statistics and progress output (stats.c)
+void DisplayProgressBar(size_t current, size_t total);
+void ResetLiveTypingStats(LiveTypingStats* live);
+void ResetTypingMeter(TypingMeter* meter);
+void RecordKeystroke(TypingMeter* meter, LiveTypingStats* live, uint64_t time_ns, uint16_t flags);
+void UpdateTypingStats(TypingStats* stats, const LiveTypingStats* live);
+void DisplayTypingStats(const TypingStats* stats);
+void StartStatsRenderer(StatsRenderer* renderer, const LiveTypingStats* live, unsigned refresh_hz,
+                        StatsDrawFn draw, void* context);
+void StopStatsRenderer(StatsRenderer* renderer);
+void ResetDelayHistogram(DelayHistogram* histogram);
+void RecordDelay(DelayHistogram* histogram, uint64_t delay_ns);
+double DelayPercentile(const DelayHistogram* histogram, double percentile);
+void DisplayDryRunReport(const TypingReport* report);
+
+// Interactive console front end shared by all platforms (console.c)
+void ClearScreen(void);
+void ClearInputBuffer(void);
+void HandleInputChoice(TypingSimulator* simulator);
+void HandleManualInput(TypingSimulator* simulator);
+void HandleFileDrop(TypingSimulator* simulator);
+
+// Non-interactive mode for scripts and pipes (console.c)
+bool StandardInputIsInteractive(void);
+int TypeNonInteractive(TypingSimulator* simulator, const char* path, double delay_seconds);
+
+#endif // HUMANIZER_CORE_HUMANIZER_H
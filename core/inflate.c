@@ -0,0 +1,380 @@
+#include "inflate.h"
+
+#include <string.h>
+
+// Decoder states kept between InflateRead calls
+enum {
+    INFLATE_HEADER,   // Expecting a block header
+    INFLATE_STORED,   // Copying an uncompressed block
+    INFLATE_CODES,    // Decoding literal/length symbols
+    INFLATE_MATCH,    // Copying a back-reference out of the window
+    INFLATE_DONE      // End of stream or error
+};
+
+#define WINDOW_MASK (INFLATE_WINDOW_SIZE - 1)
+
+// Base values and extra bits for length symbols 257..285 and distance symbols 0..29
+static const uint16_t kLengthBase[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t kLengthExtra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t kDistanceBase[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t kDistanceExtra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+// Order in which code length code lengths are stored
+static const uint8_t kCodeLengthOrder[19] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+// Prepare to decode a raw DEFLATE stream pulled from read(context, ...)
+void InitializeInflater(Inflater* inflater, InflateReadFn read, void* context) {
+    inflater->read = read;
+    inflater->context = context;
+    inflater->input_pos = 0;
+    inflater->input_length = 0;
+    inflater->bit_buffer = 0;
+    inflater->bit_count = 0;
+    inflater->total_out = 0;
+    inflater->mode = INFLATE_HEADER;
+    inflater->final_block = false;
+    inflater->copy_length = 0;
+    inflater->copy_distance = 0;
+    inflater->failed = false;
+}
+
+// Top up the bit buffer to at least need bits; false if the input ran out first
+static bool NeedBits(Inflater* inflater, unsigned need) {
+    while (inflater->bit_count < need) {
+        if (inflater->input_pos == inflater->input_length) {
+            inflater->input_length = inflater->read(inflater->context, inflater->input, sizeof(inflater->input));
+            inflater->input_pos = 0;
+            if (inflater->input_length == 0) {
+                return false;
+            }
+        }
+        inflater->bit_buffer |= (uint64_t)inflater->input[inflater->input_pos++] << inflater->bit_count;
+        inflater->bit_count += 8;
+    }
+    return true;
+}
+
+// Take count (<= 32) bits from the stream
+static bool GetBits(Inflater* inflater, unsigned count, uint32_t* value) {
+    if (!NeedBits(inflater, count)) {
+        return false;
+    }
+    *value = (uint32_t)(inflater->bit_buffer & ((1ULL << count) - 1));
+    inflater->bit_buffer >>= count;
+    inflater->bit_count -= count;
+    return true;
+}
+
+// Build a canonical Huffman code from per-symbol code lengths
+static bool BuildHuffman(InflateHuffman* h, const uint8_t* lengths, unsigned symbols) {
+    uint16_t offsets[INFLATE_MAX_BITS + 2];
+
+    memset(h->count, 0, sizeof(h->count));
+    memset(h->fast, 0, sizeof(h->fast));
+    for (unsigned s = 0; s < symbols; s++) {
+        h->count[lengths[s]]++;
+    }
+
+    // Reject over-subscribed codes; incomplete ones are allowed (single distance code)
+    int left = 1;
+    for (unsigned len = 1; len <= INFLATE_MAX_BITS; len++) {
+        left <<= 1;
+        left -= h->count[len];
+        if (left < 0) {
+            return false;
+        }
+    }
+
+    offsets[1] = 0;
+    for (unsigned len = 1; len <= INFLATE_MAX_BITS; len++) {
+        offsets[len + 1] = (uint16_t)(offsets[len] + h->count[len]);
+    }
+    for (unsigned s = 0; s < symbols; s++) {
+        if (lengths[s] != 0) {
+            h->symbol[offsets[lengths[s]]++] = (uint16_t)s;
+        }
+    }
+
+    // Fill the lookup table: codes are stored MSB-first but read LSB-first, so index by reversed code
+    unsigned code = 0;
+    unsigned index = 0;
+    for (unsigned len = 1; len <= INFLATE_FAST_BITS; len++) {
+        for (unsigned n = 0; n < h->count[len]; n++, code++, index++) {
+            unsigned reversed = 0;
+            for (unsigned b = 0; b < len; b++) {
+                reversed |= ((code >> b) & 1) << (len - 1 - b);
+            }
+            for (unsigned fill = reversed; fill < (1u << INFLATE_FAST_BITS); fill += 1u << len) {
+                h->fast[fill] = (uint16_t)((h->symbol[index] << 4) | len);
+            }
+        }
+        code <<= 1;
+    }
+    return true;
+}
+
+// Decode one symbol: table lookup for short codes, canonical bit-by-bit walk otherwise
+static int DecodeSymbol(Inflater* inflater, const InflateHuffman* h) {
+    if (NeedBits(inflater, INFLATE_FAST_BITS) || inflater->bit_count > 0) {
+        unsigned peek = (unsigned)(inflater->bit_buffer & ((1u << INFLATE_FAST_BITS) - 1));
+        uint16_t entry = h->fast[peek];
+        unsigned len = entry & 0xF;
+        if (entry != 0 && len <= inflater->bit_count) {
+            inflater->bit_buffer >>= len;
+            inflater->bit_count -= len;
+            return entry >> 4;
+        }
+    }
+
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    for (unsigned len = 1; len <= INFLATE_MAX_BITS; len++) {
+        uint32_t bit;
+        if (!GetBits(inflater, 1, &bit)) {
+            return -1;
+        }
+        code |= (int)bit;
+        int count = h->count[len];
+        if (code - count < first) {
+            return h->symbol[index + (code - first)];
+        }
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+// Install the fixed codes of block type 1
+static void BuildFixedCodes(Inflater* inflater) {
+    uint8_t lengths[288];
+    unsigned s = 0;
+    for (; s < 144; s++) lengths[s] = 8;
+    for (; s < 256; s++) lengths[s] = 9;
+    for (; s < 280; s++) lengths[s] = 7;
+    for (; s < 288; s++) lengths[s] = 8;
+    BuildHuffman(&inflater->lencode, lengths, 288);
+
+    for (s = 0; s < 30; s++) lengths[s] = 5;
+    BuildHuffman(&inflater->distcode, lengths, 30);
+}
+
+// Read the code descriptions of a block type 2 header
+static bool ReadDynamicCodes(Inflater* inflater) {
+    uint32_t hlit, hdist, hclen;
+    if (!GetBits(inflater, 5, &hlit) || !GetBits(inflater, 5, &hdist) || !GetBits(inflater, 4, &hclen)) {
+        return false;
+    }
+    hlit += 257;
+    hdist += 1;
+    hclen += 4;
+    if (hlit > 286 || hdist > 30) {
+        return false;
+    }
+
+    uint8_t lengths[286 + 30];
+    memset(lengths, 0, 19);
+    for (uint32_t i = 0; i < hclen; i++) {
+        uint32_t len;
+        if (!GetBits(inflater, 3, &len)) {
+            return false;
+        }
+        lengths[kCodeLengthOrder[i]] = (uint8_t)len;
+    }
+
+    // The code length code is built in lencode and replaced once the real lengths are known
+    if (!BuildHuffman(&inflater->lencode, lengths, 19)) {
+        return false;
+    }
+
+    uint32_t index = 0;
+    while (index < hlit + hdist) {
+        int symbol = DecodeSymbol(inflater, &inflater->lencode);
+        if (symbol < 0) {
+            return false;
+        }
+        if (symbol < 16) {
+            lengths[index++] = (uint8_t)symbol;
+            continue;
+        }
+
+        uint8_t value = 0;
+        uint32_t repeat;
+        if (symbol == 16) {
+            if (index == 0 || !GetBits(inflater, 2, &repeat)) {
+                return false;
+            }
+            value = lengths[index - 1];
+            repeat += 3;
+        } else if (symbol == 17) {
+            if (!GetBits(inflater, 3, &repeat)) {
+                return false;
+            }
+            repeat += 3;
+        } else {
+            if (!GetBits(inflater, 7, &repeat)) {
+                return false;
+            }
+            repeat += 11;
+        }
+        if (index + repeat > hlit + hdist) {
+            return false;
+        }
+        while (repeat--) {
+            lengths[index++] = value;
+        }
+    }
+
+    // A block without an end-of-block code can never terminate
+    if (lengths[256] == 0) {
+        return false;
+    }
+    return BuildHuffman(&inflater->lencode, lengths, hlit) &&
+           BuildHuffman(&inflater->distcode, lengths + hlit, hdist);
+}
+
+// Parse a block header and switch to the matching state
+static bool ReadBlockHeader(Inflater* inflater) {
+    uint32_t final_block, type;
+    if (!GetBits(inflater, 1, &final_block) || !GetBits(inflater, 2, &type)) {
+        return false;
+    }
+    inflater->final_block = final_block != 0;
+
+    if (type == 0) {
+        // Stored blocks start on a byte boundary
+        inflater->bit_buffer >>= inflater->bit_count & 7;
+        inflater->bit_count -= inflater->bit_count & 7;
+
+        uint32_t length, complement;
+        if (!GetBits(inflater, 16, &length) || !GetBits(inflater, 16, &complement) ||
+            length != (~complement & 0xFFFF)) {
+            return false;
+        }
+        inflater->copy_length = length;
+        inflater->mode = INFLATE_STORED;
+        return true;
+    }
+    if (type == 1) {
+        BuildFixedCodes(inflater);
+        inflater->mode = INFLATE_CODES;
+        return true;
+    }
+    if (type == 2 && ReadDynamicCodes(inflater)) {
+        inflater->mode = INFLATE_CODES;
+        return true;
+    }
+    return false;
+}
+
+// State after finishing a block
+static int NextBlockMode(const Inflater* inflater) {
+    return inflater->final_block ? INFLATE_DONE : INFLATE_HEADER;
+}
+
+// Decode up to capacity bytes into out; returns 0 once the stream has ended (check failed)
+size_t InflateRead(Inflater* inflater, uint8_t* out, size_t capacity) {
+    size_t produced = 0;
+
+    while (produced < capacity) {
+        switch (inflater->mode) {
+            case INFLATE_HEADER:
+                if (!ReadBlockHeader(inflater)) {
+                    goto fail;
+                }
+                break;
+
+            case INFLATE_STORED:
+                while (inflater->copy_length > 0 && produced < capacity) {
+                    uint32_t byte;
+                    if (!GetBits(inflater, 8, &byte)) {
+                        goto fail;
+                    }
+                    inflater->window[inflater->total_out++ & WINDOW_MASK] = (uint8_t)byte;
+                    out[produced++] = (uint8_t)byte;
+                    inflater->copy_length--;
+                }
+                if (inflater->copy_length == 0) {
+                    inflater->mode = NextBlockMode(inflater);
+                }
+                break;
+
+            case INFLATE_MATCH:
+                while (inflater->copy_length > 0 && produced < capacity) {
+                    uint8_t byte = inflater->window[(inflater->total_out - inflater->copy_distance) & WINDOW_MASK];
+                    inflater->window[inflater->total_out++ & WINDOW_MASK] = byte;
+                    out[produced++] = byte;
+                    inflater->copy_length--;
+                }
+                if (inflater->copy_length == 0) {
+                    inflater->mode = INFLATE_CODES;
+                }
+                break;
+
+            case INFLATE_CODES: {
+                int symbol = DecodeSymbol(inflater, &inflater->lencode);
+                if (symbol < 0) {
+                    goto fail;
+                }
+                if (symbol < 256) {
+                    inflater->window[inflater->total_out++ & WINDOW_MASK] = (uint8_t)symbol;
+                    out[produced++] = (uint8_t)symbol;
+                    break;
+                }
+                if (symbol == 256) {
+                    inflater->mode = NextBlockMode(inflater);
+                    break;
+                }
+
+                symbol -= 257;
+                if (symbol >= 29) {
+                    goto fail;
+                }
+                uint32_t extra;
+                if (!GetBits(inflater, kLengthExtra[symbol], &extra)) {
+                    goto fail;
+                }
+                uint32_t length = kLengthBase[symbol] + extra;
+
+                symbol = DecodeSymbol(inflater, &inflater->distcode);
+                if (symbol < 0 || symbol >= 30 || !GetBits(inflater, kDistanceExtra[symbol], &extra)) {
+                    goto fail;
+                }
+                uint32_t distance = kDistanceBase[symbol] + extra;
+                if (distance > inflater->total_out) {
+                    goto fail;
+                }
+
+                inflater->copy_length = length;
+                inflater->copy_distance = distance;
+                inflater->mode = INFLATE_MATCH;
+                break;
+            }
+
+            default:
+                return produced;
+        }
+    }
+    return produced;
+
+fail:
+    inflater->failed = true;
+    inflater->mode = INFLATE_DONE;
+    return produced;
+}
@@ -0,0 +1,51 @@
+#ifndef HUMANIZER_CORE_INFLATE_H
+#define HUMANIZER_CORE_INFLATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define INFLATE_WINDOW_SIZE 32768
+#define INFLATE_MAX_BITS 15
+#define INFLATE_FAST_BITS 9
+#define INFLATE_INPUT_SIZE 4096
+
+// Canonical Huffman code with a direct lookup table for short codes
+typedef struct {
+    uint16_t fast[1 << INFLATE_FAST_BITS]; // (symbol << 4) | length, 0 when the code is longer
+    uint16_t count[INFLATE_MAX_BITS + 1];  // Number of codes of each length
+    uint16_t symbol[288];                  // Symbols ordered by code
+} InflateHuffman;
+
+// Pulls compressed bytes; returns 0 at end of input
+typedef size_t (*InflateReadFn)(void* context, uint8_t* buffer, size_t capacity);
+
+// Streaming raw DEFLATE (RFC 1951) decoder. Input is pulled through a callback;
+// output is produced on demand, so a caller can decode any amount of data
+// through a fixed 32 KB window.
+typedef struct {
+    InflateReadFn read;            // Source of compressed bytes
+    void* context;                 // Passed to read
+    uint8_t input[INFLATE_INPUT_SIZE];
+    size_t input_pos;              // Next unread byte in input
+    size_t input_length;           // Valid bytes in input
+    uint64_t bit_buffer;           // Bits not yet consumed, LSB first
+    unsigned bit_count;            // Number of valid bits in bit_buffer
+    uint8_t window[INFLATE_WINDOW_SIZE];
+    uint64_t total_out;            // Bytes produced so far (also the window position)
+    int mode;                      // Decoder state between calls
+    bool final_block;              // Current block is the last one
+    uint32_t copy_length;          // Bytes left in the current stored block or match
+    uint32_t copy_distance;        // Distance of the current match
+    InflateHuffman lencode;        // Literal/length code of the current block
+    InflateHuffman distcode;       // Distance code of the current block
+    bool failed;                   // Stream was corrupt or truncated
+} Inflater;
+
+// Prepare to decode a raw DEFLATE stream pulled from read(context, ...)
+void InitializeInflater(Inflater* inflater, InflateReadFn read, void* context);
+
+// Decode up to capacity bytes into out; returns 0 once the stream has ended (check failed)
+size_t InflateRead(Inflater* inflater, uint8_t* out, size_t capacity);
+
+#endif // HUMANIZER_CORE_INFLATE_H
@@ -0,0 +1,149 @@
+#include "humanizer.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+// Case-insensitive comparison of two file extensions
+static bool ExtensionEquals(const char* a, const char* b) {
+    while (*a && *b) {
+        if (tolower((unsigned char)*a) != tolower((unsigned char)*b)) {
+            return false;
+        }
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+// Check if the file extension is supported for loading
+bool IsSupportedFileType(const char* filepath) {
+    const char* ext = strrchr(filepath, '.');
+    if (!ext) {
+        return false;
+    }
+
+    // SUPPORTED_EXTENSIONS is a list of NUL-terminated entries ending in an empty one
+    for (const char* token = SUPPORTED_EXTENSIONS; *token; token += strlen(token) + 1) {
+        if (ExtensionEquals(ext, token)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Check whether the path names a Word .docx document
+bool IsDocxFile(const char* filepath) {
+    const char* ext = strrchr(filepath, '.');
+    return ext && ExtensionEquals(ext, ".docx");
+}
+
+// Load the extracted text of a .docx document into the simulator's text buffer
+static bool LoadDocxContent(const char* filepath, TypingSimulator* simulator) {
+    TextSource* source = OpenDocxTextSource(filepath);
+    if (!source) {
+        return false;
+    }
+
+    char* temp_buffer = (char*)malloc(MAX_TEXT_LENGTH);
+    if (!temp_buffer) {
+        printf(ANSI_COLOR_RED "Error: Memory allocation failed\n" ANSI_COLOR_RESET);
+        CloseTextSource(source);
+        return false;
+    }
+
+    size_t pos = 0;
+    const char* chunk;
+    size_t chunk_length;
+    while (source->Next(source, &chunk, &chunk_length)) {
+        if (pos + chunk_length > MAX_TEXT_LENGTH - 1) {
+            printf(ANSI_COLOR_RED "Error: File too large\n" ANSI_COLOR_RESET);
+            free(temp_buffer);
+            CloseTextSource(source);
+            return false;
+        }
+        memcpy(temp_buffer + pos, chunk, chunk_length);
+        pos += chunk_length;
+    }
+
+    bool failed = source->failed;
+    CloseTextSource(source);
+
+    if (failed) {
+        printf(ANSI_COLOR_RED "Error: Failed to read file\n" ANSI_COLOR_RESET);
+        free(temp_buffer);
+        return false;
+    }
+    if (pos == 0) {
+        printf(ANSI_COLOR_RED "Error: File is empty\n" ANSI_COLOR_RESET);
+        free(temp_buffer);
+        return false;
+    }
+
+    temp_buffer[pos] = '\0';
+    simulator->text = temp_buffer;
+    simulator->length = pos;
+    return true;
+}
+
+// Load the content of a file into the simulator's text buffer
+bool LoadFileContent(const char* filepath, TypingSimulator* simulator) {
+    if (!IsSupportedFileType(filepath)) {
+        printf(ANSI_COLOR_RED "Error: Unsupported file type\n" ANSI_COLOR_RESET);
+        return false;
+    }
+    if (IsDocxFile(filepath)) {
+        return LoadDocxContent(filepath, simulator);
+    }
+
+    FILE* file = fopen(filepath, "rb");
+    if (file == NULL) {
+        printf(ANSI_COLOR_RED "Error: Could not open file\n" ANSI_COLOR_RESET);
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long file_size = ftell(file);
+    rewind(file);
+
+    if (file_size < 0) {
+        printf(ANSI_COLOR_RED "Error: Could not determine file size\n" ANSI_COLOR_RESET);
+        fclose(file);
+        return false;
+    }
+
+    if (file_size == 0) {
+        printf(ANSI_COLOR_RED "Error: File is empty\n" ANSI_COLOR_RESET);
+        fclose(file);
+        return false;
+    }
+
+    if (file_size > MAX_TEXT_LENGTH - 1) {
+        printf(ANSI_COLOR_RED "Error: File too large\n" ANSI_COLOR_RESET);
+        fclose(file);
+        return false;
+    }
+
+    char* temp_buffer = (char*)malloc((size_t)file_size + 1);
+    if (!temp_buffer) {
+        printf(ANSI_COLOR_RED "Error: Memory allocation failed\n" ANSI_COLOR_RESET);
+        fclose(file);
+        return false;
+    }
+
+    size_t read_size = fread(temp_buffer, 1, (size_t)file_size, file);
+    if (read_size != (size_t)file_size) {
+        printf(ANSI_COLOR_RED "Error: Failed to read file\n" ANSI_COLOR_RESET);
+        free(temp_buffer);
+        fclose(file);
+        return false;
+    }
+
+    temp_buffer[read_size] = '\0';
+    simulator->text = temp_buffer;
+    simulator->length = read_size;
+
+    fclose(file);
+    return true;
+}
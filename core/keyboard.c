@@ -0,0 +1,13 @@
+#include "keyboard.h"
+
+#include <string.h>
+
+// Index of the layout with this name
+int FindKeyboardLayout(const char* name) {
+    for (int i = 0; i < KEYBOARD_LAYOUT_COUNT; i++) {
+        if (strcmp(kKeyboardLayouts[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,73 @@
+#ifndef HUMANIZER_CORE_KEYBOARD_H
+#define HUMANIZER_CORE_KEYBOARD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Keyboard geometry: where each key of the main block sits, which finger
+// types it, which keys surround it and how far apart any two are, plus the
+// characters every supported layout puts on each key. The tables are flat
+// constant arrays written by tools/keyboard_gen.c (keyboard_tables.c; CMake
+// regenerates it at build time), so typo selection and distance timing are
+// plain array reads with nothing built or hashed at run time.
+//
+// Keys are the 47 character keys of an ANSI main block in rows, then space:
+//   0-12 `1234567890-=   13-25 qwertyuiop[]\   26-36 asdfghjkl;'
+//   37-46 zxcvbnm,./     47 space
+// named after the US QWERTY characters they carry. A layout only changes the
+// characters, so positions, fingers, neighbours and distances are shared.
+#define KEYBOARD_KEYS 48
+#define KEYBOARD_SPACE 47
+#define KEYBOARD_MAX_NEIGHBORS 6   // Keys whose centres lie within 1.3 key widths
+#define KEYBOARD_NONE 0xFF         // KeyboardKey() of a character no key types
+#define KEYBOARD_SHIFT 0x80        // Set in KeyboardKey() when the character needs Shift
+#define KEYBOARD_KEY_MASK 0x7F
+#define KEYBOARD_DISTANCE_UNIT 10  // Distances are in tenths of a key width
+
+// Supported layouts, in kKeyboardLayouts order
+#define KEYBOARD_QWERTY 0
+#define KEYBOARD_AZERTY 1          // French
+#define KEYBOARD_QWERTZ 2          // German
+#define KEYBOARD_DVORAK 3
+#define KEYBOARD_COLEMAK 4
+#define KEYBOARD_LAYOUT_COUNT 5
+
+// Hands in kKeyboardHand
+#define KEYBOARD_HAND_LEFT 0
+#define KEYBOARD_HAND_RIGHT 1
+#define KEYBOARD_HAND_THUMB 2      // Space, pressed with either thumb
+
+typedef struct {
+    const char* name;                      // Lowercase, as --keyboard takes it
+    uint16_t characters[KEYBOARD_KEYS][2]; // Unshifted and shifted character of each key (0: none)
+    uint8_t keys[256];                     // Key typing each Latin-1 character, | KEYBOARD_SHIFT; KEYBOARD_NONE if none
+    uint64_t letters;                      // Bit k set if key k types a letter in both cases
+    double mean_travel;                    // Mean KeyboardTravel between successive characters of English text
+} KeyboardLayout;
+
+extern const uint8_t kKeyboardHand[KEYBOARD_KEYS];    // KEYBOARD_HAND_*
+extern const uint8_t kKeyboardFinger[KEYBOARD_KEYS];  // 0 thumb, 1 index, 2 middle, 3 ring, 4 little
+extern const uint8_t kKeyboardRow[KEYBOARD_KEYS];     // 0 number row to 4 space bar
+extern const uint8_t kKeyboardNeighborCount[KEYBOARD_KEYS];
+extern const uint8_t kKeyboardNeighbors[KEYBOARD_KEYS][KEYBOARD_MAX_NEIGHBORS];
+extern const uint8_t kKeyboardDistance[KEYBOARD_KEYS][KEYBOARD_KEYS];
+extern const KeyboardLayout kKeyboardLayouts[KEYBOARD_LAYOUT_COUNT];
+
+// Index of the layout with this name; -1 if there is none
+int FindKeyboardLayout(const char* name);
+
+// Key typing a character on a layout, | KEYBOARD_SHIFT if it needs Shift;
+// KEYBOARD_NONE if no key of the main block types it
+static inline uint8_t KeyboardKey(const KeyboardLayout* layout, uint32_t codepoint) {
+    return codepoint < 256 ? layout->keys[codepoint] : KEYBOARD_NONE;
+}
+
+// Distance the typing hand moves from one key to the next, in tenths of a
+// key width. Keys on different hands (or the thumbs' space bar) are struck
+// while the other hand is already in place, so they need none.
+static inline uint32_t KeyboardTravel(uint8_t from, uint8_t to) {
+    return kKeyboardHand[from] == kKeyboardHand[to] ? kKeyboardDistance[from][to] : 0;
+}
+
+#endif // HUMANIZER_CORE_KEYBOARD_H
@@ -0,0 +1,479 @@
+// Generated by tools/keyboard_gen.c; edit that and regenerate instead of this
+
+#include "keyboard.h"
+
+const uint8_t kKeyboardHand[KEYBOARD_KEYS] = {
+    0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0,
+    0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 1,
+    1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 2,
+};
+
+const uint8_t kKeyboardFinger[KEYBOARD_KEYS] = {
+    4, 4, 3, 2, 1, 1, 1, 1, 2, 3, 4, 4, 4, 4, 3, 2,
+    1, 1, 1, 1, 2, 3, 4, 4, 4, 4, 4, 3, 2, 1, 1, 1,
+    1, 2, 3, 4, 4, 4, 3, 2, 1, 1, 1, 1, 2, 3, 4, 0,
+};
+
+const uint8_t kKeyboardRow[KEYBOARD_KEYS] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 4,
+};
+
+const uint8_t kKeyboardNeighborCount[KEYBOARD_KEYS] = {
+    1, 3, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 3, 4, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 4, 1, 4, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 4, 3, 4, 4, 4, 4, 4, 4, 4, 4, 3, 0,
+};
+
+const uint8_t kKeyboardNeighbors[KEYBOARD_KEYS][KEYBOARD_MAX_NEIGHBORS] = {
+    { 1, 255, 255, 255, 255, 255 },
+    { 0, 2, 13, 255, 255, 255 },
+    { 1, 3, 13, 14, 255, 255 },
+    { 2, 4, 14, 15, 255, 255 },
+    { 3, 5, 15, 16, 255, 255 },
+    { 4, 6, 16, 17, 255, 255 },
+    { 5, 7, 17, 18, 255, 255 },
+    { 6, 8, 18, 19, 255, 255 },
+    { 7, 9, 19, 20, 255, 255 },
+    { 8, 10, 20, 21, 255, 255 },
+    { 9, 11, 21, 22, 255, 255 },
+    { 10, 12, 22, 23, 255, 255 },
+    { 11, 23, 24, 255, 255, 255 },
+    { 1, 2, 14, 26, 255, 255 },
+    { 2, 3, 13, 15, 26, 27 },
+    { 3, 4, 14, 16, 27, 28 },
+    { 4, 5, 15, 17, 28, 29 },
+    { 5, 6, 16, 18, 29, 30 },
+    { 6, 7, 17, 19, 30, 31 },
+    { 7, 8, 18, 20, 31, 32 },
+    { 8, 9, 19, 21, 32, 33 },
+    { 9, 10, 20, 22, 33, 34 },
+    { 10, 11, 21, 23, 34, 35 },
+    { 11, 12, 22, 24, 35, 36 },
+    { 12, 23, 25, 36, 255, 255 },
+    { 24, 255, 255, 255, 255, 255 },
+    { 13, 14, 27, 37, 255, 255 },
+    { 14, 15, 26, 28, 37, 38 },
+    { 15, 16, 27, 29, 38, 39 },
+    { 16, 17, 28, 30, 39, 40 },
+    { 17, 18, 29, 31, 40, 41 },
+    { 18, 19, 30, 32, 41, 42 },
+    { 19, 20, 31, 33, 42, 43 },
+    { 20, 21, 32, 34, 43, 44 },
+    { 21, 22, 33, 35, 44, 45 },
+    { 22, 23, 34, 36, 45, 46 },
+    { 23, 24, 35, 46, 255, 255 },
+    { 26, 27, 38, 255, 255, 255 },
+    { 27, 28, 37, 39, 255, 255 },
+    { 28, 29, 38, 40, 255, 255 },
+    { 29, 30, 39, 41, 255, 255 },
+    { 30, 31, 40, 42, 255, 255 },
+    { 31, 32, 41, 43, 255, 255 },
+    { 32, 33, 42, 44, 255, 255 },
+    { 33, 34, 43, 45, 255, 255 },
+    { 34, 35, 44, 46, 255, 255 },
+    { 35, 36, 45, 255, 255, 255 },
+    { 255, 255, 255, 255, 255, 255 },
+};
+
+const uint8_t kKeyboardDistance[KEYBOARD_KEYS][KEYBOARD_KEYS] = {
+    {
+        0, 10, 20, 30, 40, 50, 60, 70, 80, 90, 100, 110, 120, 18, 27, 36,
+        46, 56, 66, 76, 86, 96, 105, 115, 125, 135, 27, 34, 43, 52, 61, 70,
+        80, 90, 100, 109, 119, 38, 44, 52, 60, 69, 78, 88, 97, 107, 116, 75,
+    },
+    {
+        10, 0, 10, 20, 30, 40, 50, 60, 70, 80, 90, 100, 110, 11, 18, 27,
+        36, 46, 56, 66, 76, 86, 96, 105, 115, 125, 21, 27, 34, 43, 52, 61,
+        70, 80, 90, 100, 109, 33, 38, 44, 52, 60, 69, 78, 88, 97, 107, 67,
+    },
+    {
+        20, 10, 0, 10, 20, 30, 40, 50, 60, 70, 80, 90, 100, 11, 11, 18,
+        27, 36, 46, 56, 66, 76, 86, 96, 105, 115, 20, 21, 27, 34, 43, 52,
+        61, 70, 80, 90, 100, 30, 33, 38, 44, 52, 60, 69, 78, 88, 97, 59,
+    },
+    {
+        30, 20, 10, 0, 10, 20, 30, 40, 50, 60, 70, 80, 90, 18, 11, 11,
+        18, 27, 36, 46, 56, 66, 76, 86, 96, 105, 24, 20, 21, 27, 34, 43,
+        52, 61, 70, 80, 90, 31, 30, 33, 38, 44, 52, 60, 69, 78, 88, 52,
+    },
+    {
+        40, 30, 20, 10, 0, 10, 20, 30, 40, 50, 60, 70, 80, 27, 18, 11,
+        11, 18, 27, 36, 46, 56, 66, 76, 86, 96, 30, 24, 20, 21, 27, 34,
+        43, 52, 61, 70, 80, 35, 31, 30, 33, 38, 44, 52, 60, 69, 78, 47,
+    },
+    {
+        50, 40, 30, 20, 10, 0, 10, 20, 30, 40, 50, 60, 70, 36, 27, 18,
+        11, 11, 18, 27, 36, 46, 56, 66, 76, 86, 38, 30, 24, 20, 21, 27,
+        34, 43, 52, 61, 70, 41, 35, 31, 30, 33, 38, 44, 52, 60, 69, 42,
+    },
+    {
+        60, 50, 40, 30, 20, 10, 0, 10, 20, 30, 40, 50, 60, 46, 36, 27,
+        18, 11, 11, 18, 27, 36, 46, 56, 66, 76, 47, 38, 30, 24, 20, 21,
+        27, 34, 43, 52, 61, 48, 41, 35, 31, 30, 33, 38, 44, 52, 60, 40,
+    },
+    {
+        70, 60, 50, 40, 30, 20, 10, 0, 10, 20, 30, 40, 50, 56, 46, 36,
+        27, 18, 11, 11, 18, 27, 36, 46, 56, 66, 56, 47, 38, 30, 24, 20,
+        21, 27, 34, 43, 52, 56, 48, 41, 35, 31, 30, 33, 38, 44, 52, 40,
+    },
+    {
+        80, 70, 60, 50, 40, 30, 20, 10, 0, 10, 20, 30, 40, 66, 56, 46,
+        36, 27, 18, 11, 11, 18, 27, 36, 46, 56, 66, 56, 47, 38, 30, 24,
+        20, 21, 27, 34, 43, 65, 56, 48, 41, 35, 31, 30, 33, 38, 44, 43,
+    },
+    {
+        90, 80, 70, 60, 50, 40, 30, 20, 10, 0, 10, 20, 30, 76, 66, 56,
+        46, 36, 27, 18, 11, 11, 18, 27, 36, 46, 75, 66, 56, 47, 38, 30,
+        24, 20, 21, 27, 34, 74, 65, 56, 48, 41, 35, 31, 30, 33, 38, 48,
+    },
+    {
+        100, 90, 80, 70, 60, 50, 40, 30, 20, 10, 0, 10, 20, 86, 76, 66,
+        56, 46, 36, 27, 18, 11, 11, 18, 27, 36, 85, 75, 66, 56, 47, 38,
+        30, 24, 20, 21, 27, 83, 74, 65, 56, 48, 41, 35, 31, 30, 33, 54,
+    },
+    {
+        110, 100, 90, 80, 70, 60, 50, 40, 30, 20, 10, 0, 10, 96, 86, 76,
+        66, 56, 46, 36, 27, 18, 11, 11, 18, 27, 95, 85, 75, 66, 56, 47,
+        38, 30, 24, 20, 21, 93, 83, 74, 65, 56, 48, 41, 35, 31, 30, 61,
+    },
+    {
+        120, 110, 100, 90, 80, 70, 60, 50, 40, 30, 20, 10, 0, 105, 96, 86,
+        76, 66, 56, 46, 36, 27, 18, 11, 11, 18, 104, 95, 85, 75, 66, 56,
+        47, 38, 30, 24, 20, 102, 93, 83, 74, 65, 56, 48, 41, 35, 31, 69,
+    },
+    {
+        18, 11, 11, 18, 27, 36, 46, 56, 66, 76, 86, 96, 105, 0, 10, 20,
+        30, 40, 50, 60, 70, 80, 90, 100, 110, 120, 10, 16, 25, 34, 44, 53,
+        63, 73, 83, 93, 103, 21, 27, 34, 43, 52, 61, 70, 80, 90, 100, 57,
+    },
+    {
+        27, 18, 11, 11, 18, 27, 36, 46, 56, 66, 76, 86, 96, 10, 0, 10,
+        20, 30, 40, 50, 60, 70, 80, 90, 100, 110, 13, 10, 16, 25, 34, 44,
+        53, 63, 73, 83, 93, 20, 21, 27, 34, 43, 52, 61, 70, 80, 90, 49,
+    },
+    {
+        36, 27, 18, 11, 11, 18, 27, 36, 46, 56, 66, 76, 86, 20, 10, 0,
+        10, 20, 30, 40, 50, 60, 70, 80, 90, 100, 20, 13, 10, 16, 25, 34,
+        44, 53, 63, 73, 83, 24, 20, 21, 27, 34, 43, 52, 61, 70, 80, 42,
+    },
+    {
+        46, 36, 27, 18, 11, 11, 18, 27, 36, 46, 56, 66, 76, 30, 20, 10,
+        0, 10, 20, 30, 40, 50, 60, 70, 80, 90, 29, 20, 13, 10, 16, 25,
+        34, 44, 53, 63, 73, 30, 24, 20, 21, 27, 34, 43, 52, 61, 70, 35,
+    },
+    {
+        56, 46, 36, 27, 18, 11, 11, 18, 27, 36, 46, 56, 66, 40, 30, 20,
+        10, 0, 10, 20, 30, 40, 50, 60, 70, 80, 39, 29, 20, 13, 10, 16,
+        25, 34, 44, 53, 63, 38, 30, 24, 20, 21, 27, 34, 43, 52, 61, 31,
+    },
+    {
+        66, 56, 46, 36, 27, 18, 11, 11, 18, 27, 36, 46, 56, 50, 40, 30,
+        20, 10, 0, 10, 20, 30, 40, 50, 60, 70, 49, 39, 29, 20, 13, 10,
+        16, 25, 34, 44, 53, 47, 38, 30, 24, 20, 21, 27, 34, 43, 52, 30,
+    },
+    {
+        76, 66, 56, 46, 36, 27, 18, 11, 11, 18, 27, 36, 46, 60, 50, 40,
+        30, 20, 10, 0, 10, 20, 30, 40, 50, 60, 58, 49, 39, 29, 20, 13,
+        10, 16, 25, 34, 44, 56, 47, 38, 30, 24, 20, 21, 27, 34, 43, 32,
+    },
+    {
+        86, 76, 66, 56, 46, 36, 27, 18, 11, 11, 18, 27, 36, 70, 60, 50,
+        40, 30, 20, 10, 0, 10, 20, 30, 40, 50, 68, 58, 49, 39, 29, 20,
+        13, 10, 16, 25, 34, 66, 56, 47, 38, 30, 24, 20, 21, 27, 34, 37,
+    },
+    {
+        96, 86, 76, 66, 56, 46, 36, 27, 18, 11, 11, 18, 27, 80, 70, 60,
+        50, 40, 30, 20, 10, 0, 10, 20, 30, 40, 78, 68, 58, 49, 39, 29,
+        20, 13, 10, 16, 25, 75, 66, 56, 47, 38, 30, 24, 20, 21, 27, 43,
+    },
+    {
+        105, 96, 86, 76, 66, 56, 46, 36, 27, 18, 11, 11, 18, 90, 80, 70,
+        60, 50, 40, 30, 20, 10, 0, 10, 20, 30, 88, 78, 68, 58, 49, 39,
+        29, 20, 13, 10, 16, 85, 75, 66, 56, 47, 38, 30, 24, 20, 21, 51,
+    },
+    {
+        115, 105, 96, 86, 76, 66, 56, 46, 36, 27, 18, 11, 11, 100, 90, 80,
+        70, 60, 50, 40, 30, 20, 10, 0, 10, 20, 98, 88, 78, 68, 58, 49,
+        39, 29, 20, 13, 10, 95, 85, 75, 66, 56, 47, 38, 30, 24, 20, 59,
+    },
+    {
+        125, 115, 105, 96, 86, 76, 66, 56, 46, 36, 27, 18, 11, 110, 100, 90,
+        80, 70, 60, 50, 40, 30, 20, 10, 0, 10, 108, 98, 88, 78, 68, 58,
+        49, 39, 29, 20, 13, 104, 95, 85, 75, 66, 56, 47, 38, 30, 24, 68,
+    },
+    {
+        135, 125, 115, 105, 96, 86, 76, 66, 56, 46, 36, 27, 18, 120, 110, 100,
+        90, 80, 70, 60, 50, 40, 30, 20, 10, 0, 118, 108, 98, 88, 78, 68,
+        58, 49, 39, 29, 20, 114, 104, 95, 85, 75, 66, 56, 47, 38, 30, 77,
+    },
+    {
+        27, 21, 20, 24, 30, 38, 47, 56, 66, 75, 85, 95, 104, 10, 13, 20,
+        29, 39, 49, 58, 68, 78, 88, 98, 108, 118, 0, 10, 20, 30, 40, 50,
+        60, 70, 80, 90, 100, 11, 18, 27, 36, 46, 56, 66, 76, 86, 96, 50,
+    },
+    {
+        34, 27, 21, 20, 24, 30, 38, 47, 56, 66, 75, 85, 95, 16, 10, 13,
+        20, 29, 39, 49, 58, 68, 78, 88, 98, 108, 10, 0, 10, 20, 30, 40,
+        50, 60, 70, 80, 90, 11, 11, 18, 27, 36, 46, 56, 66, 76, 86, 41,
+    },
+    {
+        43, 34, 27, 21, 20, 24, 30, 38, 47, 56, 66, 75, 85, 25, 16, 10,
+        13, 20, 29, 39, 49, 58, 68, 78, 88, 98, 20, 10, 0, 10, 20, 30,
+        40, 50, 60, 70, 80, 18, 11, 11, 18, 27, 36, 46, 56, 66, 76, 33,
+    },
+    {
+        52, 43, 34, 27, 21, 20, 24, 30, 38, 47, 56, 66, 75, 34, 25, 16,
+        10, 13, 20, 29, 39, 49, 58, 68, 78, 88, 30, 20, 10, 0, 10, 20,
+        30, 40, 50, 60, 70, 27, 18, 11, 11, 18, 27, 36, 46, 56, 66, 26,
+    },
+    {
+        61, 52, 43, 34, 27, 21, 20, 24, 30, 38, 47, 56, 66, 44, 34, 25,
+        16, 10, 13, 20, 29, 39, 49, 58, 68, 78, 40, 30, 20, 10, 0, 10,
+        20, 30, 40, 50, 60, 36, 27, 18, 11, 11, 18, 27, 36, 46, 56, 21,
+    },
+    {
+        70, 61, 52, 43, 34, 27, 21, 20, 24, 30, 38, 47, 56, 53, 44, 34,
+        25, 16, 10, 13, 20, 29, 39, 49, 58, 68, 50, 40, 30, 20, 10, 0,
+        10, 20, 30, 40, 50, 46, 36, 27, 18, 11, 11, 18, 27, 36, 46, 20,
+    },
+    {
+        80, 70, 61, 52, 43, 34, 27, 21, 20, 24, 30, 38, 47, 63, 53, 44,
+        34, 25, 16, 10, 13, 20, 29, 39, 49, 58, 60, 50, 40, 30, 20, 10,
+        0, 10, 20, 30, 40, 56, 46, 36, 27, 18, 11, 11, 18, 27, 36, 24,
+    },
+    {
+        90, 80, 70, 61, 52, 43, 34, 27, 21, 20, 24, 30, 38, 73, 63, 53,
+        44, 34, 25, 16, 10, 13, 20, 29, 39, 49, 70, 60, 50, 40, 30, 20,
+        10, 0, 10, 20, 30, 66, 56, 46, 36, 27, 18, 11, 11, 18, 27, 31,
+    },
+    {
+        100, 90, 80, 70, 61, 52, 43, 34, 27, 21, 20, 24, 30, 83, 73, 63,
+        53, 44, 34, 25, 16, 10, 13, 20, 29, 39, 80, 70, 60, 50, 40, 30,
+        20, 10, 0, 10, 20, 76, 66, 56, 46, 36, 27, 18, 11, 11, 18, 39,
+    },
+    {
+        109, 100, 90, 80, 70, 61, 52, 43, 34, 27, 21, 20, 24, 93, 83, 73,
+        63, 53, 44, 34, 25, 16, 10, 13, 20, 29, 90, 80, 70, 60, 50, 40,
+        30, 20, 10, 0, 10, 86, 76, 66, 56, 46, 36, 27, 18, 11, 11, 48,
+    },
+    {
+        119, 109, 100, 90, 80, 70, 61, 52, 43, 34, 27, 21, 20, 103, 93, 83,
+        73, 63, 53, 44, 34, 25, 16, 10, 13, 20, 100, 90, 80, 70, 60, 50,
+        40, 30, 20, 10, 0, 96, 86, 76, 66, 56, 46, 36, 27, 18, 11, 57,
+    },
+    {
+        38, 33, 30, 31, 35, 41, 48, 56, 65, 74, 83, 93, 102, 21, 20, 24,
+        30, 38, 47, 56, 66, 75, 85, 95, 104, 114, 11, 11, 18, 27, 36, 46,
+        56, 66, 76, 86, 96, 0, 10, 20, 30, 40, 50, 60, 70, 80, 90, 42,
+    },
+    {
+        44, 38, 33, 30, 31, 35, 41, 48, 56, 65, 74, 83, 93, 27, 21, 20,
+        24, 30, 38, 47, 56, 66, 75, 85, 95, 104, 18, 11, 11, 18, 27, 36,
+        46, 56, 66, 76, 86, 10, 0, 10, 20, 30, 40, 50, 60, 70, 80, 33,
+    },
+    {
+        52, 44, 38, 33, 30, 31, 35, 41, 48, 56, 65, 74, 83, 34, 27, 21,
+        20, 24, 30, 38, 47, 56, 66, 75, 85, 95, 27, 18, 11, 11, 18, 27,
+        36, 46, 56, 66, 76, 20, 10, 0, 10, 20, 30, 40, 50, 60, 70, 23,
+    },
+    {
+        60, 52, 44, 38, 33, 30, 31, 35, 41, 48, 56, 65, 74, 43, 34, 27,
+        21, 20, 24, 30, 38, 47, 56, 66, 75, 85, 36, 27, 18, 11, 11, 18,
+        27, 36, 46, 56, 66, 30, 20, 10, 0, 10, 20, 30, 40, 50, 60, 15,
+    },
+    {
+        69, 60, 52, 44, 38, 33, 30, 31, 35, 41, 48, 56, 65, 52, 43, 34,
+        27, 21, 20, 24, 30, 38, 47, 56, 66, 75, 46, 36, 27, 18, 11, 11,
+        18, 27, 36, 46, 56, 40, 30, 20, 10, 0, 10, 20, 30, 40, 50, 10,
+    },
+    {
+        78, 69, 60, 52, 44, 38, 33, 30, 31, 35, 41, 48, 56, 61, 52, 43,
+        34, 27, 21, 20, 24, 30, 38, 47, 56, 66, 56, 46, 36, 27, 18, 11,
+        11, 18, 27, 36, 46, 50, 40, 30, 20, 10, 0, 10, 20, 30, 40, 13,
+    },
+    {
+        88, 78, 69, 60, 52, 44, 38, 33, 30, 31, 35, 41, 48, 70, 61, 52,
+        43, 34, 27, 21, 20, 24, 30, 38, 47, 56, 66, 56, 46, 36, 27, 18,
+        11, 11, 18, 27, 36, 60, 50, 40, 30, 20, 10, 0, 10, 20, 30, 21,
+    },
+    {
+        97, 88, 78, 69, 60, 52, 44, 38, 33, 30, 31, 35, 41, 80, 70, 61,
+        52, 43, 34, 27, 21, 20, 24, 30, 38, 47, 76, 66, 56, 46, 36, 27,
+        18, 11, 11, 18, 27, 70, 60, 50, 40, 30, 20, 10, 0, 10, 20, 30,
+    },
+    {
+        107, 97, 88, 78, 69, 60, 52, 44, 38, 33, 30, 31, 35, 90, 80, 70,
+        61, 52, 43, 34, 27, 21, 20, 24, 30, 38, 86, 76, 66, 56, 46, 36,
+        27, 18, 11, 11, 18, 80, 70, 60, 50, 40, 30, 20, 10, 0, 10, 40,
+    },
+    {
+        116, 107, 97, 88, 78, 69, 60, 52, 44, 38, 33, 30, 31, 100, 90, 80,
+        70, 61, 52, 43, 34, 27, 21, 20, 24, 30, 96, 86, 76, 66, 56, 46,
+        36, 27, 18, 11, 11, 90, 80, 70, 60, 50, 40, 30, 20, 10, 0, 50,
+    },
+    {
+        75, 67, 59, 52, 47, 42, 40, 40, 43, 48, 54, 61, 69, 57, 49, 42,
+        35, 31, 30, 32, 37, 43, 51, 59, 68, 77, 50, 41, 33, 26, 21, 20,
+        24, 31, 39, 48, 57, 42, 33, 23, 15, 10, 13, 21, 30, 40, 50, 0,
+    },
+};
+
+const KeyboardLayout kKeyboardLayouts[KEYBOARD_LAYOUT_COUNT] = {
+    {
+        "qwerty",
+        {
+            { 0x60, 0x7E }, { 0x31, 0x21 }, { 0x32, 0x40 }, { 0x33, 0x23 }, { 0x34, 0x24 }, { 0x35, 0x25 }, { 0x36, 0x5E }, { 0x37, 0x26 },
+            { 0x38, 0x2A }, { 0x39, 0x28 }, { 0x30, 0x29 }, { 0x2D, 0x5F }, { 0x3D, 0x2B }, { 0x71, 0x51 }, { 0x77, 0x57 }, { 0x65, 0x45 },
+            { 0x72, 0x52 }, { 0x74, 0x54 }, { 0x79, 0x59 }, { 0x75, 0x55 }, { 0x69, 0x49 }, { 0x6F, 0x4F }, { 0x70, 0x50 }, { 0x5B, 0x7B },
+            { 0x5D, 0x7D }, { 0x5C, 0x7C }, { 0x61, 0x41 }, { 0x73, 0x53 }, { 0x64, 0x44 }, { 0x66, 0x46 }, { 0x67, 0x47 }, { 0x68, 0x48 },
+            { 0x6A, 0x4A }, { 0x6B, 0x4B }, { 0x6C, 0x4C }, { 0x3B, 0x3A }, { 0x27, 0x22 }, { 0x7A, 0x5A }, { 0x78, 0x58 }, { 0x63, 0x43 },
+            { 0x76, 0x56 }, { 0x62, 0x42 }, { 0x6E, 0x4E }, { 0x6D, 0x4D }, { 0x2C, 0x3C }, { 0x2E, 0x3E }, { 0x2F, 0x3F }, { 0x20, 0x20 },
+        },
+        {
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            47, 129, 164, 131, 132, 133, 135, 36, 137, 138, 136, 140, 44, 11, 45, 46,
+            10, 1, 2, 3, 4, 5, 6, 7, 8, 9, 163, 35, 172, 12, 173, 174,
+            130, 154, 169, 167, 156, 143, 157, 158, 159, 148, 160, 161, 162, 171, 170, 149,
+            150, 141, 144, 155, 145, 147, 168, 142, 166, 146, 165, 23, 25, 24, 134, 139,
+            0, 26, 41, 39, 28, 15, 29, 30, 31, 20, 32, 33, 34, 43, 42, 21,
+            22, 13, 16, 27, 17, 19, 40, 14, 38, 18, 37, 151, 153, 152, 128, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+        },
+        0x00000FE7FC7FE000ULL,
+        6.0075,
+    },
+    {
+        "azerty",
+        {
+            { 0xB2, 0x00 }, { 0x26, 0x31 }, { 0xE9, 0x32 }, { 0x22, 0x33 }, { 0x27, 0x34 }, { 0x28, 0x35 }, { 0x2D, 0x36 }, { 0xE8, 0x37 },
+            { 0x5F, 0x38 }, { 0xE7, 0x39 }, { 0xE0, 0x30 }, { 0x29, 0xB0 }, { 0x3D, 0x2B }, { 0x61, 0x41 }, { 0x7A, 0x5A }, { 0x65, 0x45 },
+            { 0x72, 0x52 }, { 0x74, 0x54 }, { 0x79, 0x59 }, { 0x75, 0x55 }, { 0x69, 0x49 }, { 0x6F, 0x4F }, { 0x70, 0x50 }, { 0x5E, 0xA8 },
+            { 0x24, 0xA3 }, { 0x2A, 0xB5 }, { 0x71, 0x51 }, { 0x73, 0x53 }, { 0x64, 0x44 }, { 0x66, 0x46 }, { 0x67, 0x47 }, { 0x68, 0x48 },
+            { 0x6A, 0x4A }, { 0x6B, 0x4B }, { 0x6C, 0x4C }, { 0x6D, 0x4D }, { 0xF9, 0x25 }, { 0x77, 0x57 }, { 0x78, 0x58 }, { 0x63, 0x43 },
+            { 0x76, 0x56 }, { 0x62, 0x42 }, { 0x6E, 0x4E }, { 0x2C, 0x3F }, { 0x3B, 0x2E }, { 0x3A, 0x2F }, { 0x21, 0xA7 }, { 0x20, 0x20 },
+        },
+        {
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            47, 46, 3, 255, 24, 164, 1, 4, 5, 11, 25, 140, 43, 6, 172, 173,
+            138, 129, 130, 131, 132, 133, 134, 135, 136, 137, 45, 44, 255, 12, 255, 171,
+            255, 141, 169, 167, 156, 143, 157, 158, 159, 148, 160, 161, 162, 163, 170, 149,
+            150, 154, 144, 155, 145, 147, 168, 165, 166, 146, 142, 255, 255, 255, 23, 8,
+            255, 13, 41, 39, 28, 15, 29, 30, 31, 20, 32, 33, 34, 35, 42, 21,
+            22, 26, 16, 27, 17, 19, 40, 37, 38, 18, 14, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 152, 255, 255, 255, 174, 151, 255, 255, 255, 255, 255, 255, 255,
+            139, 255, 0, 255, 255, 153, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            10, 255, 255, 255, 255, 255, 255, 9, 7, 2, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 36, 255, 255, 255, 255, 255, 255,
+        },
+        0x000007EFFC7FE000ULL,
+        6.2849,
+    },
+    {
+        "qwertz",
+        {
+            { 0x5E, 0xB0 }, { 0x31, 0x21 }, { 0x32, 0x22 }, { 0x33, 0xA7 }, { 0x34, 0x24 }, { 0x35, 0x25 }, { 0x36, 0x26 }, { 0x37, 0x2F },
+            { 0x38, 0x28 }, { 0x39, 0x29 }, { 0x30, 0x3D }, { 0xDF, 0x3F }, { 0xB4, 0x60 }, { 0x71, 0x51 }, { 0x77, 0x57 }, { 0x65, 0x45 },
+            { 0x72, 0x52 }, { 0x74, 0x54 }, { 0x7A, 0x5A }, { 0x75, 0x55 }, { 0x69, 0x49 }, { 0x6F, 0x4F }, { 0x70, 0x50 }, { 0xFC, 0xDC },
+            { 0x2B, 0x2A }, { 0x23, 0x27 }, { 0x61, 0x41 }, { 0x73, 0x53 }, { 0x64, 0x44 }, { 0x66, 0x46 }, { 0x67, 0x47 }, { 0x68, 0x48 },
+            { 0x6A, 0x4A }, { 0x6B, 0x4B }, { 0x6C, 0x4C }, { 0xF6, 0xD6 }, { 0xE4, 0xC4 }, { 0x79, 0x59 }, { 0x78, 0x58 }, { 0x63, 0x43 },
+            { 0x76, 0x56 }, { 0x62, 0x42 }, { 0x6E, 0x4E }, { 0x6D, 0x4D }, { 0x2C, 0x3B }, { 0x2E, 0x3A }, { 0x2D, 0x5F }, { 0x20, 0x20 },
+        },
+        {
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            47, 129, 130, 25, 132, 133, 134, 153, 136, 137, 152, 24, 44, 46, 45, 135,
+            10, 1, 2, 3, 4, 5, 6, 7, 8, 9, 173, 172, 255, 138, 255, 139,
+            255, 154, 169, 167, 156, 143, 157, 158, 159, 148, 160, 161, 162, 171, 170, 149,
+            150, 141, 144, 155, 145, 147, 168, 142, 166, 165, 146, 255, 255, 255, 0, 174,
+            140, 26, 41, 39, 28, 15, 29, 30, 31, 20, 32, 33, 34, 43, 42, 21,
+            22, 13, 16, 27, 17, 19, 40, 14, 38, 37, 18, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 131, 255, 255, 255, 255, 255, 255, 255, 255,
+            128, 255, 255, 255, 12, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 164, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 163, 255, 255, 255, 255, 255, 151, 255, 255, 11,
+            255, 255, 255, 255, 36, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 35, 255, 255, 255, 255, 255, 23, 255, 255, 255,
+        },
+        0x00000FFFFCFFE000ULL,
+        5.7631,
+    },
+    {
+        "dvorak",
+        {
+            { 0x60, 0x7E }, { 0x31, 0x21 }, { 0x32, 0x40 }, { 0x33, 0x23 }, { 0x34, 0x24 }, { 0x35, 0x25 }, { 0x36, 0x5E }, { 0x37, 0x26 },
+            { 0x38, 0x2A }, { 0x39, 0x28 }, { 0x30, 0x29 }, { 0x5B, 0x7B }, { 0x5D, 0x7D }, { 0x27, 0x22 }, { 0x2C, 0x3C }, { 0x2E, 0x3E },
+            { 0x70, 0x50 }, { 0x79, 0x59 }, { 0x66, 0x46 }, { 0x67, 0x47 }, { 0x63, 0x43 }, { 0x72, 0x52 }, { 0x6C, 0x4C }, { 0x2F, 0x3F },
+            { 0x3D, 0x2B }, { 0x5C, 0x7C }, { 0x61, 0x41 }, { 0x6F, 0x4F }, { 0x65, 0x45 }, { 0x75, 0x55 }, { 0x69, 0x49 }, { 0x64, 0x44 },
+            { 0x68, 0x48 }, { 0x74, 0x54 }, { 0x6E, 0x4E }, { 0x73, 0x53 }, { 0x2D, 0x5F }, { 0x3B, 0x3A }, { 0x71, 0x51 }, { 0x6A, 0x4A },
+            { 0x6B, 0x4B }, { 0x78, 0x58 }, { 0x62, 0x42 }, { 0x6D, 0x4D }, { 0x77, 0x57 }, { 0x76, 0x56 }, { 0x7A, 0x5A }, { 0x20, 0x20 },
+        },
+        {
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            47, 129, 141, 131, 132, 133, 135, 13, 137, 138, 136, 152, 14, 36, 15, 23,
+            10, 1, 2, 3, 4, 5, 6, 7, 8, 9, 165, 37, 142, 24, 143, 151,
+            130, 154, 170, 148, 159, 156, 146, 147, 160, 158, 167, 168, 150, 171, 162, 155,
+            144, 166, 149, 163, 161, 157, 173, 172, 169, 145, 174, 11, 25, 12, 134, 164,
+            0, 26, 42, 20, 31, 28, 18, 19, 32, 30, 39, 40, 22, 43, 34, 27,
+            16, 38, 21, 35, 33, 29, 45, 44, 41, 17, 46, 139, 153, 140, 128, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+        },
+        0x00007FCFFC7F0000ULL,
+        3.5091,
+    },
+    {
+        "colemak",
+        {
+            { 0x60, 0x7E }, { 0x31, 0x21 }, { 0x32, 0x40 }, { 0x33, 0x23 }, { 0x34, 0x24 }, { 0x35, 0x25 }, { 0x36, 0x5E }, { 0x37, 0x26 },
+            { 0x38, 0x2A }, { 0x39, 0x28 }, { 0x30, 0x29 }, { 0x2D, 0x5F }, { 0x3D, 0x2B }, { 0x71, 0x51 }, { 0x77, 0x57 }, { 0x66, 0x46 },
+            { 0x70, 0x50 }, { 0x67, 0x47 }, { 0x6A, 0x4A }, { 0x6C, 0x4C }, { 0x75, 0x55 }, { 0x79, 0x59 }, { 0x3B, 0x3A }, { 0x5B, 0x7B },
+            { 0x5D, 0x7D }, { 0x5C, 0x7C }, { 0x61, 0x41 }, { 0x72, 0x52 }, { 0x73, 0x53 }, { 0x74, 0x54 }, { 0x64, 0x44 }, { 0x68, 0x48 },
+            { 0x6E, 0x4E }, { 0x65, 0x45 }, { 0x69, 0x49 }, { 0x6F, 0x4F }, { 0x27, 0x22 }, { 0x7A, 0x5A }, { 0x78, 0x58 }, { 0x63, 0x43 },
+            { 0x76, 0x56 }, { 0x62, 0x42 }, { 0x6B, 0x4B }, { 0x6D, 0x4D }, { 0x2C, 0x3C }, { 0x2E, 0x3E }, { 0x2F, 0x3F }, { 0x20, 0x20 },
+        },
+        {
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            47, 129, 164, 131, 132, 133, 135, 36, 137, 138, 136, 140, 44, 11, 45, 46,
+            10, 1, 2, 3, 4, 5, 6, 7, 8, 9, 150, 22, 172, 12, 173, 174,
+            130, 154, 169, 167, 158, 161, 143, 145, 159, 162, 146, 170, 147, 171, 160, 163,
+            144, 141, 155, 156, 157, 148, 168, 142, 166, 149, 165, 23, 25, 24, 134, 139,
+            0, 26, 41, 39, 30, 33, 15, 17, 31, 34, 18, 42, 19, 43, 32, 35,
+            16, 13, 27, 28, 29, 20, 40, 14, 38, 21, 37, 151, 153, 152, 128, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+        },
+        0x00000FEFFC3FE000ULL,
+        5.7174,
+    },
+};
@@ -0,0 +1,189 @@
+#include "humanizer.h"
+#include "latency.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Bucket holding value: exact below 2^LATENCY_SUB_BITS, then the top
+// LATENCY_SUB_BITS bits of the value for each power of two
+static inline size_t LatencyBucket(uint64_t value) {
+    if (value < (1u << LATENCY_SUB_BITS)) {
+        return (size_t)value;
+    }
+    unsigned msb = 63;
+    while (!(value >> msb)) {
+        msb--;
+    }
+    unsigned shift = msb - LATENCY_SUB_BITS + 1;
+    return (size_t)shift * LATENCY_HALF_BUCKETS + (size_t)(value >> shift);
+}
+
+// Smallest value that lands in bucket
+static uint64_t LatencyBucketFloor(size_t bucket) {
+    if (bucket < (1u << LATENCY_SUB_BITS)) {
+        return bucket;
+    }
+    unsigned shift = (unsigned)(bucket / LATENCY_HALF_BUCKETS) - 1;
+    return (uint64_t)(bucket - (size_t)shift * LATENCY_HALF_BUCKETS) << shift;
+}
+
+static void ResetLatencyHistogram(LatencyHistogram* histogram) {
+    memset(histogram, 0, sizeof(*histogram));
+    histogram->min = UINT64_MAX;
+}
+
+// Allocate a tracer keeping the last capacity samples (rounded up to a power of two)
+LatencyTracer* CreateLatencyTracer(size_t capacity, const char* export_path) {
+    size_t rounded = 1;
+    while (rounded < capacity) {
+        rounded <<= 1;
+    }
+
+    LatencyTracer* tracer = (LatencyTracer*)malloc(sizeof(LatencyTracer));
+    LatencySample* ring = (LatencySample*)malloc(rounded * sizeof(LatencySample));
+    if (!tracer || !ring) {
+        printf(ANSI_COLOR_RED "Error: Memory allocation failed\n" ANSI_COLOR_RESET);
+        free(tracer);
+        free(ring);
+        return NULL;
+    }
+    // Touch the ring now so the first keystrokes do not take page faults
+    memset(ring, 0, rounded * sizeof(LatencySample));
+
+    tracer->ring = ring;
+    tracer->capacity = rounded;
+    tracer->export_path = export_path;
+    ResetLatencyTracer(tracer);
+    return tracer;
+}
+
+void DestroyLatencyTracer(LatencyTracer* tracer) {
+    if (tracer) {
+        free(tracer->ring);
+        free(tracer);
+    }
+}
+
+// Forget everything recorded so far (called at the start of each session)
+void ResetLatencyTracer(LatencyTracer* tracer) {
+    tracer->recorded = 0;
+    ResetLatencyHistogram(&tracer->lateness);
+    ResetLatencyHistogram(&tracer->emit_time);
+}
+
+// Add one value to the histogram
+void RecordLatency(LatencyHistogram* histogram, uint64_t value) {
+    histogram->counts[LatencyBucket(value)]++;
+    histogram->count++;
+    histogram->total += value;
+    if (value < histogram->min) {
+        histogram->min = value;
+    }
+    if (value > histogram->max) {
+        histogram->max = value;
+    }
+}
+
+// Value at percentile (0-100): the midpoint of the bucket it falls in, kept
+// within the recorded range
+uint64_t LatencyPercentile(const LatencyHistogram* histogram, double percentile) {
+    if (histogram->count == 0) {
+        return 0;
+    }
+
+    uint64_t rank = (uint64_t)(percentile / 100.0 * (double)histogram->count + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < LATENCY_BUCKETS; i++) {
+        seen += histogram->counts[i];
+        if (seen >= rank) {
+            uint64_t low = LatencyBucketFloor(i);
+            uint64_t high = i + 1 < LATENCY_BUCKETS ? LatencyBucketFloor(i + 1) : histogram->max + 1;
+            uint64_t value = low + (high - low - 1) / 2;
+            if (value < histogram->min) {
+                value = histogram->min;
+            }
+            return value > histogram->max ? histogram->max : value;
+        }
+    }
+    return histogram->max;
+}
+
+// One summary line: microseconds at the usual percentiles
+void PrintLatencyLine(FILE* out, const char* label, const LatencyHistogram* histogram) {
+    static const double percentiles[] = { 50.0, 90.0, 99.0, 99.9 };
+
+    fprintf(out, "  %-10s mean %8.1f", label, (double)histogram->total / (double)histogram->count / 1e3);
+    for (size_t i = 0; i < sizeof(percentiles) / sizeof(percentiles[0]); i++) {
+        fprintf(out, "  p%-4g %8.1f", percentiles[i], (double)LatencyPercentile(histogram, percentiles[i]) / 1e3);
+    }
+    fprintf(out, "  max %8.1f\n", (double)histogram->max / 1e3);
+}
+
+// Print how late keystrokes went out and how long the sink took, in microseconds
+void PrintLatencySummary(const LatencyTracer* tracer, FILE* out) {
+    if (tracer->lateness.count == 0) {
+        fprintf(out, "No keystroke latency recorded\n");
+        return;
+    }
+
+    fprintf(out, "\nKeystroke latency over %llu keystrokes (microseconds):\n",
+            (unsigned long long)tracer->lateness.count);
+    PrintLatencyLine(out, "late by", &tracer->lateness);
+    PrintLatencyLine(out, "emit", &tracer->emit_time);
+
+    uint64_t late_1ms = 0;
+    for (size_t i = LatencyBucket(1000000); i < LATENCY_BUCKETS; i++) {
+        late_1ms += tracer->lateness.counts[i];
+    }
+    fprintf(out, "  %llu keystrokes (%.2f%%) went out 1 ms or more after their deadline\n",
+            (unsigned long long)late_1ms, 100.0 * (double)late_1ms / (double)tracer->lateness.count);
+}
+
+// Write the samples still in the ring as Chrome trace events: one complete
+// event per Emit call plus a lateness counter track
+bool ExportLatencyTrace(const LatencyTracer* tracer, const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        printf(ANSI_COLOR_RED "Error: Could not open %s for writing\n" ANSI_COLOR_RESET, path);
+        return false;
+    }
+
+    uint64_t kept = tracer->recorded < tracer->capacity ? tracer->recorded : tracer->capacity;
+    uint64_t first = tracer->recorded - kept;
+
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"emit\"}}");
+    for (uint64_t n = first; n < tracer->recorded; n++) {
+        const LatencySample* sample = &tracer->ring[n & (tracer->capacity - 1)];
+        uint64_t late_ns = sample->woke_ns > sample->scheduled_ns ? sample->woke_ns - sample->scheduled_ns : 0;
+
+        fprintf(file, ",\n{\"name\":\"key\",\"cat\":\"keystroke\",\"ph\":\"X\",\"pid\":1,\"tid\":1,"
+                      "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"code\":%u,\"flags\":%u,\"events\":%u,\"scheduled_us\":%.3f}}",
+                (double)sample->woke_ns / 1e3, (double)(sample->done_ns - sample->woke_ns) / 1e3,
+                (unsigned)sample->code, (unsigned)sample->flags, (unsigned)sample->events,
+                (double)sample->scheduled_ns / 1e3);
+        fprintf(file, ",\n{\"name\":\"lateness\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{\"late_us\":%.3f}}",
+                (double)sample->woke_ns / 1e3, (double)late_ns / 1e3);
+    }
+    fprintf(file, "\n]}\n");
+
+    bool ok = !ferror(file);
+    ok = fclose(file) == 0 && ok;
+    if (!ok) {
+        printf(ANSI_COLOR_RED "Error: Failed to write %s\n" ANSI_COLOR_RESET, path);
+        return false;
+    }
+    printf("Wrote %llu keystroke timings to %s\n", (unsigned long long)kept, path);
+    return true;
+}
+
+// End-of-session output: summary, then the export if one was asked for
+void ReportLatencyTrace(const LatencyTracer* tracer) {
+    PrintLatencySummary(tracer, stdout);
+    if (tracer->export_path) {
+        ExportLatencyTrace(tracer, tracer->export_path);
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef HUMANIZER_CORE_LATENCY_H
+#define HUMANIZER_CORE_LATENCY_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Log-linear histogram in the style of HdrHistogram: values below 2^LATENCY_SUB_BITS
+// are exact, larger ones land in one of 2^(LATENCY_SUB_BITS-1) buckets per power
+// of two, so every recorded value is kept to within 1/64 (about 1.6%)
+#define LATENCY_SUB_BITS 7
+#define LATENCY_HALF_BUCKETS (1 << (LATENCY_SUB_BITS - 1))
+#define LATENCY_BUCKETS ((64 - LATENCY_SUB_BITS + 2) * LATENCY_HALF_BUCKETS)
+
+// Samples kept for export when the caller does not choose (the newest win)
+#define LATENCY_DEFAULT_CAPACITY 65536
+
+typedef struct {
+    uint64_t counts[LATENCY_BUCKETS];
+    uint64_t count;        // Values recorded
+    uint64_t min;          // Smallest value
+    uint64_t max;          // Largest value
+    uint64_t total;        // Sum of all values
+} LatencyHistogram;
+
+// Timing of one emitted keystroke, relative to the start of the session
+typedef struct {
+    uint64_t scheduled_ns; // Planned emission time
+    uint64_t woke_ns;      // When the scheduler returned (just before Emit)
+    uint64_t done_ns;      // When the sink's Emit returned
+    uint32_t code;         // First event of the keystroke
+    uint16_t flags;
+    uint16_t events;       // Events in the keystroke
+} LatencySample;
+
+// Instrumentation attached to a simulator; everything is allocated up front
+// so recording never allocates or blocks
+typedef struct {
+    LatencySample* ring;   // Last capacity samples
+    size_t capacity;       // Power of two
+    uint64_t recorded;     // Samples recorded this session (ring index = recorded & (capacity - 1))
+    LatencyHistogram lateness;  // woke - scheduled
+    LatencyHistogram emit_time; // done - woke
+    const char* export_path;    // Chrome trace JSON written after each session, NULL for none
+} LatencyTracer;
+
+// Tracer lifecycle
+LatencyTracer* CreateLatencyTracer(size_t capacity, const char* export_path);
+void DestroyLatencyTracer(LatencyTracer* tracer);
+void ResetLatencyTracer(LatencyTracer* tracer);
+
+// Histogram operations
+void RecordLatency(LatencyHistogram* histogram, uint64_t value);
+uint64_t LatencyPercentile(const LatencyHistogram* histogram, double percentile);
+
+// One line of mean, p50/p90/p99/p99.9 and max in microseconds
+void PrintLatencyLine(FILE* out, const char* label, const LatencyHistogram* histogram);
+
+// Record one keystroke
+static inline void RecordLatencySample(LatencyTracer* tracer, const LatencySample* sample) {
+    tracer->ring[tracer->recorded++ & (tracer->capacity - 1)] = *sample;
+    RecordLatency(&tracer->lateness, sample->woke_ns > sample->scheduled_ns ? sample->woke_ns - sample->scheduled_ns : 0);
+    RecordLatency(&tracer->emit_time, sample->done_ns - sample->woke_ns);
+}
+
+// Session output: percentile summary and Chrome trace (chrome://tracing, Perfetto)
+void PrintLatencySummary(const LatencyTracer* tracer, FILE* out);
+bool ExportLatencyTrace(const LatencyTracer* tracer, const char* path);
+
+// Print the summary to stdout and export to export_path if set
+void ReportLatencyTrace(const LatencyTracer* tracer);
+
+#endif // HUMANIZER_CORE_LATENCY_H
@@ -0,0 +1,33 @@
+#include "layout.h"
+
+#include <string.h>
+
+// Start an empty layout
+void InitializeLayout(KeyLayout* layout, bool unicode_fallback) {
+    memset(layout->entries, 0, sizeof(layout->entries));
+    layout->unicode_fallback = unicode_fallback;
+}
+
+// Register the key that produces codepoint; the first (simplest) registration wins
+void SetLayoutKey(KeyLayout* layout, uint32_t codepoint, uint16_t code, uint16_t mods) {
+    if (codepoint >= LAYOUT_TABLE_SIZE || layout->entries[codepoint].kind != LAYOUT_UNMAPPED) {
+        return;
+    }
+    layout->entries[codepoint].code = code;
+    layout->entries[codepoint].mods = (uint8_t)mods;
+    layout->entries[codepoint].kind = LAYOUT_KEY;
+}
+
+// Point every codepoint without a key (other than control characters besides
+// tab, newline and backspace) at Unicode injection when the sink supports it
+void FinishLayout(KeyLayout* layout) {
+    if (!layout->unicode_fallback) {
+        return;
+    }
+    for (uint32_t cp = '\b'; cp < LAYOUT_TABLE_SIZE; cp++) {
+        bool control = (cp < 0x20 && cp != '\b' && cp != '\t' && cp != '\n') || (cp >= 0x7F && cp <= 0x9F);
+        if (layout->entries[cp].kind == LAYOUT_UNMAPPED && !control) {
+            layout->entries[cp].kind = LAYOUT_UNICODE;
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef HUMANIZER_CORE_LAYOUT_H
+#define HUMANIZER_CORE_LAYOUT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sink.h"
+
+// Codepoints below this are looked up in the table (Latin, Greek, Cyrillic,
+// Hebrew, Arabic, general punctuation and currency signs); anything above
+// goes straight to Unicode injection
+#define LAYOUT_TABLE_SIZE 0x2400
+
+// How a codepoint is produced
+#define LAYOUT_UNMAPPED 0 // Sink cannot type it
+#define LAYOUT_KEY      1 // Keycode plus modifiers on the active layout
+#define LAYOUT_UNICODE  2 // Injected as a Unicode character
+
+// One table slot, packed so the whole table stays cache resident
+typedef struct {
+    uint16_t code;         // Platform keycode for LAYOUT_KEY
+    uint8_t mods;          // KEY_MOD_* for LAYOUT_KEY
+    uint8_t kind;          // LAYOUT_* kind
+} LayoutEntry;
+
+// Character-to-key mapping for one sink, built once when the sink is opened
+typedef struct KeyLayout {
+    LayoutEntry entries[LAYOUT_TABLE_SIZE];
+    bool unicode_fallback; // Sink can inject codepoints the layout cannot produce
+} KeyLayout;
+
+// Building a layout: start empty, register keys, then seal
+void InitializeLayout(KeyLayout* layout, bool unicode_fallback);
+void SetLayoutKey(KeyLayout* layout, uint32_t codepoint, uint16_t code, uint16_t mods);
+void FinishLayout(KeyLayout* layout);
+
+// Map a codepoint to a key press; false if the sink cannot produce it
+static inline bool LookupLayout(const KeyLayout* layout, uint32_t codepoint, KeyEvent* out) {
+    uint8_t kind = codepoint < LAYOUT_TABLE_SIZE ? layout->entries[codepoint].kind
+                 : (layout->unicode_fallback ? LAYOUT_UNICODE : LAYOUT_UNMAPPED);
+
+    if (kind == LAYOUT_KEY) {
+        out->code = layout->entries[codepoint].code;
+        out->mods = layout->entries[codepoint].mods;
+        out->flags = 0;
+        return true;
+    }
+    out->code = codepoint;
+    out->mods = 0;
+    out->flags = KEY_EVENT_UNICODE;
+    return kind == LAYOUT_UNICODE;
+}
+
+#endif // HUMANIZER_CORE_LAYOUT_H
@@ -0,0 +1,162 @@
+#include "humanizer.h"
+#include "scheduler.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+// Outcome of every stream, updated from the scheduler threads
+typedef struct {
+    atomic_size_t succeeded;
+    atomic_size_t failed;
+    atomic_size_t keystrokes;
+    atomic_size_t chars_typed;
+} LoadTestTally;
+
+static void CountFinishedStream(TypingSimulator* simulator, const TypingReport* report, void* context) {
+    (void)simulator;
+    LoadTestTally* tally = (LoadTestTally*)context;
+    atomic_fetch_add_explicit(report->error ? &tally->failed : &tally->succeeded, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&tally->keystrokes, report->keystrokes, memory_order_relaxed);
+    atomic_fetch_add_explicit(&tally->chars_typed, report->chars_typed, memory_order_relaxed);
+}
+
+// User plus system CPU time used by the process so far
+static double ProcessCpuSeconds(void) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0.0;
+    }
+    return (double)usage.ru_utime.tv_sec + (double)usage.ru_utime.tv_usec / 1e6 +
+           (double)usage.ru_stime.tv_sec + (double)usage.ru_stime.tv_usec / 1e6;
+}
+
+// Read the whole input once; every stream then serves it from memory
+static bool LoadLoadTestText(const char* path, TextBuffer* text) {
+    TextSource* source = OpenFileTextSource(path);
+    if (!source) {
+        return false;
+    }
+    const char* chunk;
+    size_t length;
+    bool ok = true;
+    while (ok && source->Next(source, &chunk, &length)) {
+        ok = ReserveTextBuffer(text, length);
+        if (ok) {
+            memcpy(text->data + text->length, chunk, length);
+            text->length += length;
+            text->data[text->length] = '\0';
+        }
+    }
+    ok = ok && !source->failed && text->length > 0;
+    CloseTextSource(source);
+    if (!ok) {
+        printf(ANSI_COLOR_RED "Error: Could not load %s\n" ANSI_COLOR_RESET, path);
+    }
+    return ok;
+}
+
+// Type the same text on many streams at once and report lateness and CPU use
+int RunLoadTest(const LoadTestOptions* options) {
+    if (options->streams == 0) {
+        printf(ANSI_COLOR_RED "Error: A load test needs at least one stream\n" ANSI_COLOR_RESET);
+        return 1;
+    }
+
+    TextBuffer text;
+    InitializeTextBuffer(&text);
+    if (!LoadLoadTestText(options->path, &text)) {
+        FreeTextBuffer(&text);
+        return 1;
+    }
+
+    size_t streams = options->streams;
+    TypingSimulator* simulators = (TypingSimulator*)calloc(streams, sizeof(TypingSimulator));
+    TextSource** sources = (TextSource**)calloc(streams, sizeof(TextSource*));
+    if (!simulators || !sources) {
+        printf(ANSI_COLOR_RED "Error: Memory allocation failed\n" ANSI_COLOR_RESET);
+        free(simulators);
+        free(sources);
+        FreeTextBuffer(&text);
+        return 1;
+    }
+
+    // Open every sink before typing starts, so device creation does not skew the timing
+    size_t opened = 0;
+    for (; opened < streams; opened++) {
+        KeySink* sink;
+        if (options->null_sink) {
+            sink = OpenNullSink();
+        } else {
+            char name[80]; // UINPUT_MAX_NAME_SIZE
+            snprintf(name, sizeof(name), "%s-%zu", options->device_prefix, opened);
+            sink = OpenUinputSink(name, options->unicode_input);
+        }
+        sources[opened] = sink ? OpenMemoryTextSource(text.data, text.length) : NULL;
+        if (!sources[opened]) {
+            CloseSink(sink);
+            break;
+        }
+        InitializeSimulator(&simulators[opened], sink, options->wpm);
+        simulators[opened].humanized = !options->steady;
+        simulators[opened].directives = options->directives;
+        simulators[opened].seed = options->seed + opened;
+        simulators[opened].coalesce_ns = options->coalesce_ns;
+    }
+
+    TypingScheduler* scheduler = opened == streams ? CreateTypingScheduler(options->threads) : NULL;
+    LoadTestTally tally;
+    atomic_init(&tally.succeeded, 0);
+    atomic_init(&tally.failed, 0);
+    atomic_init(&tally.keystrokes, 0);
+    atomic_init(&tally.chars_typed, 0);
+
+    int status = 1;
+    if (scheduler) {
+        printf("Typing %zu bytes on %zu %s streams with %zu threads (seeds %llu-%llu)\n", text.length, streams,
+               options->null_sink ? "null" : "uinput", options->threads, (unsigned long long)options->seed,
+               (unsigned long long)(options->seed + streams - 1));
+        fflush(stdout);
+
+        double cpu_start = ProcessCpuSeconds();
+        uint64_t start_ns = MonotonicNowNs();
+        size_t scheduled = 0;
+        for (size_t i = 0; i < streams; i++) {
+            uint64_t delay_ns = (uint64_t)(options->spread_seconds * 1e9 * (double)i / (double)streams);
+            if (ScheduleTyping(scheduler, &simulators[i], sources[i], delay_ns, CountFinishedStream, &tally)) {
+                scheduled++;
+            }
+        }
+        WaitForTypingStreams(scheduler);
+        double wall = (double)(MonotonicNowNs() - start_ns) / 1e9;
+        double cpu = ProcessCpuSeconds() - cpu_start;
+
+        LatencyHistogram lateness;
+        GetSchedulerLateness(scheduler, &lateness);
+        DestroyTypingScheduler(scheduler);
+
+        size_t succeeded = atomic_load(&tally.succeeded);
+        size_t keystrokes = atomic_load(&tally.keystrokes);
+        printf("\nStreams: %zu finished, %zu failed, %zu not started\n", succeeded, atomic_load(&tally.failed),
+               streams - scheduled);
+        printf("Keystrokes: %zu (%zu characters) in %.1fs, %.0f per second\n", keystrokes,
+               atomic_load(&tally.chars_typed), wall, wall > 0 ? (double)keystrokes / wall : 0.0);
+        printf("CPU: %.2fs (%.1f%% of one core, %.2f us per keystroke)\n", cpu, wall > 0 ? 100.0 * cpu / wall : 0.0,
+               keystrokes ? cpu * 1e6 / (double)keystrokes : 0.0);
+        if (lateness.count) {
+            printf("Keystroke lateness (microseconds):\n");
+            PrintLatencyLine(stdout, "late by", &lateness);
+        }
+        status = succeeded == streams ? 0 : 1;
+    }
+
+    for (size_t i = 0; i < opened; i++) {
+        CloseTextSource(sources[i]);
+        CloseSink(simulators[i].sink);
+        CleanupSimulator(&simulators[i]);
+    }
+    free(simulators);
+    free(sources);
+    FreeTextBuffer(&text);
+    return status;
+}
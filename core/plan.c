@@ -0,0 +1,514 @@
+#include "humanizer.h"
+#include "plan.h"
+#include "layout.h"
+#include "digraph.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Initialize an empty plan
+void InitializePlan(KeyPlan* plan) {
+    plan->events = NULL;
+    plan->count = 0;
+    plan->capacity = 0;
+}
+
+// Release the plan's storage
+void CleanupPlan(KeyPlan* plan) {
+    free(plan->events);
+    InitializePlan(plan);
+}
+
+// Drop all events but keep the storage for reuse
+void ClearPlan(KeyPlan* plan) {
+    plan->count = 0;
+}
+
+// Make sure the plan can hold at least capacity events
+bool ReservePlan(KeyPlan* plan, size_t capacity) {
+    if (capacity <= plan->capacity) {
+        return true;
+    }
+
+    size_t new_capacity = plan->capacity ? plan->capacity : 256;
+    while (new_capacity < capacity) {
+        new_capacity *= 2;
+    }
+
+    KeyEvent* events = (KeyEvent*)realloc(plan->events, new_capacity * sizeof(KeyEvent));
+    if (!events) {
+        return false;
+    }
+    plan->events = events;
+    plan->capacity = new_capacity;
+    return true;
+}
+
+// Whether a target speed from the user is usable (NaN fails both tests)
+bool IsValidWpm(double wpm) {
+    return wpm > 0.0 && wpm <= MAX_WPM;
+}
+
+// Mean keystroke spacing for a speed, at least 1 ns so the pace never stops
+static uint64_t SpacingForWpm(double wpm) {
+    double ns = 60e9 / wpm / CHARS_PER_WORD;
+    return ns >= 1.0 ? (uint64_t)ns : 1;
+}
+
+// Prepare a planner that paces keystrokes at target_wpm on average, either
+// evenly or varied by the humanize model (reproducible for a given seed)
+void InitializePlanner(KeyPlanner* planner, KeySink* sink, double target_wpm,
+                       const HumanizeModel* humanize, uint64_t seed) {
+    planner->sink = sink;
+    planner->humanize = humanize;
+    SeedRandom(&planner->rng, seed);
+    planner->next_ns = 0;
+    planner->earliest_ns = 0;
+    planner->ns_per_char = SpacingForWpm(target_wpm);
+    planner->base_ns_per_char = planner->ns_per_char;
+    planner->typo_chance = humanize ? humanize->typo_chance : 0;
+    planner->directives = false;
+    planner->lex_state = PLAN_LEX_LINE_START;
+    planner->indent = 0;
+    planner->pending_length = 0;
+    planner->in_word = false;
+    planner->after_cr = false;
+    planner->previous = 0;
+    planner->last_key = 0;
+    InitializeUtf8Decoder(&planner->decoder);
+    planner->chars_planned = 0;
+    planner->unmapped_chars = 0;
+    planner->typos = 0;
+}
+
+// Time for the next keystroke planned at *at: never before the previous
+// keystroke's time + 1 ns, so keystrokes stay apart however fast the pace
+// (a keystroke is the events sharing one timestamp)
+static uint64_t KeystrokeTime(KeyPlanner* planner, uint64_t* at) {
+    if (*at < planner->earliest_ns) {
+        *at = planner->earliest_ns;
+    }
+    planner->earliest_ns = *at + 1;
+    return *at;
+}
+
+// Write the press/release pair for one keystroke and return the next free slot
+static KeyEvent* AppendKeystroke(KeyPlanner* planner, KeyEvent* out, const KeyEvent* key, uint64_t* at,
+                                 uint16_t flags) {
+    out[0] = *key;
+    out[0].time_ns = KeystrokeTime(planner, at);
+    out[0].flags |= flags;
+    out[1] = out[0];
+    out[1].flags = (uint16_t)((out[0].flags & ~KEY_EVENT_WORD_END) | KEY_EVENT_UP);
+    return out + 2;
+}
+
+// Whether an interval depends on the key after it too (a digraph profile or
+// travel timing), so KeyDelay adds it once that key is known
+static bool PairTimed(const HumanizeModel* humanize) {
+    return humanize && (humanize->digraphs || humanize->distance_weight > 0.0);
+}
+
+// Time until the keystroke after this one, or nothing when KeyDelay adds it
+static uint64_t NextInterval(KeyPlanner* planner) {
+    if (!planner->humanize) {
+        return planner->ns_per_char;
+    }
+    if (PairTimed(planner->humanize)) {
+        return 0;
+    }
+    return SampleKeystrokeInterval(planner->humanize, &planner->rng, planner->ns_per_char);
+}
+
+// Time from the last key planned to one typing codepoint: a draw from the
+// digraph profile's cell for the pair, an interval scaled by the hand's
+// travel between the two keys, or nothing when intervals ignore the pair
+static uint64_t KeyDelay(KeyPlanner* planner, uint32_t codepoint) {
+    const HumanizeModel* humanize = planner->humanize;
+    uint32_t last = planner->last_key;
+    planner->last_key = codepoint;
+    if (!PairTimed(humanize) || !last) {
+        return 0;
+    }
+    if (humanize->digraphs) {
+        return SampleDigraphDelay(humanize->digraphs, &planner->rng, DigraphSlot(humanize->keyboard, last),
+                                  DigraphSlot(humanize->keyboard, codepoint), planner->ns_per_char);
+    }
+    return SampleTravelInterval(humanize, &planner->rng, last, codepoint, planner->ns_per_char);
+}
+
+// Plan a slip onto a neighbouring key and its backspace before the intended
+// character; returns false (planning nothing) if the sink cannot type them
+static bool PlanTypo(KeyPlanner* planner, KeyEvent** out, uint32_t codepoint, uint64_t* at) {
+    const KeyLayout* layout = planner->sink->layout;
+    KeyEvent typo;
+    KeyEvent backspace;
+
+    uint32_t wrong = PickTypo(planner->humanize, &planner->rng, codepoint);
+    if (!wrong || !LookupLayout(layout, wrong, &typo) || !LookupLayout(layout, '\b', &backspace)) {
+        return false;
+    }
+
+    *at += KeyDelay(planner, wrong);
+    *out = AppendKeystroke(planner, *out, &typo, at, KEY_EVENT_CORRECTION);
+    *at += NextInterval(planner) + SampleCorrectionDelay(planner->humanize, &planner->rng);
+    *at += KeyDelay(planner, '\b');
+    *out = AppendKeystroke(planner, *out, &backspace, at, KEY_EVENT_CORRECTION | KEY_EVENT_ERASE);
+    *at += NextInterval(planner);
+    planner->typos++;
+    return true;
+}
+
+// Plan one character at the planner's pace, or at twice the pace when quick
+// (indentation); false if memory ran out
+static bool PlanCharacter(KeyPlanner* planner, KeyPlan* plan, uint32_t cp, bool quick) {
+    // The keystroke, plus a typo and its backspace
+    if (!ReservePlan(plan, plan->count + 6)) {
+        return false;
+    }
+
+    uint64_t at = planner->next_ns;
+    planner->chars_planned++;
+
+    uint16_t word_flag = 0;
+    bool space = IsWordSeparator(cp);
+    if (space) {
+        if (planner->in_word) {
+            word_flag = KEY_EVENT_WORD_END;
+            planner->in_word = false;
+        }
+    } else {
+        planner->in_word = true;
+    }
+
+    KeyEvent key;
+    if (!LookupLayout(planner->sink->layout, cp, &key)) {
+        planner->unmapped_chars++;
+        planner->next_ns += NextInterval(planner);
+        planner->previous = cp;
+        return true;
+    }
+
+    KeyEvent* out = plan->events + plan->count;
+    const HumanizeModel* humanize = planner->humanize;
+    if (humanize && !space && RandomChance(&planner->rng, planner->typo_chance)) {
+        PlanTypo(planner, &out, cp, &at);
+    }
+
+    uint64_t delay = KeyDelay(planner, cp);
+    at += quick ? delay / 2 : delay;
+    out = AppendKeystroke(planner, out, &key, &at, word_flag);
+    plan->count = (size_t)(out - plan->events);
+    planner->next_ns = at + (quick ? NextInterval(planner) / 2 : NextInterval(planner));
+
+    // Hesitate before the next word now and then, more often between sentences
+    if (humanize && word_flag) {
+        bool sentence = planner->previous == '.' || planner->previous == '!' || planner->previous == '?';
+        if (RandomChance(&planner->rng, sentence ? humanize->sentence_pause_chance : humanize->word_pause_chance)) {
+            planner->next_ns += SampleThinkingPause(humanize, &planner->rng);
+        }
+    }
+    planner->previous = cp;
+    return true;
+}
+
+// Keep a byte back until the lexer knows what it belongs to
+static void HoldByte(KeyPlanner* planner, uint32_t cp) {
+    planner->pending[planner->pending_length++] = (char)cp;
+}
+
+// Type the held bytes as ordinary text; leading indentation goes out quickly
+static bool FlushPending(KeyPlanner* planner, KeyPlan* plan) {
+    bool indentation = true;
+    for (size_t i = 0; i < planner->pending_length; i++) {
+        uint32_t cp = (unsigned char)planner->pending[i];
+        indentation = indentation && (cp == ' ' || cp == '\t');
+        if (!PlanCharacter(planner, plan, cp, indentation)) {
+            return false;
+        }
+    }
+    planner->pending_length = 0;
+    return true;
+}
+
+// Type the list marker held back: its indentation rounded down to whole
+// levels (typed quickly), the marker, then exactly one space
+static bool PlanListMarker(KeyPlanner* planner, KeyPlan* plan) {
+    size_t spaces = planner->indent / LIST_INDENT_SPACES * LIST_INDENT_SPACES;
+    for (size_t i = 0; i < spaces; i++) {
+        if (!PlanCharacter(planner, plan, ' ', true)) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < planner->pending_length; i++) {
+        char byte = planner->pending[i];
+        if (byte != ' ' && byte != '\t' && !PlanCharacter(planner, plan, (unsigned char)byte, false)) {
+            return false;
+        }
+    }
+    planner->pending_length = 0;
+
+    // The marker is formatting, not a word
+    planner->in_word = false;
+    return PlanCharacter(planner, plan, ' ', false);
+}
+
+// Insert a hold: typing pauses here until resumed
+static bool PlanHold(KeyPlanner* planner, KeyPlan* plan) {
+    if (!ReservePlan(plan, plan->count + 1)) {
+        return false;
+    }
+    KeyEvent* hold = &plan->events[plan->count++];
+    hold->time_ns = KeystrokeTime(planner, &planner->next_ns);
+    hold->code = 0;
+    hold->mods = 0;
+    hold->flags = KEY_EVENT_HOLD;
+    planner->next_ns += NextInterval(planner);
+    return true;
+}
+
+// Characters that can appear between the braces of a directive
+static bool IsDirectiveChar(uint32_t cp) {
+    return (cp >= 'A' && cp <= 'Z') || (cp >= '0' && cp <= '9') || cp == ':' || cp == '.';
+}
+
+// Carry out the directive held in pending ("{NAME" or "{NAME:VALUE"); false
+// if it is not one, which leaves it to be typed as text
+static bool ApplyDirective(KeyPlanner* planner, KeyPlan* plan, bool* ok) {
+    planner->pending[planner->pending_length] = '\0';
+    const char* name = planner->pending + 1;
+    const char* colon = strchr(name, ':');
+    size_t name_length = colon ? (size_t)(colon - name) : strlen(name);
+
+    double value = 0.0;
+    if (colon) {
+        char* end;
+        value = strtod(colon + 1, &end);
+        if (end == colon + 1 || *end != '\0' || !isfinite(value) || value < 0.0) {
+            return false;
+        }
+    }
+
+    *ok = true;
+    if (name_length == 5 && strncmp(name, "PAUSE", 5) == 0 && value <= MAX_PAUSE_S) {
+        if (!colon) {
+            *ok = PlanHold(planner, plan);
+        } else {
+            planner->next_ns += (uint64_t)(value * 1e9);
+        }
+    } else if (name_length == 3 && strncmp(name, "WPM", 3) == 0 && (!colon || IsValidWpm(value))) {
+        planner->ns_per_char = colon ? SpacingForWpm(value) : planner->base_ns_per_char;
+    } else if (name_length == 5 && strncmp(name, "TYPOS", 5) == 0 && value <= 100.0) {
+        uint64_t base = planner->humanize ? planner->humanize->typo_chance : 0;
+        planner->typo_chance = colon ? ChanceThreshold(value / 100.0) : base;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Run one character through the directive lexer. Braces introduce directives;
+// at the start of a line, indentation and list markers ("-", "*", "+", "12.")
+// are held back until it is clear whether the line is a list item. Anything
+// that turns out not to be a directive or marker is typed unchanged.
+static bool LexCharacter(KeyPlanner* planner, KeyPlan* plan, uint32_t cp) {
+    bool blank = cp == ' ' || cp == '\t';
+    bool digit = cp >= '0' && cp <= '9';
+    bool room = planner->pending_length < PLAN_PENDING_SIZE;
+
+    switch (planner->lex_state) {
+    case PLAN_LEX_LINE_START:
+        if (blank && room) {
+            HoldByte(planner, cp);
+            planner->indent += cp == '\t' ? LIST_INDENT_SPACES : 1;
+            return true;
+        }
+        if ((cp == '-' || cp == '*' || cp == '+' || digit) && room) {
+            HoldByte(planner, cp);
+            planner->lex_state = digit ? PLAN_LEX_NUMBER : PLAN_LEX_MARKER;
+            return true;
+        }
+        break;
+    case PLAN_LEX_NUMBER:
+        if ((digit || cp == '.') && room) {
+            HoldByte(planner, cp);
+            planner->lex_state = digit ? PLAN_LEX_NUMBER : PLAN_LEX_MARKER;
+            return true;
+        }
+        break;
+    case PLAN_LEX_MARKER:
+        if (blank) {
+            planner->lex_state = PLAN_LEX_AFTER_MARKER;
+            return PlanListMarker(planner, plan);
+        }
+        break;
+    case PLAN_LEX_AFTER_MARKER:
+        if (blank) {
+            return true;
+        }
+        break;
+    case PLAN_LEX_DIRECTIVE:
+        if (cp == '{' && planner->pending_length == 1) {
+            // "{{" types a brace
+            planner->pending_length = 0;
+            planner->lex_state = PLAN_LEX_TEXT;
+            return PlanCharacter(planner, plan, '{', false);
+        }
+        if (cp == '}') {
+            bool ok;
+            if (ApplyDirective(planner, plan, &ok)) {
+                planner->pending_length = 0;
+                planner->lex_state = PLAN_LEX_TEXT;
+                return ok;
+            }
+        } else if (IsDirectiveChar(cp) && room) {
+            HoldByte(planner, cp);
+            return true;
+        }
+        break;
+    }
+
+    // cp does not continue what was held back: type that as it was, then cp
+    if (!FlushPending(planner, plan)) {
+        return false;
+    }
+    planner->lex_state = PLAN_LEX_TEXT;
+    if (cp == '{') {
+        HoldByte(planner, cp);
+        planner->lex_state = PLAN_LEX_DIRECTIVE;
+        return true;
+    }
+    if (cp == '\n') {
+        planner->lex_state = PLAN_LEX_LINE_START;
+        planner->indent = 0;
+    }
+    return PlanCharacter(planner, plan, cp, false);
+}
+
+// Append the press/release events for length bytes of UTF-8 text to the plan
+bool PlanText(KeyPlanner* planner, KeyPlan* plan, const char* text, size_t length) {
+    if (!ReservePlan(plan, plan->count + length * 2)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < length; i++) {
+        unsigned char byte = (unsigned char)text[i];
+        uint32_t cp;
+
+        // ASCII needs no decoding as long as no multi-byte sequence is open
+        if (byte < 0x80 && planner->decoder.remaining == 0) {
+            cp = byte;
+        } else {
+            int step = Utf8Step(&planner->decoder, byte, &cp);
+            if (step == UTF8_CONTINUE) {
+                continue;
+            }
+            if (step == UTF8_REJECT || step == UTF8_INVALID) {
+                // Skip the malformed character (decoding a byte that cut a
+                // sequence short afresh); like any other character it belongs
+                // to the word around it
+                planner->unmapped_chars++;
+                planner->in_word = true;
+                i -= step == UTF8_REJECT;
+                continue;
+            }
+        }
+
+        // Type CRLF and lone CR as a single newline
+        if (cp == '\n' && planner->after_cr) {
+            planner->after_cr = false;
+            continue;
+        }
+        planner->after_cr = (cp == '\r');
+        if (cp == '\r') {
+            cp = '\n';
+        }
+
+        bool ok = planner->directives ? LexCharacter(planner, plan, cp) : PlanCharacter(planner, plan, cp, false);
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Close out the last word once the whole text has been planned, typing
+// anything the directive lexer still holds back; false if memory ran out
+bool FinishPlan(KeyPlanner* planner, KeyPlan* plan) {
+    bool ok = FlushPending(planner, plan);
+    planner->lex_state = PLAN_LEX_TEXT;
+    if (!planner->in_word) {
+        return ok;
+    }
+    planner->in_word = false;
+
+    for (size_t i = plan->count; i-- > 0;) {
+        if (!(plan->events[i].flags & (KEY_EVENT_UP | KEY_EVENT_HOLD))) {
+            plan->events[i].flags |= KEY_EVENT_WORD_END;
+            break;
+        }
+    }
+    return ok;
+}
+
+// Expected typing time for a scanned text. Intervals average ns_per_char; each
+// typo adds a wrong key, the delay before noticing it and a backspace; each
+// gap after a word may hold a thinking pause.
+uint64_t EstimatePlanDuration(const TextScan* scan, double target_wpm, const HumanizeModel* humanize) {
+    double ns_per_char = 60e9 / target_wpm / CHARS_PER_WORD;
+    double total = (double)scan->chars * ns_per_char;
+    if (!humanize) {
+        return (uint64_t)total;
+    }
+
+    double typos = (double)scan->letters * (double)humanize->typo_chance / 4294967296.0;
+    double correction_ns = (double)humanize->correction_min_ns + (double)humanize->correction_span_ns / 2.0;
+    total += typos * (2.0 * ns_per_char + correction_ns);
+
+    double pause_ns = AliasDistributionMean(&humanize->pause);
+    double sentence_pauses = (double)scan->sentence_gaps * (double)humanize->sentence_pause_chance / 4294967296.0;
+    double word_pauses = (double)(scan->word_gaps - scan->sentence_gaps) * (double)humanize->word_pause_chance / 4294967296.0;
+    total += (sentence_pauses + word_pauses) * pause_ns;
+    return (uint64_t)total;
+}
+
+// Length of the keystroke starting at index (events sharing one timestamp)
+size_t PlanGroupLength(const KeyPlan* plan, size_t index) {
+    size_t end = index + 1;
+    while (end < plan->count && plan->events[end].time_ns == plan->events[index].time_ns) {
+        end++;
+    }
+    return end - index;
+}
+
+// Length of the run of whole keystrokes starting at index that are due before until_ns
+size_t PlanBurstLength(const KeyPlan* plan, size_t index, uint64_t until_ns, size_t max_events) {
+    size_t end = index + PlanGroupLength(plan, index);
+    while (end < plan->count && plan->events[end].time_ns < until_ns && !(plan->events[end].flags & KEY_EVENT_HOLD)) {
+        size_t next = end + PlanGroupLength(plan, end);
+        if (next - index > max_events) {
+            break;
+        }
+        end = next;
+    }
+    return end - index;
+}
+
+// Write a human-readable listing of the plan
+void PrintPlan(const KeyPlan* plan, FILE* out) {
+    for (size_t i = 0; i < plan->count; i++) {
+        const KeyEvent* ev = &plan->events[i];
+        if (ev->flags & KEY_EVENT_HOLD) {
+            fprintf(out, "%12.6f hold\n", (double)ev->time_ns / 1e9);
+            continue;
+        }
+        fprintf(out,
+                (ev->flags & KEY_EVENT_UNICODE) ? "%12.6f %s U+%04X mods=%u%s%s\n" : "%12.6f %s key %u mods=%u%s%s\n",
+                (double)ev->time_ns / 1e9,
+                (ev->flags & KEY_EVENT_UP) ? "up  " : "down",
+                (unsigned)ev->code, (unsigned)ev->mods,
+                (ev->flags & KEY_EVENT_WORD_END) ? " word" : "",
+                (ev->flags & KEY_EVENT_ERASE) ? " erase" : (ev->flags & KEY_EVENT_CORRECTION) ? " typo" : "");
+    }
+}
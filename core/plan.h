@@ -0,0 +1,92 @@
+#ifndef HUMANIZER_CORE_PLAN_H
+#define HUMANIZER_CORE_PLAN_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sink.h"
+#include "utf8.h"
+#include "scan.h"
+#include "humanize.h"
+
+// Bytes the directive lexer can hold back (a directive or indentation plus list marker)
+#define PLAN_PENDING_SIZE 32
+
+// Columns per indentation level of a list item; a tab counts as one level
+#define LIST_INDENT_SPACES 3
+
+// Where the directive lexer is
+#define PLAN_LEX_TEXT         0 // Inside a line
+#define PLAN_LEX_LINE_START   1 // Reading the indentation at the start of a line
+#define PLAN_LEX_NUMBER       2 // Reading the digits of a possible "12." marker
+#define PLAN_LEX_MARKER       3 // Read a list marker, whitespace must follow
+#define PLAN_LEX_AFTER_MARKER 4 // Dropping extra whitespace after a list marker
+#define PLAN_LEX_DIRECTIVE    5 // Inside {...}
+
+// Flat, timestamped list of key events compiled ahead of typing
+typedef struct {
+    KeyEvent* events;      // Events in emission order
+    size_t count;          // Number of events in use
+    size_t capacity;       // Number of events allocated
+} KeyPlan;
+
+// State carried between PlanText calls so text can be compiled in pieces
+typedef struct {
+    KeySink* sink;                // Sink whose keycode space the plan targets
+    const HumanizeModel* humanize; // Timing/typo model, NULL for evenly spaced keystrokes
+    RandomState rng;              // Seeded generator driving the model
+    uint64_t next_ns;             // Target time of the next keystroke
+    uint64_t earliest_ns;         // Earliest time left for it (1 ns after the previous keystroke)
+    uint64_t ns_per_char;         // Mean spacing between keystrokes
+    uint64_t base_ns_per_char;    // Spacing for the target speed, restored by {WPM}
+    uint64_t typo_chance;         // ChanceThreshold() of a typo per letter ({TYPOS:N} overrides the model)
+    bool in_word;                 // Whether the previous character was part of a word
+    bool after_cr;                // Previous character was '\r' (folds CRLF across chunk boundaries)
+    uint32_t previous;            // Previous codepoint (sentence ends for thinking pauses)
+    uint32_t last_key;            // Character of the last key planned, typos included (digraph delays)
+    Utf8Decoder decoder;          // Partial UTF-8 sequence carried across chunk boundaries
+    size_t chars_planned;         // Characters consumed so far
+    size_t unmapped_chars;        // Characters the sink could not produce
+    size_t typos;                 // Typos planned (each followed by a backspace)
+    bool directives;              // Compile {PAUSE}, {PAUSE:N}, {WPM:N}, {TYPOS:N} and list formatting
+    uint8_t lex_state;            // PLAN_LEX_* state of the directive lexer
+    size_t indent;                // Columns of indentation held back at the start of the line
+    size_t pending_length;
+    char pending[PLAN_PENDING_SIZE + 1]; // Bytes held back until the lexer knows what they are
+} KeyPlanner;
+
+// Plan storage
+void InitializePlan(KeyPlan* plan);
+void CleanupPlan(KeyPlan* plan);
+void ClearPlan(KeyPlan* plan);
+bool ReservePlan(KeyPlan* plan, size_t capacity);
+
+// Whether a target speed from the user is usable: positive, finite and at
+// most MAX_WPM
+bool IsValidWpm(double wpm);
+
+// Compiling text into events
+void InitializePlanner(KeyPlanner* planner, KeySink* sink, double target_wpm,
+                       const HumanizeModel* humanize, uint64_t seed);
+bool PlanText(KeyPlanner* planner, KeyPlan* plan, const char* text, size_t length);
+bool FinishPlan(KeyPlanner* planner, KeyPlan* plan);
+
+// Expected typing time for a scanned text at target_wpm, with the humanize
+// model's typos and thinking pauses when one is given
+uint64_t EstimatePlanDuration(const TextScan* scan, double target_wpm, const HumanizeModel* humanize);
+
+// Length of the keystroke starting at index (events sharing one timestamp;
+// the planner gives every keystroke a later time than the one before it)
+size_t PlanGroupLength(const KeyPlan* plan, size_t index);
+
+// Length of the run of whole keystrokes starting at index that are due before
+// until_ns: at least the first keystroke, then more while the run stays within
+// max_events; stops at a hold
+size_t PlanBurstLength(const KeyPlan* plan, size_t index, uint64_t until_ns, size_t max_events);
+
+// Write a human-readable listing of the plan
+void PrintPlan(const KeyPlan* plan, FILE* out);
+
+#endif // HUMANIZER_CORE_PLAN_H
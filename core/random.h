@@ -0,0 +1,62 @@
+#ifndef HUMANIZER_CORE_RANDOM_H
+#define HUMANIZER_CORE_RANDOM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// xoshiro256** generator: a few cycles per draw and fully determined by its seed
+typedef struct {
+    uint64_t s[4];
+} RandomState;
+
+static inline uint64_t RotateLeft64(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+// Expand a 64-bit seed into the generator state with splitmix64
+static inline void SeedRandom(RandomState* state, uint64_t seed) {
+    for (int i = 0; i < 4; i++) {
+        uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        state->s[i] = z ^ (z >> 31);
+    }
+}
+
+// Next 64 random bits
+static inline uint64_t NextRandom(RandomState* state) {
+    uint64_t* s = state->s;
+    uint64_t result = RotateLeft64(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = RotateLeft64(s[3], 45);
+    return result;
+}
+
+// Uniform double in [0, 1)
+static inline double RandomUnit(RandomState* state) {
+    return (double)(NextRandom(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Probability expressed as a threshold on 32 random bits (see RandomChance)
+static inline uint64_t ChanceThreshold(double probability) {
+    if (probability <= 0.0) {
+        return 0;
+    }
+    if (probability >= 1.0) {
+        return 1ULL << 32;
+    }
+    return (uint64_t)(probability * 4294967296.0);
+}
+
+// True with the probability encoded in threshold
+static inline bool RandomChance(RandomState* state, uint64_t threshold) {
+    return (NextRandom(state) >> 32) < threshold;
+}
+
+#endif // HUMANIZER_CORE_RANDOM_H
@@ -0,0 +1,166 @@
+#include "humanizer.h"
+#include "ring.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+bool InitializeEventRing(EventRing* ring, size_t capacity) {
+    size_t rounded = 1;
+    while (rounded < capacity) {
+        rounded <<= 1;
+    }
+
+    ring->events = (KeyEvent*)malloc(rounded * sizeof(KeyEvent));
+    if (!ring->events) {
+        printf(ANSI_COLOR_RED "Error: Memory allocation failed\n" ANSI_COLOR_RESET);
+        return false;
+    }
+    ring->capacity = rounded;
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->head, 0);
+    ring->cached_head = 0;
+    ring->cached_tail = 0;
+    atomic_init(&ring->closed, false);
+    atomic_init(&ring->cancelled, false);
+    return true;
+}
+
+void DestroyEventRing(EventRing* ring) {
+    free(ring->events);
+    ring->events = NULL;
+}
+
+// Copy count events into the ring starting at position, wrapping at the end
+static void CopyIntoRing(EventRing* ring, size_t position, const KeyEvent* events, size_t count) {
+    size_t start = position & (ring->capacity - 1);
+    size_t first = ring->capacity - start;
+    if (first > count) {
+        first = count;
+    }
+    memcpy(ring->events + start, events, first * sizeof(KeyEvent));
+    memcpy(ring->events, events + first, (count - first) * sizeof(KeyEvent));
+}
+
+// Events in the keystroke starting at events[0], counting at most limit
+static size_t KeystrokeLength(const KeyEvent* events, size_t count, size_t limit) {
+    size_t length = 1;
+    while (length < count && length < limit && events[length].time_ns == events[0].time_ns) {
+        length++;
+    }
+    return length;
+}
+
+// Publish the longest prefix of events made of whole keystrokes that fits right now
+size_t PushKeystrokes(EventRing* ring, const KeyEvent* events, size_t count) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t space = ring->capacity - (tail - ring->cached_head);
+    if (space < count) {
+        // Only look at the consumer's index when the cached one says we are short
+        ring->cached_head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        space = ring->capacity - (tail - ring->cached_head);
+    }
+
+    size_t fit = count;
+    if (fit > space) {
+        // Back off to the start of the keystroke the cut would split
+        fit = space;
+        while (fit > 0 && events[fit].time_ns == events[fit - 1].time_ns) {
+            fit--;
+        }
+        // A keystroke longer than the whole ring would never fit: split it
+        if (fit == 0 && space > 0 && KeystrokeLength(events, count, ring->capacity + 1) > ring->capacity) {
+            fit = space;
+        }
+    }
+    if (fit == 0) {
+        return 0;
+    }
+
+    CopyIntoRing(ring, tail, events, fit);
+    atomic_store_explicit(&ring->tail, tail + fit, memory_order_release);
+    return fit;
+}
+
+// Publish every event, waiting for the consumer to make room; false if it cancelled
+bool WriteKeystrokes(EventRing* ring, const KeyEvent* events, size_t count, uint64_t max_backoff_ns) {
+    uint64_t backoff_ns = EVENT_RING_BACKOFF_MIN_NS;
+    while (count > 0) {
+        if (atomic_load_explicit(&ring->cancelled, memory_order_acquire)) {
+            return false;
+        }
+        size_t pushed = PushKeystrokes(ring, events, count);
+        if (pushed == 0) {
+            EventRingBackoff(&backoff_ns, max_backoff_ns);
+            continue;
+        }
+        events += pushed;
+        count -= pushed;
+        backoff_ns = EVENT_RING_BACKOFF_MIN_NS;
+    }
+    return !atomic_load_explicit(&ring->cancelled, memory_order_acquire);
+}
+
+void CloseEventRing(EventRing* ring) {
+    atomic_store_explicit(&ring->closed, true, memory_order_release);
+}
+
+// Copy out up to max published events; 0 if none are available
+size_t PopEvents(EventRing* ring, KeyEvent* out, size_t max) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t available = ring->cached_tail - head;
+    if (available < max) {
+        ring->cached_tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        available = ring->cached_tail - head;
+    }
+    if (available > max) {
+        available = max;
+    }
+    if (available == 0) {
+        return 0;
+    }
+
+    size_t start = head & (ring->capacity - 1);
+    size_t first = ring->capacity - start;
+    if (first > available) {
+        first = available;
+    }
+    memcpy(out, ring->events + start, first * sizeof(KeyEvent));
+    memcpy(out + first, ring->events, (available - first) * sizeof(KeyEvent));
+    atomic_store_explicit(&ring->head, head + available, memory_order_release);
+    return available;
+}
+
+// The next published event, left in the ring; NULL if there is none yet
+const KeyEvent* PeekEvent(EventRing* ring) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    if (ring->cached_tail == head) {
+        ring->cached_tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        if (ring->cached_tail == head) {
+            return NULL;
+        }
+    }
+    return &ring->events[head & (ring->capacity - 1)];
+}
+
+void CancelEventRing(EventRing* ring) {
+    atomic_store_explicit(&ring->cancelled, true, memory_order_release);
+}
+
+// Whether the producer closed the ring and every event was consumed. closed is
+// read before tail, so events published before the close are never missed.
+bool EventRingDrained(EventRing* ring) {
+    if (!atomic_load_explicit(&ring->closed, memory_order_acquire)) {
+        return false;
+    }
+    return atomic_load_explicit(&ring->tail, memory_order_acquire) ==
+           atomic_load_explicit(&ring->head, memory_order_relaxed);
+}
+
+// Sleep *backoff_ns on the OS timer, then double it up to max_ns
+void EventRingBackoff(uint64_t* backoff_ns, uint64_t max_ns) {
+    CoarseSleepUntilNs(MonotonicNowNs() + *backoff_ns);
+    *backoff_ns *= 2;
+    if (*backoff_ns > max_ns) {
+        *backoff_ns = max_ns;
+    }
+}
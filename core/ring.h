@@ -0,0 +1,79 @@
+#ifndef HUMANIZER_CORE_RING_H
+#define HUMANIZER_CORE_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "sink.h"
+
+// Events the planner may run ahead of the emitter (power of two, about 256 KB)
+#define EVENT_RING_CAPACITY 16384
+
+// Assumed cache line size; each side's index sits on its own line
+#define EVENT_RING_LINE 64
+
+// Polling interval bounds while one side waits for the other: waits start
+// short and double, so a busy pipeline reacts quickly and an idle one sleeps
+#define EVENT_RING_BACKOFF_MIN_NS 20000ULL
+#define EVENT_RING_PLANNER_BACKOFF_MAX_NS 10000000ULL // Planner seconds ahead of real-time typing
+#define EVENT_RING_DRY_RUN_BACKOFF_MAX_NS 1000000ULL  // Planner feeding an emitter that never sleeps
+#define EVENT_RING_EMITTER_BACKOFF_MAX_NS 200000ULL   // The emitter may owe a keystroke any moment
+
+// Lock-free single-producer/single-consumer queue of planned key events. The
+// planner publishes whole keystrokes (events sharing a timestamp), so whatever
+// the emitter can see ends on a keystroke boundary unless a keystroke is
+// longer than the ring. Neither side ever blocks
+// the other: both only read the opposite index and keep a private copy of it
+// to avoid touching the other side's cache line on every call.
+typedef struct {
+    // Producer side
+    atomic_size_t tail;           // Events published
+    size_t cached_head;           // Producer's last look at head
+    char producer_pad[EVENT_RING_LINE - sizeof(atomic_size_t) - sizeof(size_t)];
+
+    // Consumer side
+    atomic_size_t head;           // Events consumed
+    size_t cached_tail;           // Consumer's last look at tail
+    char consumer_pad[EVENT_RING_LINE - sizeof(atomic_size_t) - sizeof(size_t)];
+
+    KeyEvent* events;             // capacity slots, index & (capacity - 1)
+    size_t capacity;
+    atomic_bool closed;           // Producer is done: nothing follows what is published
+    atomic_bool cancelled;        // Consumer gave up: the producer should stop
+} EventRing;
+
+// Ring lifecycle; capacity is rounded up to a power of two
+bool InitializeEventRing(EventRing* ring, size_t capacity);
+void DestroyEventRing(EventRing* ring);
+
+// Producer: publish the longest prefix of events made of whole keystrokes that
+// fits right now (count must end on a keystroke boundary). A keystroke longer
+// than the ring is split, since it could never fit whole. Returns the number
+// of events published without waiting.
+size_t PushKeystrokes(EventRing* ring, const KeyEvent* events, size_t count);
+
+// Producer: publish every event, polling for space at most max_backoff_ns
+// apart; false if the consumer cancelled first
+bool WriteKeystrokes(EventRing* ring, const KeyEvent* events, size_t count, uint64_t max_backoff_ns);
+
+// Producer: mark the end of the stream
+void CloseEventRing(EventRing* ring);
+
+// Consumer: copy out up to max published events; 0 if none are available
+size_t PopEvents(EventRing* ring, KeyEvent* out, size_t max);
+
+// Consumer: the next published event, left in the ring; NULL if there is none yet
+const KeyEvent* PeekEvent(EventRing* ring);
+
+// Consumer: tell the producer to stop
+void CancelEventRing(EventRing* ring);
+
+// Whether the ring is closed and everything in it consumed
+bool EventRingDrained(EventRing* ring);
+
+// Poll wait used by both sides: sleeps *backoff_ns, then doubles it up to max_ns
+void EventRingBackoff(uint64_t* backoff_ns, uint64_t max_ns);
+
+#endif // HUMANIZER_CORE_RING_H
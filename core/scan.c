@@ -0,0 +1,446 @@
+#include "scan.h"
+
+#include <string.h>
+#include <stdatomic.h>
+
+// Helpers are forced inline so each kernel gets a copy compiled for its own
+// instruction set (popcnt included)
+#if defined(_MSC_VER)
+#define SCAN_INLINE static __forceinline
+#else
+#define SCAN_INLINE static inline __attribute__((always_inline))
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SCAN_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SCAN_TARGET_SSE2
+#define SCAN_TARGET_AVX2
+#else
+#define SCAN_TARGET_SSE2 __attribute__((target("popcnt")))
+#define SCAN_TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+#endif
+#endif
+
+// Per-byte classes of one block, bit i standing for byte i
+typedef struct {
+    uint64_t space;        // IsWordSeparator
+    uint64_t newline;      // '\n'
+    uint64_t cr;           // '\r'
+    uint64_t punct;        // . ! ?
+    uint64_t letter;       // A-Z a-z
+    uint64_t control;      // Controls other than \t \n \r, and DEL
+    uint64_t high;         // 0x80 and up (part of a multi-byte sequence or invalid)
+    uint64_t continuation; // 0x80-0xBF
+} ScanMasks;
+
+// Classify and count SCAN_BLOCK_SIZE * blocks bytes
+typedef void (*ScanBlocksFn)(TextScanner* scanner, const uint8_t* data, size_t blocks);
+
+#if defined(_MSC_VER)
+SCAN_INLINE unsigned Popcount64(uint64_t x) {
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (unsigned)((x * 0x0101010101010101ULL) >> 56);
+}
+
+SCAN_INLINE unsigned TrailingZeros64(uint64_t x) {
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return (unsigned)index;
+}
+#else
+SCAN_INLINE unsigned Popcount64(uint64_t x) {
+    return (unsigned)__builtin_popcountll(x);
+}
+
+SCAN_INLINE unsigned TrailingZeros64(uint64_t x) {
+    return (unsigned)__builtin_ctzll(x);
+}
+#endif
+
+// Bits [from, to) of a block
+SCAN_INLINE uint64_t BitRange(unsigned from, unsigned to) {
+    uint64_t below_to = to >= 64 ? ~0ULL : (1ULL << to) - 1;
+    uint64_t below_from = from >= 64 ? ~0ULL : (1ULL << from) - 1;
+    return below_to & ~below_from;
+}
+
+static inline void NoteProblem(uint64_t* count, uint64_t* first, uint64_t offset) {
+    if ((*count)++ == 0) {
+        *first = offset;
+    }
+}
+
+// A non-whitespace character after breaks line breaks: the first one, or one
+// after a blank line, starts a paragraph
+static inline void NoteContent(TextScanner* scanner) {
+    if (scanner->scan.paragraphs == 0 || scanner->breaks >= 2) {
+        scanner->scan.paragraphs++;
+    }
+    scanner->breaks = 0;
+}
+
+// Decode the block byte by byte to validate UTF-8 and look characters up in
+// the layout; only blocks with non-ASCII bytes or controls (or an open
+// sequence) come here unless the layout lacks printable ASCII
+static void WalkBlock(TextScanner* scanner, const uint8_t* data, size_t length, uint64_t crlf) {
+    TextScan* scan = &scanner->scan;
+    KeyEvent key;
+
+    for (size_t i = 0; i < length; i++) {
+        uint8_t byte = data[i];
+        uint64_t offset = scan->bytes + i;
+        uint32_t cp;
+
+        if (byte < 0x80 && scanner->decoder.remaining == 0) {
+            cp = byte;
+            if (!scanner->check_ascii && byte >= 0x20 && byte != 0x7F) {
+                continue;
+            }
+        } else {
+            bool stray = scanner->decoder.remaining == 0 && (byte & 0xC0) == 0x80;
+            int step = Utf8Step(&scanner->decoder, byte, &cp);
+            if (step == UTF8_CONTINUE) {
+                continue;
+            }
+            if (step == UTF8_REJECT) {
+                // The truncated sequence is one bad character; decode this byte afresh
+                NoteProblem(&scan->invalid_sequences, &scan->first_invalid, offset);
+                i--;
+                continue;
+            }
+            if (step == UTF8_INVALID) {
+                // The block counts skip continuation bytes, but the planner
+                // skips a stray one as a character of its own
+                scan->chars += stray;
+                NoteProblem(&scan->invalid_sequences, &scan->first_invalid, offset);
+                continue;
+            }
+        }
+
+        // The block counts only see ASCII letters; typos are planned for the
+        // Latin-1 ones too (all of U+00C0..U+00FF but the two signs)
+        scan->letters += cp >= 0xC0 && cp <= 0xFF && cp != 0xD7 && cp != 0xF7;
+        if (!scanner->layout || (crlf >> i & 1)) {
+            continue;
+        }
+        if (!LookupLayout(scanner->layout, cp == '\r' ? '\n' : cp, &key)) {
+            NoteProblem(&scan->unmappable_chars, &scan->first_unmappable, offset);
+        }
+    }
+}
+
+// Fold one classified block of length bytes into the counts
+SCAN_INLINE void AccumulateBlock(TextScanner* scanner, const ScanMasks* m, const uint8_t* data, size_t length) {
+    TextScan* scan = &scanner->scan;
+    uint64_t valid = BitRange(0, (unsigned)length);
+    uint64_t content = ~m->space & valid;
+
+    uint64_t word_starts = content & ((m->space << 1) | (uint64_t)scanner->after_space);
+    uint64_t gaps = m->space & ((content << 1) | (uint64_t)scanner->after_content);
+    uint64_t sentence_gaps = m->space & ((m->punct << 1) | (uint64_t)scanner->after_punct);
+    uint64_t crlf = m->newline & ((m->cr << 1) | (uint64_t)scanner->after_cr);
+    uint64_t breaks = (m->newline & ~crlf) | m->cr;
+
+    scan->words += Popcount64(word_starts);
+    scan->word_gaps += Popcount64(gaps);
+    scan->sentence_gaps += Popcount64(sentence_gaps);
+    scan->lines += Popcount64(breaks);
+    scan->letters += Popcount64(m->letter);
+    scan->chars += length - Popcount64(m->continuation) - Popcount64(crlf);
+    if (m->control) {
+        if (scan->control_chars == 0) {
+            scan->first_control = scan->bytes + TrailingZeros64(m->control);
+        }
+        scan->control_chars += Popcount64(m->control);
+    }
+
+    // Line breaks are sparse, so walking them one by one stays cheap
+    unsigned from = 0;
+    for (uint64_t rest = breaks; rest; rest &= rest - 1) {
+        unsigned at = TrailingZeros64(rest);
+        if (content & BitRange(from, at)) {
+            NoteContent(scanner);
+        }
+        scanner->breaks++;
+        from = at + 1;
+    }
+    if (content & BitRange(from, (unsigned)length)) {
+        NoteContent(scanner);
+    }
+
+    if (m->high || m->control || scanner->decoder.remaining || scanner->check_ascii) {
+        WalkBlock(scanner, data, length, crlf);
+    }
+
+    unsigned last = (unsigned)length - 1;
+    scanner->after_space = (m->space >> last) & 1;
+    scanner->after_content = !scanner->after_space;
+    scanner->after_punct = (m->punct >> last) & 1;
+    scanner->after_cr = (m->cr >> last) & 1;
+    scanner->after_break = ((breaks | crlf) >> last) & 1;
+    scan->bytes += length;
+}
+
+// Portable classification, also used for the tail shorter than a block
+static void ClassifyScalar(const uint8_t* data, size_t length, ScanMasks* m) {
+    memset(m, 0, sizeof(*m));
+    for (size_t i = 0; i < length; i++) {
+        uint8_t byte = data[i];
+        uint64_t bit = 1ULL << i;
+        uint8_t lower = byte | 0x20;
+
+        if (IsWordSeparator(byte)) {
+            m->space |= bit;
+        }
+        if (byte == '\n') {
+            m->newline |= bit;
+        } else if (byte == '\r') {
+            m->cr |= bit;
+        } else if (byte == '.' || byte == '!' || byte == '?') {
+            m->punct |= bit;
+        } else if (lower >= 'a' && lower <= 'z') {
+            m->letter |= bit;
+        } else if ((byte < 0x20 && byte != '\t') || byte == 0x7F) {
+            m->control |= bit;
+        } else if (byte >= 0x80) {
+            m->high |= bit;
+            if (byte < 0xC0) {
+                m->continuation |= bit;
+            }
+        }
+    }
+}
+
+static void ScanBlocksScalar(TextScanner* scanner, const uint8_t* data, size_t blocks) {
+    ScanMasks m;
+    for (size_t b = 0; b < blocks; b++, data += SCAN_BLOCK_SIZE) {
+        ClassifyScalar(data, SCAN_BLOCK_SIZE, &m);
+        AccumulateBlock(scanner, &m, data, SCAN_BLOCK_SIZE);
+    }
+}
+
+#if defined(SCAN_X86)
+
+// Classes of 16 bytes; signed compares leave bytes 0x80 and up out of every
+// ASCII range
+SCAN_TARGET_SSE2 SCAN_INLINE void ClassifySse2(__m128i v, uint64_t shift, ScanMasks* m) {
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    uint64_t space = (uint16_t)_mm_movemask_epi8(_mm_or_si128(
+        _mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+        _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('\t' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('\r' + 1)))));
+    uint64_t newline = (uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+    uint64_t cr = (uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')));
+    uint64_t tab = (uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\t')));
+    uint64_t punct = (uint16_t)_mm_movemask_epi8(_mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('.')), _mm_cmpeq_epi8(v, _mm_set1_epi8('!'))),
+        _mm_cmpeq_epi8(v, _mm_set1_epi8('?'))));
+    uint64_t letter = (uint16_t)_mm_movemask_epi8(
+        _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1))));
+    uint64_t high = (uint16_t)_mm_movemask_epi8(v);
+    uint64_t below_space = (uint16_t)_mm_movemask_epi8(_mm_cmplt_epi8(v, _mm_set1_epi8(0x20)));
+    uint64_t del = (uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(0x7F)));
+    uint64_t continuation = (uint16_t)_mm_movemask_epi8(_mm_cmplt_epi8(v, _mm_set1_epi8((char)0xC0)));
+
+    m->space |= space << shift;
+    m->newline |= newline << shift;
+    m->cr |= cr << shift;
+    m->punct |= punct << shift;
+    m->letter |= letter << shift;
+    m->control |= ((below_space & ~high & ~tab & ~newline & ~cr) | del) << shift;
+    m->high |= high << shift;
+    m->continuation |= continuation << shift;
+}
+
+SCAN_TARGET_SSE2 static void ScanBlocksSse2(TextScanner* scanner, const uint8_t* data, size_t blocks) {
+    ScanMasks m;
+    for (size_t b = 0; b < blocks; b++, data += SCAN_BLOCK_SIZE) {
+        memset(&m, 0, sizeof(m));
+        for (unsigned lane = 0; lane < SCAN_BLOCK_SIZE; lane += 16) {
+            ClassifySse2(_mm_loadu_si128((const __m128i*)(data + lane)), lane, &m);
+        }
+        AccumulateBlock(scanner, &m, data, SCAN_BLOCK_SIZE);
+    }
+}
+
+// Same classes as ClassifySse2 for 32 bytes
+SCAN_TARGET_AVX2 SCAN_INLINE void ClassifyAvx2(__m256i v, uint64_t shift, ScanMasks* m) {
+    __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    uint64_t space = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(
+        _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+        _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('\t' - 1)),
+                         _mm256_cmpgt_epi8(_mm256_set1_epi8('\r' + 1), v))));
+    uint64_t newline = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')));
+    uint64_t cr = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')));
+    uint64_t tab = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t')));
+    uint64_t punct = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('.')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('!'))),
+        _mm256_cmpeq_epi8(v, _mm256_set1_epi8('?'))));
+    uint64_t letter = (uint32_t)_mm256_movemask_epi8(
+        _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+                         _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower)));
+    uint64_t high = (uint32_t)_mm256_movemask_epi8(v);
+    uint64_t below_space = (uint32_t)_mm256_movemask_epi8(_mm256_cmpgt_epi8(_mm256_set1_epi8(0x20), v));
+    uint64_t del = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(0x7F)));
+    uint64_t continuation = (uint32_t)_mm256_movemask_epi8(_mm256_cmpgt_epi8(_mm256_set1_epi8((char)0xC0), v));
+
+    m->space |= space << shift;
+    m->newline |= newline << shift;
+    m->cr |= cr << shift;
+    m->punct |= punct << shift;
+    m->letter |= letter << shift;
+    m->control |= ((below_space & ~high & ~tab & ~newline & ~cr) | del) << shift;
+    m->high |= high << shift;
+    m->continuation |= continuation << shift;
+}
+
+SCAN_TARGET_AVX2 static void ScanBlocksAvx2(TextScanner* scanner, const uint8_t* data, size_t blocks) {
+    ScanMasks m;
+    for (size_t b = 0; b < blocks; b++, data += SCAN_BLOCK_SIZE) {
+        memset(&m, 0, sizeof(m));
+        ClassifyAvx2(_mm256_loadu_si256((const __m256i*)data), 0, &m);
+        ClassifyAvx2(_mm256_loadu_si256((const __m256i*)(data + 32)), 32, &m);
+        AccumulateBlock(scanner, &m, data, SCAN_BLOCK_SIZE);
+    }
+}
+
+// AVX2 needs both the CPU flag and the OS saving the YMM registers
+static bool CpuHasAvx2(void) {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+// SSE2 is part of x86-64; the kernel also counts bits with popcnt
+static bool CpuHasSse2(void) {
+#if defined(_MSC_VER)
+    return true;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("popcnt");
+#endif
+}
+
+#endif // SCAN_X86
+
+static bool CpuHasScalar(void) {
+    return true;
+}
+
+typedef struct {
+    const char* name;
+    ScanBlocksFn scan;
+    bool (*supported)(void);
+} ScanKernel;
+
+// Fastest first
+static const ScanKernel kScanKernels[] = {
+#if defined(SCAN_X86)
+    { "avx2", ScanBlocksAvx2, CpuHasAvx2 },
+    { "sse2", ScanBlocksSse2, CpuHasSse2 },
+#endif
+    { "scalar", ScanBlocksScalar, CpuHasScalar },
+};
+#define SCAN_KERNEL_COUNT (sizeof(kScanKernels) / sizeof(kScanKernels[0]))
+
+// Index of the kernel in use plus one; 0 until the first scan picks one
+static atomic_uint g_scan_kernel;
+
+static const ScanKernel* SelectedScanKernel(void) {
+    unsigned selected = atomic_load_explicit(&g_scan_kernel, memory_order_relaxed);
+    if (selected == 0) {
+        while (!kScanKernels[selected].supported()) {
+            selected++;
+        }
+        selected++;
+        atomic_store_explicit(&g_scan_kernel, selected, memory_order_relaxed);
+    }
+    return &kScanKernels[selected - 1];
+}
+
+const char* ScanKernelName(void) {
+    return SelectedScanKernel()->name;
+}
+
+bool UseScanKernel(const char* name) {
+    for (unsigned i = 0; i < SCAN_KERNEL_COUNT; i++) {
+        if (strcmp(kScanKernels[i].name, name) == 0 && kScanKernels[i].supported()) {
+            atomic_store_explicit(&g_scan_kernel, i + 1, memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Start a scan; with a layout, characters it cannot produce are counted too
+void InitializeTextScanner(TextScanner* scanner, const KeyLayout* layout) {
+    memset(scanner, 0, sizeof(*scanner));
+    scanner->scan.first_control = SCAN_NONE;
+    scanner->scan.first_invalid = SCAN_NONE;
+    scanner->scan.first_unmappable = SCAN_NONE;
+    scanner->layout = layout;
+    scanner->after_space = true;
+    InitializeUtf8Decoder(&scanner->decoder);
+
+    KeyEvent key;
+    for (uint32_t cp = 0x20; layout && cp < 0x7F && !scanner->check_ascii; cp++) {
+        scanner->check_ascii = !LookupLayout(layout, cp, &key);
+    }
+    scanner->check_ascii = scanner->check_ascii || (layout && !LookupLayout(layout, '\t', &key));
+}
+
+// Feed the next piece of the text: whole blocks go to the fastest kernel the
+// CPU supports, the rest is classified one byte at a time
+void ScanText(TextScanner* scanner, const char* text, size_t length) {
+    const uint8_t* data = (const uint8_t*)text;
+    size_t blocks = length / SCAN_BLOCK_SIZE;
+    if (blocks) {
+        SelectedScanKernel()->scan(scanner, data, blocks);
+    }
+
+    size_t tail = length % SCAN_BLOCK_SIZE;
+    if (tail) {
+        ScanMasks m;
+        ClassifyScalar(data + blocks * SCAN_BLOCK_SIZE, tail, &m);
+        AccumulateBlock(scanner, &m, data + blocks * SCAN_BLOCK_SIZE, tail);
+    }
+}
+
+// Close the scan: a sequence still open is malformed, and a last line
+// without a line break still counts
+void FinishTextScan(TextScanner* scanner, TextScan* out) {
+    if (scanner->decoder.remaining) {
+        NoteProblem(&scanner->scan.invalid_sequences, &scanner->scan.first_invalid, scanner->scan.bytes);
+        InitializeUtf8Decoder(&scanner->decoder);
+    }
+    *out = scanner->scan;
+    if (out->bytes && !scanner->after_break) {
+        out->lines++;
+    }
+}
+
+void ScanBuffer(const char* text, size_t length, const KeyLayout* layout, TextScan* out) {
+    TextScanner scanner;
+    InitializeTextScanner(&scanner, layout);
+    ScanText(&scanner, text, length);
+    FinishTextScan(&scanner, out);
+}
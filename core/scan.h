@@ -0,0 +1,69 @@
+#ifndef HUMANIZER_CORE_SCAN_H
+#define HUMANIZER_CORE_SCAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "utf8.h"
+#include "layout.h"
+
+// Bytes classified per step of the scan kernels
+#define SCAN_BLOCK_SIZE 64
+
+// Offset recorded when a problem never occurs
+#define SCAN_NONE UINT64_MAX
+
+// What one pass over a text found. Counts follow the planner's rules: words are
+// runs of non-whitespace, CRLF is one character and one line break.
+typedef struct {
+    uint64_t bytes;
+    uint64_t chars;               // Characters the planner will type or skip
+    uint64_t letters;             // ASCII and Latin-1 letters (the keys typos are planned for)
+    uint64_t words;
+    uint64_t word_gaps;           // Whitespace right after a word (where thinking pauses fall)
+    uint64_t sentence_gaps;       // ...of those, the ones after . ! or ?
+    uint64_t lines;
+    uint64_t paragraphs;          // Runs of lines with text, split by blank lines
+    uint64_t control_chars;       // C0 controls other than tab and line breaks, and DEL
+    uint64_t invalid_sequences;   // Malformed UTF-8 (each becomes one skipped character)
+    uint64_t unmappable_chars;    // Valid characters the layout cannot produce
+    uint64_t first_control;       // Byte offsets of the first of each problem, or SCAN_NONE
+    uint64_t first_invalid;
+    uint64_t first_unmappable;
+} TextScan;
+
+// Incremental scanner: text can be fed in pieces of any size
+typedef struct {
+    TextScan scan;
+    const KeyLayout* layout;      // Layout checked for unmappable characters, NULL to skip
+    bool check_ascii;             // Layout misses printable ASCII, so every byte is looked up
+    Utf8Decoder decoder;          // Sequence left open by the previous piece
+    uint64_t breaks;              // Line breaks since the last non-whitespace character
+    bool after_space;             // Previous byte was whitespace (true at the start)
+    bool after_content;           // Previous byte was not whitespace
+    bool after_punct;             // Previous byte was . ! or ?
+    bool after_cr;                // Previous byte was '\r'
+    bool after_break;             // Previous byte ended a line
+} TextScanner;
+
+// Whitespace as the planner sees it: the ASCII characters isspace() accepts in
+// the C locale (space, \t, \n, \v, \f, \r)
+static inline bool IsWordSeparator(uint32_t codepoint) {
+    return codepoint == ' ' || (codepoint >= '\t' && codepoint <= '\r');
+}
+
+void InitializeTextScanner(TextScanner* scanner, const KeyLayout* layout);
+void ScanText(TextScanner* scanner, const char* text, size_t length);
+void FinishTextScan(TextScanner* scanner, TextScan* out);
+
+// Scan a whole buffer in one call
+void ScanBuffer(const char* text, size_t length, const KeyLayout* layout, TextScan* out);
+
+// Name of the kernel in use ("avx2", "sse2" or "scalar")
+const char* ScanKernelName(void);
+
+// Force a kernel by name (for benchmarks and tests); false if this CPU lacks it
+bool UseScanKernel(const char* name);
+
+#endif // HUMANIZER_CORE_SCAN_H
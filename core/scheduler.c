@@ -0,0 +1,559 @@
+#define _GNU_SOURCE
+
+#include "humanizer.h"
+#include "scheduler.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/prctl.h>
+
+#define STREAM_PROGRESS_NS (1000000000ULL / STATS_REFRESH_HZ)
+
+// One typing session driven by a scheduler thread
+typedef struct TypingStream {
+    struct TypingStream* next_new; // Inbox link until the thread adopts the stream
+    TypingSimulator* simulator;    // Sink, settings, plan storage and live counters
+    TextSource* source;
+    StreamDoneFn done;
+    void* context;
+    KeyPlanner planner;
+    const char* chunk;             // Source text not planned yet
+    size_t chunk_length;
+    bool planned_all;              // The source is exhausted and the plan finished
+    size_t next;                   // Next event of simulator->plan to emit
+    uint64_t origin_ns;            // Monotonic time plan timestamps are relative to (moves forward after pauses)
+    uint64_t deadline_ns;          // When the stream needs the thread next (heap key)
+    uint64_t paused_ns;            // When the current pause began, 0 while typing
+    uint64_t started_ns;           // When the stream was scheduled
+    size_t keystrokes;
+    uint64_t last_ns;              // Planned time of the last emitted keystroke
+    TypingMeter meter;
+} TypingStream;
+
+// One thread of the pool with the streams it owns
+typedef struct {
+    TypingScheduler* scheduler;
+    pthread_mutex_t lock;          // Guards inbox and stopping
+    pthread_cond_t wake;           // Signalled when a stream arrives or the scheduler stops
+    TypingStream* inbox;           // Streams handed over but not yet in the heap
+    bool stopping;
+    TypingStream** heap;           // Min-heap on deadline_ns, owned by the thread
+    size_t count;
+    size_t capacity;
+    atomic_size_t load;            // Streams assigned and not yet done
+    LatencyHistogram lateness;     // Emission time minus deadline of every keystroke
+    HumanizerThread thread;
+    bool started;
+} SchedulerThread;
+
+struct TypingScheduler {
+    SchedulerThread* threads;
+    size_t thread_count;
+    pthread_mutex_t lock;          // Guards active
+    pthread_cond_t idle;           // Signalled when active drops to 0
+    size_t active;                 // Streams scheduled and not yet done
+};
+
+static inline bool StreamBefore(const TypingStream* a, const TypingStream* b) {
+    return a->deadline_ns < b->deadline_ns;
+}
+
+static void HeapSiftUp(SchedulerThread* thread, size_t index) {
+    TypingStream** heap = thread->heap;
+    TypingStream* stream = heap[index];
+    while (index > 0) {
+        size_t parent = (index - 1) / SCHEDULER_HEAP_ARITY;
+        if (!StreamBefore(stream, heap[parent])) {
+            break;
+        }
+        heap[index] = heap[parent];
+        index = parent;
+    }
+    heap[index] = stream;
+}
+
+static void HeapSiftDown(SchedulerThread* thread, size_t index) {
+    TypingStream** heap = thread->heap;
+    TypingStream* stream = heap[index];
+    while (true) {
+        size_t first = index * SCHEDULER_HEAP_ARITY + 1;
+        if (first >= thread->count) {
+            break;
+        }
+        size_t last = first + SCHEDULER_HEAP_ARITY < thread->count ? first + SCHEDULER_HEAP_ARITY : thread->count;
+        size_t best = first;
+        for (size_t child = first + 1; child < last; child++) {
+            if (StreamBefore(heap[child], heap[best])) {
+                best = child;
+            }
+        }
+        if (!StreamBefore(heap[best], stream)) {
+            break;
+        }
+        heap[index] = heap[best];
+        index = best;
+    }
+    heap[index] = stream;
+}
+
+static bool HeapPush(SchedulerThread* thread, TypingStream* stream) {
+    if (thread->count == thread->capacity) {
+        size_t capacity = thread->capacity ? thread->capacity * 2 : 64;
+        TypingStream** heap = (TypingStream**)realloc(thread->heap, capacity * sizeof(TypingStream*));
+        if (!heap) {
+            return false;
+        }
+        thread->heap = heap;
+        thread->capacity = capacity;
+    }
+    thread->heap[thread->count++] = stream;
+    HeapSiftUp(thread, thread->count - 1);
+    return true;
+}
+
+static void HeapPopTop(SchedulerThread* thread) {
+    thread->heap[0] = thread->heap[--thread->count];
+    if (thread->count > 0) {
+        HeapSiftDown(thread, 0);
+    }
+}
+
+// Plan the next piece of text into the stream's plan. Reads one chunk ahead
+// so the last piece is finished (final word end, held-back bytes) before it
+// is emitted. False once everything is planned and emitted, or on failure
+// with *error set.
+static bool PlanNextPiece(TypingStream* stream, const char** error) {
+    KeyPlan* plan = &stream->simulator->plan;
+    ClearPlan(plan);
+    stream->next = 0;
+
+    while (plan->count == 0) {
+        if (stream->planned_all) {
+            return false;
+        }
+        size_t piece = stream->chunk_length < STREAM_PLAN_BYTES ? stream->chunk_length : STREAM_PLAN_BYTES;
+        if (!PlanText(&stream->planner, plan, stream->chunk, piece)) {
+            *error = "Out of memory";
+            return false;
+        }
+        stream->chunk += piece;
+        stream->chunk_length -= piece;
+
+        if (stream->chunk_length == 0 && !stream->source->Next(stream->source, &stream->chunk, &stream->chunk_length)) {
+            stream->planned_all = true;
+            if (!FinishPlan(&stream->planner, plan)) {
+                *error = "Out of memory";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Handle a pause or stop request at the stream's deadline. False if the
+// stream must end; otherwise *wait tells whether it is (still) paused and the
+// deadline was moved.
+static bool FollowControl(TypingStream* stream, uint64_t now_ns, bool* wait, const char** error) {
+    RunControl* control = stream->simulator->control;
+    LiveTypingStats* live = &stream->simulator->live;
+    *wait = false;
+    if (!control) {
+        return true;
+    }
+
+    RunState state = GetRunState(control);
+    if (state == RUN_STATE_STOPPED) {
+        *error = "Cancelled";
+        return false;
+    }
+    if (state == RUN_STATE_PAUSED) {
+        if (!stream->paused_ns) {
+            stream->paused_ns = now_ns;
+            atomic_store_explicit(&live->paused_ns, now_ns, memory_order_release);
+        }
+        stream->deadline_ns = now_ns + STREAM_PAUSE_POLL_NS;
+        *wait = true;
+        return true;
+    }
+    if (stream->paused_ns) {
+        // Freeze the timeline over the pause, as WaitOnTimeline does
+        stream->origin_ns += now_ns - stream->paused_ns;
+        stream->paused_ns = 0;
+        atomic_store_explicit(&live->start_ns, stream->origin_ns, memory_order_release);
+        atomic_store_explicit(&live->paused_ns, 0, memory_order_release);
+        stream->deadline_ns = stream->origin_ns + stream->simulator->plan.events[stream->next].time_ns;
+        *wait = stream->deadline_ns > now_ns;
+    }
+    return true;
+}
+
+// Emit the stream's due keystroke and move its deadline to the next one.
+// False when the stream has ended (*error is NULL if it typed everything).
+static bool AdvanceStream(SchedulerThread* thread, TypingStream* stream, uint64_t now_ns, const char** error) {
+    TypingSimulator* simulator = stream->simulator;
+    const KeyPlan* plan = &simulator->plan;
+    if (stream->next >= plan->count) {
+        return false;
+    }
+
+    bool wait;
+    if (!FollowControl(stream, now_ns, &wait, error)) {
+        return false;
+    }
+    if (wait) {
+        return true;
+    }
+
+    const KeyEvent* keystroke = &plan->events[stream->next];
+    size_t count = PlanGroupLength(plan, stream->next);
+    if (keystroke->flags & KEY_EVENT_HOLD) {
+        if (simulator->control && simulator->resumable) {
+            RequestPause(simulator->control);
+        }
+    } else {
+        // Keystrokes already due, or due within the coalescing window, ride
+        // along in one sink call
+        size_t burst = count;
+        if (simulator->coalesce_ns) {
+            uint64_t late_ns = now_ns > stream->deadline_ns ? now_ns - stream->deadline_ns : 0;
+            burst = PlanBurstLength(plan, stream->next, keystroke->time_ns + late_ns + simulator->coalesce_ns,
+                                    EMIT_BURST_EVENTS);
+        }
+        RecordLatency(&thread->lateness, now_ns - stream->deadline_ns);
+        if (!simulator->sink->Emit(simulator->sink, keystroke, burst)) {
+            *error = "Stopped early (sink rejected a keystroke)";
+            return false;
+        }
+        for (size_t end = stream->next + burst; stream->next < end; stream->next += count) {
+            keystroke = &plan->events[stream->next];
+            count = PlanGroupLength(plan, stream->next);
+            stream->last_ns = keystroke->time_ns;
+            stream->keystrokes++;
+            RecordKeystroke(&stream->meter, &simulator->live, keystroke->time_ns, keystroke->flags);
+        }
+        count = 0;
+    }
+
+    stream->next += count;
+    if (stream->next >= plan->count && !PlanNextPiece(stream, error)) {
+        return false;
+    }
+    stream->deadline_ns = stream->origin_ns + plan->events[stream->next].time_ns;
+    return true;
+}
+
+// Report the outcome, hand the stream back to its owner and free it
+static void FinishStream(SchedulerThread* thread, TypingStream* stream, const char* error) {
+    TypingSimulator* simulator = stream->simulator;
+    if (!error && stream->source->failed) {
+        error = "Failed to read the rest of the input";
+    }
+    UpdateTypingStats(&simulator->stats, &simulator->live);
+
+    TypingReport report;
+    memset(&report, 0, sizeof(report));
+    report.keystrokes = stream->keystrokes;
+    report.chars_typed = stream->meter.chars_typed;
+    report.words_typed = stream->meter.words_typed;
+    report.typos = stream->planner.typos;
+    report.unmapped_chars = stream->planner.unmapped_chars;
+    report.planned_ns = stream->last_ns;
+    report.wall_ns = MonotonicNowNs() - stream->started_ns;
+    report.target_wpm = simulator->target_wpm;
+    report.error = error;
+
+    stream->done(simulator, &report, stream->context);
+    free(stream);
+    atomic_fetch_sub_explicit(&thread->load, 1, memory_order_relaxed);
+
+    TypingScheduler* scheduler = thread->scheduler;
+    pthread_mutex_lock(&scheduler->lock);
+    if (--scheduler->active == 0) {
+        pthread_cond_broadcast(&scheduler->idle);
+    }
+    pthread_mutex_unlock(&scheduler->lock);
+}
+
+// Hand every stream's statistics to its progress receiver
+static void ReportStreamProgress(SchedulerThread* thread) {
+    for (size_t i = 0; i < thread->count; i++) {
+        TypingSimulator* simulator = thread->heap[i]->simulator;
+        if (simulator->progress) {
+            TypingStats stats;
+            UpdateTypingStats(&stats, &simulator->live);
+            simulator->progress(&stats, simulator->progress_context);
+        }
+    }
+}
+
+// Move newly scheduled streams into the heap; the caller holds thread->lock.
+// Streams that do not fit are returned through *rejected.
+static void AdoptStreams(SchedulerThread* thread, TypingStream** rejected) {
+    while (thread->inbox) {
+        TypingStream* stream = thread->inbox;
+        thread->inbox = stream->next_new;
+        if (!HeapPush(thread, stream)) {
+            stream->next_new = *rejected;
+            *rejected = stream;
+        }
+    }
+}
+
+// Sleep until deadline_ns (UINT64_MAX: indefinitely) or until signalled; the
+// caller holds thread->lock
+static void WaitForWork(SchedulerThread* thread, uint64_t deadline_ns) {
+    if (deadline_ns == UINT64_MAX) {
+        pthread_cond_wait(&thread->wake, &thread->lock);
+        return;
+    }
+    struct timespec ts;
+    ts.tv_sec = (time_t)(deadline_ns / 1000000000ULL);
+    ts.tv_nsec = (long)(deadline_ns % 1000000000ULL);
+    pthread_cond_timedwait(&thread->wake, &thread->lock, &ts);
+}
+
+// Advance the stream with the earliest deadline at now_ns and sift it back
+// into place, or take it out of the heap if it ended
+static void RunEarliestStream(SchedulerThread* thread, uint64_t now_ns) {
+    TypingStream* stream = thread->heap[0];
+    const char* error = NULL;
+    if (AdvanceStream(thread, stream, now_ns, &error)) {
+        HeapSiftDown(thread, 0);
+    } else {
+        HeapPopTop(thread);
+        FinishStream(thread, stream, error);
+    }
+}
+
+static void SchedulerThreadMain(void* arg) {
+    SchedulerThread* thread = (SchedulerThread*)arg;
+
+    // The default 50 us slack would make every keystroke that late; with 1 ns
+    // the timer fires on time and the thread never needs to spin
+    prctl(PR_SET_TIMERSLACK, 1UL, 0, 0, 0);
+
+    uint64_t next_progress_ns = MonotonicNowNs() + STREAM_PROGRESS_NS;
+    while (true) {
+        TypingStream* rejected = NULL;
+        pthread_mutex_lock(&thread->lock);
+        AdoptStreams(thread, &rejected);
+        bool stopping = thread->stopping;
+        if (!stopping && !rejected) {
+            uint64_t wake_ns = thread->count ? thread->heap[0]->deadline_ns : UINT64_MAX;
+            if (thread->count && next_progress_ns < wake_ns) {
+                wake_ns = next_progress_ns;
+            }
+            if (MonotonicNowNs() < wake_ns) {
+                WaitForWork(thread, wake_ns);
+                AdoptStreams(thread, &rejected);
+                stopping = thread->stopping;
+            }
+        }
+        pthread_mutex_unlock(&thread->lock);
+
+        while (rejected) {
+            TypingStream* stream = rejected;
+            rejected = stream->next_new;
+            FinishStream(thread, stream, "Out of memory");
+        }
+        if (stopping) {
+            break;
+        }
+
+        uint64_t now_ns = MonotonicNowNs();
+        while (thread->count && thread->heap[0]->deadline_ns <= now_ns) {
+            RunEarliestStream(thread, now_ns);
+            now_ns = MonotonicNowNs();
+        }
+
+        if (now_ns >= next_progress_ns) {
+            ReportStreamProgress(thread);
+            next_progress_ns = now_ns + STREAM_PROGRESS_NS;
+        }
+    }
+
+    // Shutting down: cancel whatever is left
+    while (thread->count) {
+        TypingStream* stream = thread->heap[0];
+        HeapPopTop(thread);
+        FinishStream(thread, stream, "Cancelled");
+    }
+    pthread_mutex_lock(&thread->lock);
+    TypingStream* left = thread->inbox;
+    thread->inbox = NULL;
+    pthread_mutex_unlock(&thread->lock);
+    while (left) {
+        TypingStream* stream = left;
+        left = stream->next_new;
+        FinishStream(thread, stream, "Cancelled");
+    }
+}
+
+TypingScheduler* CreateTypingScheduler(size_t threads) {
+    if (threads == 0 || threads > SCHEDULER_MAX_THREADS) {
+        printf(ANSI_COLOR_RED "Error: Thread count must be between 1 and %d\n" ANSI_COLOR_RESET, SCHEDULER_MAX_THREADS);
+        return NULL;
+    }
+
+    TypingScheduler* scheduler = (TypingScheduler*)calloc(1, sizeof(TypingScheduler));
+    SchedulerThread* pool = (SchedulerThread*)calloc(threads, sizeof(SchedulerThread));
+    if (!scheduler || !pool) {
+        printf(ANSI_COLOR_RED "Error: Memory allocation failed\n" ANSI_COLOR_RESET);
+        free(scheduler);
+        free(pool);
+        return NULL;
+    }
+    scheduler->threads = pool;
+    pthread_mutex_init(&scheduler->lock, NULL);
+    pthread_cond_init(&scheduler->idle, NULL);
+
+    // Timed waits take absolute CLOCK_MONOTONIC deadlines, the clock of MonotonicNowNs
+    pthread_condattr_t attributes;
+    pthread_condattr_init(&attributes);
+    pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+
+    for (size_t i = 0; i < threads; i++) {
+        SchedulerThread* thread = &pool[i];
+        thread->scheduler = scheduler;
+        pthread_mutex_init(&thread->lock, NULL);
+        pthread_cond_init(&thread->wake, &attributes);
+        atomic_init(&thread->load, 0);
+        thread->lateness.min = UINT64_MAX;
+        thread->started = StartThread(&thread->thread, SchedulerThreadMain, thread);
+        scheduler->thread_count++;
+        if (!thread->started) {
+            printf(ANSI_COLOR_RED "Error: Could not start scheduler thread %zu\n" ANSI_COLOR_RESET, i);
+            pthread_condattr_destroy(&attributes);
+            DestroyTypingScheduler(scheduler);
+            return NULL;
+        }
+    }
+    pthread_condattr_destroy(&attributes);
+    return scheduler;
+}
+
+// Read and plan the first piece of source into a new stream whose timeline
+// starts at origin_ns; NULL (with the error printed) on failure
+static TypingStream* CreateStream(TypingSimulator* simulator, TextSource* source, uint64_t origin_ns,
+                                  StreamDoneFn done, void* context) {
+    TypingStream* stream = (TypingStream*)malloc(sizeof(TypingStream));
+    if (!stream) {
+        printf(ANSI_COLOR_RED "Error: Memory allocation failed\n" ANSI_COLOR_RESET);
+        return NULL;
+    }
+    memset(stream, 0, offsetof(TypingStream, meter));
+    ResetTypingMeter(&stream->meter);
+    stream->simulator = simulator;
+    stream->source = source;
+    stream->done = done;
+    stream->context = context;
+    InitializeSimulatorPlanner(simulator, &stream->planner);
+
+    if (!source->Next(source, &stream->chunk, &stream->chunk_length)) {
+        printf(ANSI_COLOR_RED "Error: %s\n" ANSI_COLOR_RESET, source->failed ? "Failed to read input" : "No text to type");
+        free(stream);
+        return NULL;
+    }
+    const char* error = NULL;
+    if (!PlanNextPiece(stream, &error) && error) {
+        printf(ANSI_COLOR_RED "Error: %s\n" ANSI_COLOR_RESET, error);
+        free(stream);
+        return NULL;
+    }
+
+    ResetLiveTypingStats(&simulator->live);
+    simulator->stats.start_time = time(NULL);
+    stream->started_ns = MonotonicNowNs();
+    stream->origin_ns = origin_ns;
+    atomic_store_explicit(&simulator->live.start_ns, stream->origin_ns, memory_order_release);
+    stream->deadline_ns = stream->origin_ns + (simulator->plan.count ? simulator->plan.events[0].time_ns : 0);
+    return stream;
+}
+
+// Type source on the least loaded thread, starting delay_ns from now
+bool ScheduleTyping(TypingScheduler* scheduler, TypingSimulator* simulator, TextSource* source,
+                    uint64_t delay_ns, StreamDoneFn done, void* context) {
+    TypingStream* stream = CreateStream(simulator, source, MonotonicNowNs() + delay_ns, done, context);
+    if (!stream) {
+        return false;
+    }
+
+    SchedulerThread* thread = &scheduler->threads[0];
+    for (size_t i = 1; i < scheduler->thread_count; i++) {
+        if (atomic_load_explicit(&scheduler->threads[i].load, memory_order_relaxed) <
+            atomic_load_explicit(&thread->load, memory_order_relaxed)) {
+            thread = &scheduler->threads[i];
+        }
+    }
+
+    pthread_mutex_lock(&scheduler->lock);
+    scheduler->active++;
+    pthread_mutex_unlock(&scheduler->lock);
+    atomic_fetch_add_explicit(&thread->load, 1, memory_order_relaxed);
+
+    pthread_mutex_lock(&thread->lock);
+    stream->next_new = thread->inbox;
+    thread->inbox = stream;
+    pthread_cond_signal(&thread->wake);
+    pthread_mutex_unlock(&thread->lock);
+    return true;
+}
+
+void WaitForTypingStreams(TypingScheduler* scheduler) {
+    pthread_mutex_lock(&scheduler->lock);
+    while (scheduler->active > 0) {
+        pthread_cond_wait(&scheduler->idle, &scheduler->lock);
+    }
+    pthread_mutex_unlock(&scheduler->lock);
+}
+
+// Sum the per-thread histograms; waiting on the scheduler lock orders this
+// after the updates of every stream that has finished
+void GetSchedulerLateness(TypingScheduler* scheduler, LatencyHistogram* out) {
+    memset(out, 0, sizeof(*out));
+    out->min = UINT64_MAX;
+
+    pthread_mutex_lock(&scheduler->lock);
+    for (size_t t = 0; t < scheduler->thread_count; t++) {
+        const LatencyHistogram* lateness = &scheduler->threads[t].lateness;
+        for (size_t i = 0; i < LATENCY_BUCKETS; i++) {
+            out->counts[i] += lateness->counts[i];
+        }
+        out->count += lateness->count;
+        out->total += lateness->total;
+        if (lateness->min < out->min) {
+            out->min = lateness->min;
+        }
+        if (lateness->max > out->max) {
+            out->max = lateness->max;
+        }
+    }
+    pthread_mutex_unlock(&scheduler->lock);
+}
+
+void DestroyTypingScheduler(TypingScheduler* scheduler) {
+    if (!scheduler) {
+        return;
+    }
+    for (size_t i = 0; i < scheduler->thread_count; i++) {
+        SchedulerThread* thread = &scheduler->threads[i];
+        pthread_mutex_lock(&thread->lock);
+        thread->stopping = true;
+        pthread_cond_signal(&thread->wake);
+        pthread_mutex_unlock(&thread->lock);
+    }
+    for (size_t i = 0; i < scheduler->thread_count; i++) {
+        SchedulerThread* thread = &scheduler->threads[i];
+        if (thread->started) {
+            JoinThread(&thread->thread);
+        }
+        pthread_cond_destroy(&thread->wake);
+        pthread_mutex_destroy(&thread->lock);
+        free(thread->heap);
+    }
+    pthread_cond_destroy(&scheduler->idle);
+    pthread_mutex_destroy(&scheduler->lock);
+    free(scheduler->threads);
+    free(scheduler);
+}
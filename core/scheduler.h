@@ -0,0 +1,71 @@
+#ifndef HUMANIZER_CORE_SCHEDULER_H
+#define HUMANIZER_CORE_SCHEDULER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "humanizer.h"
+
+// Many typing sessions multiplexed onto a small pool of threads (scheduler.c,
+// Linux only). Each thread owns its streams and keeps them in a 4-ary min-heap
+// keyed by the deadline of their next keystroke; it sleeps until the earliest
+// one (with a 1 ns timer slack, so without spinning), emits it, plans a little
+// more text if the stream needs it and sifts the stream back into place. A
+// thread with thousands of streams only ever touches the few that are due.
+
+#define SCHEDULER_MAX_THREADS 64
+#define SCHEDULER_DEFAULT_THREADS 2
+#define SCHEDULER_HEAP_ARITY 4
+#define STREAM_PLAN_BYTES 512           // Text planned per refill, so one stream never holds up the others for long
+#define STREAM_PAUSE_POLL_NS 50000000ULL // How often a paused stream checks whether it may go on
+
+typedef struct TypingScheduler TypingScheduler;
+
+// Called on a scheduler thread when a stream ends; report->error is NULL if
+// the whole text was typed. The simulator and source may be released here.
+typedef void (*StreamDoneFn)(TypingSimulator* simulator, const TypingReport* report, void* context);
+
+// Start threads (1 to SCHEDULER_MAX_THREADS) that run streams; NULL on failure
+TypingScheduler* CreateTypingScheduler(size_t threads);
+
+// Type source with simulator's sink, speed, humanize model, seed and control,
+// starting delay_ns from now. The first piece of text is read and planned on
+// the calling thread, so empty input fails here. Progress goes to
+// simulator->progress about STATS_REFRESH_HZ times a second. {PAUSE} waits
+// only if simulator->resumable. The simulator and source must stay valid
+// until done is called.
+bool ScheduleTyping(TypingScheduler* scheduler, TypingSimulator* simulator, TextSource* source,
+                    uint64_t delay_ns, StreamDoneFn done, void* context);
+
+// Block until every scheduled stream has ended
+void WaitForTypingStreams(TypingScheduler* scheduler);
+
+// How late each keystroke went out, merged over all threads (call once the streams have ended)
+void GetSchedulerLateness(TypingScheduler* scheduler, LatencyHistogram* out);
+
+// Cancel the streams still running (their done callbacks report "Cancelled"),
+// stop the threads and free the scheduler
+void DestroyTypingScheduler(TypingScheduler* scheduler);
+
+// Load test configuration (loadtest.c)
+typedef struct {
+    const char* path;          // Text every stream types
+    size_t streams;            // Concurrent typing sessions
+    size_t threads;            // Scheduler threads
+    bool null_sink;            // Discard keystrokes instead of creating one uinput device per stream
+    const char* device_prefix; // Stream n types on the device "<prefix>-<n>"
+    bool unicode_input;        // Passed to OpenUinputSink
+    double wpm;
+    bool steady;               // Evenly spaced keystrokes, no humanization
+    bool directives;
+    uint64_t seed;             // Stream n uses seed + n
+    double spread_seconds;     // Starts are spread evenly over this span
+    uint64_t coalesce_ns;      // TypingSimulator.coalesce_ns of every stream
+} LoadTestOptions;
+
+// Type the same text on many streams at once and report keystroke lateness
+// and CPU use; returns the process exit code
+int RunLoadTest(const LoadTestOptions* options);
+
+#endif // HUMANIZER_CORE_SCHEDULER_H
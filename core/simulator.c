@@ -0,0 +1,695 @@
+#include "humanizer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Initialize the typing simulator with default values
+void InitializeSimulator(TypingSimulator* simulator, KeySink* sink, double target_wpm) {
+    simulator->text = NULL;
+    simulator->length = 0;
+    memset(&simulator->stats, 0, sizeof(simulator->stats));
+    ResetLiveTypingStats(&simulator->live);
+    simulator->sink = sink;
+    simulator->target_wpm = target_wpm;
+    simulator->plan_listing = NULL;
+    simulator->record_path = NULL;
+    simulator->latency = NULL;
+    InitializePlan(&simulator->plan);
+
+    HumanizeProfile profile;
+    DefaultHumanizeProfile(&profile);
+    BuildHumanizeModel(&simulator->humanize, &profile);
+    simulator->humanized = true;
+    simulator->seed = (uint64_t)time(NULL) ^ MonotonicNowNs();
+    simulator->progress = NULL;
+    simulator->progress_context = NULL;
+    simulator->control = NULL;
+    simulator->resumable = false;
+    simulator->directives = false;
+    simulator->realtime = false;
+    simulator->emitter_cpu = -1;
+    simulator->coalesce_ns = 0;
+}
+
+// Set up a planner for the simulator's sink, speed and humanization settings
+void InitializeSimulatorPlanner(TypingSimulator* simulator, KeyPlanner* planner) {
+    InitializePlanner(planner, simulator->sink, simulator->target_wpm,
+                      simulator->humanized ? &simulator->humanize : NULL, simulator->seed);
+    planner->directives = simulator->directives;
+}
+
+// Clean up resources used by the simulator
+void CleanupSimulator(TypingSimulator* simulator) {
+    if (simulator->text) {
+        free(simulator->text);
+        simulator->text = NULL;
+    }
+    simulator->length = 0;
+    CleanupPlan(&simulator->plan);
+}
+
+// Emission state shared by every plan chunk of one typing session
+typedef struct {
+    uint64_t start_ns;     // Monotonic time planned timestamps are relative to
+    TypingMeter meter;     // Characters, words and typos emitted so far, with recent timing
+    size_t keystrokes;     // Keystrokes emitted so far, corrections included
+    bool virtual_clock;    // Emit immediately instead of waiting for each deadline (dry run)
+    DelayHistogram* delays; // Optional record of the planned spacing between keystrokes
+    uint64_t last_ns;      // Planned time of the previous keystroke
+    TraceWriter* trace;    // Records every planned event when set
+    LatencyTracer* latency; // Times every keystroke when set
+    StatsRenderer renderer;
+} TypingSession;
+
+// Reset the counters, fix the time origin and start the stats renderer.
+// Headless sessions only render when the simulator has a progress receiver.
+static void BeginTypingSession(TypingSimulator* simulator, TypingSession* session, bool headless) {
+    LiveTypingStats* live = &simulator->live;
+
+    ResetTypingMeter(&session->meter);
+    session->keystrokes = 0;
+    session->virtual_clock = false;
+    session->delays = NULL;
+    session->last_ns = 0;
+    session->trace = NULL;
+    session->latency = simulator->latency;
+    if (session->latency) {
+        ResetLatencyTracer(session->latency);
+    }
+    ResetLiveTypingStats(live);
+    simulator->stats.start_time = time(NULL);
+    session->start_ns = MonotonicNowNs();
+    atomic_store_explicit(&live->start_ns, session->start_ns, memory_order_release);
+
+    session->renderer.running = false;
+    if (!headless) {
+        StartStatsRenderer(&session->renderer, live, STATS_REFRESH_HZ, NULL, NULL);
+    } else if (simulator->progress) {
+        StartStatsRenderer(&session->renderer, live, STATS_REFRESH_HZ, simulator->progress, simulator->progress_context);
+    }
+}
+
+// Wait until offset_ns past *origin_ns. A pause freezes the timeline: the
+// origin moves forward by the time spent paused, so what follows keeps its
+// spacing, and live (if set) sees the pause and the new origin. False if
+// typing was stopped.
+static bool WaitOnTimeline(RunControl* control, LiveTypingStats* live, uint64_t* origin_ns, uint64_t offset_ns) {
+    if (!control) {
+        SleepUntilNs(*origin_ns + offset_ns);
+        return true;
+    }
+
+    while (true) {
+        RunState state = WaitForDeadline(control, *origin_ns + offset_ns);
+        if (state != RUN_STATE_PAUSED) {
+            return state == RUN_STATE_RUNNING;
+        }
+        uint64_t paused_ns = MonotonicNowNs();
+        if (live) {
+            atomic_store_explicit(&live->paused_ns, paused_ns, memory_order_release);
+        }
+        if (WaitWhilePaused(control) == RUN_STATE_STOPPED) {
+            return false;
+        }
+        *origin_ns += MonotonicNowNs() - paused_ns;
+        if (live) {
+            atomic_store_explicit(&live->start_ns, *origin_ns, memory_order_release);
+            atomic_store_explicit(&live->paused_ns, 0, memory_order_release);
+        }
+    }
+}
+
+// Whether the simulator's control asked typing to stop
+static bool StopRequested(TypingSimulator* simulator) {
+    return simulator->control && GetRunState(simulator->control) == RUN_STATE_STOPPED;
+}
+
+// Clear any stop left over from the previous session
+static void ResetControl(TypingSimulator* simulator) {
+    if (simulator->control) {
+        SetRunState(simulator->control, RUN_STATE_RUNNING);
+    }
+}
+
+// Emit a compiled plan, one keystroke (events sharing a timestamp) at a time.
+// Every keystroke waits for its absolute deadline, so time spent emitting is
+// absorbed instead of accumulating as drift; on the virtual clock of a dry run
+// it goes out immediately. With simulator->coalesce_ns set, the keystrokes
+// already due when the loop wakes, or due within coalesce_ns of that moment,
+// go out in the same sink call: a late emitter catches up in one system call
+// instead of one per key, while one on time sends only what it would
+// otherwise spin through. Waits end early when the simulator's control pauses
+// or stops typing. Console output happens on the stats renderer
+// thread; this loop only publishes counters. EmitPlan instantiates it with and
+// without a tracer, so the untraced loop carries no timing code at all.
+static inline bool EmitKeystrokes(TypingSimulator* simulator, TypingSession* session, const KeyPlan* plan,
+                                  LatencyTracer* latency) {
+    KeySink* sink = simulator->sink;
+    LiveTypingStats* live = &simulator->live;
+
+    for (size_t i = 0; i < plan->count;) {
+        const KeyEvent* keystroke = &plan->events[i];
+        size_t count = PlanGroupLength(plan, i);
+
+        if (session->virtual_clock) {
+            if (StopRequested(simulator)) {
+                return false;
+            }
+        } else if (!WaitOnTimeline(simulator->control, live, &session->start_ns, keystroke->time_ns)) {
+            return false;
+        }
+
+        if (keystroke->flags & KEY_EVENT_HOLD) {
+            // {PAUSE}: the next wait blocks until someone resumes typing
+            if (simulator->control && simulator->resumable && !session->virtual_clock) {
+                RequestPause(simulator->control);
+            }
+            i += count;
+            continue;
+        }
+
+        // The window runs from the actual wake time, so it widens with lateness
+        size_t burst = count;
+        if (simulator->coalesce_ns) {
+            uint64_t now_ns = session->virtual_clock ? keystroke->time_ns : MonotonicNowNs() - session->start_ns;
+            burst = PlanBurstLength(plan, i, (now_ns > keystroke->time_ns ? now_ns : keystroke->time_ns) +
+                                             simulator->coalesce_ns, EMIT_BURST_EVENTS);
+        }
+
+        LatencySample sample;
+        if (latency) {
+            sample.woke_ns = MonotonicNowNs() - session->start_ns;
+        }
+
+        if (!sink->Emit(sink, keystroke, burst)) {
+            return false;
+        }
+
+        if (latency) {
+            sample.done_ns = MonotonicNowNs() - session->start_ns;
+            sample.scheduled_ns = keystroke->time_ns;
+            sample.code = keystroke->code;
+            sample.flags = keystroke->flags;
+            sample.events = (uint16_t)burst;
+            RecordLatencySample(latency, &sample);
+        }
+
+        for (size_t end = i + burst; i < end; i += count) {
+            keystroke = &plan->events[i];
+            count = PlanGroupLength(plan, i);
+            if (session->delays && session->keystrokes > 0) {
+                RecordDelay(session->delays, keystroke->time_ns - session->last_ns);
+            }
+            session->last_ns = keystroke->time_ns;
+            session->keystrokes++;
+
+            // Typos and their backspaces are counted as such, not as typed text
+            RecordKeystroke(&session->meter, live, keystroke->time_ns, keystroke->flags);
+        }
+    }
+    return true;
+}
+
+static bool EmitPlan(TypingSimulator* simulator, TypingSession* session, const KeyPlan* plan) {
+    if (session->latency) {
+        return EmitKeystrokes(simulator, session, plan, session->latency);
+    }
+    return EmitKeystrokes(simulator, session, plan, NULL);
+}
+
+// Stop the renderer and record the final statistics
+static void EndTypingSession(TypingSimulator* simulator, TypingSession* session) {
+    StopStatsRenderer(&session->renderer);
+    UpdateTypingStats(&simulator->stats, &simulator->live);
+}
+
+// Print and export the session's keystroke timing, if it was traced
+static void ReportLatency(const TypingSession* session) {
+    if (session->latency) {
+        ReportLatencyTrace(session->latency);
+    }
+}
+
+// Show the countdown that gives the user time to focus the target window;
+// false if typing was stopped during it
+static bool CountDown(TypingSimulator* simulator) {
+    printf("Switch to your target window now!\n");
+    if (simulator->control) {
+        printf("Press " HOTKEY_PAUSE_NAME " to pause or resume, " HOTKEY_STOP_NAME " to stop\n");
+    }
+    printf("\n");
+
+    uint64_t start_ns = MonotonicNowNs();
+    for (size_t i = 0; i <= 100; i++) {
+        DisplayProgressBar(i, 100);
+        if (!WaitOnTimeline(simulator->control, NULL, &start_ns, (uint64_t)(i + 1) * 30000000ULL)) {
+            printf("\n\nStopped\n");
+            return false;
+        }
+    }
+    printf("\n\n");
+    return true;
+}
+
+// Print the speed achieved by the last session, measured over the intervals
+// between keystrokes (corrections included, hotkey pauses left out)
+static void PrintMeasuredSpeed(const TypingSimulator* simulator) {
+    const TypingStats* stats = &simulator->stats;
+    if (stats->chars_typed > 1 && stats->elapsed_time > 0) {
+        double chars_per_minute = (double)(stats->chars_typed - 1) / (stats->elapsed_time / 60.0);
+        printf("Measured speed: %.1f WPM (target %.1f) over %.1fs, accuracy %.1f%%\n",
+               chars_per_minute / CHARS_PER_WORD, simulator->target_wpm, stats->elapsed_time,
+               stats->accuracy * 100.0);
+    }
+}
+
+// Print the completion summary
+static void ReportTypingComplete(TypingSimulator* simulator, const KeyPlanner* planner) {
+    printf("\n\nTyping complete!\n");
+
+    if (planner->unmapped_chars > 0) {
+        printf("Skipped %zu characters the %s sink cannot type\n", planner->unmapped_chars, simulator->sink->name);
+    }
+    if (planner->humanize) {
+        printf("Typos made and corrected: %zu (seed %llu)\n", planner->typos, (unsigned long long)simulator->seed);
+    }
+
+    PrintMeasuredSpeed(simulator);
+}
+
+// Events the emitter copies out of the ring at a time
+#define EMITTER_BATCH_EVENTS 256
+
+// A session split across two threads: the calling thread reads and plans,
+// the emitter thread only waits for deadlines and emits
+typedef struct {
+    TypingSimulator* simulator;
+    TypingSession* session;
+    EventRing ring;        // Planned keystrokes not yet emitted
+    bool ok;               // Emitter outcome: false if the sink failed or typing was stopped
+} TypingPipeline;
+
+// Emit keystrokes from the ring until the planner closes it. Batches are cut
+// at keystroke boundaries: when the next event in the ring shares the last
+// one's timestamp, that keystroke waits for the next batch, unless it fills
+// the whole batch and could never fit.
+static bool EmitFromRing(TypingSimulator* simulator, TypingSession* session, EventRing* ring) {
+    KeyEvent batch[EMITTER_BATCH_EVENTS];
+    KeyPlan view;
+    view.events = batch;
+    view.capacity = EMITTER_BATCH_EVENTS;
+    size_t held = 0;
+    uint64_t backoff_ns = EVENT_RING_BACKOFF_MIN_NS;
+
+    while (true) {
+        size_t got = PopEvents(ring, batch + held, EMITTER_BATCH_EVENTS - held);
+        if (got == 0 && held == 0) {
+            if (EventRingDrained(ring)) {
+                return true;
+            }
+            if (StopRequested(simulator)) {
+                return false;
+            }
+            // The planner fell behind (start of input, or a slow pipe)
+            EventRingBackoff(&backoff_ns, EVENT_RING_EMITTER_BACKOFF_MAX_NS);
+            continue;
+        }
+        backoff_ns = EVENT_RING_BACKOFF_MIN_NS;
+
+        size_t count = held + got;
+        size_t complete = count;
+        const KeyEvent* next = PeekEvent(ring);
+        if (next) {
+            while (complete > 0 && batch[complete - 1].time_ns == next->time_ns) {
+                complete--;
+            }
+            if (complete == 0 && count == EMITTER_BATCH_EVENTS) {
+                complete = count;
+            }
+        }
+
+        view.count = complete;
+        if (!EmitPlan(simulator, session, &view)) {
+            return false;
+        }
+        held = count - complete;
+        memmove(batch, batch + complete, held * sizeof(KeyEvent));
+    }
+}
+
+static void EmitterThread(void* arg) {
+    TypingPipeline* pipeline = (TypingPipeline*)arg;
+    TypingSimulator* simulator = pipeline->simulator;
+
+    if (simulator->realtime && !RaiseThreadPriority()) {
+        printf("Warning: Could not give the emitter thread real-time priority\n");
+    }
+    if (simulator->emitter_cpu >= 0 && !PinThreadToCpu((unsigned)simulator->emitter_cpu)) {
+        printf("Warning: Could not pin the emitter thread to CPU %d\n", simulator->emitter_cpu);
+    }
+
+    pipeline->ok = EmitFromRing(simulator, pipeline->session, &pipeline->ring);
+    if (!pipeline->ok) {
+        CancelEventRing(&pipeline->ring);
+    }
+}
+
+// Compile text chunk by chunk, starting with the chunk already read from
+// source, and hand the keystrokes to an emitter thread through a bounded ring:
+// planning and reading overlap with typing, and the planner runs at most
+// EVENT_RING_CAPACITY events ahead. False if planning or the sink failed.
+static bool TypeChunks(TypingSimulator* simulator, TypingSession* session, KeyPlanner* planner,
+                       TextSource* source, const char* chunk, size_t chunk_length) {
+    TypingPipeline pipeline;
+    if (!InitializeEventRing(&pipeline.ring, EVENT_RING_CAPACITY)) {
+        return false;
+    }
+    pipeline.simulator = simulator;
+    pipeline.session = session;
+    pipeline.ok = true;
+
+    // A real-time emitter drains the ring slowly, so a full ring can be polled rarely
+    uint64_t backoff_max_ns = session->virtual_clock ? EVENT_RING_DRY_RUN_BACKOFF_MAX_NS
+                                                     : EVENT_RING_PLANNER_BACKOFF_MAX_NS;
+    HumanizerThread emitter;
+    bool started = false;
+    bool planned = true;
+    bool more = true;
+    while (more) {
+        ClearPlan(&simulator->plan);
+        if (!PlanText(planner, &simulator->plan, chunk, chunk_length)) {
+            planned = false;
+            break;
+        }
+
+        more = source->Next(source, &chunk, &chunk_length);
+        if (!more && !FinishPlan(planner, &simulator->plan)) {
+            planned = false;
+            break;
+        }
+
+        if (simulator->plan_listing) {
+            PrintPlan(&simulator->plan, simulator->plan_listing);
+            fflush(simulator->plan_listing);
+        }
+        if (session->trace) {
+            WriteTraceEvents(session->trace, simulator->plan.events, simulator->plan.count);
+        }
+
+        // The emitter starts once the first keystrokes are waiting for it
+        size_t pushed = 0;
+        if (!started) {
+            pushed = PushKeystrokes(&pipeline.ring, simulator->plan.events, simulator->plan.count);
+            if (!StartThread(&emitter, EmitterThread, &pipeline)) {
+                printf(ANSI_COLOR_RED "Error: Could not start the emitter thread\n" ANSI_COLOR_RESET);
+                planned = false;
+                break;
+            }
+            started = true;
+        }
+        if (!WriteKeystrokes(&pipeline.ring, simulator->plan.events + pushed, simulator->plan.count - pushed,
+                             backoff_max_ns)) {
+            break;
+        }
+    }
+
+    CloseEventRing(&pipeline.ring);
+    if (started) {
+        JoinThread(&emitter);
+    }
+    DestroyEventRing(&pipeline.ring);
+    return planned && pipeline.ok;
+}
+
+// Open the session's trace if the simulator records one; NULL otherwise
+static TraceWriter* StartRecording(TypingSimulator* simulator, TraceWriter* writer) {
+    if (!simulator->record_path || !OpenTraceWriter(writer, simulator->record_path, simulator->sink->name)) {
+        return NULL;
+    }
+    return writer;
+}
+
+// Finish the session's trace
+static void StopRecording(TypingSimulator* simulator, TraceWriter* writer) {
+    if (writer && CloseTraceWriter(writer)) {
+        printf("Recorded %llu events to %s\n", (unsigned long long)writer->event_count, simulator->record_path);
+    }
+}
+
+// Scan text held in memory and print what will be typed, how long it should
+// take and what will be skipped
+void DescribeText(const TypingSimulator* simulator, const char* text, size_t length) {
+    uint64_t started_ns = MonotonicNowNs();
+    TextScan scan;
+    ScanBuffer(text, length, simulator->sink->layout, &scan);
+    double scan_ms = (double)(MonotonicNowNs() - started_ns) / 1e6;
+
+    uint64_t eta_s = EstimatePlanDuration(&scan, simulator->target_wpm,
+                                          simulator->humanized ? &simulator->humanize : NULL) / 1000000000ULL;
+    printf("%llu characters, %llu words, %llu lines, %llu paragraphs (scanned in %.1f ms, %s)\n",
+           (unsigned long long)scan.chars, (unsigned long long)scan.words, (unsigned long long)scan.lines,
+           (unsigned long long)scan.paragraphs, scan_ms, ScanKernelName());
+    printf("Estimated typing time: %llu:%02llu:%02llu at %.0f WPM\n", (unsigned long long)(eta_s / 3600),
+           (unsigned long long)(eta_s / 60 % 60), (unsigned long long)(eta_s % 60), simulator->target_wpm);
+
+    if (scan.invalid_sequences) {
+        printf("Warning: %llu malformed UTF-8 sequences (first at byte %llu) will be skipped\n",
+               (unsigned long long)scan.invalid_sequences, (unsigned long long)scan.first_invalid);
+    }
+    if (scan.control_chars) {
+        printf("Warning: %llu control characters (first at byte %llu)\n",
+               (unsigned long long)scan.control_chars, (unsigned long long)scan.first_control);
+    }
+    if (scan.unmappable_chars) {
+        printf("Warning: %llu characters the %s sink cannot type (first at byte %llu) will be skipped\n",
+               (unsigned long long)scan.unmappable_chars, simulator->sink->name,
+               (unsigned long long)scan.first_unmappable);
+    }
+    printf("\n");
+}
+
+// Type text pulled from source chunk by chunk: each chunk is compiled into the
+// reusable plan and emitted before the next one is read, so memory stays
+// bounded and typing starts without reading the whole input first
+void SimulateTypingFromSource(TypingSimulator* simulator, TextSource* source) {
+    ClearScreen();
+    printf("Preparing to type...\n");
+
+    // Read the first chunk up front so empty or unreadable input fails before the countdown
+    const char* chunk = NULL;
+    size_t chunk_length = 0;
+    if (!source->Next(source, &chunk, &chunk_length)) {
+        printf(ANSI_COLOR_RED "Error: %s\n" ANSI_COLOR_RESET, source->failed ? "Failed to read input" : "No text to type");
+        return;
+    }
+    if (source->text) {
+        DescribeText(simulator, source->text, source->length);
+    }
+
+    ResetControl(simulator);
+    if (!CountDown(simulator)) {
+        return;
+    }
+
+    KeyPlanner planner;
+    InitializeSimulatorPlanner(simulator, &planner);
+
+    TraceWriter writer;
+    TypingSession session;
+    BeginTypingSession(simulator, &session, false);
+    session.trace = StartRecording(simulator, &writer);
+
+    bool ok = TypeChunks(simulator, &session, &planner, source, chunk, chunk_length);
+
+    EndTypingSession(simulator, &session);
+    StopRecording(simulator, session.trace);
+    ReportLatency(&session);
+
+    if (!ok && StopRequested(simulator)) {
+        printf("\n\nTyping stopped after %zu characters\n", session.meter.chars_typed);
+        return;
+    }
+    if (!ok) {
+        printf(ANSI_COLOR_RED "\nError: Typing stopped early (%s sink rejected a keystroke or memory ran out)\n" ANSI_COLOR_RESET,
+               simulator->sink->name);
+        return;
+    }
+    if (source->failed) {
+        printf(ANSI_COLOR_RED "\nError: Failed to read the rest of the input\n" ANSI_COLOR_RESET);
+        return;
+    }
+    ReportTypingComplete(simulator, &planner);
+}
+
+// Events decoded from a trace per emitted batch
+#define REPLAY_BATCH_EVENTS 4096
+
+// Whether keycodes recorded for trace_sink mean the same thing to sink
+static bool TraceMatchesSink(const char* trace_sink, const KeySink* sink) {
+    // The null and file sinks only log, so they accept any keycode space
+    return strcmp(trace_sink, sink->name) == 0 || strcmp(sink->name, "null") == 0 || strcmp(sink->name, "file") == 0;
+}
+
+// Type a recorded keystroke trace exactly as it was planned. Events are decoded
+// from the mapped file in batches and emitted as is: no planning, layout
+// lookups or humanization happen during replay.
+void ReplayTrace(TypingSimulator* simulator, const char* path) {
+    TraceReader reader;
+    if (!OpenTraceReader(&reader, path)) {
+        return;
+    }
+    if (!TraceMatchesSink(reader.sink, simulator->sink)) {
+        printf(ANSI_COLOR_RED "Error: Trace was recorded for the %s sink, not %s\n" ANSI_COLOR_RESET,
+               reader.sink, simulator->sink->name);
+        CloseTraceReader(&reader);
+        return;
+    }
+    if (!ReservePlan(&simulator->plan, REPLAY_BATCH_EVENTS)) {
+        printf(ANSI_COLOR_RED "Error: Memory allocation failed\n" ANSI_COLOR_RESET);
+        CloseTraceReader(&reader);
+        return;
+    }
+
+    ClearScreen();
+    printf("Replaying %llu events (%.1fs) recorded for the %s sink\n",
+           (unsigned long long)reader.event_count, (double)reader.duration_ns / 1e9, reader.sink);
+    ResetControl(simulator);
+    if (!CountDown(simulator)) {
+        CloseTraceReader(&reader);
+        return;
+    }
+
+    TypingSession session;
+    BeginTypingSession(simulator, &session, false);
+
+    KeyEvent* events = simulator->plan.events;
+    size_t carried = 0;
+    bool ok = true;
+    while (ok) {
+        size_t count = carried + ReadTraceEvents(&reader, events + carried, REPLAY_BATCH_EVENTS - carried);
+        if (count == 0) {
+            break;
+        }
+
+        // Hold back the last keystroke while more events follow, so its press
+        // and release are never split across two batches
+        size_t emit = count;
+        if (reader.remaining > 0 && !reader.failed) {
+            size_t start = count - 1;
+            while (start > 0 && events[start - 1].time_ns == events[count - 1].time_ns) {
+                start--;
+            }
+            if (start > 0) {
+                emit = start;
+            }
+        }
+
+        simulator->plan.count = emit;
+        ok = EmitPlan(simulator, &session, &simulator->plan);
+        carried = count - emit;
+        memmove(events, events + emit, carried * sizeof(KeyEvent));
+    }
+    ClearPlan(&simulator->plan);
+
+    EndTypingSession(simulator, &session);
+    ReportLatency(&session);
+    bool corrupt = reader.failed;
+    CloseTraceReader(&reader);
+
+    if (!ok && StopRequested(simulator)) {
+        printf("\n\nReplay stopped after %zu keystrokes\n", session.keystrokes);
+        return;
+    }
+    if (!ok) {
+        printf(ANSI_COLOR_RED "\nError: Replay stopped early (%s sink rejected a keystroke)\n" ANSI_COLOR_RESET,
+               simulator->sink->name);
+        return;
+    }
+    if (corrupt) {
+        printf(ANSI_COLOR_RED "\nError: Trace is truncated or corrupt; replay stopped early\n" ANSI_COLOR_RESET);
+        return;
+    }
+    printf("\n\nReplay complete!\n");
+    PrintMeasuredSpeed(simulator);
+}
+
+// Simulate the typing process for the text loaded into the simulator
+void SimulateTyping(TypingSimulator* simulator) {
+    TextSource* source = OpenMemoryTextSource(simulator->text, simulator->length);
+    if (!source) {
+        return;
+    }
+    SimulateTypingFromSource(simulator, source);
+    CloseTextSource(source);
+}
+
+// Run source through the pipeline without console interaction and fill report;
+// on the virtual clock nothing waits for its deadline
+static bool RunHeadless(TypingSimulator* simulator, TextSource* source, bool virtual_clock, TypingReport* report) {
+    memset(report, 0, sizeof(*report));
+    report->target_wpm = simulator->target_wpm;
+
+    const char* chunk = NULL;
+    size_t chunk_length = 0;
+    if (!source->Next(source, &chunk, &chunk_length)) {
+        report->error = source->failed ? "Failed to read input" : "No text to type";
+        return false;
+    }
+
+    KeyPlanner planner;
+    InitializeSimulatorPlanner(simulator, &planner);
+
+    TypingSession session;
+    if (virtual_clock) {
+        // No renderer: the live counters are still published, nobody draws them
+        memset(&session, 0, sizeof(session));
+        session.virtual_clock = true;
+        ResetLiveTypingStats(&simulator->live);
+    } else {
+        BeginTypingSession(simulator, &session, true);
+    }
+    session.delays = &report->delays;
+
+    TraceWriter writer;
+    session.trace = StartRecording(simulator, &writer);
+
+    uint64_t started_ns = MonotonicNowNs();
+    bool ok = TypeChunks(simulator, &session, &planner, source, chunk, chunk_length);
+    report->wall_ns = MonotonicNowNs() - started_ns;
+
+    if (!virtual_clock) {
+        EndTypingSession(simulator, &session);
+    }
+    StopRecording(simulator, session.trace);
+
+    report->keystrokes = session.keystrokes;
+    report->chars_typed = session.meter.chars_typed;
+    report->words_typed = session.meter.words_typed;
+    report->typos = planner.typos;
+    report->unmapped_chars = planner.unmapped_chars;
+    report->planned_ns = session.last_ns;
+
+    if (!ok) {
+        report->error = StopRequested(simulator) ? "Cancelled"
+                      : "Stopped early (sink rejected a keystroke or memory ran out)";
+        return false;
+    }
+    if (source->failed) {
+        report->error = "Failed to read the rest of the input";
+        return false;
+    }
+    return true;
+}
+
+// Run the whole pipeline (read, plan, humanize, emit) against the simulator's
+// sink on a virtual clock: nothing waits for its deadline, so a long document
+// finishes in a fraction of a second. Fills report; false if the run failed.
+bool DryRunTyping(TypingSimulator* simulator, TextSource* source, TypingReport* report) {
+    return RunHeadless(simulator, source, true, report);
+}
+
+// Type source in real time without countdown or console output; progress goes
+// to simulator->progress if set. Fills report; false if the run failed.
+bool TypeHeadless(TypingSimulator* simulator, TextSource* source, TypingReport* report) {
+    return RunHeadless(simulator, source, false, report);
+}
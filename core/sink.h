@@ -0,0 +1,62 @@
+#ifndef HUMANIZER_CORE_SINK_H
+#define HUMANIZER_CORE_SINK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Key event flags
+#define KEY_EVENT_UP         0x0001 // Key release instead of key press
+#define KEY_EVENT_UNICODE    0x0002 // code holds a Unicode codepoint, not a keycode
+#define KEY_EVENT_WORD_END   0x0004 // Keystroke completes a word (used for statistics)
+#define KEY_EVENT_CORRECTION 0x0008 // Typo or backspace that is not part of the text (not counted as typed)
+#define KEY_EVENT_ERASE      0x0010 // With KEY_EVENT_CORRECTION: the backspace that erases a typo
+#define KEY_EVENT_HOLD       0x0020 // Not a key: typing pauses here until resumed ({PAUSE} directive)
+
+// Modifiers a sink holds down around a key press
+#define KEY_MOD_SHIFT 0x0001
+#define KEY_MOD_CTRL  0x0002
+#define KEY_MOD_ALT   0x0004
+#define KEY_MOD_ALTGR 0x0008
+
+// A single press or release, expressed in the sink's own keycode space
+typedef struct {
+    uint64_t time_ns;      // Target time relative to the start of typing
+    uint32_t code;         // Platform keycode (or codepoint with KEY_EVENT_UNICODE)
+    uint16_t mods;         // KEY_MOD_* held for this key
+    uint16_t flags;        // KEY_EVENT_* flags
+} KeyEvent;
+
+typedef struct KeySink KeySink;
+struct KeyLayout;
+
+// Destination for keystrokes. Each backend embeds this as its first member.
+struct KeySink {
+    const char* name;
+    // Codepoint-to-key table for the active keyboard layout, built when the sink is opened
+    const struct KeyLayout* layout;
+    // Deliver the events of one keystroke, or of several coalesced ones that are
+    // due together; events sharing a time_ns belong to the same keystroke, and
+    // time_ns is otherwise ignored
+    bool (*Emit)(KeySink* sink, const KeyEvent* events, size_t count);
+    // Release the backend and free the sink
+    void (*Close)(KeySink* sink);
+};
+
+// Backends available on every platform (sink_null.c)
+KeySink* OpenNullSink(void);
+KeySink* OpenFileSink(const char* path);
+
+// Platform backends
+#if defined(_WIN32)
+KeySink* OpenSendInputSink(void);
+#elif defined(__APPLE__)
+KeySink* OpenCGEventSink(void);
+#elif defined(__linux__)
+KeySink* OpenUinputSink(const char* device_name, bool unicode_input);
+#endif
+
+// Close a sink obtained from one of the Open*Sink functions
+void CloseSink(KeySink* sink);
+
+#endif // HUMANIZER_CORE_SINK_H
@@ -0,0 +1,130 @@
+#include "humanizer.h"
+#include "layout.h"
+
+#include <stdlib.h>
+#include <Carbon/Carbon.h>
+
+// macOS keystroke injection through CoreGraphics events
+typedef struct {
+    KeySink base;
+    KeyLayout layout;      // Current input source, Unicode for everything else
+} CGEventSink;
+
+// Virtual keycodes that never produce text through UCKeyTranslate
+#define CG_KEY_RETURN 36
+#define CG_KEY_TAB    48
+#define CG_KEY_DELETE 51
+
+// Translate every virtual key under each modifier combination through the current
+// input source and record which key produces each character
+static void BuildCGEventLayout(KeyLayout* layout) {
+    static const struct {
+        uint16_t mods;
+        UInt32 carbon;     // Carbon modifier state, shifted as UCKeyTranslate expects
+    } kModifierStates[] = {
+        { 0, 0 },
+        { KEY_MOD_SHIFT, shiftKey >> 8 },
+        { KEY_MOD_ALT, optionKey >> 8 },
+        { KEY_MOD_SHIFT | KEY_MOD_ALT, (shiftKey | optionKey) >> 8 },
+    };
+
+    InitializeLayout(layout, true);
+    SetLayoutKey(layout, '\n', CG_KEY_RETURN, 0);
+    SetLayoutKey(layout, '\t', CG_KEY_TAB, 0);
+    SetLayoutKey(layout, '\b', CG_KEY_DELETE, 0);
+
+    TISInputSourceRef source = TISCopyCurrentKeyboardLayoutInputSource();
+    CFDataRef data = source ? (CFDataRef)TISGetInputSourceProperty(source, kTISPropertyUnicodeKeyLayoutData) : NULL;
+    if (data) {
+        const UCKeyboardLayout* keyboard = (const UCKeyboardLayout*)CFDataGetBytePtr(data);
+        for (size_t m = 0; m < sizeof(kModifierStates) / sizeof(kModifierStates[0]); m++) {
+            for (UInt16 key = 0; key < 128; key++) {
+                UInt32 dead_keys = 0;
+                UniChar chars[4];
+                UniCharCount length = 0;
+                OSStatus status = UCKeyTranslate(keyboard, key, kUCKeyActionDown, kModifierStates[m].carbon,
+                                                 LMGetKbdType(), kUCKeyTranslateNoDeadKeysBit,
+                                                 &dead_keys, 4, &length, chars);
+                if (status == noErr && length == 1 && chars[0] >= 0x20) {
+                    SetLayoutKey(layout, chars[0], key, kModifierStates[m].mods);
+                }
+            }
+        }
+    }
+    if (source) {
+        CFRelease(source);
+    }
+    FinishLayout(layout);
+}
+
+static CGEventFlags ModifierFlags(uint16_t mods) {
+    CGEventFlags flags = 0;
+    if (mods & KEY_MOD_SHIFT) {
+        flags |= kCGEventFlagMaskShift;
+    }
+    if (mods & KEY_MOD_CTRL) {
+        flags |= kCGEventFlagMaskControl;
+    }
+    if (mods & KEY_MOD_ALT) {
+        flags |= kCGEventFlagMaskAlternate;
+    }
+    return flags;
+}
+
+// Post each event to the HID event tap, carrying modifiers as event flags
+static bool CGEventEmit(KeySink* sink, const KeyEvent* events, size_t count) {
+    (void)sink;
+    for (size_t i = 0; i < count; i++) {
+        const KeyEvent* ev = &events[i];
+        bool down = (ev->flags & KEY_EVENT_UP) == 0;
+        CGEventRef event;
+
+        if (ev->flags & KEY_EVENT_UNICODE) {
+            UniChar units[2];
+            UniCharCount length = 1;
+            if (ev->code > 0xFFFF) {
+                uint32_t v = ev->code - 0x10000;
+                units[0] = (UniChar)(0xD800 | (v >> 10));
+                units[1] = (UniChar)(0xDC00 | (v & 0x3FF));
+                length = 2;
+            } else {
+                units[0] = (UniChar)ev->code;
+            }
+            event = CGEventCreateKeyboardEvent(NULL, 0, down);
+            if (event) {
+                CGEventKeyboardSetUnicodeString(event, length, units);
+            }
+        } else {
+            event = CGEventCreateKeyboardEvent(NULL, (CGKeyCode)ev->code, down);
+            if (event && ev->mods) {
+                CGEventSetFlags(event, ModifierFlags(ev->mods));
+            }
+        }
+
+        if (!event) {
+            return false;
+        }
+        CGEventPost(kCGHIDEventTap, event);
+        CFRelease(event);
+    }
+    return true;
+}
+
+static void CGEventClose(KeySink* sink) {
+    free(sink);
+}
+
+// Open the CoreGraphics backend
+KeySink* OpenCGEventSink(void) {
+    CGEventSink* sink = (CGEventSink*)calloc(1, sizeof(CGEventSink));
+    if (!sink) {
+        printf(ANSI_COLOR_RED "Error: Memory allocation failed\n" ANSI_COLOR_RESET);
+        return NULL;
+    }
+    BuildCGEventLayout(&sink->layout);
+    sink->base.name = "CGEvent";
+    sink->base.layout = &sink->layout;
+    sink->base.Emit = CGEventEmit;
+    sink->base.Close = CGEventClose;
+    return &sink->base;
+}
@@ -0,0 +1,80 @@
+#include "humanizer.h"
+#include "layout.h"
+
+#include <stdlib.h>
+
+// Sink that discards events (and optionally logs them to a file)
+typedef struct {
+    KeySink base;
+    FILE* file;            // Log destination, NULL for the null sink
+    size_t events_emitted; // Number of events accepted so far
+    KeyLayout layout;      // Passes every printable character through as Unicode
+} NullSink;
+
+static bool NullEmit(KeySink* sink, const KeyEvent* events, size_t count) {
+    NullSink* null_sink = (NullSink*)sink;
+    null_sink->events_emitted += count;
+
+    if (null_sink->file) {
+        for (size_t i = 0; i < count; i++) {
+            fprintf(null_sink->file,
+                    (events[i].flags & KEY_EVENT_UNICODE) ? "%s U+%04X mods=%u\n" : "%s key %u mods=%u\n",
+                    (events[i].flags & KEY_EVENT_UP) ? "up  " : "down",
+                    (unsigned)events[i].code, (unsigned)events[i].mods);
+        }
+    }
+    return true;
+}
+
+static void NullClose(KeySink* sink) {
+    NullSink* null_sink = (NullSink*)sink;
+    if (null_sink->file) {
+        fclose(null_sink->file);
+    }
+    free(null_sink);
+}
+
+static NullSink* AllocateNullSink(const char* name) {
+    NullSink* sink = (NullSink*)calloc(1, sizeof(NullSink));
+    if (!sink) {
+        printf(ANSI_COLOR_RED "Error: Memory allocation failed\n" ANSI_COLOR_RESET);
+        return NULL;
+    }
+    InitializeLayout(&sink->layout, true);
+    FinishLayout(&sink->layout);
+    sink->base.name = name;
+    sink->base.layout = &sink->layout;
+    sink->base.Emit = NullEmit;
+    sink->base.Close = NullClose;
+    return sink;
+}
+
+// Open a sink that accepts and drops every event
+KeySink* OpenNullSink(void) {
+    NullSink* sink = AllocateNullSink("null");
+    return sink ? &sink->base : NULL;
+}
+
+// Open a sink that writes one line per event to the given file
+KeySink* OpenFileSink(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        printf(ANSI_COLOR_RED "Error: Could not open %s for writing\n" ANSI_COLOR_RESET, path);
+        return NULL;
+    }
+
+    NullSink* sink = AllocateNullSink("file");
+    if (!sink) {
+        fclose(file);
+        return NULL;
+    }
+    sink->file = file;
+    return &sink->base;
+}
+
+// Close a sink obtained from one of the Open*Sink functions
+void CloseSink(KeySink* sink) {
+    if (sink) {
+        sink->Close(sink);
+    }
+}
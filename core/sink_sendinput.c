@@ -0,0 +1,140 @@
+#include "humanizer.h"
+#include "layout.h"
+
+#include <stdlib.h>
+#include <windows.h>
+
+#pragma comment(lib, "user32.lib")
+
+#define SENDINPUT_BATCH_INPUTS 256
+
+// Windows keystroke injection through SendInput
+typedef struct {
+    KeySink base;
+    KeyLayout layout;      // Active keyboard layout, Unicode for everything else
+} SendInputSink;
+
+// Ask the active keyboard layout which key produces each codepoint in the table
+static void BuildSendInputLayout(KeyLayout* layout) {
+    HKL hkl = GetKeyboardLayout(0);
+
+    InitializeLayout(layout, true);
+    SetLayoutKey(layout, '\n', VK_RETURN, 0);
+    for (uint32_t cp = 0x20; cp < LAYOUT_TABLE_SIZE; cp++) {
+        SHORT vk = VkKeyScanExW((WCHAR)cp, hkl);
+        if (vk == -1) {
+            continue;
+        }
+
+        WORD shift_state = (vk >> 8) & 0xFF;
+        uint16_t mods = 0;
+        if (shift_state & 1) {
+            mods |= KEY_MOD_SHIFT;
+        }
+        if ((shift_state & 6) == 6) {
+            // Ctrl+Alt is how Windows reports AltGr
+            mods |= KEY_MOD_ALTGR;
+        } else if (shift_state & 2) {
+            mods |= KEY_MOD_CTRL;
+        } else if (shift_state & 4) {
+            mods |= KEY_MOD_ALT;
+        }
+        SetLayoutKey(layout, cp, vk & 0xFF, mods);
+    }
+    SetLayoutKey(layout, '\t', VK_TAB, 0);
+    SetLayoutKey(layout, '\b', VK_BACK, 0);
+    FinishLayout(layout);
+}
+
+static void AppendInput(INPUT* inputs, int* used, WORD vk, WORD scan, DWORD flags) {
+    INPUT* input = &inputs[(*used)++];
+    ZeroMemory(input, sizeof(*input));
+    input->type = INPUT_KEYBOARD;
+    input->ki.wVk = vk;
+    input->ki.wScan = scan;
+    input->ki.dwFlags = flags;
+}
+
+// Modifier virtual keys in press order
+static const struct {
+    uint16_t mod;
+    WORD vk;
+} kModifierKeys[] = {
+    { KEY_MOD_CTRL, VK_CONTROL },
+    { KEY_MOD_ALT, VK_MENU },
+    { KEY_MOD_ALTGR, VK_RMENU },
+    { KEY_MOD_SHIFT, VK_SHIFT },
+};
+#define MODIFIER_KEY_COUNT (sizeof(kModifierKeys) / sizeof(kModifierKeys[0]))
+
+// Expand the keystrokes into INPUT records and deliver them in one SendInput
+// call (a coalesced burst too, unless it outgrows the batch), so they reach
+// the input queue without other input in between
+static bool SendInputEmit(KeySink* sink, const KeyEvent* events, size_t count) {
+    (void)sink;
+    INPUT inputs[SENDINPUT_BATCH_INPUTS];
+    int used = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        const KeyEvent* ev = &events[i];
+        bool release = (ev->flags & KEY_EVENT_UP) != 0;
+
+        // Leave room for every modifier plus the key itself
+        if (used + (int)MODIFIER_KEY_COUNT + 1 > SENDINPUT_BATCH_INPUTS) {
+            if (SendInput((UINT)used, inputs, sizeof(INPUT)) != (UINT)used) {
+                return false;
+            }
+            used = 0;
+        }
+
+        if (ev->flags & KEY_EVENT_UNICODE) {
+            DWORD flags = KEYEVENTF_UNICODE | (release ? KEYEVENTF_KEYUP : 0);
+            if (ev->code > 0xFFFF) {
+                // Outside the BMP the character goes out as a UTF-16 surrogate pair
+                uint32_t v = ev->code - 0x10000;
+                AppendInput(inputs, &used, 0, (WORD)(0xD800 | (v >> 10)), flags);
+                AppendInput(inputs, &used, 0, (WORD)(0xDC00 | (v & 0x3FF)), flags);
+            } else {
+                AppendInput(inputs, &used, 0, (WORD)ev->code, flags);
+            }
+            continue;
+        }
+
+        if (!release) {
+            for (size_t m = 0; m < MODIFIER_KEY_COUNT; m++) {
+                if (ev->mods & kModifierKeys[m].mod) {
+                    AppendInput(inputs, &used, kModifierKeys[m].vk, 0, 0);
+                }
+            }
+            AppendInput(inputs, &used, (WORD)ev->code, 0, 0);
+        } else {
+            AppendInput(inputs, &used, (WORD)ev->code, 0, KEYEVENTF_KEYUP);
+            for (size_t m = MODIFIER_KEY_COUNT; m-- > 0;) {
+                if (ev->mods & kModifierKeys[m].mod) {
+                    AppendInput(inputs, &used, kModifierKeys[m].vk, 0, KEYEVENTF_KEYUP);
+                }
+            }
+        }
+    }
+
+    return used == 0 || SendInput((UINT)used, inputs, sizeof(INPUT)) == (UINT)used;
+}
+
+static void SendInputClose(KeySink* sink) {
+    free(sink);
+}
+
+// Open the SendInput backend for the current desktop
+KeySink* OpenSendInputSink(void) {
+    SendInputSink* sink = (SendInputSink*)calloc(1, sizeof(SendInputSink));
+    if (!sink) {
+        printf(ANSI_COLOR_RED "Error: Memory allocation failed\n" ANSI_COLOR_RESET);
+        return NULL;
+    }
+    BuildSendInputLayout(&sink->layout);
+    sink->base.name = "SendInput";
+    sink->base.layout = &sink->layout;
+    sink->base.Emit = SendInputEmit;
+    sink->base.Close = SendInputClose;
+    return &sink->base;
+}
@@ -0,0 +1,248 @@
+#define _GNU_SOURCE
+
+#include "humanizer.h"
+#include "layout.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/uinput.h>
+
+#define UINPUT_PATH "/dev/uinput"
+#define UINPUT_BATCH_EVENTS 512
+
+// Linux virtual keyboard backed by /dev/uinput
+typedef struct {
+    KeySink base;
+    int fd;                // uinput file descriptor
+    KeyLayout layout;      // US QWERTY, optionally with IBus-style Unicode entry
+} UinputSink;
+
+// US QWERTY keycodes for printable ASCII; the high bit requests Shift
+#define SHIFTED 0x8000
+static const uint16_t kAsciiKeymap[128] = {
+    ['\t'] = KEY_TAB, ['\n'] = KEY_ENTER,
+    [' '] = KEY_SPACE,
+    ['!'] = KEY_1 | SHIFTED, ['"'] = KEY_APOSTROPHE | SHIFTED, ['#'] = KEY_3 | SHIFTED,
+    ['$'] = KEY_4 | SHIFTED, ['%'] = KEY_5 | SHIFTED, ['&'] = KEY_7 | SHIFTED,
+    ['\''] = KEY_APOSTROPHE, ['('] = KEY_9 | SHIFTED, [')'] = KEY_0 | SHIFTED,
+    ['*'] = KEY_8 | SHIFTED, ['+'] = KEY_EQUAL | SHIFTED, [','] = KEY_COMMA,
+    ['-'] = KEY_MINUS, ['.'] = KEY_DOT, ['/'] = KEY_SLASH,
+    ['0'] = KEY_0, ['1'] = KEY_1, ['2'] = KEY_2, ['3'] = KEY_3, ['4'] = KEY_4,
+    ['5'] = KEY_5, ['6'] = KEY_6, ['7'] = KEY_7, ['8'] = KEY_8, ['9'] = KEY_9,
+    [':'] = KEY_SEMICOLON | SHIFTED, [';'] = KEY_SEMICOLON, ['<'] = KEY_COMMA | SHIFTED,
+    ['='] = KEY_EQUAL, ['>'] = KEY_DOT | SHIFTED, ['?'] = KEY_SLASH | SHIFTED,
+    ['@'] = KEY_2 | SHIFTED,
+    ['A'] = KEY_A | SHIFTED, ['B'] = KEY_B | SHIFTED, ['C'] = KEY_C | SHIFTED,
+    ['D'] = KEY_D | SHIFTED, ['E'] = KEY_E | SHIFTED, ['F'] = KEY_F | SHIFTED,
+    ['G'] = KEY_G | SHIFTED, ['H'] = KEY_H | SHIFTED, ['I'] = KEY_I | SHIFTED,
+    ['J'] = KEY_J | SHIFTED, ['K'] = KEY_K | SHIFTED, ['L'] = KEY_L | SHIFTED,
+    ['M'] = KEY_M | SHIFTED, ['N'] = KEY_N | SHIFTED, ['O'] = KEY_O | SHIFTED,
+    ['P'] = KEY_P | SHIFTED, ['Q'] = KEY_Q | SHIFTED, ['R'] = KEY_R | SHIFTED,
+    ['S'] = KEY_S | SHIFTED, ['T'] = KEY_T | SHIFTED, ['U'] = KEY_U | SHIFTED,
+    ['V'] = KEY_V | SHIFTED, ['W'] = KEY_W | SHIFTED, ['X'] = KEY_X | SHIFTED,
+    ['Y'] = KEY_Y | SHIFTED, ['Z'] = KEY_Z | SHIFTED,
+    ['['] = KEY_LEFTBRACE, ['\\'] = KEY_BACKSLASH, [']'] = KEY_RIGHTBRACE,
+    ['^'] = KEY_6 | SHIFTED, ['_'] = KEY_MINUS | SHIFTED, ['`'] = KEY_GRAVE,
+    ['a'] = KEY_A, ['b'] = KEY_B, ['c'] = KEY_C, ['d'] = KEY_D, ['e'] = KEY_E,
+    ['f'] = KEY_F, ['g'] = KEY_G, ['h'] = KEY_H, ['i'] = KEY_I, ['j'] = KEY_J,
+    ['k'] = KEY_K, ['l'] = KEY_L, ['m'] = KEY_M, ['n'] = KEY_N, ['o'] = KEY_O,
+    ['p'] = KEY_P, ['q'] = KEY_Q, ['r'] = KEY_R, ['s'] = KEY_S, ['t'] = KEY_T,
+    ['u'] = KEY_U, ['v'] = KEY_V, ['w'] = KEY_W, ['x'] = KEY_X, ['y'] = KEY_Y,
+    ['z'] = KEY_Z,
+    ['{'] = KEY_LEFTBRACE | SHIFTED, ['|'] = KEY_BACKSLASH | SHIFTED,
+    ['}'] = KEY_RIGHTBRACE | SHIFTED, ['~'] = KEY_GRAVE | SHIFTED,
+};
+
+// Modifier keycodes in press order
+static const struct {
+    uint16_t mod;
+    uint16_t key;
+} kModifierKeys[] = {
+    { KEY_MOD_CTRL, KEY_LEFTCTRL },
+    { KEY_MOD_ALT, KEY_LEFTALT },
+    { KEY_MOD_ALTGR, KEY_RIGHTALT },
+    { KEY_MOD_SHIFT, KEY_LEFTSHIFT },
+};
+#define MODIFIER_KEY_COUNT (sizeof(kModifierKeys) / sizeof(kModifierKeys[0]))
+
+// Keys for the hex digits typed in a Ctrl+Shift+U sequence
+static const uint16_t kHexDigitKeys[16] = {
+    KEY_0, KEY_1, KEY_2, KEY_3, KEY_4, KEY_5, KEY_6, KEY_7,
+    KEY_8, KEY_9, KEY_A, KEY_B, KEY_C, KEY_D, KEY_E, KEY_F
+};
+
+// Events one Unicode sequence can take: Ctrl+Shift+U, six hex digits, Space, each with SYN frames
+#define UNICODE_SEQUENCE_EVENTS 40
+
+// Write a prepared batch, retrying on short writes and interrupts
+static bool WriteEvents(int fd, const struct input_event* events, size_t count) {
+    const char* data = (const char*)events;
+    size_t remaining = count * sizeof(struct input_event);
+
+    while (remaining > 0) {
+        ssize_t written = write(fd, data, remaining);
+        if (written < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        remaining -= (size_t)written;
+    }
+    return true;
+}
+
+static void AppendEvent(struct input_event* batch, size_t* used, uint16_t type, uint16_t code, int32_t value) {
+    struct input_event* ev = &batch[(*used)++];
+    memset(ev, 0, sizeof(*ev));
+    ev->type = type;
+    ev->code = code;
+    ev->value = value;
+}
+
+// Append a press or release of key with the given modifiers held around it
+static void AppendKey(struct input_event* batch, size_t* used, uint16_t key, uint16_t mods, bool release) {
+    if (!release) {
+        for (size_t m = 0; m < MODIFIER_KEY_COUNT; m++) {
+            if (mods & kModifierKeys[m].mod) {
+                AppendEvent(batch, used, EV_KEY, kModifierKeys[m].key, 1);
+            }
+        }
+        AppendEvent(batch, used, EV_KEY, key, 1);
+    } else {
+        AppendEvent(batch, used, EV_KEY, key, 0);
+        for (size_t m = MODIFIER_KEY_COUNT; m-- > 0;) {
+            if (mods & kModifierKeys[m].mod) {
+                AppendEvent(batch, used, EV_KEY, kModifierKeys[m].key, 0);
+            }
+        }
+    }
+}
+
+// Type a codepoint with the Ctrl+Shift+U <hex> Space sequence understood by IBus and GTK
+static void AppendUnicodeSequence(struct input_event* batch, size_t* used, uint32_t codepoint) {
+    AppendKey(batch, used, KEY_U, KEY_MOD_CTRL | KEY_MOD_SHIFT, false);
+    AppendKey(batch, used, KEY_U, KEY_MOD_CTRL | KEY_MOD_SHIFT, true);
+    AppendEvent(batch, used, EV_SYN, SYN_REPORT, 0);
+
+    char hex[8];
+    int digits = snprintf(hex, sizeof(hex), "%x", (unsigned)codepoint);
+    for (int d = 0; d < digits; d++) {
+        uint16_t key = kHexDigitKeys[hex[d] <= '9' ? hex[d] - '0' : hex[d] - 'a' + 10];
+        AppendEvent(batch, used, EV_KEY, key, 1);
+        AppendEvent(batch, used, EV_KEY, key, 0);
+        AppendEvent(batch, used, EV_SYN, SYN_REPORT, 0);
+    }
+
+    AppendEvent(batch, used, EV_KEY, KEY_SPACE, 1);
+    AppendEvent(batch, used, EV_KEY, KEY_SPACE, 0);
+}
+
+// Expand the keystrokes into input_events, each closed by a SYN_REPORT, and
+// hand them to the kernel in as few writes as the batch buffer allows (one for
+// an ordinary keystroke or a coalesced burst of a few dozen)
+static bool UinputEmit(KeySink* sink, const KeyEvent* events, size_t count) {
+    UinputSink* uinput = (UinputSink*)sink;
+    struct input_event batch[UINPUT_BATCH_EVENTS];
+    size_t used = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        const KeyEvent* ev = &events[i];
+        bool release = (ev->flags & KEY_EVENT_UP) != 0;
+
+        // Leave room for the largest expansion plus the trailing SYN_REPORT
+        if (used + UNICODE_SEQUENCE_EVENTS + 1 > UINPUT_BATCH_EVENTS) {
+            if (!WriteEvents(uinput->fd, batch, used)) {
+                return false;
+            }
+            used = 0;
+        }
+
+        if (ev->flags & KEY_EVENT_UNICODE) {
+            // The whole sequence is typed on the press; the release has nothing left to do
+            if (!release) {
+                AppendUnicodeSequence(batch, &used, ev->code);
+            }
+        } else {
+            AppendKey(batch, &used, (uint16_t)ev->code, ev->mods, release);
+        }
+
+        // Separate frames keep repeated keys in a burst from merging into one report
+        if (i + 1 == count || events[i + 1].time_ns != ev->time_ns) {
+            AppendEvent(batch, &used, EV_SYN, SYN_REPORT, 0);
+        }
+    }
+    return WriteEvents(uinput->fd, batch, used);
+}
+
+static void UinputClose(KeySink* sink) {
+    UinputSink* uinput = (UinputSink*)sink;
+    ioctl(uinput->fd, UI_DEV_DESTROY);
+    close(uinput->fd);
+    free(uinput);
+}
+
+// Create a virtual keyboard through /dev/uinput. The kernel device has no idea
+// which layout the session uses, so keys are mapped for US QWERTY; with
+// unicode_input, other characters are entered with Ctrl+Shift+U (IBus/GTK).
+KeySink* OpenUinputSink(const char* device_name, bool unicode_input) {
+    UinputSink* sink = (UinputSink*)calloc(1, sizeof(UinputSink));
+    if (!sink) {
+        printf(ANSI_COLOR_RED "Error: Memory allocation failed\n" ANSI_COLOR_RESET);
+        return NULL;
+    }
+
+    InitializeLayout(&sink->layout, unicode_input);
+    for (uint32_t ch = 0; ch < 128; ch++) {
+        if (kAsciiKeymap[ch]) {
+            SetLayoutKey(&sink->layout, ch, kAsciiKeymap[ch] & ~SHIFTED, (kAsciiKeymap[ch] & SHIFTED) ? KEY_MOD_SHIFT : 0);
+        }
+    }
+    SetLayoutKey(&sink->layout, '\b', KEY_BACKSPACE, 0);
+    FinishLayout(&sink->layout);
+
+    int fd = open(UINPUT_PATH, O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        printf(ANSI_COLOR_RED "Error: Could not open " UINPUT_PATH " (%s)\n" ANSI_COLOR_RESET, strerror(errno));
+        free(sink);
+        return NULL;
+    }
+
+    // Advertise every key the layout, the modifiers and the Unicode sequence can use
+    bool ok = ioctl(fd, UI_SET_EVBIT, EV_KEY) == 0 && ioctl(fd, UI_SET_EVBIT, EV_SYN) == 0;
+    for (size_t m = 0; ok && m < MODIFIER_KEY_COUNT; m++) {
+        ok = ioctl(fd, UI_SET_KEYBIT, kModifierKeys[m].key) == 0;
+    }
+    for (uint32_t cp = 0; ok && cp < LAYOUT_TABLE_SIZE; cp++) {
+        if (sink->layout.entries[cp].kind == LAYOUT_KEY) {
+            ok = ioctl(fd, UI_SET_KEYBIT, sink->layout.entries[cp].code) == 0;
+        }
+    }
+
+    struct uinput_setup setup;
+    memset(&setup, 0, sizeof(setup));
+    setup.id.bustype = BUS_VIRTUAL;
+    setup.id.vendor = 0x1209;
+    setup.id.product = 0x4855;
+    snprintf(setup.name, UINPUT_MAX_NAME_SIZE, "%s", device_name ? device_name : "humanizer");
+
+    ok = ok && ioctl(fd, UI_DEV_SETUP, &setup) == 0 && ioctl(fd, UI_DEV_CREATE) == 0;
+    if (!ok) {
+        printf(ANSI_COLOR_RED "Error: Could not create uinput device (%s)\n" ANSI_COLOR_RESET, strerror(errno));
+        close(fd);
+        free(sink);
+        return NULL;
+    }
+
+    sink->base.name = "uinput";
+    sink->base.layout = &sink->layout;
+    sink->base.Emit = UinputEmit;
+    sink->base.Close = UinputClose;
+    sink->fd = fd;
+    return &sink->base;
+}
@@ -0,0 +1,264 @@
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+#endif
+
+#include "humanizer.h"
+#include "source.h"
+
+#include <stdlib.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#else
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+// Buffer served in TEXT_CHUNK_SIZE slices (also used for memory-mapped files)
+typedef struct {
+    TextSource base;
+    const char* data;      // Start of the text
+    size_t length;         // Total length of the text
+    size_t offset;         // Bytes already handed out
+    void* mapping;         // Mapping to release on close, NULL for caller-owned memory
+    size_t released;       // Mapped bytes already dropped from the resident set
+} MemoryTextSource;
+
+// Text read from a FILE* into one fixed-size buffer
+typedef struct {
+    TextSource base;
+    FILE* file;
+    char buffer[TEXT_CHUNK_SIZE];
+} ChunkedTextSource;
+
+static bool MemoryNext(TextSource* source, const char** data, size_t* length) {
+    MemoryTextSource* memory = (MemoryTextSource*)source;
+
+#if !defined(_WIN32)
+    // Pages behind the previous chunk are done with; let the kernel drop them so
+    // resident memory stays flat however large the mapped file is
+    if (memory->mapping && memory->offset > memory->released) {
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        size_t end = memory->offset / page * page;
+        if (end > memory->released) {
+            madvise((char*)memory->mapping + memory->released, end - memory->released, MADV_DONTNEED);
+            memory->released = end;
+        }
+    }
+#endif
+
+    if (memory->offset >= memory->length) {
+        return false;
+    }
+
+    size_t remaining = memory->length - memory->offset;
+    *data = memory->data + memory->offset;
+    *length = remaining < TEXT_CHUNK_SIZE ? remaining : TEXT_CHUNK_SIZE;
+    memory->offset += *length;
+    return true;
+}
+
+static void MemoryClose(TextSource* source) {
+    MemoryTextSource* memory = (MemoryTextSource*)source;
+#if !defined(_WIN32)
+    if (memory->mapping) {
+        munmap(memory->mapping, memory->length);
+    }
+#endif
+    free(memory);
+}
+
+static MemoryTextSource* AllocateMemorySource(const char* name, const char* text, size_t length) {
+    MemoryTextSource* source = (MemoryTextSource*)calloc(1, sizeof(MemoryTextSource));
+    if (!source) {
+        printf(ANSI_COLOR_RED "Error: Memory allocation failed\n" ANSI_COLOR_RESET);
+        return NULL;
+    }
+    source->base.name = name;
+    source->base.Next = MemoryNext;
+    source->base.Close = MemoryClose;
+    source->base.text = text;
+    source->base.length = length;
+    source->data = text;
+    source->length = length;
+    return source;
+}
+
+// Serve an existing buffer in chunks without copying it
+TextSource* OpenMemoryTextSource(const char* text, size_t length) {
+    MemoryTextSource* source = AllocateMemorySource("memory", text, length);
+    return source ? &source->base : NULL;
+}
+
+static bool ChunkedNext(TextSource* source, const char** data, size_t* length) {
+    ChunkedTextSource* chunked = (ChunkedTextSource*)source;
+    size_t read_size = fread(chunked->buffer, 1, sizeof(chunked->buffer), chunked->file);
+
+    if (read_size == 0) {
+        if (ferror(chunked->file)) {
+            source->failed = true;
+        }
+        return false;
+    }
+
+    *data = chunked->buffer;
+    *length = read_size;
+    return true;
+}
+
+static void ChunkedClose(TextSource* source) {
+    ChunkedTextSource* chunked = (ChunkedTextSource*)source;
+    if (chunked->file != stdin) {
+        fclose(chunked->file);
+    }
+    free(chunked);
+}
+
+static ChunkedTextSource* AllocateChunkedSource(const char* name, FILE* file) {
+    ChunkedTextSource* source = (ChunkedTextSource*)calloc(1, sizeof(ChunkedTextSource));
+    if (!source) {
+        printf(ANSI_COLOR_RED "Error: Memory allocation failed\n" ANSI_COLOR_RESET);
+        return NULL;
+    }
+    source->base.name = name;
+    source->base.Next = ChunkedNext;
+    source->base.Close = ChunkedClose;
+    source->file = file;
+    return source;
+}
+
+// Stream standard input in TEXT_CHUNK_SIZE reads
+TextSource* OpenStdinTextSource(void) {
+#if defined(_WIN32)
+    // Text mode would turn CRLF into LF and stop at a Ctrl+Z byte
+    _setmode(_fileno(stdin), _O_BINARY);
+#endif
+    ChunkedTextSource* source = AllocateChunkedSource("stdin", stdin);
+    return source ? &source->base : NULL;
+}
+
+#if !defined(_WIN32)
+// Map a regular file read-only; NULL (without an error message) when mapping is not possible
+static TextSource* MapFileTextSource(const char* filepath) {
+    int fd = open(filepath, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        close(fd);
+        return NULL;
+    }
+
+    void* mapping = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return NULL;
+    }
+    madvise(mapping, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    MemoryTextSource* source = AllocateMemorySource("mmap", (const char*)mapping, (size_t)st.st_size);
+    if (!source) {
+        munmap(mapping, (size_t)st.st_size);
+        return NULL;
+    }
+    source->mapping = mapping;
+    return &source->base;
+}
+#endif
+
+// Stream a file from disk, memory-mapped where possible, otherwise read in
+// fixed-size chunks; .docx files go through OpenDocxTextSource
+TextSource* OpenFileTextSource(const char* filepath) {
+    if (!IsSupportedFileType(filepath)) {
+        printf(ANSI_COLOR_RED "Error: Unsupported file type\n" ANSI_COLOR_RESET);
+        return NULL;
+    }
+    if (IsDocxFile(filepath)) {
+        return OpenDocxTextSource(filepath);
+    }
+
+#if !defined(_WIN32)
+    TextSource* mapped = MapFileTextSource(filepath);
+    if (mapped) {
+        return mapped;
+    }
+#endif
+
+    FILE* file = fopen(filepath, "rb");
+    if (file == NULL) {
+        printf(ANSI_COLOR_RED "Error: Could not open file\n" ANSI_COLOR_RESET);
+        return NULL;
+    }
+
+    ChunkedTextSource* source = AllocateChunkedSource("file", file);
+    if (!source) {
+        fclose(file);
+        return NULL;
+    }
+    return &source->base;
+}
+
+// Close a source obtained from one of the Open*TextSource functions
+void CloseTextSource(TextSource* source) {
+    if (source) {
+        source->Close(source);
+    }
+}
+
+void InitializeTextBuffer(TextBuffer* buffer) {
+    buffer->data = NULL;
+    buffer->length = 0;
+    buffer->capacity = 0;
+}
+
+void FreeTextBuffer(TextBuffer* buffer) {
+    free(buffer->data);
+    InitializeTextBuffer(buffer);
+}
+
+// Make room for extra more bytes plus the terminator, doubling the allocation
+bool ReserveTextBuffer(TextBuffer* buffer, size_t extra) {
+    size_t needed = buffer->length + extra + 1;
+    if (needed <= buffer->capacity) {
+        return true;
+    }
+
+    size_t capacity = buffer->capacity ? buffer->capacity : TEXT_CHUNK_SIZE;
+    while (capacity < needed) {
+        capacity *= 2;
+    }
+    char* grown = (char*)realloc(buffer->data, capacity);
+    if (!grown) {
+        return false;
+    }
+    buffer->data = grown;
+    buffer->capacity = capacity;
+    return true;
+}
+
+// Append the rest of file, reading straight into the free space
+bool ReadTextBuffer(TextBuffer* buffer, FILE* file, size_t limit) {
+    while (limit == 0 || buffer->length < limit) {
+        if (buffer->capacity - buffer->length <= 1 && !ReserveTextBuffer(buffer, buffer->capacity)) {
+            return false;
+        }
+        size_t room = buffer->capacity - buffer->length - 1;
+        if (limit && room > limit - buffer->length) {
+            room = limit - buffer->length;
+        }
+
+        size_t got = fread(buffer->data + buffer->length, 1, room, file);
+        buffer->length += got;
+        buffer->data[buffer->length] = '\0';
+        if (got < room) {
+            return !ferror(file);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,61 @@
+#ifndef HUMANIZER_CORE_SOURCE_H
+#define HUMANIZER_CORE_SOURCE_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Bytes handed to the typing loop per chunk; bounds the size of each compiled plan
+#define TEXT_CHUNK_SIZE 16384
+
+typedef struct TextSource TextSource;
+
+// Incremental text input. Each backend embeds this as its first member.
+struct TextSource {
+    const char* name;
+    // Point data at the next chunk of text (valid until the following call); false at end
+    bool (*Next)(TextSource* source, const char** data, size_t* length);
+    // Release the backend and free the source
+    void (*Close)(TextSource* source);
+    bool failed;           // Set when Next stopped because of an error rather than end of input
+    const char* text;      // Whole text when the backend holds it in memory (NULL when streamed)
+    size_t length;         // Length of text
+};
+
+// Stream a file from disk, memory-mapped where possible, otherwise read in
+// fixed-size chunks; .docx files go through OpenDocxTextSource
+TextSource* OpenFileTextSource(const char* filepath);
+
+// Stream the body text of a Word .docx document (docx.c)
+TextSource* OpenDocxTextSource(const char* filepath);
+
+// Serve an existing buffer in chunks without copying it
+TextSource* OpenMemoryTextSource(const char* text, size_t length);
+
+// Stream standard input (a pipe or redirected file) in fixed-size chunks;
+// closing the source leaves stdin open
+TextSource* OpenStdinTextSource(void);
+
+// Close a source obtained from one of the Open*TextSource functions
+void CloseTextSource(TextSource* source);
+
+// Text accumulated in one allocation that doubles whenever it runs out of
+// room; data is always NUL-terminated once anything has been added
+typedef struct {
+    char* data;
+    size_t length;         // Bytes of text, excluding the terminator
+    size_t capacity;       // Bytes allocated
+} TextBuffer;
+
+void InitializeTextBuffer(TextBuffer* buffer);
+void FreeTextBuffer(TextBuffer* buffer);
+
+// Make room for at least extra more bytes plus the terminator
+bool ReserveTextBuffer(TextBuffer* buffer, size_t extra);
+
+// Append everything left in file, read in large blocks straight into the
+// buffer; stops early once limit bytes are held (0: no limit). False on a
+// read error or if memory ran out.
+bool ReadTextBuffer(TextBuffer* buffer, FILE* file, size_t limit);
+
+#endif // HUMANIZER_CORE_SOURCE_H
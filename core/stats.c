@@ -0,0 +1,279 @@
+#include "humanizer.h"
+
+#include <string.h>
+
+// Display the progress bar in the console
+void DisplayProgressBar(size_t current, size_t total) {
+    size_t progress = (size_t)((double)current / total * PROGRESS_BAR_WIDTH);
+    printf(ANSI_COLOR_BLUE "\rPreparing: [" ANSI_COLOR_RESET);
+
+    for (size_t i = 0; i < PROGRESS_BAR_WIDTH; i++) {
+        if (i < progress) {
+            printf(ANSI_COLOR_GREEN "#" ANSI_COLOR_RESET);
+        } else {
+            printf(" ");
+        }
+    }
+
+    printf("] %zu%%", (size_t)((double)current / total * 100));
+    fflush(stdout);
+}
+
+// Zero the live counters before a typing session
+void ResetLiveTypingStats(LiveTypingStats* live) {
+    atomic_store_explicit(&live->sequence, 0, memory_order_relaxed);
+    atomic_store_explicit(&live->chars_typed, 0, memory_order_relaxed);
+    atomic_store_explicit(&live->words_typed, 0, memory_order_relaxed);
+    atomic_store_explicit(&live->typos, 0, memory_order_relaxed);
+    atomic_store_explicit(&live->corrections, 0, memory_order_relaxed);
+    atomic_store_explicit(&live->window_chars, 0, memory_order_relaxed);
+    atomic_store_explicit(&live->window_start_ns, 0, memory_order_relaxed);
+    atomic_store_explicit(&live->instant_chars, 0, memory_order_relaxed);
+    atomic_store_explicit(&live->instant_start_ns, 0, memory_order_relaxed);
+    atomic_store_explicit(&live->start_ns, 0, memory_order_relaxed);
+    atomic_store_explicit(&live->paused_ns, 0, memory_order_relaxed);
+}
+
+// Empty the typing thread's statistics before a session
+void ResetTypingMeter(TypingMeter* meter) {
+    meter->head = 0;
+    meter->tail = 0;
+    meter->chars_typed = 0;
+    meter->words_typed = 0;
+    meter->typos = 0;
+    meter->corrections = 0;
+}
+
+// Count one emitted keystroke planned for time_ns on the active timeline and
+// publish the updated statistics. Characters enter the window ring; ones that
+// fell out of the window are dropped from the tail, so each character is
+// added and removed once.
+void RecordKeystroke(TypingMeter* meter, LiveTypingStats* live, uint64_t time_ns, uint16_t flags) {
+    if (flags & KEY_EVENT_CORRECTION) {
+        if (flags & KEY_EVENT_ERASE) {
+            meter->corrections++;
+        } else {
+            meter->typos++;
+        }
+    } else {
+        meter->chars_typed++;
+        meter->times[meter->head++ & (RATE_WINDOW_CAPACITY - 1)] = time_ns;
+        if (meter->head - meter->tail > RATE_WINDOW_CAPACITY) {
+            meter->tail = meter->head - RATE_WINDOW_CAPACITY;
+        }
+        while (meter->times[meter->tail & (RATE_WINDOW_CAPACITY - 1)] + RATE_WINDOW_NS < time_ns) {
+            meter->tail++;
+        }
+    }
+    if (flags & KEY_EVENT_WORD_END) {
+        meter->words_typed++;
+    }
+
+    uint64_t instant = meter->head < RATE_INSTANT_CHARS ? meter->head : RATE_INSTANT_CHARS;
+    unsigned sequence = atomic_load_explicit(&live->sequence, memory_order_relaxed);
+    atomic_store_explicit(&live->sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&live->chars_typed, meter->chars_typed, memory_order_relaxed);
+    atomic_store_explicit(&live->words_typed, meter->words_typed, memory_order_relaxed);
+    atomic_store_explicit(&live->typos, meter->typos, memory_order_relaxed);
+    atomic_store_explicit(&live->corrections, meter->corrections, memory_order_relaxed);
+    atomic_store_explicit(&live->window_chars, (size_t)(meter->head - meter->tail), memory_order_relaxed);
+    atomic_store_explicit(&live->window_start_ns, meter->times[meter->tail & (RATE_WINDOW_CAPACITY - 1)],
+                          memory_order_relaxed);
+    atomic_store_explicit(&live->instant_chars, (size_t)instant, memory_order_relaxed);
+    atomic_store_explicit(&live->instant_start_ns, meter->times[(meter->head - instant) & (RATE_WINDOW_CAPACITY - 1)],
+                          memory_order_relaxed);
+    atomic_store_explicit(&live->sequence, sequence + 2, memory_order_release);
+}
+
+// Characters per minute for chars characters, the first at since_ns, up to
+// now_ns: the rate keeps falling while no new character arrives
+static double CharsPerMinute(size_t chars, uint64_t since_ns, uint64_t now_ns) {
+    if (chars < 2 || now_ns <= since_ns) {
+        return 0.0;
+    }
+    return (double)(chars - 1) / ((double)(now_ns - since_ns) / 60e9);
+}
+
+// Take a consistent snapshot of the live counters and derive speeds and accuracy
+void UpdateTypingStats(TypingStats* stats, const LiveTypingStats* live) {
+    size_t window_chars;
+    size_t instant_chars;
+    uint64_t window_start_ns;
+    uint64_t instant_start_ns;
+    uint64_t start_ns;
+    uint64_t paused_ns;
+    unsigned before;
+
+    // Retry while the typing thread is halfway through an update
+    do {
+        before = atomic_load_explicit(&live->sequence, memory_order_acquire);
+        stats->chars_typed = atomic_load_explicit(&live->chars_typed, memory_order_relaxed);
+        stats->words_typed = atomic_load_explicit(&live->words_typed, memory_order_relaxed);
+        stats->typos = atomic_load_explicit(&live->typos, memory_order_relaxed);
+        stats->corrections = atomic_load_explicit(&live->corrections, memory_order_relaxed);
+        window_chars = atomic_load_explicit(&live->window_chars, memory_order_relaxed);
+        window_start_ns = atomic_load_explicit(&live->window_start_ns, memory_order_relaxed);
+        instant_chars = atomic_load_explicit(&live->instant_chars, memory_order_relaxed);
+        instant_start_ns = atomic_load_explicit(&live->instant_start_ns, memory_order_relaxed);
+        start_ns = atomic_load_explicit(&live->start_ns, memory_order_relaxed);
+        paused_ns = atomic_load_explicit(&live->paused_ns, memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+    } while ((before & 1) || atomic_load_explicit(&live->sequence, memory_order_relaxed) != before);
+
+    // Active time stands still during a pause
+    uint64_t now_ns = paused_ns ? paused_ns : MonotonicNowNs();
+    uint64_t active_ns = start_ns && now_ns > start_ns ? now_ns - start_ns : 0;
+
+    stats->elapsed_time = (double)active_ns / 1e9;
+    stats->current_cpm = CharsPerMinute(window_chars, window_start_ns, active_ns);
+    stats->current_wpm = stats->current_cpm / CHARS_PER_WORD;
+    stats->instant_wpm = CharsPerMinute(instant_chars, instant_start_ns, active_ns) / CHARS_PER_WORD;
+    stats->average_wpm = active_ns ? (double)stats->chars_typed / CHARS_PER_WORD / ((double)active_ns / 60e9) : 0.0;
+    stats->accuracy = stats->chars_typed + stats->typos
+                    ? (double)stats->chars_typed / (double)(stats->chars_typed + stats->typos) : 1.0;
+}
+
+// Display the current typing statistics on the console
+void DisplayTypingStats(const TypingStats* stats) {
+    printf(ANSI_COLOR_BLUE "\rWPM: %.1f (now %.1f, avg %.1f) | CPM: %.0f | Chars: %zu | Words: %zu | "
+           "Typos: %zu | Accuracy: %.1f%% | Time: %.1fs  " ANSI_COLOR_RESET,
+           stats->current_wpm, stats->instant_wpm, stats->average_wpm, stats->current_cpm, stats->chars_typed,
+           stats->words_typed, stats->typos, stats->accuracy * 100.0, stats->elapsed_time);
+    fflush(stdout);
+}
+
+// Default renderer output: the statistics line on the console
+static void DrawConsoleStats(const TypingStats* stats, void* context) {
+    (void)context;
+    DisplayTypingStats(stats);
+}
+
+// Renderer thread body: redraw on fixed ticks until asked to stop, then draw the final state
+static void StatsRendererMain(void* arg) {
+    StatsRenderer* renderer = (StatsRenderer*)arg;
+    TypingStats stats = { 0 };
+    uint64_t next_ns = MonotonicNowNs();
+
+    while (!atomic_load_explicit(&renderer->stop, memory_order_acquire)) {
+        UpdateTypingStats(&stats, renderer->live);
+        renderer->draw(&stats, renderer->context);
+        next_ns += renderer->interval_ns;
+        CoarseSleepUntilNs(next_ns);
+    }
+
+    UpdateTypingStats(&stats, renderer->live);
+    renderer->draw(&stats, renderer->context);
+}
+
+// Start passing statistics snapshots to draw (NULL: the console line)
+// refresh_hz times per second on its own thread
+void StartStatsRenderer(StatsRenderer* renderer, const LiveTypingStats* live, unsigned refresh_hz,
+                        StatsDrawFn draw, void* context) {
+    renderer->live = live;
+    renderer->draw = draw ? draw : DrawConsoleStats;
+    renderer->context = context;
+    renderer->interval_ns = 1000000000ULL / (refresh_hz ? refresh_hz : 1);
+    atomic_init(&renderer->stop, false);
+    renderer->running = StartThread(&renderer->thread, StatsRendererMain, renderer);
+    if (!renderer->running) {
+        printf("Warning: Could not start statistics thread; live statistics are disabled\n");
+    }
+}
+
+// Stop the renderer after one last redraw
+void StopStatsRenderer(StatsRenderer* renderer) {
+    if (!renderer->running) {
+        return;
+    }
+    atomic_store_explicit(&renderer->stop, true, memory_order_release);
+    JoinThread(&renderer->thread);
+    renderer->running = false;
+}
+
+// Empty a delay histogram
+void ResetDelayHistogram(DelayHistogram* histogram) {
+    memset(histogram, 0, sizeof(*histogram));
+}
+
+// Add one keystroke-to-keystroke delay
+void RecordDelay(DelayHistogram* histogram, uint64_t delay_ns) {
+    uint64_t bucket = delay_ns / 1000000;
+    histogram->buckets[bucket < DELAY_HISTOGRAM_BUCKETS ? bucket : DELAY_HISTOGRAM_BUCKETS - 1]++;
+    histogram->count++;
+    histogram->total_ns += delay_ns;
+    if (delay_ns > histogram->max_ns) {
+        histogram->max_ns = delay_ns;
+    }
+}
+
+// Delay in milliseconds below which the given percentage of delays fall (bucket midpoint, capped at the maximum)
+double DelayPercentile(const DelayHistogram* histogram, double percentile) {
+    if (histogram->count == 0) {
+        return 0.0;
+    }
+
+    uint64_t rank = (uint64_t)(percentile / 100.0 * (double)(histogram->count - 1));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < DELAY_HISTOGRAM_BUCKETS - 1; i++) {
+        seen += histogram->buckets[i];
+        if (seen > rank) {
+            double midpoint = (double)i + 0.5;
+            double max_ms = (double)histogram->max_ns / 1e6;
+            return midpoint < max_ms ? midpoint : max_ms;
+        }
+    }
+    return (double)histogram->max_ns / 1e6;
+}
+
+// Print the summary of a dry run
+void DisplayDryRunReport(const TypingReport* report) {
+    double wall = (double)report->wall_ns / 1e9;
+    double planned = (double)report->planned_ns / 1e9;
+    const DelayHistogram* delays = &report->delays;
+
+    printf(ANSI_COLOR_BLUE "Dry run complete\n" ANSI_COLOR_RESET);
+    printf("Characters: %zu | Words: %zu | Keystrokes: %zu | Typos: %zu | Skipped: %zu\n",
+           report->chars_typed, report->words_typed, report->keystrokes, report->typos, report->unmapped_chars);
+    printf("Wall time: %.3fs (%.0f keystrokes/s)\n",
+           wall, wall > 0 ? (double)report->keystrokes / wall : 0.0);
+
+    if (planned > 0 && report->chars_typed > 1) {
+        double planned_wpm = (double)(report->chars_typed - 1) / 5.0 / (planned / 60.0);
+        printf("Planned typing time: %.1fs | Planned WPM: %.1f | Ideal WPM: %.1f (%.0f%%)\n",
+               planned, planned_wpm, report->target_wpm, planned_wpm / report->target_wpm * 100.0);
+    }
+
+    if (delays->count > 0) {
+        printf("Delay between keystrokes (ms): mean %.1f | p1 %.1f | p50 %.1f | p90 %.1f | p99 %.1f | max %.1f\n",
+               (double)delays->total_ns / (double)delays->count / 1e6,
+               DelayPercentile(delays, 1), DelayPercentile(delays, 50), DelayPercentile(delays, 90),
+               DelayPercentile(delays, 99), (double)delays->max_ns / 1e6);
+
+        // Coarse shape of the distribution, one bar per range
+        static const struct {
+            size_t from_ms;
+            size_t to_ms;
+        } kRanges[] = {
+            { 0, 50 }, { 50, 100 }, { 100, 150 }, { 150, 200 }, { 200, 300 },
+            { 300, 500 }, { 500, 1000 }, { 1000, DELAY_HISTOGRAM_BUCKETS },
+        };
+        for (size_t r = 0; r < sizeof(kRanges) / sizeof(kRanges[0]); r++) {
+            uint64_t in_range = 0;
+            for (size_t i = kRanges[r].from_ms; i < kRanges[r].to_ms; i++) {
+                in_range += delays->buckets[i];
+            }
+            double share = (double)in_range / (double)delays->count;
+            if (kRanges[r].to_ms == DELAY_HISTOGRAM_BUCKETS) {
+                printf("  %5zu ms+      ", kRanges[r].from_ms);
+            } else {
+                printf("  %5zu-%-5zu ms ", kRanges[r].from_ms, kRanges[r].to_ms);
+            }
+            printf("%6.2f%% ", share * 100.0);
+            for (size_t i = 0; i < (size_t)(share * PROGRESS_BAR_WIDTH + 0.5); i++) {
+                printf("#");
+            }
+            printf("\n");
+        }
+    }
+}
@@ -0,0 +1,112 @@
+#if defined(__linux__)
+#define _GNU_SOURCE
+#endif
+
+#include "thread.h"
+
+#if defined(_WIN32)
+
+static DWORD WINAPI ThreadTrampoline(LPVOID param) {
+    HumanizerThread* thread = (HumanizerThread*)param;
+    thread->entry(thread->arg);
+    return 0;
+}
+
+// Start entry(arg) on a new thread; false if the thread could not be created
+bool StartThread(HumanizerThread* thread, void (*entry)(void* arg), void* arg) {
+    thread->entry = entry;
+    thread->arg = arg;
+    thread->handle = CreateThread(NULL, 0, ThreadTrampoline, thread, 0, NULL);
+    return thread->handle != NULL;
+}
+
+// Wait for a thread started with StartThread to finish
+void JoinThread(HumanizerThread* thread) {
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+}
+
+unsigned CountProcessors(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (unsigned)info.dwNumberOfProcessors : 1;
+}
+
+bool RaiseThreadPriority(void) {
+    return SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL) != 0;
+}
+
+bool PinThreadToCpu(unsigned cpu) {
+    if (cpu >= 8 * sizeof(DWORD_PTR)) {
+        return false;
+    }
+    return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+}
+
+#else
+
+#include <sched.h>
+#include <unistd.h>
+#if defined(__APPLE__)
+#include <pthread/qos.h>
+#endif
+
+static void* ThreadTrampoline(void* param) {
+    HumanizerThread* thread = (HumanizerThread*)param;
+    thread->entry(thread->arg);
+    return NULL;
+}
+
+// Start entry(arg) on a new thread; false if the thread could not be created
+bool StartThread(HumanizerThread* thread, void (*entry)(void* arg), void* arg) {
+    thread->entry = entry;
+    thread->arg = arg;
+    return pthread_create(&thread->handle, NULL, ThreadTrampoline, thread) == 0;
+}
+
+// Wait for a thread started with StartThread to finish
+void JoinThread(HumanizerThread* thread) {
+    pthread_join(thread->handle, NULL);
+}
+
+unsigned CountProcessors(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (unsigned)count : 1;
+}
+
+#if defined(__APPLE__)
+
+// macOS has no user-settable real-time class without a time-constraint
+// contract; the user-interactive QoS class is the closest match
+bool RaiseThreadPriority(void) {
+    return pthread_set_qos_class_self_np(QOS_CLASS_USER_INTERACTIVE, 0) == 0;
+}
+
+// Thread affinity is not exposed on macOS
+bool PinThreadToCpu(unsigned cpu) {
+    (void)cpu;
+    return false;
+}
+
+#else
+
+// SCHED_FIFO just above the default real-time priority; needs CAP_SYS_NICE or an rtprio limit
+bool RaiseThreadPriority(void) {
+    struct sched_param param;
+    param.sched_priority = sched_get_priority_min(SCHED_FIFO) + 1;
+    return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+}
+
+bool PinThreadToCpu(unsigned cpu) {
+    if (cpu >= CPU_SETSIZE) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+#endif
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef HUMANIZER_CORE_THREAD_H
+#define HUMANIZER_CORE_THREAD_H
+
+#include <stdbool.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+// Thread-local storage qualifier for compilers without C11 _Thread_local
+#if defined(_MSC_VER)
+#define HUMANIZER_THREAD_LOCAL __declspec(thread)
+#else
+#define HUMANIZER_THREAD_LOCAL _Thread_local
+#endif
+
+// Minimal portable thread handle
+typedef struct {
+#if defined(_WIN32)
+    HANDLE handle;
+#else
+    pthread_t handle;
+#endif
+    void (*entry)(void* arg);  // Function run on the new thread
+    void* arg;                 // Argument passed to entry
+} HumanizerThread;
+
+// Start entry(arg) on a new thread; false if the thread could not be created
+bool StartThread(HumanizerThread* thread, void (*entry)(void* arg), void* arg);
+
+// Wait for a thread started with StartThread to finish
+void JoinThread(HumanizerThread* thread);
+
+// Give the calling thread real-time (or the highest available) scheduling
+// priority; false if the OS refused, e.g. for lack of privilege
+bool RaiseThreadPriority(void);
+
+// Processors available to the process (at least 1)
+unsigned CountProcessors(void);
+
+// Keep the calling thread on one CPU; false if that is unsupported or cpu does not exist
+bool PinThreadToCpu(unsigned cpu);
+
+#endif // HUMANIZER_CORE_THREAD_H
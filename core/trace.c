@@ -0,0 +1,271 @@
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+#endif
+
+#include "humanizer.h"
+#include "trace.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// Longest LEB128 encoding of a 64-bit value
+#define VARINT_MAX_BYTES 10
+
+static size_t PutVarint(uint8_t* out, uint64_t value) {
+    size_t used = 0;
+    while (value >= 0x80) {
+        out[used++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[used++] = (uint8_t)value;
+    return used;
+}
+
+static void PutLittleEndian(uint8_t* out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; i++) {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static uint64_t GetLittleEndian(const uint8_t* in, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        value |= (uint64_t)in[i] << (8 * i);
+    }
+    return value;
+}
+
+// Write (or rewrite) the header at the start of the file
+static bool WriteTraceHeader(TraceWriter* writer) {
+    uint8_t header[TRACE_HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+    memcpy(header, TRACE_MAGIC, 4);
+    PutLittleEndian(header + 4, TRACE_VERSION, 2);
+    PutLittleEndian(header + 6, TRACE_HEADER_SIZE, 2);
+    PutLittleEndian(header + 8, writer->event_count, 8);
+    PutLittleEndian(header + 16, writer->last_ns, 8);
+    memcpy(header + 24, writer->sink, TRACE_SINK_NAME_LENGTH);
+    return fwrite(header, 1, sizeof(header), writer->file) == sizeof(header);
+}
+
+// Start a trace of events in sink_name's keycode space
+bool OpenTraceWriter(TraceWriter* writer, const char* path, const char* sink_name) {
+    memset(writer, 0, sizeof(*writer));
+    strncpy(writer->sink, sink_name, TRACE_SINK_NAME_LENGTH - 1);
+
+    writer->file = fopen(path, "wb");
+    if (!writer->file) {
+        printf(ANSI_COLOR_RED "Error: Could not open %s for writing\n" ANSI_COLOR_RESET, path);
+        return false;
+    }
+    if (!WriteTraceHeader(writer)) {
+        printf(ANSI_COLOR_RED "Error: Could not write trace header\n" ANSI_COLOR_RESET);
+        fclose(writer->file);
+        writer->file = NULL;
+        return false;
+    }
+    return true;
+}
+
+// Append a run of planned events (timestamps must not go backwards)
+bool WriteTraceEvents(TraceWriter* writer, const KeyEvent* events, size_t count) {
+    uint8_t buffer[4096];
+    size_t used = 0;
+
+    for (size_t i = 0; i < count && !writer->failed; i++) {
+        const KeyEvent* ev = &events[i];
+        uint64_t delta = ev->time_ns - writer->last_ns;
+        uint8_t tag = (uint8_t)(ev->flags & TRACE_TAG_FLAGS);
+
+        if (used + 1 + 4 * VARINT_MAX_BYTES > sizeof(buffer)) {
+            writer->failed = fwrite(buffer, 1, used, writer->file) != used;
+            used = 0;
+        }
+
+        uint8_t* tag_slot = &buffer[used++];
+        if (delta) {
+            tag |= TRACE_TAG_DELTA;
+            used += PutVarint(buffer + used, delta);
+        }
+        if (ev->code == writer->last_code && writer->event_count > 0) {
+            tag |= TRACE_TAG_SAME_CODE;
+        } else {
+            used += PutVarint(buffer + used, ev->code);
+        }
+        if (ev->mods) {
+            tag |= TRACE_TAG_MODS;
+            used += PutVarint(buffer + used, ev->mods);
+        }
+        if (ev->flags >> 4) {
+            tag |= TRACE_TAG_HIGH_FLAGS;
+            used += PutVarint(buffer + used, (uint64_t)(ev->flags >> 4));
+        }
+        *tag_slot = tag;
+
+        writer->last_ns = ev->time_ns;
+        writer->last_code = ev->code;
+        writer->event_count++;
+    }
+
+    if (used > 0 && !writer->failed) {
+        writer->failed = fwrite(buffer, 1, used, writer->file) != used;
+    }
+    return !writer->failed;
+}
+
+// Fill in the final event count and duration and close the file
+bool CloseTraceWriter(TraceWriter* writer) {
+    if (!writer->file) {
+        return false;
+    }
+
+    bool ok = !writer->failed && fflush(writer->file) == 0 &&
+              fseek(writer->file, 0, SEEK_SET) == 0 && WriteTraceHeader(writer);
+    ok = fclose(writer->file) == 0 && ok;
+    writer->file = NULL;
+    if (!ok) {
+        printf(ANSI_COLOR_RED "Error: Failed to write the keystroke trace\n" ANSI_COLOR_RESET);
+    }
+    return ok;
+}
+
+// Map (or on Windows, read) the whole file
+static bool LoadTraceFile(TraceReader* reader, const char* path) {
+#if !defined(_WIN32)
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size < TRACE_HEADER_SIZE) {
+        close(fd);
+        return false;
+    }
+    void* mapping = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    madvise(mapping, (size_t)st.st_size, MADV_SEQUENTIAL);
+    reader->mapping = mapping;
+    reader->data = (const uint8_t*)mapping;
+    reader->size = (size_t)st.st_size;
+    return true;
+#else
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    long size = (fseek(file, 0, SEEK_END) == 0) ? ftell(file) : -1;
+    uint8_t* data = size >= TRACE_HEADER_SIZE ? (uint8_t*)malloc((size_t)size) : NULL;
+    bool ok = data && fseek(file, 0, SEEK_SET) == 0 && fread(data, 1, (size_t)size, file) == (size_t)size;
+    fclose(file);
+    if (!ok) {
+        free(data);
+        return false;
+    }
+    reader->mapping = data;
+    reader->data = data;
+    reader->size = (size_t)size;
+    return true;
+#endif
+}
+
+// Open a trace for replay and validate its header
+bool OpenTraceReader(TraceReader* reader, const char* path) {
+    memset(reader, 0, sizeof(*reader));
+    if (!LoadTraceFile(reader, path)) {
+        printf(ANSI_COLOR_RED "Error: Could not open trace %s\n" ANSI_COLOR_RESET, path);
+        return false;
+    }
+
+    const uint8_t* header = reader->data;
+    size_t header_size = (size_t)GetLittleEndian(header + 6, 2);
+    if (memcmp(header, TRACE_MAGIC, 4) != 0 || GetLittleEndian(header + 4, 2) != TRACE_VERSION ||
+        header_size < TRACE_HEADER_SIZE || header_size > reader->size) {
+        printf(ANSI_COLOR_RED "Error: %s is not a keystroke trace (or from an incompatible version)\n" ANSI_COLOR_RESET, path);
+        CloseTraceReader(reader);
+        return false;
+    }
+
+    reader->event_count = GetLittleEndian(header + 8, 8);
+    reader->duration_ns = GetLittleEndian(header + 16, 8);
+    memcpy(reader->sink, header + 24, TRACE_SINK_NAME_LENGTH);
+    reader->sink[TRACE_SINK_NAME_LENGTH] = '\0';
+    reader->remaining = reader->event_count;
+    reader->offset = header_size;
+    return true;
+}
+
+// Decode one varint; false if it runs past the end of the file
+static inline bool GetVarint(TraceReader* reader, uint64_t* value) {
+    uint64_t result = 0;
+    for (unsigned shift = 0; shift < 64 && reader->offset < reader->size; shift += 7) {
+        uint8_t byte = reader->data[reader->offset++];
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Decode up to capacity events; returns how many were produced (0 at the end
+// of the trace or on corruption, which sets failed)
+size_t ReadTraceEvents(TraceReader* reader, KeyEvent* events, size_t capacity) {
+    size_t count = 0;
+
+    while (count < capacity && reader->remaining > 0) {
+        if (reader->offset >= reader->size) {
+            reader->failed = true;
+            break;
+        }
+
+        uint8_t tag = reader->data[reader->offset++];
+        uint64_t delta = 0;
+        uint64_t code = reader->code;
+        uint64_t mods = 0;
+        uint64_t high_flags = 0;
+
+        if (((tag & TRACE_TAG_DELTA) && !GetVarint(reader, &delta)) ||
+            (!(tag & TRACE_TAG_SAME_CODE) && !GetVarint(reader, &code)) ||
+            ((tag & TRACE_TAG_MODS) && !GetVarint(reader, &mods)) ||
+            ((tag & TRACE_TAG_HIGH_FLAGS) && !GetVarint(reader, &high_flags))) {
+            reader->failed = true;
+            break;
+        }
+
+        reader->time_ns += delta;
+        reader->code = (uint32_t)code;
+
+        KeyEvent* ev = &events[count++];
+        ev->time_ns = reader->time_ns;
+        ev->code = (uint32_t)code;
+        ev->mods = (uint16_t)mods;
+        ev->flags = (uint16_t)((tag & TRACE_TAG_FLAGS) | (high_flags << 4));
+        reader->remaining--;
+    }
+    return count;
+}
+
+// Release the trace
+void CloseTraceReader(TraceReader* reader) {
+#if !defined(_WIN32)
+    if (reader->mapping) {
+        munmap(reader->mapping, reader->size);
+    }
+#else
+    free(reader->mapping);
+#endif
+    reader->mapping = NULL;
+    reader->data = NULL;
+}
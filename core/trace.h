@@ -0,0 +1,69 @@
+#ifndef HUMANIZER_CORE_TRACE_H
+#define HUMANIZER_CORE_TRACE_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sink.h"
+
+// Keystroke trace file: a fixed header followed by one variable-length record
+// per KeyEvent, all integers little endian.
+//
+// Header (TRACE_HEADER_SIZE bytes):
+//   "HKTR", u16 version, u16 header size, u64 event count, u64 duration ns,
+//   sink name (NUL-padded, TRACE_SINK_NAME_LENGTH bytes)
+// Record:
+//   tag byte: bits 0-3 KEY_EVENT_* flags, bit 4 time delta follows,
+//   bit 5 modifiers follow, bit 6 same code as the previous record,
+//   bit 7 flags above 0xF follow
+//   [varint delta ns] [varint code] [varint mods] [varint flags >> 4]
+// A typical keystroke (press + release) takes 6-7 bytes instead of 32.
+#define TRACE_MAGIC "HKTR"
+#define TRACE_VERSION 1
+#define TRACE_SINK_NAME_LENGTH 16
+#define TRACE_HEADER_SIZE (4 + 2 + 2 + 8 + 8 + TRACE_SINK_NAME_LENGTH)
+
+#define TRACE_TAG_FLAGS      0x0F
+#define TRACE_TAG_DELTA      0x10
+#define TRACE_TAG_MODS       0x20
+#define TRACE_TAG_SAME_CODE  0x40
+#define TRACE_TAG_HIGH_FLAGS 0x80
+
+// Appends plan chunks to a trace file
+typedef struct {
+    FILE* file;
+    uint64_t event_count;  // Records written
+    uint64_t last_ns;      // Time of the previous record
+    uint32_t last_code;    // Code of the previous record
+    bool failed;           // A write failed; the trace is unusable
+    char sink[TRACE_SINK_NAME_LENGTH]; // Sink whose keycodes are recorded
+} TraceWriter;
+
+// Decodes a trace straight from a read-only mapping of the file
+typedef struct {
+    const uint8_t* data;   // Whole file
+    size_t size;
+    size_t offset;         // Next record
+    void* mapping;         // Release on close (mapping on POSIX, heap copy elsewhere)
+    uint64_t event_count;  // From the header
+    uint64_t duration_ns;
+    uint64_t remaining;    // Records not decoded yet
+    uint64_t time_ns;      // Time of the previous record
+    uint32_t code;         // Code of the previous record
+    bool failed;           // The trace is truncated or corrupt
+    char sink[TRACE_SINK_NAME_LENGTH + 1];
+} TraceReader;
+
+// Recording
+bool OpenTraceWriter(TraceWriter* writer, const char* path, const char* sink_name);
+bool WriteTraceEvents(TraceWriter* writer, const KeyEvent* events, size_t count);
+bool CloseTraceWriter(TraceWriter* writer);
+
+// Replay
+bool OpenTraceReader(TraceReader* reader, const char* path);
+size_t ReadTraceEvents(TraceReader* reader, KeyEvent* events, size_t capacity);
+void CloseTraceReader(TraceReader* reader);
+
+#endif // HUMANIZER_CORE_TRACE_H
@@ -0,0 +1,68 @@
+#ifndef HUMANIZER_CORE_UTF8_H
+#define HUMANIZER_CORE_UTF8_H
+
+#include <stdint.h>
+
+// Result of feeding one byte to the decoder
+#define UTF8_CONTINUE 0 // Byte consumed, codepoint not complete yet
+#define UTF8_ACCEPT   1 // Byte consumed, *codepoint is complete
+#define UTF8_REJECT   2 // Malformed sequence dropped; byte NOT consumed, feed it again
+#define UTF8_INVALID  3 // Byte consumed, and with it a malformed character (stray or
+                        // invalid byte, overlong form, surrogate or value past U+10FFFF)
+
+// Incremental UTF-8 decoder; state survives across buffer boundaries
+typedef struct {
+    uint32_t codepoint;    // Bits collected so far
+    uint32_t minimum;      // Smallest codepoint the sequence may encode (rejects overlongs)
+    uint8_t remaining;     // Continuation bytes still expected
+} Utf8Decoder;
+
+static inline void InitializeUtf8Decoder(Utf8Decoder* decoder) {
+    decoder->codepoint = 0;
+    decoder->minimum = 0;
+    decoder->remaining = 0;
+}
+
+// Feed one byte
+static inline int Utf8Step(Utf8Decoder* decoder, uint8_t byte, uint32_t* codepoint) {
+    if (decoder->remaining > 0) {
+        if ((byte & 0xC0) != 0x80) {
+            decoder->remaining = 0;
+            return UTF8_REJECT;
+        }
+        decoder->codepoint = (decoder->codepoint << 6) | (byte & 0x3F);
+        if (--decoder->remaining > 0) {
+            return UTF8_CONTINUE;
+        }
+        *codepoint = decoder->codepoint;
+        if (*codepoint < decoder->minimum || *codepoint > 0x10FFFF ||
+            (*codepoint >= 0xD800 && *codepoint <= 0xDFFF)) {
+            return UTF8_INVALID;
+        }
+        return UTF8_ACCEPT;
+    }
+
+    if (byte < 0x80) {
+        *codepoint = byte;
+        return UTF8_ACCEPT;
+    }
+    if ((byte & 0xE0) == 0xC0) {
+        decoder->codepoint = byte & 0x1F;
+        decoder->minimum = 0x80;
+        decoder->remaining = 1;
+    } else if ((byte & 0xF0) == 0xE0) {
+        decoder->codepoint = byte & 0x0F;
+        decoder->minimum = 0x800;
+        decoder->remaining = 2;
+    } else if ((byte & 0xF8) == 0xF0) {
+        decoder->codepoint = byte & 0x07;
+        decoder->minimum = 0x10000;
+        decoder->remaining = 3;
+    } else {
+        // Stray continuation byte or invalid lead byte
+        return UTF8_INVALID;
+    }
+    return UTF8_CONTINUE;
+}
+
+#endif // HUMANIZER_CORE_UTF8_H
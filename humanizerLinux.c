@@ -0,0 +1,432 @@
+#include "core/humanizer.h"
+#include "core/daemon.h"
+#include "core/scheduler.h"
+#include "core/e2e.h"
+#include "core/calibrate.h"
+#include "core/digraph.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Target words per minute (WPM); keystrokes are scheduled on absolute deadlines
+#define BASE_WPM 100
+
+// Print command line usage
+static void PrintUsage(const char* program) {
+    printf("Usage: %s [--null | --file PATH | --device NAME] [--unicode-input] [--seed N | --steady] [--wpm N]\n"
+           "       [--directives] [--print-plan] [--record PATH] [--replay PATH] [--dry-run PATH]\n"
+           "       [--latency | --latency-json PATH] [--daemon [--workers N] | --submit PATH] [--socket PATH]\n"
+           "       [--realtime] [--emitter-cpu N] [--coalesce-us N] [--load-test N [--threads N]]\n"
+           "       [--e2e [--e2e-pty]] [--profile PATH] [--calibrate OUT [--wpm-sd N] [--typo-rate R] [--sessions N]]\n"
+           "       [--digraphs PATH] [--train-digraphs OUT LOG...] [--keyboard NAME] [--delay SECONDS] [PATH | -]\n", program);
+    printf("  PATH | -         Type PATH (- or piped input: standard input) without menu or screen clears, then exit\n");
+    printf("  --delay SECONDS  Wait before typing PATH or standard input (0 to %.0f, default: 0)\n", MAX_DELAY_S);
+    printf("  --null           Discard keystrokes instead of typing them\n");
+    printf("  --file PATH      Log keystrokes to PATH instead of typing them\n");
+    printf("  --device NAME    Name of the uinput virtual keyboard (default: humanizer)\n");
+    printf("  --unicode-input  Type characters missing from US QWERTY with Ctrl+Shift+U (IBus/GTK)\n");
+    printf("  --seed N         Seed for typos and timing variation (same seed, same typing)\n");
+    printf("  --steady         Type evenly spaced keystrokes without typos or pauses\n");
+    printf("  --wpm N          Target words per minute, at most %d (default: %d)\n", MAX_WPM, BASE_WPM);
+    printf("  --directives     Obey {PAUSE}, {PAUSE:N}, {WPM:N} and {TYPOS:N} in the text and tidy list indentation\n");
+    printf("  --print-plan     List the compiled keystroke plan before typing\n");
+    printf("  --record PATH    Save each session's keystrokes as a binary trace (works with --dry-run)\n");
+    printf("  --replay PATH    Type a recorded trace exactly as it was planned, then exit\n");
+    printf("  --dry-run PATH   Run PATH through the whole pipeline on a virtual clock and report timing\n");
+    printf("  --realtime       Run the thread that emits keystrokes at real-time priority (needs CAP_SYS_NICE)\n");
+    printf("  --emitter-cpu N  Pin the thread that emits keystrokes to CPU N\n");
+    printf("  --coalesce-us N  Send the keystrokes already due, or due within N microseconds, in one write\n"
+           "                   (%llu matches the emitter's spin; default: 0, every keystroke on its own)\n",
+           (unsigned long long)(SCHEDULER_SPIN_NS / 1000));
+    printf("  --latency        Time every keystroke against its deadline and print percentiles after typing\n");
+    printf("  --latency-json PATH  Like --latency, and also write the timings as a Chrome trace to PATH\n");
+    printf("  --daemon         Serve typing jobs on a Unix socket, one uinput device per worker\n");
+    printf("  --workers N      Jobs the daemon types at the same time (default: %d)\n", DAEMON_DEFAULT_WORKERS);
+    printf("  --submit PATH    Send PATH (- for standard input) to the daemon; typing starts 3s after the job does\n");
+    printf("  --load-test N    Type PATH on N streams at once (one uinput device each, or --null) and report\n"
+           "                   keystroke lateness and CPU use\n");
+    printf("  --threads N      Threads the load test multiplexes its streams onto (default: %d)\n", SCHEDULER_DEFAULT_THREADS);
+    printf("  --e2e            Type PATH (default: a built-in sample) into a pseudo-terminal and, with /dev/uinput,\n"
+           "                   into grabbed virtual keyboards read back through evdev; check the received text\n"
+           "                   and time every keystroke (default --wpm: %d)\n", E2E_DEFAULT_WPM);
+    printf("  --e2e-pty        Leave the uinput keyboards out of --e2e\n");
+    printf("  --profile PATH   Type with the speed and humanize settings of a profile file (--wpm still wins)\n");
+    printf("  --calibrate OUT  Plan seeded sessions over slices of PATH on every CPU, search for the profile whose\n"
+           "                   sessions average --wpm with --wpm-sd spread and --typo-rate typos, and write it to OUT\n");
+    printf("  --wpm-sd N       Target standard deviation of session WPM (default: %.0f%% of --wpm)\n",
+           CALIBRATE_DEFAULT_SD_SHARE * 100.0);
+    printf("  --typo-rate R    Target typos per character typed (default: %g)\n", CALIBRATE_DEFAULT_TYPO_RATE);
+    printf("  --sessions N     Sessions measured per candidate profile (default: %d, --threads sets the workers)\n",
+           CALIBRATE_DEFAULT_SESSIONS);
+    printf("  --digraphs PATH  Time each keystroke by its key pair from a digraph profile (replaces speed variation)\n");
+    printf("  --train-digraphs OUT LOG...  Build a digraph profile from raw evdev recordings\n"
+           "                   (e.g. cat /dev/input/eventN > LOG while typing) and write it to OUT\n");
+    printf("  --keyboard NAME  Layout the typist's fingers know: where typos land and what digraphs and key\n"
+           "                   travel are measured on (qwerty, azerty, qwertz, dvorak, colemak; default: qwerty)\n");
+    printf("  --socket PATH    Daemon socket (default: $XDG_RUNTIME_DIR/" DAEMON_SOCKET_NAME ")\n");
+}
+
+// Read a --delay value: a number of seconds with nothing after it, finite
+// and at most MAX_DELAY_S, as the daemon's delay= option
+static bool ParseDelay(const char* text, double* seconds) {
+    char* end = NULL;
+    double value = strtod(text, &end);
+    if (end == text || *end != '\0' || !isfinite(value) || value < 0 || value > MAX_DELAY_S) {
+        return false;
+    }
+    *seconds = value;
+    return true;
+}
+
+// Apply the command line settings that InitializeSimulator resets
+static void ConfigureSimulator(TypingSimulator* simulator, bool print_plan, bool steady, bool directives,
+                               bool realtime, int emitter_cpu, const char* coalesce_us, const char* seed,
+                               const TypingProfile* profile, const DigraphProfile* digraphs,
+                               const char* record_path, LatencyTracer* latency, RunControl* control) {
+    simulator->plan_listing = print_plan ? stderr : NULL;
+    simulator->record_path = record_path;
+    simulator->latency = latency;
+    simulator->control = control;
+    simulator->resumable = control != NULL;
+    simulator->directives = directives;
+    simulator->realtime = realtime;
+    simulator->emitter_cpu = emitter_cpu;
+    simulator->humanized = !steady;
+    if (coalesce_us) {
+        simulator->coalesce_ns = strtoull(coalesce_us, NULL, 10) * 1000ULL;
+    }
+    if (seed) {
+        simulator->seed = strtoull(seed, NULL, 0);
+    }
+    if (profile) {
+        BuildHumanizeModel(&simulator->humanize, &profile->humanize);
+    }
+    simulator->humanize.digraphs = digraphs;
+}
+
+int main(int argc, char** argv) {
+    const char* file_path = NULL;
+    const char* device_name = "humanizer";
+    bool use_null = false;
+    bool print_plan = false;
+    bool unicode_input = false;
+    bool steady = false;
+    bool directives = false;
+    bool realtime = false;
+    int emitter_cpu = -1;
+    const char* coalesce_us = NULL;
+    const char* seed = NULL;
+    const char* dry_run_path = NULL;
+    const char* record_path = NULL;
+    const char* replay_path = NULL;
+    bool latency = false;
+    const char* latency_path = NULL;
+    double wpm = BASE_WPM;
+    bool wpm_set = false;
+    bool daemon = false;
+    const char* submit_path = NULL;
+    const char* socket_path = NULL;
+    size_t workers = DAEMON_DEFAULT_WORKERS;
+    size_t load_streams = 0;
+    size_t threads = SCHEDULER_DEFAULT_THREADS;
+    bool threads_set = false;
+    bool e2e = false;
+    bool e2e_pty = false;
+    const char* profile_path = NULL;
+    const char* calibrate_path = NULL;
+    const char* digraphs_path = NULL;
+    const char* keyboard_name = NULL;
+    const char* train_digraphs_path = NULL;
+    const char* const* digraph_logs = NULL;
+    size_t digraph_log_count = 0;
+    double wpm_sd = -1.0;
+    double typo_rate = CALIBRATE_DEFAULT_TYPO_RATE;
+    size_t sessions = CALIBRATE_DEFAULT_SESSIONS;
+    const char* input_path = NULL;
+    double delay = 0.0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--null") == 0) {
+            use_null = true;
+        } else if (strcmp(argv[i], "--file") == 0 && i + 1 < argc) {
+            file_path = argv[++i];
+        } else if (strcmp(argv[i], "--device") == 0 && i + 1 < argc) {
+            device_name = argv[++i];
+        } else if (strcmp(argv[i], "--unicode-input") == 0) {
+            unicode_input = true;
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = argv[++i];
+        } else if (strcmp(argv[i], "--steady") == 0) {
+            steady = true;
+        } else if (strcmp(argv[i], "--wpm") == 0 && i + 1 < argc && IsValidWpm(atof(argv[i + 1]))) {
+            wpm = atof(argv[++i]);
+            wpm_set = true;
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay_path = argv[++i];
+        } else if (strcmp(argv[i], "--dry-run") == 0 && i + 1 < argc) {
+            dry_run_path = argv[++i];
+        } else if (strcmp(argv[i], "--latency") == 0) {
+            latency = true;
+        } else if (strcmp(argv[i], "--latency-json") == 0 && i + 1 < argc) {
+            latency = true;
+            latency_path = argv[++i];
+        } else if (strcmp(argv[i], "--daemon") == 0) {
+            daemon = true;
+        } else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            workers = (size_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--submit") == 0 && i + 1 < argc) {
+            submit_path = argv[++i];
+        } else if (strcmp(argv[i], "--load-test") == 0 && i + 1 < argc) {
+            load_streams = (size_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = (size_t)strtoul(argv[++i], NULL, 10);
+            threads_set = true;
+        } else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            profile_path = argv[++i];
+        } else if (strcmp(argv[i], "--calibrate") == 0 && i + 1 < argc) {
+            calibrate_path = argv[++i];
+        } else if (strcmp(argv[i], "--wpm-sd") == 0 && i + 1 < argc && atof(argv[i + 1]) >= 0) {
+            wpm_sd = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--typo-rate") == 0 && i + 1 < argc && atof(argv[i + 1]) >= 0) {
+            typo_rate = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--sessions") == 0 && i + 1 < argc && atoi(argv[i + 1]) >= 2) {
+            sessions = (size_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--digraphs") == 0 && i + 1 < argc) {
+            digraphs_path = argv[++i];
+        } else if (strcmp(argv[i], "--keyboard") == 0 && i + 1 < argc) {
+            keyboard_name = argv[++i];
+        } else if (strcmp(argv[i], "--train-digraphs") == 0 && i + 2 < argc) {
+            train_digraphs_path = argv[++i];
+            digraph_logs = (const char* const*)&argv[i + 1];
+            while (i + 1 < argc && argv[i + 1][0] != '-') {
+                digraph_log_count++;
+                i++;
+            }
+        } else if (strcmp(argv[i], "--e2e") == 0) {
+            e2e = true;
+        } else if (strcmp(argv[i], "--e2e-pty") == 0) {
+            e2e = true;
+            e2e_pty = true;
+        } else if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+            socket_path = argv[++i];
+        } else if (strcmp(argv[i], "--directives") == 0) {
+            directives = true;
+        } else if (strcmp(argv[i], "--realtime") == 0) {
+            realtime = true;
+        } else if (strcmp(argv[i], "--emitter-cpu") == 0 && i + 1 < argc && atoi(argv[i + 1]) >= 0) {
+            emitter_cpu = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--coalesce-us") == 0 && i + 1 < argc && atoi(argv[i + 1]) >= 0) {
+            coalesce_us = argv[++i];
+        } else if (strcmp(argv[i], "--print-plan") == 0) {
+            print_plan = true;
+        } else if (strcmp(argv[i], "--delay") == 0 && i + 1 < argc && ParseDelay(argv[i + 1], &delay)) {
+            i++;
+        } else if (!input_path && (argv[i][0] != '-' || strcmp(argv[i], "-") == 0)) {
+            input_path = argv[i];
+        } else {
+            PrintUsage(argv[0]);
+            return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    char default_socket[MAX_PATH_LENGTH];
+    if (!socket_path) {
+        DefaultDaemonSocketPath(default_socket, sizeof(default_socket));
+        socket_path = default_socket;
+    }
+
+    TypingProfile profile;
+    profile.wpm = 0.0;
+    DefaultHumanizeProfile(&profile.humanize);
+    if (profile_path) {
+        if (!LoadTypingProfile(profile_path, &profile)) {
+            return 1;
+        }
+        if (!wpm_set && profile.wpm > 0) {
+            wpm = profile.wpm;
+        }
+    }
+    if (keyboard_name && (profile.humanize.keyboard = FindKeyboardLayout(keyboard_name)) < 0) {
+        printf(ANSI_COLOR_RED "Error: Unknown keyboard layout %s\n" ANSI_COLOR_RESET, keyboard_name);
+        return 1;
+    }
+    const TypingProfile* typing_profile = profile_path || keyboard_name ? &profile : NULL;
+
+    DigraphProfile* digraphs = NULL;
+    if (digraphs_path && !(digraphs = LoadDigraphProfile(digraphs_path))) {
+        return 1;
+    }
+
+    if (train_digraphs_path) {
+        if (digraph_log_count == 0) {
+            printf(ANSI_COLOR_RED "Error: --train-digraphs needs at least one evdev log\n" ANSI_COLOR_RESET);
+            return 1;
+        }
+        return TrainDigraphProfile(digraph_logs, digraph_log_count, train_digraphs_path);
+    }
+
+    if (calibrate_path) {
+        if (!input_path || strcmp(input_path, "-") == 0) {
+            printf(ANSI_COLOR_RED "Error: --calibrate needs a sample file to type\n" ANSI_COLOR_RESET);
+            return 1;
+        }
+        CalibrationOptions options = { input_path, calibrate_path, wpm, wpm_sd >= 0 ? wpm_sd : wpm * CALIBRATE_DEFAULT_SD_SHARE,
+                                       typo_rate, sessions, CALIBRATE_DEFAULT_SESSION_CHARS,
+                                       threads_set ? (unsigned)threads : 0, seed ? strtoull(seed, NULL, 0) : 1 };
+        return RunCalibration(&options);
+    }
+
+    if (daemon) {
+        DaemonOptions options = { socket_path, workers, device_name, unicode_input, wpm };
+        return RunDaemon(&options);
+    }
+
+    if (load_streams > 0) {
+        if (!input_path || strcmp(input_path, "-") == 0) {
+            printf(ANSI_COLOR_RED "Error: --load-test needs a file to type\n" ANSI_COLOR_RESET);
+            return 1;
+        }
+        LoadTestOptions options = { input_path, load_streams, threads, use_null, device_name, unicode_input, wpm,
+                                    steady, directives, seed ? strtoull(seed, NULL, 0) : (uint64_t)time(NULL), 1.0,
+                                    coalesce_us ? strtoull(coalesce_us, NULL, 10) * 1000ULL : 0 };
+        return RunLoadTest(&options);
+    }
+
+    if (e2e) {
+        if (input_path && strcmp(input_path, "-") == 0) {
+            printf(ANSI_COLOR_RED "Error: --e2e needs a file to type\n" ANSI_COLOR_RESET);
+            return 1;
+        }
+        EndToEndOptions options = { input_path, wpm_set ? wpm : E2E_DEFAULT_WPM, steady,
+                                    seed ? strtoull(seed, NULL, 0) : (uint64_t)time(NULL), e2e_pty };
+        return RunEndToEndTest(&options);
+    }
+
+    if (submit_path) {
+        // Only forward what was set, so the daemon's defaults apply otherwise
+        char job_options[256];
+        int used = snprintf(job_options, sizeof(job_options), "delay=3%s%s%s",
+                            use_null ? " sink=null" : "", steady ? " steady=1" : "", directives ? " directives=1" : "");
+        if (seed) {
+            used += snprintf(job_options + used, sizeof(job_options) - (size_t)used, " seed=%s", seed);
+        }
+        if (wpm_set && (size_t)used < sizeof(job_options)) {
+            snprintf(job_options + used, sizeof(job_options) - (size_t)used, " wpm=%g", wpm);
+        }
+        return SubmitDaemonJob(socket_path, submit_path, job_options);
+    }
+
+    // Dry runs never touch /dev/uinput
+    KeySink* sink;
+    if (use_null || (dry_run_path && !file_path)) {
+        sink = OpenNullSink();
+    } else if (file_path) {
+        sink = OpenFileSink(file_path);
+    } else {
+        sink = OpenUinputSink(device_name, unicode_input);
+    }
+    if (!sink) {
+        return 1;
+    }
+
+    LatencyTracer* tracer = NULL;
+    if (latency && !(tracer = CreateLatencyTracer(LATENCY_DEFAULT_CAPACITY, latency_path))) {
+        UnloadDigraphProfile(digraphs);
+        CloseSink(sink);
+        return 1;
+    }
+
+    // Pause/stop hotkeys, started below for sessions typed in real time
+    RunControl control;
+    InitializeRunControl(&control);
+    HotkeyListener* hotkeys = NULL;
+
+    TypingSimulator simulator;
+    InitializeSimulator(&simulator, sink, wpm);
+    ConfigureSimulator(&simulator, print_plan, steady, directives, realtime, emitter_cpu, coalesce_us, seed,
+                       typing_profile, digraphs, record_path, tracer, NULL);
+
+    if (dry_run_path) {
+        TextSource* source = OpenFileTextSource(dry_run_path);
+        if (source && source->text) {
+            DescribeText(&simulator, source->text, source->length);
+        }
+        TypingReport report;
+        bool ok = source && DryRunTyping(&simulator, source, &report);
+        if (source && !ok) {
+            printf(ANSI_COLOR_RED "Error: %s\n" ANSI_COLOR_RESET, report.error);
+        }
+        if (ok) {
+            DisplayDryRunReport(&report);
+            if (simulator.humanized) {
+                printf("Seed: %llu\n", (unsigned long long)simulator.seed);
+            }
+        }
+        CloseTextSource(source);
+        CleanupSimulator(&simulator);
+        DestroyLatencyTracer(tracer);
+        UnloadDigraphProfile(digraphs);
+        CloseSink(sink);
+        return ok ? 0 : 1;
+    }
+
+    // Piped input means nobody is there to answer the menu
+    if (!replay_path && !input_path && !StandardInputIsInteractive()) {
+        input_path = "-";
+    }
+    if (input_path) {
+        hotkeys = StartHotkeyListener(&control);
+        simulator.control = hotkeys ? &control : NULL;
+        simulator.resumable = hotkeys != NULL;
+        int status = TypeNonInteractive(&simulator, input_path, delay);
+        StopHotkeyListener(hotkeys);
+        CleanupSimulator(&simulator);
+        DestroyLatencyTracer(tracer);
+        UnloadDigraphProfile(digraphs);
+        CloseSink(sink);
+        return status;
+    }
+
+    if (replay_path) {
+        hotkeys = StartHotkeyListener(&control);
+        simulator.control = hotkeys ? &control : NULL;
+        simulator.resumable = hotkeys != NULL;
+        ReplayTrace(&simulator, replay_path);
+        StopHotkeyListener(hotkeys);
+        CleanupSimulator(&simulator);
+        DestroyLatencyTracer(tracer);
+        UnloadDigraphProfile(digraphs);
+        CloseSink(sink);
+        return 0;
+    }
+
+    ClearScreen();
+    hotkeys = StartHotkeyListener(&control);
+    simulator.control = hotkeys ? &control : NULL;
+    simulator.resumable = hotkeys != NULL;
+
+    printf(ANSI_COLOR_BLUE "Humanizer Typing Simulator (Linux)\n" ANSI_COLOR_RESET);
+    printf("============================\n");
+    printf("Base WPM: %.0f\n", wpm);
+    printf("Output: %s sink\n", sink->name);
+    if (hotkeys) {
+        printf("Hotkeys: " HOTKEY_PAUSE_NAME " to pause/resume, " HOTKEY_STOP_NAME " to stop\n");
+    }
+    printf("Supported file types: txt, docx\n");
+
+    while (1) {
+        HandleInputChoice(&simulator);
+        CleanupSimulator(&simulator);
+        InitializeSimulator(&simulator, sink, wpm);
+        ConfigureSimulator(&simulator, print_plan, steady, directives, realtime, emitter_cpu, coalesce_us, seed,
+                           typing_profile, digraphs, record_path, tracer, hotkeys ? &control : NULL);
+        printf("\n");
+    }
+
+    UnloadDigraphProfile(digraphs);
+    CloseSink(sink);
+    return 0;
+}
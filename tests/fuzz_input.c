@@ -0,0 +1,206 @@
+#include "humanizer.h"
+#include "test_files.h"
+
+// Fuzz target for file loading. Each input is loaded through LoadFileContent
+// three ways: as a .txt file, as a .docx file (the ZIP reader and inflater)
+// and wrapped as the XML of a stored .docx (the XML scanner). Whatever loads
+// is then compiled with directives on, so the UTF-8 decoder and directive
+// lexer see it too. LoadFileContent reports rejected files on stdout; pass
+// -close_fd_mask=1 to libFuzzer to keep it quiet.
+//
+// Built with HUMANIZER_LIBFUZZER this is a plain libFuzzer target. Otherwise
+// main runs the files named on the command line, or mutates the seeds below
+// for --iterations rounds (with --seed for the generator), which is enough for
+// a smoke test on any compiler.
+
+#define FUZZ_MAX_INPUT 4096
+
+// Crash (so the fuzzer keeps the input) if an invariant does not hold
+#define FUZZ_ASSERT(condition)                                                      \
+    do {                                                                            \
+        if (!(condition)) {                                                         \
+            fprintf(stderr, "%s:%d: invariant failed: %s\n", __FILE__, __LINE__, #condition); \
+            abort();                                                                \
+        }                                                                           \
+    } while (0)
+
+// Compile loaded text the way the simulator does and check the plan is well formed
+static void PlanLoadedText(KeySink* sink, const HumanizeModel* model, const char* text, size_t length) {
+    KeyPlanner planner;
+    KeyPlan plan;
+    InitializePlanner(&planner, sink, 120.0, model, length);
+    planner.directives = true;
+    InitializePlan(&plan);
+    bool ok = PlanText(&planner, &plan, text, length) && FinishPlan(&planner, &plan);
+    FUZZ_ASSERT(ok);
+    for (size_t i = 1; i < plan.count; i++) {
+        FUZZ_ASSERT(plan.events[i].time_ns >= plan.events[i - 1].time_ns);
+    }
+    for (size_t i = 0; i < plan.count; i += PlanGroupLength(&plan, i)) {
+        FUZZ_ASSERT(PlanBurstLength(&plan, i, UINT64_MAX, EMIT_BURST_EVENTS) >= PlanGroupLength(&plan, i));
+    }
+    CleanupPlan(&plan);
+}
+
+// Load one file and plan it; txt_size is the expected length of a .txt load
+static void LoadAndPlan(const char* path, size_t txt_size, KeySink* sink, const HumanizeModel* model) {
+    TypingSimulator simulator;
+    memset(&simulator, 0, sizeof(simulator));
+    if (!path || !LoadFileContent(path, &simulator)) {
+        return;
+    }
+    FUZZ_ASSERT(simulator.length > 0 && simulator.length < MAX_TEXT_LENGTH);
+    FUZZ_ASSERT(simulator.text[simulator.length] == '\0');
+    FUZZ_ASSERT(IsDocxFile(path) || simulator.length == txt_size);
+    PlanLoadedText(sink, model, simulator.text, simulator.length);
+    free(simulator.text);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    static KeySink* sink;
+    static HumanizeModel model;
+    if (!sink) {
+        sink = OpenNullSink();
+        HumanizeProfile profile;
+        DefaultHumanizeProfile(&profile);
+        BuildHumanizeModel(&model, &profile);
+    }
+    if (size > FUZZ_MAX_INPUT) {
+        return 0;
+    }
+
+    LoadAndPlan(WriteTestFile("fuzz.txt", data, size), size, sink, &model);
+    LoadAndPlan(WriteTestFile("fuzz.docx", data, size), 0, sink, &model);
+
+    static uint8_t archive[DOCX_OVERHEAD + FUZZ_MAX_INPUT];
+    size_t archive_size = BuildDocx(data, size, 0, archive);
+    LoadAndPlan(WriteTestFile("fuzz-xml.docx", archive, archive_size), 0, sink, &model);
+    return 0;
+}
+
+#ifndef HUMANIZER_LIBFUZZER
+
+// A short word/document.xml compressed with raw deflate
+static const uint8_t deflated_xml[] = {
+    0xb3, 0x29, 0xb7, 0x4a, 0xc9, 0x4f, 0x2e, 0xcd, 0x4d, 0xcd, 0x2b, 0xb1, 0xb3, 0x29, 0xb7, 0x4a,
+    0xca, 0x4f, 0xa9, 0x04, 0xd1, 0x05, 0x20, 0xa2, 0x08, 0x44, 0x94, 0xd8, 0xb9, 0xa4, 0xa6, 0xe5,
+    0x24, 0x96, 0xa4, 0xa6, 0x28, 0x54, 0x87, 0x07, 0xf8, 0x5a, 0x19, 0x1a, 0x19, 0xd4, 0x96, 0xa4,
+    0x56, 0x94, 0x28, 0xa8, 0x25, 0xe6, 0x16, 0x58, 0x2b, 0xe4, 0xe6, 0x17, 0xa5, 0xda, 0xe8, 0x83,
+    0x94, 0x81, 0xc8, 0x22, 0x30, 0x59, 0x80, 0x6e, 0x82, 0xae, 0x42, 0x66, 0x49, 0x6a, 0xae, 0x42,
+    0x7e, 0x1e, 0x36, 0xa5, 0xfa, 0x30, 0x5b, 0xf5, 0x91, 0x9c, 0x02, 0x00,
+};
+
+static const char* const text_seeds[] = {
+    "Plain text with a CRLF\r\nand a lone CR\rend.",
+    "{WPM:90}Speed {TYPOS:5}changes {PAUSE:0.01}and {{braces}} {UNKNOWN} {WPM:}\n",
+    "  - bullet\n\t* nested\n12. numbered\n   3.not a marker\n",
+    "Gr\xC3\xBC\xC3\x9F" "e \xE2\x80\x94 \xF0\x9F\x98\x80 \xC3 truncated \xE2\x82 \xFF\xFE",
+    "<w:p><w:r><w:t>Fish &amp; chips &#233;&#x1F600;&bogus;&#xD800;</w:t><w:tab/><w:br/></w:r></w:p>"
+    "<w:tabs><w:tab w:val='left'/></w:tabs><w:t/><w:t attr=\"a>b\">x</w:t>",
+};
+
+// One random edit: flip a bit, overwrite, insert or delete a byte, or repeat a slice
+static size_t Mutate(RandomState* rng, uint8_t* data, size_t size) {
+    size_t at = size ? (size_t)(NextRandom(rng) % size) : 0;
+    switch (NextRandom(rng) % 5) {
+        case 0:
+            if (size) {
+                data[at] ^= (uint8_t)(1u << (NextRandom(rng) % 8));
+            }
+            return size;
+        case 1:
+            if (size) {
+                data[at] = (uint8_t)NextRandom(rng);
+            }
+            return size;
+        case 2:
+            if (size < FUZZ_MAX_INPUT) {
+                memmove(data + at + 1, data + at, size - at);
+                data[at] = (uint8_t)NextRandom(rng);
+                size++;
+            }
+            return size;
+        case 3:
+            if (size) {
+                memmove(data + at, data + at + 1, size - at - 1);
+                size--;
+            }
+            return size;
+        default: {
+            size_t length = size - at < 16 ? size - at : 16;
+            if (size + length <= FUZZ_MAX_INPUT) {
+                memmove(data + at + length, data + at, size - at);
+                size += length;
+            }
+            return size;
+        }
+    }
+}
+
+// Run one file given on the command line
+static bool RunFile(const char* path) {
+    static uint8_t data[FUZZ_MAX_INPUT];
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "Could not open %s\n", path);
+        return false;
+    }
+    size_t size = fread(data, 1, sizeof(data), file);
+    fclose(file);
+    LLVMFuzzerTestOneInput(data, size);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    size_t iterations = 1000;
+    uint64_t seed = 1;
+    int files = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = (size_t)strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 0);
+        } else if (!RunFile(argv[i])) {
+            return 1;
+        } else {
+            files++;
+        }
+    }
+    if (files > 0) {
+        return 0;
+    }
+
+    // Seeds: the text samples, plus the XML sample as a stored .docx and a deflated .docx
+    static uint8_t seeds[8][FUZZ_MAX_INPUT];
+    size_t seed_sizes[8];
+    size_t seed_count = 0;
+    for (size_t i = 0; i < sizeof(text_seeds) / sizeof(text_seeds[0]); i++, seed_count++) {
+        seed_sizes[seed_count] = strlen(text_seeds[i]);
+        memcpy(seeds[seed_count], text_seeds[i], seed_sizes[seed_count]);
+    }
+    seed_sizes[seed_count] = BuildDocx(text_seeds[4], strlen(text_seeds[4]), 0, seeds[seed_count]);
+    seed_count++;
+    seed_sizes[seed_count] = BuildDocx(deflated_xml, sizeof(deflated_xml), 8, seeds[seed_count]);
+    seed_count++;
+
+    RandomState rng;
+    SeedRandom(&rng, seed);
+    static uint8_t input[FUZZ_MAX_INPUT];
+    for (size_t i = 0; i < iterations; i++) {
+        // Every seed runs once unchanged before the mutations start
+        size_t pick = i < seed_count ? i : (size_t)(NextRandom(&rng) % seed_count);
+        size_t size = seed_sizes[pick];
+        memcpy(input, seeds[pick], size);
+        size_t edits = i < seed_count ? 0 : 1 + (size_t)(NextRandom(&rng) % 8);
+        for (size_t e = 0; e < edits; e++) {
+            size = Mutate(&rng, input, size);
+        }
+        LLVMFuzzerTestOneInput(input, size);
+    }
+    fprintf(stderr, "%zu inputs from %zu seeds (seed %llu) passed\n", iterations, seed_count,
+            (unsigned long long)seed);
+    return 0;
+}
+
+#endif // HUMANIZER_LIBFUZZER
@@ -0,0 +1,40 @@
+#ifndef HUMANIZER_TESTS_TEST_H
+#define HUMANIZER_TESTS_TEST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_files.h"
+
+// Minimal assertions for the unit tests: a failed check is reported and the
+// test carries on, and main fails the test if any check did
+static int test_failures = 0;
+
+#define CHECK(condition)                                                            \
+    do {                                                                            \
+        if (!(condition)) {                                                         \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            test_failures++;                                                        \
+        }                                                                           \
+    } while (0)
+
+#define CHECK_EQ_SIZE(actual, expected)                                             \
+    do {                                                                            \
+        size_t actual_ = (size_t)(actual), expected_ = (size_t)(expected);          \
+        if (actual_ != expected_) {                                                 \
+            fprintf(stderr, "%s:%d: %s is %zu, expected %zu\n", __FILE__, __LINE__, \
+                    #actual, actual_, expected_);                                   \
+            test_failures++;                                                        \
+        }                                                                           \
+    } while (0)
+
+// Run one test function and name it in the log
+#define RUN_TEST(test)                                                              \
+    do {                                                                            \
+        int before_ = test_failures;                                                \
+        test();                                                                     \
+        printf("%s %s\n", test_failures == before_ ? "ok  " : "FAIL", #test);       \
+    } while (0)
+
+#endif // HUMANIZER_TESTS_TEST_H
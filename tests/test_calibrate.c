@@ -0,0 +1,99 @@
+#include "humanizer.h"
+#include "calibrate.h"
+#include "test.h"
+
+static const char corpus[] =
+    "The quick brown fox jumps over the lazy dog. Pack my box with five dozen liquor jugs! "
+    "How vexingly quick daft zebras jump. Sphinx of black quartz, judge my vow.\n"
+    "Waltz, bad nymph, for quick jigs vex. Glib jocks quiz nymph to vex dwarf. "
+    "Jackdaws love my big sphinx of quartz. The five boxing wizards jump quickly.\n";
+
+// A saved profile loads back as written; comments and blank lines are skipped
+static void TestProfileRoundTrip(void) {
+    TypingProfile saved;
+    saved.wpm = 87.5;
+    DefaultHumanizeProfile(&saved.humanize);
+    saved.humanize.typo_probability = 0.0375;
+    saved.humanize.pause_median = 1.25;
+    saved.humanize.distance_weight = 0.375;
+    saved.humanize.keyboard = KEYBOARD_COLEMAK;
+    const char* path = WriteTestFile("profile.txt", "", 0);
+    CHECK(path && SaveTypingProfile(path, &saved, "Two comment\nlines"));
+
+    TypingProfile loaded;
+    loaded.wpm = 0.0;
+    DefaultHumanizeProfile(&loaded.humanize);
+    CHECK(path && LoadTypingProfile(path, &loaded));
+    CHECK(loaded.wpm == 87.5);
+    CHECK(loaded.humanize.typo_probability == 0.0375);
+    CHECK(loaded.humanize.pause_median == 1.25);
+    CHECK(loaded.humanize.speed_variation == saved.humanize.speed_variation);
+    CHECK(loaded.humanize.distance_weight == 0.375 && loaded.humanize.keyboard == KEYBOARD_COLEMAK);
+
+    static const char bad[] = "# comment\n\nwpm=60\ntypo=2\n";
+    CHECK(!LoadTypingProfile(WriteTestFile("bad-profile.txt", bad, sizeof(bad) - 1), &loaded));
+    static const char unknown[] = "speed=60\n";
+    CHECK(!LoadTypingProfile(WriteTestFile("unknown-profile.txt", unknown, sizeof(unknown) - 1), &loaded));
+    static const char layout[] = "keyboard=bepo\n";
+    CHECK(!LoadTypingProfile(WriteTestFile("layout-profile.txt", layout, sizeof(layout) - 1), &loaded));
+
+    // Values that would overflow the model's nanosecond fields, and a
+    // correction range that runs backwards
+    static const char* const out_of_range[] = {
+        "variation=inf\n", "variation=nan\n", "correction_min=1e300\n", "correction_max=inf\n",
+        "pause_median=1e300\n", "pause_median=61\n", "distance=inf\n", "distance=4.5\n",
+        "correction_min=0.5\ncorrection_max=0.4\n",
+    };
+    for (size_t i = 0; i < sizeof(out_of_range) / sizeof(out_of_range[0]); i++) {
+        DefaultHumanizeProfile(&loaded.humanize);
+        CHECK(!LoadTypingProfile(WriteTestFile("range-profile.txt", out_of_range[i], strlen(out_of_range[i])),
+                                 &loaded));
+    }
+    static const char widest[] = "variation=4\ncorrection_min=60\ncorrection_max=60\npause_median=60\ndistance=4\n";
+    DefaultHumanizeProfile(&loaded.humanize);
+    CHECK(LoadTypingProfile(WriteTestFile("widest-profile.txt", widest, sizeof(widest) - 1), &loaded));
+}
+
+// Measurements depend on the seed alone, not on how sessions are spread over threads
+static void TestMeasurementIsReproducible(void) {
+    TypingProfile profile;
+    profile.wpm = 60.0;
+    DefaultHumanizeProfile(&profile.humanize);
+    profile.humanize.typo_probability = 0.05;
+
+    CalibrationResult one;
+    CalibrationResult four;
+    CHECK(MeasureTypingProfile(corpus, sizeof(corpus) - 1, &profile, 64, 120, 1, 7, &one));
+    CHECK(MeasureTypingProfile(corpus, sizeof(corpus) - 1, &profile, 64, 120, 4, 7, &four));
+    CHECK(one.mean_wpm == four.mean_wpm && one.sd_wpm == four.sd_wpm && one.typo_rate == four.typo_rate);
+    CHECK(one.chars > 64 * 100);
+
+    // Typos and pauses only ever slow the paced speed down
+    CHECK(one.mean_wpm > 0.0 && one.mean_wpm < profile.wpm);
+    CHECK(one.sd_wpm > 0.0);
+    CHECK(one.typo_rate > 0.02 && one.typo_rate < 0.05);
+}
+
+// Without humanization every session types at the paced speed
+static void TestSteadyMeasurement(void) {
+    TypingProfile profile;
+    profile.wpm = 100.0;
+    DefaultHumanizeProfile(&profile.humanize);
+    profile.humanize.speed_variation = 0.0;
+    profile.humanize.typo_probability = 0.0;
+    profile.humanize.word_pause_probability = 0.0;
+    profile.humanize.sentence_pause_probability = 0.0;
+
+    CalibrationResult result;
+    CHECK(MeasureTypingProfile(corpus, sizeof(corpus) - 1, &profile, 16, 80, 2, 1, &result));
+    CHECK(result.mean_wpm > 99.9 && result.mean_wpm < 100.1);
+    CHECK(result.sd_wpm < 0.1);
+    CHECK(result.typo_rate == 0.0);
+}
+
+int main(void) {
+    RUN_TEST(TestProfileRoundTrip);
+    RUN_TEST(TestMeasurementIsReproducible);
+    RUN_TEST(TestSteadyMeasurement);
+    return test_failures ? 1 : 0;
+}
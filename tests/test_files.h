@@ -0,0 +1,81 @@
+#ifndef HUMANIZER_TESTS_TEST_FILES_H
+#define HUMANIZER_TESTS_TEST_FILES_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Write length bytes to a file in the temporary directory named after name;
+// returns the path in a static buffer (NULL if the file could not be written)
+static inline const char* WriteTestFile(const char* name, const void* data, size_t length) {
+    static char path[512];
+    const char* dir = getenv("TMPDIR");
+#ifdef _WIN32
+    if (!dir) {
+        dir = getenv("TEMP");
+    }
+#endif
+    snprintf(path, sizeof(path), "%s/humanizer-test-%s", dir ? dir : "/tmp", name);
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        return NULL;
+    }
+    bool ok = fwrite(data, 1, length, file) == length;
+    ok = fclose(file) == 0 && ok;
+    return ok ? path : NULL;
+}
+
+static inline void PutLE16(uint8_t* p, uint32_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+static inline void PutLE32(uint8_t* p, uint32_t value) {
+    PutLE16(p, value);
+    PutLE16(p + 2, value >> 16);
+}
+
+// Wrap body as the word/document.xml of a one-entry ZIP archive, the smallest
+// file the .docx reader accepts; method is 0 for stored XML or 8 for a raw
+// deflate stream. out needs DOCX_OVERHEAD + length bytes; returns the archive size.
+#define DOCX_OVERHEAD (30 + 46 + 22 + 2 * 17)
+static inline size_t BuildDocx(const void* body, size_t length, uint16_t method, uint8_t* out) {
+    static const char name[] = "word/document.xml";
+    const uint32_t name_length = sizeof(name) - 1;
+
+    uint8_t* local = out;
+    memset(local, 0, 30);
+    PutLE32(local, 0x04034b50);
+    PutLE16(local + 4, 20);
+    PutLE16(local + 8, method);
+    PutLE32(local + 18, (uint32_t)length);
+    PutLE32(local + 22, (uint32_t)length);
+    PutLE16(local + 26, name_length);
+    memcpy(local + 30, name, name_length);
+    memcpy(local + 30 + name_length, body, length);
+
+    uint32_t directory_offset = 30 + name_length + (uint32_t)length;
+    uint8_t* central = out + directory_offset;
+    memset(central, 0, 46);
+    PutLE32(central, 0x02014b50);
+    PutLE16(central + 4, 20);
+    PutLE16(central + 6, 20);
+    PutLE16(central + 10, method);
+    PutLE32(central + 20, (uint32_t)length);
+    PutLE32(central + 24, (uint32_t)length);
+    PutLE16(central + 28, name_length);
+    memcpy(central + 46, name, name_length);
+
+    uint8_t* end = central + 46 + name_length;
+    memset(end, 0, 22);
+    PutLE32(end, 0x06054b50);
+    PutLE16(end + 8, 1);
+    PutLE16(end + 10, 1);
+    PutLE32(end + 12, 46 + name_length);
+    PutLE32(end + 16, directory_offset);
+    return (size_t)(end + 22 - out);
+}
+
+#endif // HUMANIZER_TESTS_TEST_FILES_H
@@ -0,0 +1,232 @@
+#include "humanizer.h"
+#include "test.h"
+
+// Load path into a fresh simulator; the text is left for the caller to free
+static bool Load(const char* path, TypingSimulator* simulator) {
+    memset(simulator, 0, sizeof(*simulator));
+    return path && LoadFileContent(path, simulator);
+}
+
+static void TestSupportedFileTypes(void) {
+    CHECK(IsSupportedFileType("notes.txt"));
+    CHECK(IsSupportedFileType("NOTES.TXT"));
+    CHECK(IsSupportedFileType("report.docx"));
+    CHECK(IsSupportedFileType("dir.v2/report.DocX"));
+    CHECK(!IsSupportedFileType("notes"));
+    CHECK(!IsSupportedFileType("notes.txt.bak"));
+    CHECK(!IsSupportedFileType("notes.tx"));
+    CHECK(!IsSupportedFileType("report.doc"));
+    CHECK(IsDocxFile("report.DOCX"));
+    CHECK(!IsDocxFile("notes.txt"));
+}
+
+static void TestLoadText(void) {
+    static const char text[] = "Hello, w\xC3\xB6rld\r\nSecond line\n";
+    TypingSimulator simulator;
+    CHECK(Load(WriteTestFile("load.txt", text, sizeof(text) - 1), &simulator));
+    CHECK_EQ_SIZE(simulator.length, sizeof(text) - 1);
+    CHECK(simulator.text && memcmp(simulator.text, text, sizeof(text)) == 0);
+    free(simulator.text);
+}
+
+static void TestRejectedFiles(void) {
+    TypingSimulator simulator;
+    CHECK(!Load(WriteTestFile("empty.txt", "", 0), &simulator));
+    CHECK(!Load(WriteTestFile("load.pdf", "text", 4), &simulator));
+    CHECK(!Load("/nonexistent/humanizer-test.txt", &simulator));
+    CHECK(simulator.text == NULL);
+}
+
+static void TestSizeLimit(void) {
+    char* text = (char*)malloc(MAX_TEXT_LENGTH);
+    if (!text) {
+        CHECK(text != NULL);
+        return;
+    }
+    memset(text, 'a', MAX_TEXT_LENGTH);
+
+    TypingSimulator simulator;
+    CHECK(Load(WriteTestFile("limit.txt", text, MAX_TEXT_LENGTH - 1), &simulator));
+    CHECK_EQ_SIZE(simulator.length, MAX_TEXT_LENGTH - 1);
+    free(simulator.text);
+    CHECK(!Load(WriteTestFile("limit.txt", text, MAX_TEXT_LENGTH), &simulator));
+    free(text);
+}
+
+static void TestLoadDocx(void) {
+    static const char xml[] =
+        "<?xml version=\"1.0\"?><w:document><w:body>"
+        "<w:p><w:r><w:t xml:space=\"preserve\">Fish &amp; chips </w:t></w:r><w:r><w:t>&lt;hot&gt;</w:t></w:r></w:p>"
+        "<w:p w:rsidR=\"00A1\"/>"
+        "<w:p><w:pPr><w:tabs><w:tab w:val=\"left\"/></w:tabs></w:pPr>"
+        "<w:r><w:tab/><w:t>caf&#233;&#x2014;&bogus;</w:t><w:br/><w:t>end</w:t></w:r></w:p>"
+        "</w:body></w:document>";
+    static const char expected[] = "Fish & chips <hot>\n\n\tcaf\xC3\xA9\xE2\x80\x94&bogus;\nend\n";
+    uint8_t archive[DOCX_OVERHEAD + sizeof(xml)];
+    size_t size = BuildDocx(xml, sizeof(xml) - 1, 0, archive);
+
+    TypingSimulator simulator;
+    CHECK(Load(WriteTestFile("load.docx", archive, size), &simulator));
+    CHECK_EQ_SIZE(simulator.length, sizeof(expected) - 1);
+    CHECK(simulator.text && strcmp(simulator.text, expected) == 0);
+    free(simulator.text);
+}
+
+static void TestRejectedDocx(void) {
+    static const char xml[] = "<w:p><w:r><w:t>text</w:t></w:r></w:p>";
+    uint8_t archive[DOCX_OVERHEAD + sizeof(xml)];
+    size_t size = BuildDocx(xml, sizeof(xml) - 1, 0, archive);
+    TypingSimulator simulator;
+
+    // Not an archive at all
+    CHECK(!Load(WriteTestFile("plain.docx", xml, sizeof(xml) - 1), &simulator));
+
+    // An archive whose only part has another name in the central directory
+    size_t central_name = size - 22 - 17;
+    archive[central_name] = 'W';
+    CHECK(!Load(WriteTestFile("other.docx", archive, size), &simulator));
+    archive[central_name] = 'w';
+
+    // An archive cut off before its end record
+    CHECK(!Load(WriteTestFile("cut.docx", archive, size - 1), &simulator));
+
+    // A body part without any text
+    static const char empty_xml[] = "<w:document><w:body/></w:document>";
+    size = BuildDocx(empty_xml, sizeof(empty_xml) - 1, 0, archive);
+    CHECK(!Load(WriteTestFile("empty.docx", archive, size), &simulator));
+}
+
+// A file source must hand back exactly the file, however it splits it
+static void TestFileTextSource(void) {
+    size_t length = 3 * TEXT_CHUNK_SIZE + 123;
+    char* text = (char*)malloc(length);
+    if (!text) {
+        CHECK(text != NULL);
+        return;
+    }
+    for (size_t i = 0; i < length; i++) {
+        text[i] = (char)('a' + i % 26);
+    }
+
+    TextSource* source = OpenFileTextSource(WriteTestFile("source.txt", text, length));
+    CHECK(source != NULL);
+    if (source) {
+        TextBuffer copy;
+        InitializeTextBuffer(&copy);
+        const char* chunk;
+        size_t chunk_length;
+        while (source->Next(source, &chunk, &chunk_length)) {
+            CHECK(ReserveTextBuffer(&copy, chunk_length));
+            memcpy(copy.data + copy.length, chunk, chunk_length);
+            copy.length += chunk_length;
+        }
+        CHECK(!source->failed);
+        CHECK_EQ_SIZE(copy.length, length);
+        CHECK(copy.data && memcmp(copy.data, text, length) == 0);
+        FreeTextBuffer(&copy);
+        CloseTextSource(source);
+    }
+    free(text);
+}
+
+static void TestReadTextBufferLimit(void) {
+    static const char text[] = "0123456789abcdef";
+    FILE* file = fopen(WriteTestFile("buffer.txt", text, sizeof(text) - 1), "rb");
+    CHECK(file != NULL);
+    if (!file) {
+        return;
+    }
+    TextBuffer buffer;
+    InitializeTextBuffer(&buffer);
+    CHECK(ReadTextBuffer(&buffer, file, 4));
+    CHECK(buffer.length >= 4 && buffer.length <= sizeof(text) - 1);
+    CHECK(buffer.data && buffer.data[buffer.length] == '\0');
+    CHECK(ReadTextBuffer(&buffer, file, 0));
+    CHECK_EQ_SIZE(buffer.length, sizeof(text) - 1);
+    CHECK(buffer.data && strcmp(buffer.data, text) == 0);
+    FreeTextBuffer(&buffer);
+    fclose(file);
+}
+
+// Scan text in pieces of at most piece bytes (0: all at once)
+static void ScanInPieces(const char* text, size_t length, size_t piece, const KeyLayout* layout, TextScan* out) {
+    TextScanner scanner;
+    InitializeTextScanner(&scanner, layout);
+    for (size_t at = 0; at < length;) {
+        size_t n = piece && length - at > piece ? piece : length - at;
+        ScanText(&scanner, text + at, n);
+        at += n;
+    }
+    FinishTextScan(&scanner, out);
+}
+
+// Every scan kernel counts random text exactly like the scalar one, however
+// the text is split, with multi-byte and malformed sequences landing across
+// 16 and 32 byte lanes, 64 byte blocks and piece boundaries
+static void TestScanKernels(void) {
+    static const char* const fragments[] = {
+        "a", "Z", "q", " ", "  ", "\t", "\n", "\r\n", "\r", ".", "!", "?", ",", "7", "\x01", "\x7F",
+        "\xC3\xA9", "\xC3\x9F", "\xC3\x97", "\xE2\x82\xAC", "\xF0\x9F\x98\x80", "\xEF\xBF\xBD",
+        "\x80", "\xFF", "\xC3", "\xE2\x82", "\xC0\xAF", "\xED\xA0\x80",
+    };
+    static const char* const kernels[] = { "scalar", "sse2", "avx2" };
+    static const size_t pieces[] = { 0, 1, 3, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100, 1000 };
+    const size_t fragment_count = sizeof(fragments) / sizeof(fragments[0]);
+
+    KeySink* sink = OpenNullSink();
+    RandomState rng;
+    SeedRandom(&rng, 16);
+    for (size_t round = 0; round < 8; round++) {
+        char text[5000];
+        size_t length = 0;
+        size_t limit = 64 + (size_t)(NextRandom(&rng) % (sizeof(text) - 64 - 8));
+        while (length < limit) {
+            // Mostly ASCII words, like real text, so both block paths run
+            uint64_t r = NextRandom(&rng);
+            const char* fragment = fragments[r % 8 < 6 ? r % 4 : (r >> 8) % fragment_count];
+            size_t n = strlen(fragment);
+            memcpy(text + length, fragment, n);
+            length += n;
+        }
+
+        const KeyLayout* layout = round % 2 ? sink->layout : NULL;
+        TextScan expected;
+        CHECK(UseScanKernel("scalar"));
+        ScanInPieces(text, length, 0, layout, &expected);
+        for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+            if (!UseScanKernel(kernels[k])) {
+                continue;
+            }
+            for (size_t p = 0; p < sizeof(pieces) / sizeof(pieces[0]); p++) {
+                TextScan scan;
+                ScanInPieces(text, length, pieces[p], layout, &scan);
+                CHECK(memcmp(&scan, &expected, sizeof(scan)) == 0);
+            }
+        }
+    }
+
+    // Latin-1 letters count for typos; the multiplication sign, € and ASCII
+    // punctuation do not
+    static const char latin[] = "A\xC3\xA9\xC3\x97\xC3\x9F\xE2\x82\xAC.z";
+    TextScan scan;
+    ScanBuffer(latin, sizeof(latin) - 1, NULL, &scan);
+    CHECK_EQ_SIZE(scan.letters, 4);
+
+    // Back to the fastest kernel for whatever runs next
+    for (size_t k = sizeof(kernels) / sizeof(kernels[0]); k-- > 0 && !UseScanKernel(kernels[k]);) {
+    }
+    CloseSink(sink);
+}
+
+int main(void) {
+    RUN_TEST(TestSupportedFileTypes);
+    RUN_TEST(TestLoadText);
+    RUN_TEST(TestRejectedFiles);
+    RUN_TEST(TestSizeLimit);
+    RUN_TEST(TestLoadDocx);
+    RUN_TEST(TestRejectedDocx);
+    RUN_TEST(TestFileTextSource);
+    RUN_TEST(TestReadTextBufferLimit);
+    RUN_TEST(TestScanKernels);
+    return test_failures ? 1 : 0;
+}
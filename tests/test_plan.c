@@ -0,0 +1,687 @@
+#include "humanizer.h"
+#include "digraph.h"
+#include "ring.h"
+#include "test.h"
+
+static const char sample_text[] =
+    "The quick brown fox jumps over the lazy dog. Pack my box with five dozen liquor jugs!\r\n"
+    "Gr\xC3\xBC\xC3\x9F" "e aus K\xC3\xB6ln \xE2\x80\x94 na\xC3\xAFve caf\xC3\xA9s, \xF0\x9F\x98\x80 and tabs\tat the end.\n";
+
+// Plan text in pieces of at most piece bytes (0: all at once)
+static bool PlanInPieces(KeySink* sink, const HumanizeModel* model, uint64_t seed, const char* text,
+                         size_t length, size_t piece, KeyPlan* plan, KeyPlanner* planner) {
+    InitializePlanner(planner, sink, 80.0, model, seed);
+    InitializePlan(plan);
+    for (size_t at = 0; at < length;) {
+        size_t n = piece && length - at > piece ? piece : length - at;
+        if (!PlanText(planner, plan, text + at, n)) {
+            return false;
+        }
+        at += n;
+    }
+    return FinishPlan(planner, plan);
+}
+
+static bool PlansEqual(const KeyPlan* a, const KeyPlan* b) {
+    return a->count == b->count && memcmp(a->events, b->events, a->count * sizeof(KeyEvent)) == 0;
+}
+
+// Evenly paced plans: one press/release pair per character at the WPM spacing
+static void TestSteadyPlan(void) {
+    KeySink* sink = OpenNullSink();
+    KeyPlan plan;
+    KeyPlanner planner;
+    CHECK(PlanInPieces(sink, NULL, 1, "ab c", 4, 0, &plan, &planner));
+    CHECK_EQ_SIZE(plan.count, 8);
+    CHECK_EQ_SIZE(planner.chars_planned, 4);
+    CHECK_EQ_SIZE(planner.typos, 0);
+
+    uint64_t spacing = (uint64_t)(60.0 / 80.0 / CHARS_PER_WORD * 1e9);
+    for (size_t i = 0; i < plan.count; i += 2) {
+        CHECK_EQ_SIZE(PlanGroupLength(&plan, i), 2);
+        CHECK(plan.events[i].time_ns == (uint64_t)(i / 2) * spacing);
+        CHECK(!(plan.events[i].flags & KEY_EVENT_UP) && (plan.events[i + 1].flags & KEY_EVENT_UP));
+    }
+    // "ab" ends at the space, "c" at the end of the text
+    CHECK(plan.events[4].flags & KEY_EVENT_WORD_END);
+    CHECK(plan.events[6].flags & KEY_EVENT_WORD_END);
+    CHECK(!(plan.events[2].flags & KEY_EVENT_WORD_END));
+
+    CleanupPlan(&plan);
+    CloseSink(sink);
+}
+
+// The same seed gives the same plan however the text is split, even inside
+// a UTF-8 sequence or a CRLF pair; another seed gives another plan
+static void TestChunkedPlansMatch(void) {
+    KeySink* sink = OpenNullSink();
+    HumanizeProfile profile;
+    DefaultHumanizeProfile(&profile);
+    profile.typo_probability = 0.2;
+    HumanizeModel model;
+    BuildHumanizeModel(&model, &profile);
+
+    KeyPlan whole;
+    KeyPlanner planner;
+    size_t length = sizeof(sample_text) - 1;
+    CHECK(PlanInPieces(sink, &model, 42, sample_text, length, 0, &whole, &planner));
+    CHECK(planner.typos > 0);
+    for (size_t i = 1; i < whole.count; i++) {
+        CHECK(whole.events[i].time_ns >= whole.events[i - 1].time_ns);
+    }
+
+    for (size_t piece = 1; piece <= 7; piece++) {
+        KeyPlan pieces;
+        CHECK(PlanInPieces(sink, &model, 42, sample_text, length, piece, &pieces, &planner));
+        CHECK(PlansEqual(&whole, &pieces));
+        CleanupPlan(&pieces);
+    }
+
+    KeyPlan other;
+    CHECK(PlanInPieces(sink, &model, 43, sample_text, length, 0, &other, &planner));
+    CHECK(!PlansEqual(&whole, &other));
+    CleanupPlan(&other);
+    CleanupPlan(&whole);
+    CloseSink(sink);
+}
+
+// Malformed UTF-8 is skipped and counted, never typed as U+FFFD, while a
+// U+FFFD written out in the text is typed; the scan's warning agrees
+static void TestMalformedText(void) {
+    static const char text[] = "a\x80" "b\xC0\xAF" "c\xFF" "d\xED\xA0\x80" "x\xEF\xBF\xBD" "y\xC3" "e";
+    static const uint32_t typed[] = { 'a', 'b', 'c', 'd', 'x', 0xFFFD, 'y', 'e' };
+    KeySink* sink = OpenNullSink();
+    KeyPlan whole;
+    KeyPlanner planner;
+    CHECK(PlanInPieces(sink, NULL, 1, text, sizeof(text) - 1, 0, &whole, &planner));
+    CHECK_EQ_SIZE(planner.unmapped_chars, 5);
+    CHECK_EQ_SIZE(whole.count, 2 * sizeof(typed) / sizeof(typed[0]));
+    for (size_t i = 0; i < whole.count / 2 && i < sizeof(typed) / sizeof(typed[0]); i++) {
+        CHECK(whole.events[2 * i].code == typed[i]);
+    }
+    for (size_t piece = 1; piece <= 7; piece++) {
+        KeyPlan pieces;
+        CHECK(PlanInPieces(sink, NULL, 1, text, sizeof(text) - 1, piece, &pieces, &planner));
+        CHECK(PlansEqual(&whole, &pieces));
+        CleanupPlan(&pieces);
+    }
+
+    TextScan scan;
+    ScanBuffer(text, sizeof(text) - 1, sink->layout, &scan);
+    CHECK(scan.invalid_sequences == 5 && scan.unmappable_chars == 0);
+    CHECK(scan.chars == 13);
+    CleanupPlan(&whole);
+    CloseSink(sink);
+}
+
+static void TestBurstLength(void) {
+    KeySink* sink = OpenNullSink();
+    KeyPlan plan;
+    KeyPlanner planner;
+    CHECK(PlanInPieces(sink, NULL, 1, "abcdef", 6, 0, &plan, &planner));
+    uint64_t spacing = plan.events[2].time_ns;
+
+    // The first keystroke always goes, whatever the window
+    CHECK_EQ_SIZE(PlanBurstLength(&plan, 0, 0, 64), 2);
+    // Keystrokes due strictly before until_ns join it
+    CHECK_EQ_SIZE(PlanBurstLength(&plan, 0, 2 * spacing, 64), 4);
+    CHECK_EQ_SIZE(PlanBurstLength(&plan, 0, 2 * spacing + 1, 64), 6);
+    // Never more events than allowed, and never half a keystroke
+    CHECK_EQ_SIZE(PlanBurstLength(&plan, 0, UINT64_MAX, 5), 4);
+    CHECK_EQ_SIZE(PlanBurstLength(&plan, 8, UINT64_MAX, 64), 4);
+    CleanupPlan(&plan);
+
+    // A {PAUSE} hold ends the burst before it
+    InitializePlanner(&planner, sink, 80.0, NULL, 1);
+    planner.directives = true;
+    InitializePlan(&plan);
+    CHECK(PlanText(&planner, &plan, "ab{PAUSE}cd", 11) && FinishPlan(&planner, &plan));
+    size_t hold = 0;
+    while (hold < plan.count && !(plan.events[hold].flags & KEY_EVENT_HOLD)) {
+        hold++;
+    }
+    CHECK_EQ_SIZE(hold, 4);
+    CHECK_EQ_SIZE(PlanBurstLength(&plan, 0, UINT64_MAX, 64), 4);
+    CleanupPlan(&plan);
+    CloseSink(sink);
+}
+
+// Whole keystrokes go in, events come out in order across the wrap, and the
+// consumer may take any number of them
+static void TestRingKeystrokes(void) {
+    EventRing ring;
+    CHECK(InitializeEventRing(&ring, 5));
+    CHECK_EQ_SIZE(ring.capacity, 8);
+
+    // Three keystrokes of three events; only two fit at first
+    KeyEvent events[9];
+    memset(events, 0, sizeof(events));
+    for (size_t i = 0; i < 9; i++) {
+        events[i].time_ns = i / 3;
+        events[i].code = (uint32_t)i;
+    }
+    CHECK_EQ_SIZE(PushKeystrokes(&ring, events, 9), 6);
+    CHECK_EQ_SIZE(PushKeystrokes(&ring, events + 6, 3), 0);
+
+    const KeyEvent* next = PeekEvent(&ring);
+    CHECK(next && next->code == 0);
+    KeyEvent out[8];
+    CHECK_EQ_SIZE(PopEvents(&ring, out, 4), 4);
+    CHECK(out[0].code == 0 && out[3].code == 3);
+
+    // The last keystroke now fits, wrapping around the end of the ring
+    CHECK_EQ_SIZE(PushKeystrokes(&ring, events + 6, 3), 3);
+    CHECK_EQ_SIZE(PopEvents(&ring, out, 8), 5);
+    for (size_t i = 0; i < 5; i++) {
+        CHECK(out[i].code == 4 + i);
+    }
+    CHECK(PeekEvent(&ring) == NULL);
+    CHECK_EQ_SIZE(PopEvents(&ring, out, 8), 0);
+
+    // Drained only once the producer closes it
+    CHECK(!EventRingDrained(&ring));
+    CloseEventRing(&ring);
+    CHECK(EventRingDrained(&ring));
+    DestroyEventRing(&ring);
+
+    // A producer waiting for room gives up when the consumer cancels
+    CHECK(InitializeEventRing(&ring, 8));
+    for (size_t i = 0; i < 9; i++) {
+        events[i].time_ns = i;
+    }
+    CHECK(WriteKeystrokes(&ring, events, 8, EVENT_RING_BACKOFF_MIN_NS));
+    CancelEventRing(&ring);
+    CHECK(!WriteKeystrokes(&ring, events + 8, 1, EVENT_RING_BACKOFF_MIN_NS));
+    DestroyEventRing(&ring);
+}
+
+#define RING_TEST_EVENTS 200000
+
+typedef struct {
+    EventRing ring;
+    KeyEvent* events;
+    bool written;
+} RingTest;
+
+// Producer: publish the events in uneven runs, then close the ring
+static void RingTestProducer(void* arg) {
+    RingTest* test = (RingTest*)arg;
+    size_t at = 0;
+    test->written = true;
+    for (size_t run = 1; at < RING_TEST_EVENTS && test->written; run = run % 97 + 1) {
+        // Runs end on keystroke boundaries, as the planner's do
+        size_t end = at + run < RING_TEST_EVENTS ? at + run : RING_TEST_EVENTS;
+        while (end < RING_TEST_EVENTS && test->events[end].time_ns == test->events[end - 1].time_ns) {
+            end++;
+        }
+        test->written = WriteKeystrokes(&test->ring, test->events + at, end - at, EVENT_RING_BACKOFF_MIN_NS);
+        at = end;
+    }
+    CloseEventRing(&test->ring);
+}
+
+// Another thread's keystrokes arrive complete and in order: whatever the
+// consumer can see ends on a keystroke boundary
+static void TestRingAcrossThreads(void) {
+    RingTest test;
+    test.events = (KeyEvent*)calloc(RING_TEST_EVENTS, sizeof(KeyEvent));
+    CHECK(test.events != NULL);
+    if (!test.events || !InitializeEventRing(&test.ring, 64)) {
+        free(test.events);
+        return;
+    }
+    // Keystrokes of one to four events
+    uint64_t time_ns = 0;
+    for (size_t i = 0, left = 1; i < RING_TEST_EVENTS; i++) {
+        test.events[i].time_ns = time_ns;
+        test.events[i].code = (uint32_t)i;
+        if (--left == 0) {
+            time_ns++;
+            left = time_ns % 4 + 1;
+        }
+    }
+
+    HumanizerThread producer;
+    CHECK(StartThread(&producer, RingTestProducer, &test));
+    KeyEvent out[64];
+    size_t popped = 0;
+    bool in_order = true;
+    bool whole = true;
+    uint64_t backoff_ns = EVENT_RING_BACKOFF_MIN_NS;
+    while (!EventRingDrained(&test.ring)) {
+        size_t got = PopEvents(&test.ring, out, 64);
+        if (got == 0) {
+            EventRingBackoff(&backoff_ns, EVENT_RING_BACKOFF_MIN_NS);
+            continue;
+        }
+        for (size_t i = 0; i < got; i++) {
+            in_order = in_order && out[i].code == popped + i;
+        }
+        popped += got;
+        whole = whole && (popped == RING_TEST_EVENTS || test.events[popped].time_ns != out[got - 1].time_ns);
+    }
+    JoinThread(&producer);
+
+    CHECK(test.written);
+    CHECK_EQ_SIZE(popped, RING_TEST_EVENTS);
+    CHECK(in_order);
+    CHECK(whole);
+    DestroyEventRing(&test.ring);
+    free(test.events);
+}
+
+// Events sharing one timestamp (a keystroke, as far as the ring can tell)
+// longer than the ring still pass through it, in order
+static void TestRingSplitsOversizedKeystroke(void) {
+    EventRing ring;
+    CHECK(InitializeEventRing(&ring, 64));
+    KeyEvent events[1000];
+    memset(events, 0, sizeof(events));
+    for (size_t i = 0; i < 1000; i++) {
+        events[i].code = (uint16_t)i;
+    }
+
+    KeyEvent out[64];
+    size_t pushed = 0;
+    size_t popped = 0;
+    bool in_order = true;
+    for (size_t round = 0; round < 100 && popped < 1000; round++) {
+        pushed += PushKeystrokes(&ring, events + pushed, 1000 - pushed);
+        size_t got = PopEvents(&ring, out, 64);
+        for (size_t i = 0; i < got; i++) {
+            in_order = in_order && out[i].code == popped + i;
+        }
+        popped += got;
+    }
+    CHECK_EQ_SIZE(popped, 1000);
+    CHECK(in_order);
+    DestroyEventRing(&ring);
+}
+
+// Users cannot ask for absurd speeds, but speeds so high the keystroke
+// spacing vanishes still type every character rather than stalling the
+// emitter on one oversized batch
+static void TestSimultaneousKeystrokes(void) {
+    CHECK(IsValidWpm(1.0) && IsValidWpm(MAX_WPM) && !IsValidWpm(0.0) && !IsValidWpm(1e14));
+    CHECK(!IsValidWpm(strtod("inf", NULL)) && !IsValidWpm(strtod("nan", NULL)));
+
+    char text[1000];
+    memset(text, 'a', sizeof(text));
+    KeySink* sink = OpenNullSink();
+    TypingSimulator simulator;
+    InitializeSimulator(&simulator, sink, 1e14);
+    simulator.humanized = false;
+    TextSource* source = OpenMemoryTextSource(text, sizeof(text));
+    CHECK(source != NULL);
+    if (source) {
+        TypingReport report;
+        CHECK(DryRunTyping(&simulator, source, &report));
+        CHECK_EQ_SIZE(report.keystrokes, 1000);
+        CHECK_EQ_SIZE(report.chars_typed, 1000);
+        CloseTextSource(source);
+    }
+    CleanupSimulator(&simulator);
+    CloseSink(sink);
+}
+
+// Plan text with directives on, in pieces of at most piece bytes (0: all at once)
+static bool PlanDirectives(KeySink* sink, const HumanizeModel* model, const char* text, size_t piece,
+                           KeyPlan* plan, KeyPlanner* planner) {
+    InitializePlanner(planner, sink, 80.0, model, 1);
+    planner->directives = true;
+    InitializePlan(plan);
+    size_t length = strlen(text);
+    for (size_t at = 0; at < length;) {
+        size_t n = piece && length - at > piece ? piece : length - at;
+        if (!PlanText(planner, plan, text + at, n)) {
+            return false;
+        }
+        at += n;
+    }
+    return FinishPlan(planner, plan);
+}
+
+// The ASCII text a null sink plan types, typos and their corrections left out
+static const char* TypedText(const KeyPlan* plan) {
+    static char typed[256];
+    size_t length = 0;
+    for (size_t i = 0; i < plan->count && length + 1 < sizeof(typed); i++) {
+        if (!(plan->events[i].flags & (KEY_EVENT_UP | KEY_EVENT_HOLD | KEY_EVENT_CORRECTION))) {
+            typed[length++] = (char)plan->events[i].code;
+        }
+    }
+    typed[length] = '\0';
+    return typed;
+}
+
+// Time of the press that types the index-th character of the text
+static uint64_t TypedAt(const KeyPlan* plan, size_t index) {
+    for (size_t i = 0; i < plan->count; i++) {
+        if (!(plan->events[i].flags & (KEY_EVENT_UP | KEY_EVENT_HOLD | KEY_EVENT_CORRECTION)) && index-- == 0) {
+            return plan->events[i].time_ns;
+        }
+    }
+    return 0;
+}
+
+// Directives and list markers are recognised however the text is split into
+// chunks, even one byte at a time, and whatever is not one is typed as it is
+static void TestDirectiveLexer(void) {
+    static const struct {
+        const char* text;
+        const char* typed;
+    } cases[] = {
+        { "a{PAUSE:2}b", "ab" },
+        { "a{WPM:160}bc{WPM}d", "abcd" },
+        { "{WPM:20000}x{WPM:0}", "{WPM:20000}x{WPM:0}" },
+        { "{TYPOS:101}{NAP}{{PAUSE}", "{TYPOS:101}{NAP}{PAUSE}" },
+        { "a{PAUSE}b", "ab" },
+        { "{PAUSE:NAN}{PAUSE:INF}{PAUSE:1E30}{PAUSE:1E10}{PAUSE:3601}{TYPOS:NAN}{WPM:INF}",
+          "{PAUSE:NAN}{PAUSE:INF}{PAUSE:1E30}{PAUSE:1E10}{PAUSE:3601}{TYPOS:NAN}{WPM:INF}" },
+        { "a{PAUSE:3600}b", "ab" },
+        { "  - item\n3.   next\n-x\n\t* tab\n12.5 units", "- item\n3. next\n-x\n   * tab\n12.5 units" },
+    };
+    KeySink* sink = OpenNullSink();
+    uint64_t spacing = (uint64_t)(60.0 / 80.0 / CHARS_PER_WORD * 1e9);
+
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        KeyPlan whole;
+        KeyPlanner planner;
+        CHECK(PlanDirectives(sink, NULL, cases[c].text, 0, &whole, &planner));
+        CHECK(strcmp(TypedText(&whole), cases[c].typed) == 0);
+        for (size_t piece = 1; piece <= 7; piece++) {
+            KeyPlan pieces;
+            CHECK(PlanDirectives(sink, NULL, cases[c].text, piece, &pieces, &planner));
+            CHECK(PlansEqual(&whole, &pieces));
+            CleanupPlan(&pieces);
+        }
+
+        if (c == 0) {
+            // {PAUSE:2} waits two seconds on top of the usual spacing
+            CHECK(TypedAt(&whole, 1) - TypedAt(&whole, 0) == spacing + 2000000000ULL);
+        } else if (c == 1) {
+            // {WPM:160} halves the spacing from the next character on; {WPM} restores it
+            CHECK(TypedAt(&whole, 1) - TypedAt(&whole, 0) == spacing);
+            CHECK(TypedAt(&whole, 2) - TypedAt(&whole, 1) == spacing / 2);
+            CHECK(TypedAt(&whole, 3) - TypedAt(&whole, 2) == spacing / 2);
+        } else if (c == 4) {
+            size_t holds = 0;
+            for (size_t i = 0; i < whole.count; i++) {
+                holds += (whole.events[i].flags & KEY_EVENT_HOLD) != 0;
+            }
+            CHECK_EQ_SIZE(holds, 1);
+        }
+        CleanupPlan(&whole);
+    }
+
+    // {TYPOS:N} overrides the model's typo rate until {TYPOS} restores it
+    HumanizeProfile profile;
+    DefaultHumanizeProfile(&profile);
+    profile.typo_probability = 0.0;
+    HumanizeModel model;
+    BuildHumanizeModel(&model, &profile);
+    KeyPlan plan;
+    KeyPlanner planner;
+    CHECK(PlanDirectives(sink, &model, "{TYPOS:100}asdf{TYPOS}asdf", 3, &plan, &planner));
+    CHECK(strcmp(TypedText(&plan), "asdfasdf") == 0);
+    CHECK_EQ_SIZE(planner.typos, 4);
+    CleanupPlan(&plan);
+    CloseSink(sink);
+}
+
+// A profile where every key pair takes 100 ticks except "a" to "b" (300),
+// written out and mapped back in
+static DigraphProfile* WriteTestDigraphProfile(void) {
+    const KeyboardLayout* qwerty = &kKeyboardLayouts[KEYBOARD_QWERTY];
+    size_t cells = (size_t)DIGRAPH_SLOTS * DIGRAPH_SLOTS;
+    size_t size = sizeof(DigraphFileHeader) + cells * sizeof(DigraphEntry);
+    uint8_t* data = (uint8_t*)calloc(1, size);
+    if (!data) {
+        return NULL;
+    }
+    DigraphFileHeader* header = (DigraphFileHeader*)data;
+    memcpy(header->magic, DIGRAPH_MAGIC, 4);
+    header->byte_order = DIGRAPH_BYTE_ORDER;
+    header->version = DIGRAPH_VERSION;
+    header->slots = DIGRAPH_SLOTS;
+    header->quantiles = DIGRAPH_QUANTILES;
+    header->tick_us = DIGRAPH_TICK_US;
+    header->mean_ticks = 100;
+    DigraphEntry* entries = (DigraphEntry*)(header + 1);
+    for (size_t i = 0; i < cells; i++) {
+        bool ab = i == (size_t)DigraphSlot(qwerty, 'a') * DIGRAPH_SLOTS + DigraphSlot(qwerty, 'b');
+        for (size_t q = 0; q <= DIGRAPH_QUANTILES; q++) {
+            entries[i].quantiles[q] = ab ? 300 : 100;
+        }
+    }
+    const char* path = WriteTestFile("profile.hzdg", data, size);
+    DigraphProfile* profile = path ? LoadDigraphProfile(path) : NULL;
+
+    // A cell whose quantiles fall must be refused
+    entries[0].quantiles[1] = 50;
+    CHECK(LoadDigraphProfile(WriteTestFile("bad.hzdg", data, size)) == NULL);
+    free(data);
+    return profile;
+}
+
+// With a digraph profile each delay follows the key pair, scaled so the
+// profile's mean latency matches the planner's pace
+static void TestDigraphDelays(void) {
+    const KeyboardLayout* qwerty = &kKeyboardLayouts[KEYBOARD_QWERTY];
+    CHECK(DigraphSlot(qwerty, 'A') == DigraphSlot(qwerty, 'a') && DigraphSlot(qwerty, '!') == DigraphSlot(qwerty, '1'));
+    CHECK(DigraphSlot(qwerty, 0x00E9) == DIGRAPH_OTHER && DigraphSlot(qwerty, 'a') != DIGRAPH_OTHER);
+    CHECK(DigraphSlot(&kKeyboardLayouts[KEYBOARD_AZERTY], 0x00E9) == DigraphSlot(qwerty, '2'));
+    CHECK(DigraphSlot(qwerty, '\r') == DigraphSlot(qwerty, '\n'));
+
+    DigraphProfile* digraphs = WriteTestDigraphProfile();
+    CHECK(digraphs != NULL);
+    if (!digraphs) {
+        return;
+    }
+    KeySink* sink = OpenNullSink();
+    HumanizeProfile profile;
+    DefaultHumanizeProfile(&profile);
+    profile.typo_probability = 0.0;
+    profile.word_pause_probability = 0.0;
+    profile.sentence_pause_probability = 0.0;
+    HumanizeModel model;
+    BuildHumanizeModel(&model, &profile);
+    model.digraphs = digraphs;
+
+    KeyPlan plan;
+    KeyPlanner planner;
+    CHECK(PlanInPieces(sink, &model, 1, "aAbz", 4, 0, &plan, &planner));
+    CHECK_EQ_SIZE(plan.count, 8);
+    uint64_t spacing = planner.ns_per_char;
+    if (plan.count == 8) {
+        CHECK(plan.events[0].time_ns == 0);
+        CHECK(plan.events[2].time_ns == spacing);
+        CHECK(plan.events[4].time_ns == 4 * spacing);
+        CHECK(plan.events[6].time_ns == 5 * spacing);
+    }
+    CleanupPlan(&plan);
+    CloseSink(sink);
+    UnloadDigraphProfile(digraphs);
+}
+
+// Every layout types each of its characters with the key that carries it, and
+// the shared geometry is symmetric
+static void TestKeyboardTables(void) {
+    CHECK(FindKeyboardLayout("dvorak") == KEYBOARD_DVORAK && FindKeyboardLayout("bepo") == -1);
+    for (size_t i = 0; i < KEYBOARD_LAYOUT_COUNT; i++) {
+        const KeyboardLayout* layout = &kKeyboardLayouts[i];
+        CHECK(FindKeyboardLayout(layout->name) == (int)i);
+        for (size_t key = 0; key < KEYBOARD_KEYS; key++) {
+            for (size_t shift = 0; shift < 2; shift++) {
+                uint32_t c = layout->characters[key][shift];
+                uint8_t found = KeyboardKey(layout, c);
+                CHECK(!c || (found != KEYBOARD_NONE &&
+                             layout->characters[found & KEYBOARD_KEY_MASK][(found & KEYBOARD_SHIFT) != 0] == c));
+            }
+        }
+        CHECK(KeyboardKey(layout, 0x20AC) == KEYBOARD_NONE);
+    }
+    for (size_t a = 0; a < KEYBOARD_KEYS; a++) {
+        CHECK(kKeyboardDistance[a][a] == 0);
+        for (size_t b = 0; b < KEYBOARD_KEYS; b++) {
+            CHECK(kKeyboardDistance[a][b] == kKeyboardDistance[b][a]);
+        }
+        for (size_t n = 0; n < kKeyboardNeighborCount[a]; n++) {
+            CHECK(kKeyboardDistance[a][kKeyboardNeighbors[a][n]] < 2 * KEYBOARD_DISTANCE_UNIT);
+        }
+    }
+
+    // Home row letters sit under the same fingers whatever the layout
+    uint8_t f = KeyboardKey(&kKeyboardLayouts[KEYBOARD_QWERTY], 'f');
+    CHECK(f == KeyboardKey(&kKeyboardLayouts[KEYBOARD_DVORAK], 'u'));
+    CHECK(f == KeyboardKey(&kKeyboardLayouts[KEYBOARD_COLEMAK], 't'));
+    CHECK(kKeyboardHand[f] == KEYBOARD_HAND_LEFT && kKeyboardFinger[f] == 1 && kKeyboardRow[f] == 2);
+    CHECK(kKeyboardLayouts[KEYBOARD_DVORAK].mean_travel < kKeyboardLayouts[KEYBOARD_QWERTY].mean_travel);
+}
+
+// Typos land on keys around the intended one on the typist's layout, in the
+// same case where the neighbour is a letter; non-letters get none
+static void TestTyposFollowKeyboard(void) {
+    HumanizeProfile profile;
+    DefaultHumanizeProfile(&profile);
+    profile.keyboard = KEYBOARD_QWERTZ;
+    HumanizeModel model;
+    BuildHumanizeModel(&model, &profile);
+
+    RandomState rng;
+    SeedRandom(&rng, 5);
+    for (size_t i = 0; i < 200; i++) {
+        uint32_t lower = PickTypo(&model, &rng, 'z');
+        uint32_t upper = PickTypo(&model, &rng, 'Z');
+        uint32_t umlaut = PickTypo(&model, &rng, 0x00F6);
+        CHECK(lower && strchr("67tugh", (int)lower));
+        CHECK(upper && strchr("67TUGH", (int)upper));
+        CHECK(umlaut == 'p' || umlaut == 0x00FC || umlaut == 'l' || umlaut == 0x00E4 || umlaut == '.' ||
+              umlaut == '-');
+    }
+    CHECK(PickTypo(&model, &rng, '5') == 0 && PickTypo(&model, &rng, 0x00DF) == 0);
+    CHECK(PickTypo(&model, &rng, 0x4E2D) == 0);
+}
+
+// With travel timing a pair typed by both hands comes faster than the pace
+// and a stretch across one hand slower
+static void TestTravelTiming(void) {
+    KeySink* sink = OpenNullSink();
+    HumanizeProfile profile;
+    DefaultHumanizeProfile(&profile);
+    profile.speed_variation = 0.0;
+    profile.typo_probability = 0.0;
+    profile.word_pause_probability = 0.0;
+    profile.distance_weight = 0.5;
+    HumanizeModel model;
+    BuildHumanizeModel(&model, &profile);
+
+    KeyPlan plan;
+    KeyPlanner planner;
+    CHECK(PlanInPieces(sink, &model, 1, "fjfb", 4, 0, &plan, &planner));
+    CHECK_EQ_SIZE(plan.count, 8);
+    if (plan.count == 8) {
+        double spacing = (double)planner.ns_per_char;
+        double across = (double)(plan.events[2].time_ns - plan.events[0].time_ns) / spacing;
+        double stretch = (double)(plan.events[6].time_ns - plan.events[4].time_ns) / spacing;
+        CHECK(across > 0.45 && across < 0.55);
+        double expected = 1.0 + 0.5 * ((double)KeyboardTravel(KeyboardKey(model.keyboard, 'f'),
+                                                              KeyboardKey(model.keyboard, 'b')) /
+                                       model.keyboard->mean_travel - 1.0);
+        CHECK(stretch > 1.0 && stretch > expected * 0.95 && stretch < expected * 1.05);
+    }
+    CleanupPlan(&plan);
+    CloseSink(sink);
+}
+
+// A recorded plan reads back exactly as written, however it is written and
+// read in pieces, and a trace cut short is reported rather than replayed
+static void TestTraceRoundTrip(void) {
+    KeySink* sink = OpenNullSink();
+    HumanizeProfile profile;
+    DefaultHumanizeProfile(&profile);
+    profile.typo_probability = 0.2;
+    HumanizeModel model;
+    BuildHumanizeModel(&model, &profile);
+    KeyPlan plan;
+    KeyPlanner planner;
+    CHECK(PlanInPieces(sink, &model, 7, sample_text, sizeof(sample_text) - 1, 0, &plan, &planner));
+
+    // Every optional field of a record, at its widest, and a repeated key
+    KeyEvent tail[2] = {
+        { plan.count ? plan.events[plan.count - 1].time_ns + UINT32_MAX : 0, 0x10FFFF,
+          KEY_MOD_SHIFT | KEY_MOD_CTRL | KEY_MOD_ALT | KEY_MOD_ALTGR, KEY_EVENT_UNICODE | KEY_EVENT_HOLD },
+        { 0, 0x10FFFF, 0, KEY_EVENT_UP },
+    };
+    tail[1].time_ns = tail[0].time_ns;
+    size_t total = plan.count + 2;
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s", WriteTestFile("trace.hktr", "", 0));
+    TraceWriter writer;
+    CHECK(OpenTraceWriter(&writer, path, sink->name));
+    CHECK(WriteTraceEvents(&writer, plan.events, plan.count / 2));
+    CHECK(WriteTraceEvents(&writer, plan.events + plan.count / 2, plan.count - plan.count / 2));
+    CHECK(WriteTraceEvents(&writer, tail, 2));
+    CHECK(CloseTraceWriter(&writer));
+
+    KeyEvent* events = (KeyEvent*)calloc(total + 1, sizeof(KeyEvent));
+    TraceReader reader;
+    bool opened = events && OpenTraceReader(&reader, path);
+    CHECK(opened);
+    if (opened) {
+        CHECK(reader.event_count == total && reader.duration_ns == tail[1].time_ns);
+        CHECK(strcmp(reader.sink, sink->name) == 0);
+        size_t read = 0;
+        for (size_t got; (got = ReadTraceEvents(&reader, events + read, 3)) > 0;) {
+            read += got;
+        }
+        CHECK_EQ_SIZE(read, total);
+        CHECK(!reader.failed);
+        CHECK(memcmp(events, plan.events, plan.count * sizeof(KeyEvent)) == 0);
+        CHECK(memcmp(events + plan.count, tail, sizeof(tail)) == 0);
+
+        // The same file without its last byte
+        uint8_t* bytes = (uint8_t*)malloc(reader.size);
+        size_t size = reader.size;
+        if (bytes) {
+            memcpy(bytes, reader.data, size);
+        }
+        CloseTraceReader(&reader);
+        opened = bytes && OpenTraceReader(&reader, WriteTestFile("cut.hktr", bytes, size - 1));
+        CHECK(opened);
+        if (opened) {
+            CHECK(ReadTraceEvents(&reader, events, total + 1) < total);
+            CHECK(reader.failed);
+            CloseTraceReader(&reader);
+        }
+
+        // Not a trace at all
+        if (bytes) {
+            bytes[0] = 'X';
+            CHECK(!OpenTraceReader(&reader, WriteTestFile("bad.hktr", bytes, size)));
+        }
+        free(bytes);
+    }
+    free(events);
+    CleanupPlan(&plan);
+    CloseSink(sink);
+}
+
+int main(void) {
+    RUN_TEST(TestSteadyPlan);
+    RUN_TEST(TestChunkedPlansMatch);
+    RUN_TEST(TestMalformedText);
+    RUN_TEST(TestBurstLength);
+    RUN_TEST(TestRingKeystrokes);
+    RUN_TEST(TestRingAcrossThreads);
+    RUN_TEST(TestRingSplitsOversizedKeystroke);
+    RUN_TEST(TestSimultaneousKeystrokes);
+    RUN_TEST(TestDirectiveLexer);
+    RUN_TEST(TestDigraphDelays);
+    RUN_TEST(TestKeyboardTables);
+    RUN_TEST(TestTyposFollowKeyboard);
+    RUN_TEST(TestTravelTiming);
+    RUN_TEST(TestTraceRoundTrip);
+    return test_failures ? 1 : 0;
+}
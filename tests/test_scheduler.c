@@ -0,0 +1,175 @@
+// The scheduler's heap is private to scheduler.c, so the test builds it in
+// and drives one scheduler thread by hand on a virtual clock
+#include "scheduler.c"
+#include "test.h"
+
+#define STREAM_COUNT 40
+#define MS 1000000ULL
+#define CANCEL_AT_NS (3000 * MS)
+
+// Sink that checks each stream's keystrokes go out in order, on time
+typedef struct {
+    KeySink base;
+    const TypingStream* stream; // Set once the stream exists
+    uint64_t last_time_ns;      // Plan time of the last event emitted
+    size_t events;
+} OrderSink;
+
+static SchedulerThread thread;
+static uint64_t virtual_now_ns;
+
+// Outcome of each stream, filled in by its done callback
+typedef struct {
+    TextSource* source;
+    bool done;
+    const char* error;
+    size_t chars_typed;
+    size_t unmapped_chars;
+} StreamResult;
+
+static bool OrderEmit(KeySink* sink, const KeyEvent* events, size_t count) {
+    OrderSink* order = (OrderSink*)sink;
+    // No coalescing: the keystroke is due exactly now on the stream's timeline
+    CHECK(order->stream && order->stream->origin_ns + events[0].time_ns == virtual_now_ns);
+    for (size_t i = 0; i < count; i++) {
+        CHECK(events[i].time_ns >= order->last_time_ns);
+        order->last_time_ns = events[i].time_ns;
+    }
+    order->events += count;
+    return true;
+}
+
+static bool InHeap(const TypingSimulator* simulator) {
+    for (size_t i = 0; i < thread.count; i++) {
+        if (thread.heap[i]->simulator == simulator) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void StreamDone(TypingSimulator* simulator, const TypingReport* report, void* context) {
+    StreamResult* result = (StreamResult*)context;
+    CHECK(!result->done);
+    CHECK(!InHeap(simulator));
+    result->done = true;
+    result->error = report->error;
+    result->chars_typed = report->chars_typed;
+    result->unmapped_chars = report->unmapped_chars;
+    CloseTextSource(result->source);
+}
+
+// Every parent is due no later than its children
+static bool HeapOrdered(void) {
+    for (size_t i = 1; i < thread.count; i++) {
+        if (thread.heap[(i - 1) / SCHEDULER_HEAP_ARITY]->deadline_ns > thread.heap[i]->deadline_ns) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Many humanized streams with staggered starts share one thread: keystrokes
+// leave in deadline order, each stream's in its own order and on time, and
+// streams leave the heap when they finish or are cancelled
+static void TestInterleavedStreams(void) {
+    static TypingSimulator simulators[STREAM_COUNT];
+    static OrderSink sinks[STREAM_COUNT];
+    static RunControl controls[STREAM_COUNT];
+    static StreamResult results[STREAM_COUNT];
+    static char texts[STREAM_COUNT][1200];
+    KeySink* null_sink = OpenNullSink();
+    TypingScheduler scheduler;
+    memset(&scheduler, 0, sizeof(scheduler));
+    pthread_mutex_init(&scheduler.lock, NULL);
+    pthread_cond_init(&scheduler.idle, NULL);
+    memset(&thread, 0, sizeof(thread));
+    thread.scheduler = &scheduler;
+    thread.lateness.min = UINT64_MAX;
+    atomic_init(&thread.load, 0);
+
+    for (size_t i = 0; i < STREAM_COUNT; i++) {
+        // Long enough to be planned in several pieces
+        size_t length = 0;
+        while (length + 64 < sizeof(texts[i])) {
+            length += (size_t)snprintf(texts[i] + length, sizeof(texts[i]) - length,
+                                       "Stream %zu types its own words, piece %zu.\n", i, length);
+        }
+        sinks[i].base.name = "order";
+        sinks[i].base.layout = null_sink->layout;
+        sinks[i].base.Emit = OrderEmit;
+        InitializeSimulator(&simulators[i], &sinks[i].base, 200.0 + 37.0 * (double)i);
+        simulators[i].seed = i;
+        // Every fifth stream is cancelled part way through
+        if (i % 5 == 2) {
+            CHECK(InitializeRunControl(&controls[i]));
+            simulators[i].control = &controls[i];
+        }
+
+        results[i].source = OpenMemoryTextSource(texts[i], length);
+        CHECK(results[i].source != NULL);
+        TypingStream* stream = results[i].source
+            ? CreateStream(&simulators[i], results[i].source, i * 13 * MS, StreamDone, &results[i]) : NULL;
+        CHECK(stream != NULL);
+        if (stream) {
+            sinks[i].stream = stream;
+            scheduler.active++;
+            atomic_fetch_add(&thread.load, 1);
+            CHECK(HeapPush(&thread, stream));
+        }
+    }
+
+    bool cancelled = false;
+    size_t steps = 0;
+    while (thread.count) {
+        if (!HeapOrdered()) {
+            CHECK(HeapOrdered());
+            break;
+        }
+        uint64_t due_ns = thread.heap[0]->deadline_ns;
+        CHECK(due_ns >= virtual_now_ns);
+        virtual_now_ns = due_ns;
+        if (!cancelled && virtual_now_ns >= CANCEL_AT_NS) {
+            for (size_t i = 2; i < STREAM_COUNT; i += 5) {
+                RequestStop(&controls[i]);
+            }
+            cancelled = true;
+        }
+        RunEarliestStream(&thread, virtual_now_ns);
+        steps++;
+    }
+    CHECK(cancelled);
+    CHECK_EQ_SIZE(scheduler.active, 0);
+    CHECK_EQ_SIZE(atomic_load(&thread.load), 0);
+    CHECK(thread.lateness.max == 0);
+
+    size_t typed = 0;
+    for (size_t i = 0; i < STREAM_COUNT; i++) {
+        CHECK(results[i].done);
+        CHECK_EQ_SIZE(results[i].unmapped_chars, 0);
+        if (i % 5 == 2) {
+            CHECK(results[i].error && strcmp(results[i].error, "Cancelled") == 0);
+            CHECK(results[i].chars_typed > 0 && results[i].chars_typed < strlen(texts[i]));
+            DestroyRunControl(&controls[i]);
+        } else {
+            CHECK(results[i].error == NULL);
+            CHECK_EQ_SIZE(results[i].chars_typed, strlen(texts[i]));
+        }
+        CHECK(sinks[i].events > 0);
+        typed += results[i].chars_typed;
+        CleanupSimulator(&simulators[i]);
+    }
+
+    // One keystroke per step at least, typos on top
+    CHECK(steps >= typed);
+
+    free(thread.heap);
+    pthread_cond_destroy(&scheduler.idle);
+    pthread_mutex_destroy(&scheduler.lock);
+    CloseSink(null_sink);
+}
+
+int main(void) {
+    RUN_TEST(TestInterleavedStreams);
+    return test_failures ? 1 : 0;
+}
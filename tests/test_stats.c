@@ -0,0 +1,143 @@
+#include "humanizer.h"
+#include "test.h"
+
+#define MS 1000000ULL
+#define FAKE_ORIGIN_NS 5000000000ULL
+
+static TypingMeter meter;
+static LiveTypingStats live;
+
+// Start a session whose active timeline begins at FAKE_ORIGIN_NS on the monotonic clock
+static void StartSession(void) {
+    ResetTypingMeter(&meter);
+    ResetLiveTypingStats(&live);
+    atomic_store_explicit(&live.start_ns, FAKE_ORIGIN_NS, memory_order_relaxed);
+}
+
+// Snapshot the statistics as if now_ns of active time had passed: a pause
+// freezes the clock UpdateTypingStats reads, which makes a fake one
+static void StatsAt(uint64_t now_ns, TypingStats* stats) {
+    atomic_store_explicit(&live.paused_ns, FAKE_ORIGIN_NS + now_ns, memory_order_relaxed);
+    UpdateTypingStats(stats, &live);
+}
+
+// Whether actual is expected up to rounding
+static bool Near(double actual, double expected) {
+    double difference = actual > expected ? actual - expected : expected - actual;
+    return difference <= 1e-9 * (expected > 0 ? expected : -expected) + 1e-12;
+}
+
+// Evenly spaced characters: every speed is the spacing's, and the window
+// speed keeps falling once they stop
+static void TestSteadySpeeds(void) {
+    StartSession();
+    for (uint64_t i = 0; i < 100; i++) {
+        RecordKeystroke(&meter, &live, i * 100 * MS, (i % 5 == 4) ? KEY_EVENT_WORD_END : 0);
+    }
+
+    TypingStats stats;
+    StatsAt(9900 * MS, &stats);
+    CHECK_EQ_SIZE(stats.chars_typed, 100);
+    CHECK_EQ_SIZE(stats.words_typed, 20);
+    CHECK(Near(stats.elapsed_time, 9.9));
+    CHECK(Near(stats.current_cpm, 600.0));
+    CHECK(Near(stats.current_wpm, 120.0));
+    CHECK(Near(stats.instant_wpm, 120.0));
+    CHECK(Near(stats.average_wpm, 100.0 / CHARS_PER_WORD / (9.9 / 60.0)));
+    CHECK(stats.accuracy == 1.0);
+
+    // Ten seconds later nothing left the window yet, but it spans twice the time
+    StatsAt(19800 * MS, &stats);
+    CHECK(Near(stats.current_wpm, 60.0));
+    CHECK(Near(stats.instant_wpm, 7.0 / CHARS_PER_WORD / (10.6 / 60.0)));
+}
+
+// A character after a pause longer than the window evicts everything before
+// it; the instantaneous speed still spans the last few characters
+static void TestWindowEviction(void) {
+    StartSession();
+    for (uint64_t i = 0; i < 50; i++) {
+        RecordKeystroke(&meter, &live, i * 100 * MS, 0);
+    }
+    RecordKeystroke(&meter, &live, 30000 * MS, 0);
+
+    TypingStats stats;
+    StatsAt(30000 * MS, &stats);
+    CHECK_EQ_SIZE(atomic_load(&live.window_chars), 1);
+    CHECK(atomic_load(&live.window_start_ns) == 30000 * MS);
+    CHECK(stats.current_wpm == 0.0);
+    CHECK(Near(stats.instant_wpm, 7.0 / CHARS_PER_WORD / ((30000.0 - 4300.0) / 60000.0)));
+
+    for (uint64_t i = 1; i <= 10; i++) {
+        RecordKeystroke(&meter, &live, 30000 * MS + i * 50 * MS, 0);
+    }
+    StatsAt(30500 * MS, &stats);
+    CHECK_EQ_SIZE(atomic_load(&live.window_chars), 11);
+    CHECK(Near(stats.current_cpm, 1200.0));
+    CHECK(Near(stats.instant_wpm, 240.0));
+
+    // Characters leave one by one as the window slides past them
+    RecordKeystroke(&meter, &live, 40025 * MS, 0);
+    CHECK_EQ_SIZE(atomic_load(&live.window_chars), 11);
+    CHECK(atomic_load(&live.window_start_ns) == 30050 * MS);
+    CHECK_EQ_SIZE(meter.chars_typed, 62);
+}
+
+// More characters inside the window than the ring holds: the oldest are
+// overwritten and the window keeps exactly the ring's worth
+static void TestRingWrapAround(void) {
+    StartSession();
+    uint64_t count = 3 * RATE_WINDOW_CAPACITY + 5;
+    for (uint64_t i = 0; i < count; i++) {
+        RecordKeystroke(&meter, &live, i * MS, 0);
+        if (i % 1000 == 999) {
+            // Typos do not enter the ring
+            RecordKeystroke(&meter, &live, i * MS, KEY_EVENT_CORRECTION);
+            RecordKeystroke(&meter, &live, i * MS, KEY_EVENT_CORRECTION | KEY_EVENT_ERASE);
+        }
+    }
+
+    TypingStats stats;
+    StatsAt((count - 1) * MS, &stats);
+    CHECK_EQ_SIZE(stats.chars_typed, count);
+    CHECK_EQ_SIZE(atomic_load(&live.window_chars), RATE_WINDOW_CAPACITY);
+    CHECK(atomic_load(&live.window_start_ns) == (count - RATE_WINDOW_CAPACITY) * MS);
+    CHECK(atomic_load(&live.instant_start_ns) == (count - RATE_INSTANT_CHARS) * MS);
+    CHECK(Near(stats.current_cpm, 60000.0));
+    CHECK(Near(stats.instant_wpm, 60000.0 / CHARS_PER_WORD));
+}
+
+// Typos and their backspaces are counted apart from the text; accuracy is
+// the share of keystrokes that were not typos
+static void TestAccuracy(void) {
+    StartSession();
+    TypingStats stats;
+    StatsAt(0, &stats);
+    CHECK(stats.accuracy == 1.0);
+    CHECK(stats.current_wpm == 0.0 && stats.instant_wpm == 0.0 && stats.average_wpm == 0.0);
+
+    static const uint16_t flags[] = {
+        0, KEY_EVENT_CORRECTION, KEY_EVENT_CORRECTION | KEY_EVENT_ERASE, 0, KEY_EVENT_WORD_END,
+        0, 0, KEY_EVENT_CORRECTION, KEY_EVENT_CORRECTION | KEY_EVENT_ERASE, 0,
+        KEY_EVENT_CORRECTION, KEY_EVENT_CORRECTION | KEY_EVENT_ERASE, KEY_EVENT_WORD_END,
+    };
+    for (size_t i = 0; i < sizeof(flags) / sizeof(flags[0]); i++) {
+        RecordKeystroke(&meter, &live, i * 100 * MS, flags[i]);
+    }
+
+    StatsAt(1200 * MS, &stats);
+    CHECK_EQ_SIZE(stats.chars_typed, 7);
+    CHECK_EQ_SIZE(stats.words_typed, 2);
+    CHECK_EQ_SIZE(stats.typos, 3);
+    CHECK_EQ_SIZE(stats.corrections, 3);
+    CHECK(Near(stats.accuracy, 0.7));
+    CHECK(Near(stats.current_cpm, 6.0 / (1.2 / 60.0)));
+}
+
+int main(void) {
+    RUN_TEST(TestSteadySpeeds);
+    RUN_TEST(TestWindowEviction);
+    RUN_TEST(TestRingWrapAround);
+    RUN_TEST(TestAccuracy);
+    return test_failures ? 1 : 0;
+}
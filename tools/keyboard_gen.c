@@ -0,0 +1,282 @@
+#include "keyboard.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <uchar.h>
+
+// Writes core/keyboard_tables.c: the key geometry and layout tables declared
+// in core/keyboard.h, worked out here from the row stagger, the touch-typing
+// finger columns and each layout's rows of characters. CMake builds it and
+// compiles the library against its output; run it by hand (keyboard_gen
+// core/keyboard_tables.c) after a change so builds without CMake see it too.
+
+// Keys per row of the main block and where each row starts, in key widths
+#define ROWS 4
+static const size_t kRowKeys[ROWS] = { 13, 13, 11, 10 };
+static const double kRowOffset[ROWS] = { 0.0, 1.5, 1.75, 2.25 };
+
+// Centre of the space bar on an ANSI board (three 1.25 wide modifiers, then 6.25)
+#define SPACE_X 6.875
+
+// Keys whose centres lie closer than this are neighbours (a row over and half
+// a key across is 1.12, a row over and a key and a half across 1.8)
+#define NEIGHBOR_DISTANCE 1.3
+
+// Finger of each touch-typing column: 0-1 left little, 2 ring, 3 middle, 4-5
+// index; 6-7 right index, 8 middle, 9 ring, 10 on right little. Rows below
+// the number row start one column in.
+static const uint8_t kColumnFingers[] = { 4, 4, 3, 2, 1, 1, 1, 1, 2, 3, 4 };
+
+// Each layout's rows, unshifted and shifted; a space marks a key with nothing
+// on Shift. Keys the ANSI block lacks (the ISO key beside left Shift) are left
+// out, and the ANSI backslash key carries the ISO key beside Enter.
+typedef struct {
+    const char* name;
+    const char32_t* rows[ROWS];
+    const char32_t* shifted[ROWS];
+} LayoutRows;
+
+static const LayoutRows kLayouts[KEYBOARD_LAYOUT_COUNT] = {
+    { "qwerty",
+      { U"`1234567890-=", U"qwertyuiop[]\\", U"asdfghjkl;'", U"zxcvbnm,./" },
+      { U"~!@#$%^&*()_+", U"QWERTYUIOP{}|", U"ASDFGHJKL:\"", U"ZXCVBNM<>?" } },
+    { "azerty",
+      { U"\u00B2&\u00E9\"'(-\u00E8_\u00E7\u00E0)=", U"azertyuiop^$*", U"qsdfghjklm\u00F9", U"wxcvbn,;:!" },
+      { U" 1234567890\u00B0+", U"AZERTYUIOP\u00A8\u00A3\u00B5", U"QSDFGHJKLM%", U"WXCVBN?./\u00A7" } },
+    { "qwertz",
+      { U"^1234567890\u00DF\u00B4", U"qwertzuiop\u00FC+#", U"asdfghjkl\u00F6\u00E4", U"yxcvbnm,.-" },
+      { U"\u00B0!\"\u00A7$%&/()=?`", U"QWERTZUIOP\u00DC*'", U"ASDFGHJKL\u00D6\u00C4", U"YXCVBNM;:_" } },
+    { "dvorak",
+      { U"`1234567890[]", U"',.pyfgcrl/=\\", U"aoeuidhtns-", U";qjkxbmwvz" },
+      { U"~!@#$%^&*(){}", U"\"<>PYFGCRL?+|", U"AOEUIDHTNS_", U":QJKXBMWVZ" } },
+    { "colemak",
+      { U"`1234567890-=", U"qwfpgjluy;[]\\", U"arstdhneio'", U"zxcvbkm,./" },
+      { U"~!@#$%^&*()_+", U"QWFPGJLUY:{}|", U"ARSTDHNEIO\"", U"ZXCVBKM<>?" } },
+};
+
+// English text whose character pairs set each layout's mean hand travel
+static const char kSampleText[] =
+    "The quick brown fox jumps over the lazy dog. It was the best of times, it was the worst of "
+    "times, it was the age of wisdom, it was the age of foolishness. Call me Ishmael. Some years "
+    "ago, never mind how long precisely, having little or no money in my purse, and nothing in "
+    "particular to interest me on shore, I thought I would sail about a little and see the watery "
+    "part of the world. All happy families are alike; each unhappy family is unhappy in its own way. "
+    "People should type the words they know with the fingers they have, and nobody types every "
+    "letter at the same speed: common pairs come quickly while awkward stretches take longer.";
+
+typedef struct {
+    double x;
+    double y;
+    uint8_t hand;
+    uint8_t finger;
+    uint8_t row;
+} KeyGeometry;
+
+// Place every key and assign its finger
+static void PlaceKeys(KeyGeometry* keys) {
+    size_t key = 0;
+    for (size_t row = 0; row < ROWS; row++) {
+        for (size_t i = 0; i < kRowKeys[row]; i++, key++) {
+            size_t column = i + (row > 0);
+            keys[key].x = kRowOffset[row] + (double)i + 0.5;
+            keys[key].y = (double)row;
+            keys[key].hand = column <= 5 ? KEYBOARD_HAND_LEFT : KEYBOARD_HAND_RIGHT;
+            keys[key].finger = kColumnFingers[column < 10 ? column : 10];
+            keys[key].row = (uint8_t)row;
+        }
+    }
+    keys[KEYBOARD_SPACE].x = SPACE_X;
+    keys[KEYBOARD_SPACE].y = ROWS;
+    keys[KEYBOARD_SPACE].hand = KEYBOARD_HAND_THUMB;
+    keys[KEYBOARD_SPACE].finger = 0;
+    keys[KEYBOARD_SPACE].row = ROWS;
+}
+
+static double KeyDistance(const KeyGeometry* a, const KeyGeometry* b) {
+    return sqrt((a->x - b->x) * (a->x - b->x) + (a->y - b->y) * (a->y - b->y));
+}
+
+// Lowercase of a Latin-1 letter, 0 for anything else
+static uint32_t LowerLetter(uint32_t c) {
+    if ((c >= 'a' && c <= 'z') || (c >= 0xE0 && c <= 0xFE && c != 0xF7)) {
+        return c;
+    }
+    if ((c >= 'A' && c <= 'Z') || (c >= 0xC0 && c <= 0xDE && c != 0xD7)) {
+        return c + 0x20;
+    }
+    return 0;
+}
+
+// Fill a layout's character and lookup tables; false if its rows are malformed
+static bool BuildLayout(const LayoutRows* rows, KeyboardLayout* layout) {
+    memset(layout, 0, sizeof(*layout));
+    memset(layout->keys, KEYBOARD_NONE, sizeof(layout->keys));
+    layout->name = rows->name;
+
+    size_t key = 0;
+    for (size_t row = 0; row < ROWS; row++) {
+        for (size_t i = 0; i < kRowKeys[row]; i++, key++) {
+            char32_t plain = rows->rows[row][i];
+            char32_t shifted = rows->shifted[row][i];
+            if (!plain || !shifted || plain >= 256 || shifted >= 256) {
+                fprintf(stderr, "Error: Row %zu of %s is too short or leaves Latin-1\n", row, rows->name);
+                return false;
+            }
+            layout->characters[key][0] = (uint16_t)plain;
+            layout->characters[key][1] = shifted == ' ' ? 0 : (uint16_t)shifted;
+        }
+        if (rows->rows[row][kRowKeys[row]] || rows->shifted[row][kRowKeys[row]]) {
+            fprintf(stderr, "Error: Row %zu of %s is too long\n", row, rows->name);
+            return false;
+        }
+    }
+    layout->characters[KEYBOARD_SPACE][0] = ' ';
+    layout->characters[KEYBOARD_SPACE][1] = ' ';
+
+    // A character on two keys is typed with the first, and unshifted if it can be
+    for (int shift = 0; shift < 2; shift++) {
+        for (key = 0; key < KEYBOARD_KEYS; key++) {
+            uint16_t c = layout->characters[key][shift];
+            if (c && layout->keys[c] == KEYBOARD_NONE) {
+                layout->keys[c] = (uint8_t)(key | (shift ? KEYBOARD_SHIFT : 0));
+            }
+        }
+    }
+
+    for (key = 0; key < KEYBOARD_KEYS; key++) {
+        uint32_t lower = LowerLetter(layout->characters[key][0]);
+        if (lower == layout->characters[key][0] && lower - 0x20 == layout->characters[key][1]) {
+            layout->letters |= 1ULL << key;
+        }
+    }
+    return true;
+}
+
+// Mean distance a hand travels between successive characters of the sample
+// text, in tenths (KeyboardTravel: keys on different hands need none)
+static double MeanTravel(const KeyboardLayout* layout, const KeyGeometry* keys) {
+    double total = 0.0;
+    size_t pairs = 0;
+    for (size_t i = 1; kSampleText[i]; i++) {
+        uint8_t a = layout->keys[(unsigned char)kSampleText[i - 1]];
+        uint8_t b = layout->keys[(unsigned char)kSampleText[i]];
+        if (a == KEYBOARD_NONE || b == KEYBOARD_NONE) {
+            continue;
+        }
+        const KeyGeometry* from = &keys[a & KEYBOARD_KEY_MASK];
+        const KeyGeometry* to = &keys[b & KEYBOARD_KEY_MASK];
+        if (from->hand == to->hand) {
+            total += KeyDistance(from, to);
+        }
+        pairs++;
+    }
+    return total / (double)pairs * KEYBOARD_DISTANCE_UNIT;
+}
+
+// Print a table of bytes, sixteen to a line
+static void WriteBytes(FILE* out, const char* indent, const uint8_t* bytes, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        fprintf(out, "%s%u,%s", i % 16 ? "" : indent, bytes[i], i % 16 == 15 || i + 1 == count ? "\n" : " ");
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "Usage: keyboard_gen OUTPUT.c\n");
+        return 2;
+    }
+
+    KeyGeometry keys[KEYBOARD_KEYS];
+    PlaceKeys(keys);
+
+    uint8_t distance[KEYBOARD_KEYS][KEYBOARD_KEYS];
+    uint8_t neighbor_count[KEYBOARD_KEYS] = { 0 };
+    uint8_t neighbors[KEYBOARD_KEYS][KEYBOARD_MAX_NEIGHBORS];
+    memset(neighbors, KEYBOARD_NONE, sizeof(neighbors));
+    for (size_t a = 0; a < KEYBOARD_KEYS; a++) {
+        for (size_t b = 0; b < KEYBOARD_KEYS; b++) {
+            double d = KeyDistance(&keys[a], &keys[b]);
+            double tenths = d * KEYBOARD_DISTANCE_UNIT + 0.5;
+            distance[a][b] = tenths < 255.0 ? (uint8_t)tenths : 255;
+            if (a == b || a == KEYBOARD_SPACE || b == KEYBOARD_SPACE || d >= NEIGHBOR_DISTANCE) {
+                continue;
+            }
+            if (neighbor_count[a] == KEYBOARD_MAX_NEIGHBORS) {
+                fprintf(stderr, "Error: Key %zu has more than %d neighbours\n", a, KEYBOARD_MAX_NEIGHBORS);
+                return 1;
+            }
+            neighbors[a][neighbor_count[a]++] = (uint8_t)b;
+        }
+    }
+
+    static KeyboardLayout layouts[KEYBOARD_LAYOUT_COUNT];
+    for (size_t i = 0; i < KEYBOARD_LAYOUT_COUNT; i++) {
+        if (!BuildLayout(&kLayouts[i], &layouts[i])) {
+            return 1;
+        }
+        layouts[i].mean_travel = MeanTravel(&layouts[i], keys);
+    }
+
+    FILE* out = fopen(argv[1], "w");
+    if (!out) {
+        fprintf(stderr, "Error: Could not write %s\n", argv[1]);
+        return 1;
+    }
+    fprintf(out, "// Generated by tools/keyboard_gen.c; edit that and regenerate instead of this\n\n");
+    fprintf(out, "#include \"keyboard.h\"\n\n");
+
+    uint8_t column[KEYBOARD_KEYS];
+    static const char* const kColumns[] = { "kKeyboardHand", "kKeyboardFinger", "kKeyboardRow" };
+    for (size_t table = 0; table < 3; table++) {
+        for (size_t key = 0; key < KEYBOARD_KEYS; key++) {
+            column[key] = table == 0 ? keys[key].hand : table == 1 ? keys[key].finger : keys[key].row;
+        }
+        fprintf(out, "const uint8_t %s[KEYBOARD_KEYS] = {\n", kColumns[table]);
+        WriteBytes(out, "    ", column, KEYBOARD_KEYS);
+        fprintf(out, "};\n\n");
+    }
+
+    fprintf(out, "const uint8_t kKeyboardNeighborCount[KEYBOARD_KEYS] = {\n");
+    WriteBytes(out, "    ", neighbor_count, KEYBOARD_KEYS);
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "const uint8_t kKeyboardNeighbors[KEYBOARD_KEYS][KEYBOARD_MAX_NEIGHBORS] = {\n");
+    for (size_t key = 0; key < KEYBOARD_KEYS; key++) {
+        fprintf(out, "    {");
+        for (size_t i = 0; i < KEYBOARD_MAX_NEIGHBORS; i++) {
+            fprintf(out, "%s%u", i ? ", " : " ", neighbors[key][i]);
+        }
+        fprintf(out, " },\n");
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "const uint8_t kKeyboardDistance[KEYBOARD_KEYS][KEYBOARD_KEYS] = {\n");
+    for (size_t key = 0; key < KEYBOARD_KEYS; key++) {
+        fprintf(out, "    {\n");
+        WriteBytes(out, "        ", distance[key], KEYBOARD_KEYS);
+        fprintf(out, "    },\n");
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "const KeyboardLayout kKeyboardLayouts[KEYBOARD_LAYOUT_COUNT] = {\n");
+    for (size_t i = 0; i < KEYBOARD_LAYOUT_COUNT; i++) {
+        const KeyboardLayout* layout = &layouts[i];
+        fprintf(out, "    {\n        \"%s\",\n        {\n", layout->name);
+        for (size_t key = 0; key < KEYBOARD_KEYS; key++) {
+            fprintf(out, "%s{ 0x%02X, 0x%02X },%s", key % 8 ? "" : "            ", layout->characters[key][0],
+                    layout->characters[key][1], key % 8 == 7 || key + 1 == KEYBOARD_KEYS ? "\n" : " ");
+        }
+        fprintf(out, "        },\n        {\n");
+        WriteBytes(out, "            ", layout->keys, sizeof(layout->keys));
+        fprintf(out, "        },\n        0x%016llXULL,\n        %.4f,\n    },\n", (unsigned long long)layout->letters,
+                layout->mean_travel);
+    }
+    fprintf(out, "};\n");
+
+    if (fclose(out) != 0) {
+        fprintf(stderr, "Error: Could not write %s\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}